@@ -20,11 +20,52 @@
 
 #define BLOCK_SIZE 8
 
+// blocks along each side of a block page, see level_t::blocks
+#define BLOCK_PAGE_SIZE 8
+
+// size of object broadphase cells, should be around the diameter of the
+// objects which collide with each other
+#define BROADPHASE_CELL_SIZE 2
+
+// objects moving within a bucket of this size keep their cached line of sight
+// results, see level/los.h
+#define LOS_BUCKET_SIZE 0.25f
+
+// max. number of cached line of sight pairs before the cache is cleared
+#define LOS_CACHE_MAX 8192
+
+// max. floor height which navigation paths may step up, and the additional
+// cost per unit of height stepped up or down
+#define NAV_STEP_HEIGHT 0.5f
+#define NAV_STEP_COST 2.0f
+
+// max. number of agent sizes which keep their own flow field towards the
+// player, see nav_player_field
+#define NAV_PLAYER_FIELDS 4
+
+// objects slower than this which are on the floor for this many consecutive
+// frames are put to sleep, see objects_update
+#define OBJECT_REST_SPEED 0.01f
+#define OBJECT_REST_FRAMES 30
+
+// actor timer wheel dimensions, actors can sleep for up to
+// ACTOR_WHEEL_SLOTS^ACTOR_WHEEL_LEVELS - 1 ticks
+#define ACTOR_WHEEL_BITS 6
+#define ACTOR_WHEEL_SLOTS (1 << ACTOR_WHEEL_BITS)
+#define ACTOR_WHEEL_LEVELS 4
+
+// max. sectors for which visibility is stored as a dense n x n matrix (2 MiB)
+#define VISIBILITY_DENSE_MAX 4096
+
 #define LIGHT_MAX 31
 #define LIGHT_EXTRA 35
 
 #define MAPEDITOR
 
+// level vertices are packed into 24 bytes (shorts for ids/flags, unorm16 uvs)
+// instead of 32 bytes of floats, see renderer.c
+#define RENDERER_PACKED_VERTICES
+
 // TODO
 #define RELOADABLE
 
@@ -7,6 +7,13 @@
 
 enum { VERSION = 1 };
 
+// cached atlas entry of one resource, see atlas_lookup_handle. zero
+// initialized handles are stale
+typedef struct atlas_handle {
+    int id, generation;
+    bool found;
+} atlas_handle_t;
+
 typedef enum {
     GAMEMODE_MENU,
     GAMEMODE_EDITOR,
@@ -56,6 +63,7 @@ enum {
     OTF_INVISIBLE       = 1 << 1,
     OTF_NO_VERSION_BUMP = 1 << 2,
     OTF_PROJECTILE      = 1 << 3,
+    OTF_SOLID           = 1 << 4,
 };
 
 // object flags
@@ -171,6 +179,7 @@ typedef struct side_segment side_segment_t;
 typedef struct sidemat sidemat_t;
 typedef struct sector sector_t;
 typedef struct subsector subsector_t;
+typedef struct nav_field nav_field_t;
 typedef struct sectmat sectmat_t;
 typedef struct object object_t;
 typedef struct decal decal_t;
@@ -3,6 +3,7 @@
 #include "editor/editor.h"
 #include "editor/cursor.h"
 #include "level/level.h"
+#include "level/locate.h"
 #include "level/lptr.h"
 #include "level/vertex.h"
 #include "level/wall.h"
@@ -2,6 +2,7 @@
 #include "editor/editor.h"
 #include "editor/cursor.h"
 #include "level/level.h"
+#include "level/block.h"
 #include "level/lptr.h"
 #include "level/vertex.h"
 #include "level/wall.h"
@@ -799,8 +800,6 @@ void editor_map_frame(editor_t *ed) {
             pmax = editor_screen_to_map(ed, IVEC_TO_V(ed->size));
 
         const ivec2s
-            boffset = ed->level->blocks.offset,
-            bsize = ed->level->blocks.size,
             bmin = IVEC2(pmin.x / BLOCK_SIZE, pmin.y / BLOCK_SIZE),
             bmax = IVEC2(pmax.x / BLOCK_SIZE, pmax.y / BLOCK_SIZE),
             bmcursor = IVEC2(
@@ -810,17 +809,9 @@ void editor_map_frame(editor_t *ed) {
 
         for (int by = bmin.y; by <= bmax.y; by++) {
             for (int bx = bmin.x; bx <= bmax.x; bx++) {
-                // only draw block if it exists and contains some walls
-                if (bx < boffset.x
-                    || by < boffset.y
-                    || bx >= boffset.x + bsize.x
-                    || by >= boffset.y + bsize.y) {
-                    continue;
-                }
-
-                block_t *block =
-                    &ed->level->blocks.arr[
-                        (by - boffset.y) * bsize.x + (bx - boffset.x)];
+                // only draw block if it exists
+                block_t *block = level_get_block(ed->level, IVEC2(bx, by));
+                if (!block) { continue; }
 
                 const bool curbox = bx == bmcursor.x && by == bmcursor.y;
 
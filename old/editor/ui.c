@@ -5,6 +5,7 @@
 #include "editor/map.h"
 #include "level/level.h"
 #include "level/lptr.h"
+#include "level/block.h"
 #include "level/vertex.h"
 #include "level/wall.h"
 #include "level/side.h"
@@ -14,6 +15,7 @@
 #include "level/decal.h"
 #include "level/object.h"
 #include "level/tag.h"
+#include "level/visibility.h"
 #include "util/file.h"
 #include "util/input.h"
 #include "state.h"
@@ -1177,6 +1179,13 @@ static void edit_status(editor_t *ed) {
             igEndMenu();
         }
 
+        if (igBeginMenu("LEVEL", true)) {
+            if (igMenuItem_Bool("BAKE VISIBILITY", NULL, false, true)) {
+                visibility_bake(ed->level);
+            }
+            igEndMenu();
+        }
+
         igEndMenuBar();
     }
 
@@ -1395,6 +1404,47 @@ static void show_stats(editor_t *ed) {
 /*         igTreePop(); */
 /*     } */
 
+#define STAT(_n, _fmt, ...)  \
+    igTableNextRow(0, 0);    \
+    igTableSetColumnIndex(0);\
+    igText("%s", _n);        \
+    igTableSetColumnIndex(1);\
+    igText(_fmt, __VA_ARGS__)
+
+    if (igTreeNode_Str("LEVEL")) {
+        if (igBeginTable(
+                "LEVEL", 2, ImGuiTableFlags_None, (ImVec2) { 0, 0 }, 0.0f)) {
+            STAT(
+                "VISIBILITY (KiB)", "%.1f (%s%s)",
+                visibility_memory(ed->level) / 1024.0f,
+                visibility_is_sparse(ed->level) ? "SPARSE" : "DENSE",
+                ed->level->visibility.baked ? ", BAKED" : "");
+            STAT(
+                "BLOCK PAGES", "%d (%.1f KiB)",
+                (int) map_size(&ed->level->blocks.pages),
+                level_blocks_memory(ed->level) / 1024.0f);
+            STAT(
+                "BROADPHASE CELLS", "%d",
+                (int) map_size(&ed->level->broadphase.cells));
+            STAT(
+                "LOS HIT/MISS/REJECT", "%" PRIu64 "/%" PRIu64 "/%" PRIu64,
+                ed->level->los.hits,
+                ed->level->los.misses,
+                ed->level->los.rejects);
+            STAT(
+                "OBJECTS AWAKE/ASLEEP", "%d/%d",
+                (int) dynlist_size(ed->level->awake_objects),
+                level_get_list_count(ed->level, T_OBJECT)
+                    - (int) dynlist_size(ed->level->awake_objects));
+            STAT(
+                "ACTORS AWAKE/SLEEPING", "%d/%d",
+                ed->level->sched.n_awake,
+                ed->level->sched.n_sleeping);
+            igEndTable();
+        }
+
+        igTreePop();
+    }
 
     igEnd();
 #undef STAT
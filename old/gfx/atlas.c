@@ -2,6 +2,9 @@
 #include "util/file.h"
 #include "util/image.h"
 #include "util/resource.h"
+#include "util/time.h"
+
+// #define DO_BENCH_ATLAS_LOOKUP
 
 typedef struct atlas_entry {
     int id;
@@ -129,6 +132,14 @@ static bool insert(
 
     *dynlist_push(atlas->boxes[layer]) = entry;
 
+    if (entry->id >= (int) dynlist_size(atlas->entries)) {
+        dynlist_resize(atlas->entries, entry->id + 1);
+    }
+    atlas->entries[entry->id] = entry;
+
+    // handles which cached a NOTEX fallback may now resolve to this entry
+    atlas->generation++;
+
     char upper_name[256];
     snprintf(upper_name, sizeof(upper_name), "%s", name);
     strtoupper(upper_name);
@@ -167,8 +178,58 @@ static bool insert_from_path(
     return insert(atlas, name, data, size, box_out, layer_out);
 }
 
-void atlas_init(atlas_t *atlas) {
+void atlas_init_headless(atlas_t *atlas) {
     *atlas = (atlas_t) { 0 };
+    atlas->generation = 1;
+    atlas->headless = true;
+
+    atlas->coords_data = calloc(1, ATLAS_MAX_TEXTURES * sizeof(vec4s));
+    atlas->layer_data = calloc(1, ATLAS_MAX_TEXTURES * sizeof(u32));
+
+    map_init(
+        &atlas->lookup,
+        map_hash_str,
+        NULL,
+        NULL,
+        map_dup_str,
+        map_cmp_str,
+        map_default_free,
+        NULL,
+        NULL);
+
+    // create NOTEX
+    atlas_clear(atlas);
+
+#ifdef DO_BENCH_ATLAS_LOOKUP
+    // 10k sprites worth of lookups, by name and through a handle
+    const int n = 10000;
+    atlas_lookup_t lookup;
+    atlas_handle_t handle = { 0 };
+
+    const u64 t_name = time_ns();
+    for (int i = 0; i < n; i++) {
+        atlas_lookup(atlas, AS_RESOURCE(TEXTURE_NOTEX), &lookup);
+    }
+    const u64 ns_name = time_ns() - t_name;
+
+    const u64 t_handle = time_ns();
+    for (int i = 0; i < n; i++) {
+        atlas_lookup_handle(
+            atlas, &handle, AS_RESOURCE(TEXTURE_NOTEX), &lookup);
+    }
+    const u64 ns_handle = time_ns() - t_handle;
+
+    LOG(
+        "atlas lookup (%d): name %" PRIu64 "ns, handle %" PRIu64 "ns",
+        n, ns_name, ns_handle);
+    memset(&atlas->stats, 0, sizeof(atlas->stats));
+#endif // ifdef DO_BENCH_ATLAS_LOOKUP
+}
+
+void atlas_init(atlas_t *atlas) {
+    atlas_init_headless(atlas);
+    atlas->headless = false;
+
     atlas->image =
         sg_make_image(
             &(sg_image_desc) {
@@ -206,9 +267,6 @@ void atlas_init(atlas_t *atlas) {
                 .usage = SG_USAGE_DYNAMIC
             });
 
-    atlas->coords_data = calloc(1, ATLAS_MAX_TEXTURES * sizeof(vec4s));
-    atlas->layer_data = calloc(1, ATLAS_MAX_TEXTURES * sizeof(u32));
-
 #ifdef MAPEDITOR
     for (int i = 0; i < ATLAS_DEPTH; i++) {
         atlas->layer_images[i] =
@@ -224,35 +282,25 @@ void atlas_init(atlas_t *atlas) {
                 });
     }
 #endif // ifdef MAPEDITOR
-
-    map_init(
-        &atlas->lookup,
-        map_hash_str,
-        NULL,
-        NULL,
-        map_dup_str,
-        map_cmp_str,
-        map_default_free,
-        NULL,
-        NULL);
-
-    // create NOTEX
-    atlas_clear(atlas);
 }
 
 void atlas_destroy(atlas_t *atlas) {
 #ifdef MAPEDITOR
     dynlist_each(atlas->names, it) { free((void*) *it.el); }
     dynlist_free(atlas->names);
+#endif // ifdef MAPEDITOR
 
-    for (int i = 0; i < ATLAS_DEPTH; i++) {
-        sg_destroy_image(atlas->layer_images[i]);
-    }
+    if (!atlas->headless) {
+#ifdef MAPEDITOR
+        for (int i = 0; i < ATLAS_DEPTH; i++) {
+            sg_destroy_image(atlas->layer_images[i]);
+        }
 #endif // ifdef MAPEDITOR
 
-    sg_destroy_image(atlas->image);
-    sg_destroy_image(atlas->coords_image);
-    sg_destroy_image(atlas->layer_image);
+        sg_destroy_image(atlas->image);
+        sg_destroy_image(atlas->coords_image);
+        sg_destroy_image(atlas->layer_image);
+    }
 
     free(atlas->coords_data);
     free(atlas->layer_data);
@@ -266,11 +314,12 @@ void atlas_destroy(atlas_t *atlas) {
         dynlist_free(atlas->boxes[i]);
     }
 
+    dynlist_free(atlas->entries);
     map_destroy(&atlas->lookup);
 }
 
 void atlas_update(atlas_t *atlas) {
-    if (!atlas->dirty) { return; }
+    if (!atlas->dirty || atlas->headless) { return; }
     atlas->dirty = false;
 
     sg_image_data image_data;
@@ -337,7 +386,21 @@ void atlas_load_all(atlas_t *atlas) {
     dynlist_free(images);
 }
 
+static void entry_lookup(const atlas_entry_t *entry, atlas_lookup_t *out) {
+    const vec2s unit = glms_vec2_divs(VEC2(1.0f), ATLAS_SIZE);
+    *out = (atlas_lookup_t) {
+        .id = entry->id,
+        .layer = entry->layer,
+        .box_uv =
+            AABBF_PS(
+                entry->uv,
+                glms_vec2_mul(IVEC_TO_V(aabb_size(entry->box)), unit)),
+        .box_px = entry->box,
+    };
+}
+
 bool atlas_lookup(atlas_t *atlas, resource_t resource, atlas_lookup_t *out) {
+    atlas->stats.name_lookups++;
     strtoupper(resource.name);
 
     atlas_entry_t **slot =
@@ -368,21 +431,33 @@ bool atlas_lookup(atlas_t *atlas, resource_t resource, atlas_lookup_t *out) {
         }
     }
 
-    const vec2s unit = glms_vec2_divs(VEC2(1.0f), ATLAS_SIZE);
-    atlas_entry_t *entry = *slot;
-    *out = (atlas_lookup_t) {
-        .id = entry->id,
-        .layer = entry->layer,
-        .box_uv =
-            AABBF_PS(
-                entry->uv,
-                glms_vec2_mul(IVEC_TO_V(aabb_size(entry->box)), unit)),
-        .box_px = entry->box,
-    };
-
+    entry_lookup(*slot, out);
     return true;
 }
 
+bool atlas_lookup_handle(
+    atlas_t *atlas,
+    atlas_handle_t *handle,
+    resource_t resource,
+    atlas_lookup_t *out) {
+    if (handle->generation == atlas->generation) {
+        atlas->stats.handle_hits++;
+        entry_lookup(atlas->entries[handle->id], out);
+        return handle->found;
+    }
+
+    // NOTEX fallback is cached too, missing resources are only reported once
+    // per generation. lookup can insert (bumping generation), so it is read
+    // after
+    const bool found = atlas_lookup(atlas, resource, out);
+    *handle = (atlas_handle_t) {
+        .id = out->id,
+        .generation = atlas->generation,
+        .found = found,
+    };
+    return found;
+}
+
 void atlas_clear(atlas_t *atlas) {
     for (int i = 0; i < ATLAS_DEPTH; i++) {
         dynlist_free(atlas->boxes[i]);
@@ -391,6 +466,14 @@ void atlas_clear(atlas_t *atlas) {
     map_clear(&atlas->lookup);
     dynlist_free(atlas->names);
 
+    // ids are not reused, see insert
+    dynlist_each(atlas->entries, it) {
+        *it.el = NULL;
+    }
+
+    // invalidate all handles
+    atlas->generation++;
+
     // create NOTEX
     u32 data[16 * 16];
     const u32 c0 = 0xFFFF00FF, c1 = 0xFF550055;
@@ -7,6 +7,7 @@
 #include "util/aabb.h"
 #include "util/map.h"
 #include "util/dynlist.h"
+#include "util/resource.h"
 #include "config.h"
 
 #define ATLAS_SIZE 4096
@@ -25,6 +26,9 @@ typedef struct atlas {
     u32 *layer_data;
     int next_entry_id;
 
+    // entry id -> atlas_entry_t*, NULL for entries removed by atlas_clear
+    DYNLIST(atlas_entry_t*) entries;
+
     // boxes for each layer
     DYNLIST(atlas_entry_t*) boxes[ATLAS_DEPTH];
 
@@ -37,9 +41,22 @@ typedef struct atlas {
     // const char* -> atlas_entry_t*
     map_t lookup;
 
+    // bumped when entries are added or invalidated (atlas_clear), see
+    // atlas_handle_t. starts at 1 so that zeroed handles are stale
+    int generation;
+
+    // lookups by name and through valid handles, reset each frame by the
+    // renderer
+    struct {
+        int name_lookups, handle_hits;
+    } stats;
+
     // if true, atlas is uploaded next atlas_update
     bool dirty;
 
+    // no images, see atlas_init_headless
+    bool headless;
+
 #ifdef MAPEDITOR
     sg_image layer_images[ATLAS_DEPTH];
 
@@ -49,6 +66,10 @@ typedef struct atlas {
 } atlas_t;
 
 void atlas_init(atlas_t*);
+
+// init without images (no sokol context needed), entries and lookups work but
+// atlas_update does nothing
+void atlas_init_headless(atlas_t*);
 void atlas_destroy(atlas_t*);
 void atlas_update(atlas_t*);
 
@@ -61,6 +82,12 @@ typedef struct atlas_lookup {
 
 bool atlas_lookup(atlas_t*, resource_t, atlas_lookup_t*);
 
+// atlas_lookup through handle (see defs.h), resource is only looked up by name
+// if handle is from an older atlas generation. a handle belongs to the owner of
+// one resource and must be zeroed when that resource changes
+bool atlas_lookup_handle(
+    atlas_t*, atlas_handle_t*, resource_t, atlas_lookup_t*);
+
 void atlas_load_all(atlas_t*);
 
 void atlas_clear(atlas_t*);
@@ -400,7 +400,11 @@ void gfx_batcher_push_sprite(
     gfx_batcher_t *batcher,
     const gfx_sprite_t *sprite) {
     atlas_lookup_t lookup;
-    atlas_lookup(state->atlas, sprite->res, &lookup);
+    if (sprite->handle) {
+        atlas_lookup_handle(state->atlas, sprite->handle, sprite->res, &lookup);
+    } else {
+        atlas_lookup(state->atlas, sprite->res, &lookup);
+    }
     // TODO ??
     /* const vec2s half_px = {{ */
     /*     (1.0f / atlas->size_px.x) / 8.0f, */
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "gfx/sokol.h"
+#include "gfx/atlas.h"
 #include "util/math.h"
 #include "util/map.h"
 #include "util/dynlist.h"
@@ -49,6 +50,11 @@ typedef struct gfx_state {
 
 typedef struct {
     resource_t res;
+
+    // if not NULL, caches the atlas lookup of res across pushes (only ever
+    // pushed with the same res)
+    atlas_handle_t *handle;
+
     vec2s pos;
     vec2s scale;
     vec4s color;
@@ -0,0 +1,317 @@
+#include "gfx/occlusion.h"
+#include "util/assert.h"
+#include "util/time.h"
+#include "ext/stb_image_write.h"
+
+// rasterization works on 4 pixels of a row at a time
+typedef f32 f32x4 __attribute__((vector_size(16)));
+typedef i32 i32x4 __attribute__((vector_size(16)));
+
+#define F32X4(_x) ((f32x4) { (_x), (_x), (_x), (_x) })
+
+// max points of a polygon clipped against the near plane
+#define MAX_CLIP_POINTS 9
+
+// screen space point, x/y in pixels and z in [0, 1]
+typedef struct {
+    f32 x, y, z;
+} point_t;
+
+static point_t clip_to_screen(vec4s p) {
+    const f32 inv_w = 1.0f / p.w;
+    return (point_t) {
+        .x = ((p.x * inv_w) * 0.5f + 0.5f) * OCCLUSION_WIDTH,
+        .y = ((p.y * inv_w) * 0.5f + 0.5f) * OCCLUSION_HEIGHT,
+        .z = (p.z * inv_w) * 0.5f + 0.5f,
+    };
+}
+
+// clip polygon against near plane (z >= -w), returns number of points out
+static int clip_near(const vec4s *ps, int n, vec4s *out) {
+    int n_out = 0;
+
+    for (int i = 0; i < n; i++) {
+        const vec4s p = ps[i], q = ps[(i + 1) % n];
+        const f32 dp = p.z + p.w, dq = q.z + q.w;
+
+        if (dp >= 0.0f) {
+            out[n_out++] = p;
+        }
+
+        if ((dp >= 0.0f) != (dq >= 0.0f)) {
+            out[n_out++] = glms_vec4_lerp(p, q, dp / (dp - dq));
+        }
+    }
+
+    return n_out;
+}
+
+// "outer" has bit i set if the edge opposite of p_i is on the outline of the
+// polygon being rasterized (not an edge shared with another of its triangles)
+static void raster_tri(
+    occlusion_t *o,
+    point_t p0,
+    point_t p1,
+    point_t p2,
+    int outer) {
+    // twice the signed area, CCW (front facing) is positive
+    const f32 area =
+        (p1.x - p0.x) * (p2.y - p0.y) - (p1.y - p0.y) * (p2.x - p0.x);
+    if (area <= 0.0f) { return; }
+
+    const int
+        x0 = max(0, (int) floorf(min(p0.x, min(p1.x, p2.x)))) & ~3,
+        x1 = min(OCCLUSION_WIDTH - 1, (int) ceilf(max(p0.x, max(p1.x, p2.x)))),
+        y0 = max(0, (int) floorf(min(p0.y, min(p1.y, p2.y)))),
+        y1 = min(OCCLUSION_HEIGHT - 1, (int) ceilf(max(p0.y, max(p1.y, p2.y))));
+    if (x0 > x1 || y0 > y1) { return; }
+
+    o->stats.tris++;
+
+    // edge functions e_i = a_i * x + b_i * y + c_i, positive inside, where
+    // e_i is the edge opposite of p_i
+    const point_t ps[3] = { p0, p1, p2 };
+    f32 a[3], b[3], c[3];
+    for (int i = 0; i < 3; i++) {
+        const point_t p = ps[(i + 1) % 3], q = ps[(i + 2) % 3];
+        a[i] = -(q.y - p.y);
+        b[i] = q.x - p.x;
+        c[i] = (q.y - p.y) * p.x - (q.x - p.x) * p.y;
+    }
+
+    // depth plane z = za * x + zb * y + zc from barycentrics e_i / area
+    f32
+        za = (a[0] * p0.z + a[1] * p1.z + a[2] * p2.z) / area,
+        zb = (b[0] * p0.z + b[1] * p1.z + b[2] * p2.z) / area,
+        zc = (c[0] * p0.z + c[1] * p1.z + c[2] * p2.z) / area;
+
+    // occluders must be conservative: only write pixels which the polygon
+    // covers entirely, at the farthest depth inside of them. edges are tested
+    // at pixel centers, so move each outline edge in by half a pixel in x and
+    // y (to the corner of the pixel which is furthest outside) and the depth
+    // plane back by the most it changes across half a pixel. edges between
+    // triangles of the same polygon are left as-is, every pixel center on
+    // them is still covered by one of the two triangles.
+    for (int i = 0; i < 3; i++) {
+        if (outer & (1 << i)) {
+            c[i] -= 0.5f * (fabsf(a[i]) + fabsf(b[i]));
+        }
+    }
+
+    zc += 0.5f * (fabsf(za) + fabsf(zb));
+
+    const f32x4 offsets = { 0.5f, 1.5f, 2.5f, 3.5f };
+
+    for (int y = y0; y <= y1; y++) {
+        const f32 py = y + 0.5f;
+        const f32x4
+            e0_row = F32X4(b[0] * py + c[0]),
+            e1_row = F32X4(b[1] * py + c[1]),
+            e2_row = F32X4(b[2] * py + c[2]),
+            z_row = F32X4(zb * py + zc);
+
+        for (int x = x0; x <= x1; x += 4) {
+            const f32x4 px = F32X4((f32) x) + offsets;
+            const f32x4
+                e0 = F32X4(a[0]) * px + e0_row,
+                e1 = F32X4(a[1]) * px + e1_row,
+                e2 = F32X4(a[2]) * px + e2_row,
+                z = F32X4(za) * px + z_row;
+
+            f32x4 *pd = (f32x4*) &o->depth[y][x];
+            const f32x4 d = *pd;
+
+            const i32x4 mask =
+                (e0 >= 0.0f) & (e1 >= 0.0f) & (e2 >= 0.0f) & (z < d);
+            *pd = (f32x4) ((mask & (i32x4) z) | (~mask & (i32x4) d));
+        }
+    }
+}
+
+void occlusion_begin(occlusion_t *o, mat4s view_proj) {
+    o->view_proj = view_proj;
+    memset(&o->stats, 0, sizeof(o->stats));
+
+    const u64 t_start = time_ns();
+
+    f32x4 *pd = (f32x4*) o->depth;
+    for (usize i = 0; i < sizeof(o->depth) / sizeof(f32x4); i++) {
+        pd[i] = F32X4(1.0f);
+    }
+
+    o->stats.ns_raster += time_ns() - t_start;
+}
+
+void occlusion_add_polygon(occlusion_t *o, const vec3s *points, int n) {
+    ASSERT(n >= 3 && n <= MAX_CLIP_POINTS - 1);
+
+    const u64 t_start = time_ns();
+
+    vec4s clip[MAX_CLIP_POINTS - 1], clipped[MAX_CLIP_POINTS];
+    for (int i = 0; i < n; i++) {
+        clip[i] = glms_mat4_mulv(o->view_proj, VEC4(points[i], 1.0f));
+    }
+
+    const int n_clipped = clip_near(clip, n, clipped);
+
+    if (n_clipped >= 3) {
+        o->stats.occluders++;
+
+        point_t ps[MAX_CLIP_POINTS];
+        for (int i = 0; i < n_clipped; i++) {
+            ps[i] = clip_to_screen(clipped[i]);
+        }
+
+        // fan of (0, i, i + 1): i -> i + 1 is always on the outline, 0 -> i
+        // only for the first and i + 1 -> 0 only for the last triangle
+        for (int i = 1; i < n_clipped - 1; i++) {
+            raster_tri(
+                o, ps[0], ps[i], ps[i + 1],
+                (1 << 0)
+                    | (i + 1 == n_clipped - 1 ? (1 << 1) : 0)
+                    | (i == 1 ? (1 << 2) : 0));
+        }
+    }
+
+    o->stats.ns_raster += time_ns() - t_start;
+}
+
+void occlusion_end(occlusion_t *o) {
+    const u64 t_start = time_ns();
+
+    for (int ty = 0; ty < OCCLUSION_TILES_Y; ty++) {
+        for (int tx = 0; tx < OCCLUSION_TILES_X; tx++) {
+            f32x4 lo = F32X4(1.0f), hi = F32X4(0.0f);
+
+            for (int y = 0; y < OCCLUSION_TILE; y++) {
+                const f32x4 *pd =
+                    (const f32x4*)
+                        &o->depth
+                            [ty * OCCLUSION_TILE + y]
+                            [tx * OCCLUSION_TILE];
+
+                for (int i = 0; i < OCCLUSION_TILE / 4; i++) {
+                    const i32x4
+                        lt = pd[i] < lo,
+                        gt = pd[i] > hi;
+                    lo = (f32x4) ((lt & (i32x4) pd[i]) | (~lt & (i32x4) lo));
+                    hi = (f32x4) ((gt & (i32x4) pd[i]) | (~gt & (i32x4) hi));
+                }
+            }
+
+            o->tile_min[ty][tx] = min(min(lo[0], lo[1]), min(lo[2], lo[3]));
+            o->tile_max[ty][tx] = max(max(hi[0], hi[1]), max(hi[2], hi[3]));
+        }
+    }
+
+    o->stats.ns_raster += time_ns() - t_start;
+}
+
+static bool test_box(occlusion_t *o, vec3s box_min, vec3s box_max) {
+    f32 x_min = 1e30f, y_min = 1e30f, x_max = -1e30f, y_max = -1e30f,
+        z_min = 1e30f;
+    int n_near = 0;
+
+    for (int i = 0; i < 8; i++) {
+        const vec4s p =
+            glms_mat4_mulv(
+                o->view_proj,
+                VEC4(
+                    (i & 1) ? box_max.x : box_min.x,
+                    (i & 2) ? box_max.y : box_min.y,
+                    (i & 4) ? box_max.z : box_min.z,
+                    1.0f));
+
+        if (p.z + p.w < 0.0f) {
+            n_near++;
+            continue;
+        }
+
+        const point_t s = clip_to_screen(p);
+        x_min = min(x_min, s.x);
+        y_min = min(y_min, s.y);
+        x_max = max(x_max, s.x);
+        y_max = max(y_max, s.y);
+        z_min = min(z_min, s.z);
+    }
+
+    // entirely behind near plane, or crossing it (assume visible)
+    if (n_near == 8) { return false; }
+    if (n_near != 0) { return true; }
+
+    const int
+        x0 = max(0, (int) floorf(x_min)),
+        x1 = min(OCCLUSION_WIDTH - 1, (int) floorf(x_max)),
+        y0 = max(0, (int) floorf(y_min)),
+        y1 = min(OCCLUSION_HEIGHT - 1, (int) floorf(y_max));
+
+    // off screen
+    if (x0 > x1 || y0 > y1) { return false; }
+
+    for (int ty = y0 / OCCLUSION_TILE; ty <= y1 / OCCLUSION_TILE; ty++) {
+        for (int tx = x0 / OCCLUSION_TILE; tx <= x1 / OCCLUSION_TILE; tx++) {
+            // behind everything in tile
+            if (z_min >= o->tile_max[ty][tx]) { continue; }
+
+            // in front of everything in tile
+            if (z_min < o->tile_min[ty][tx]) { return true; }
+
+            const int
+                px0 = max(x0, tx * OCCLUSION_TILE),
+                px1 = min(x1, (tx + 1) * OCCLUSION_TILE - 1),
+                py0 = max(y0, ty * OCCLUSION_TILE),
+                py1 = min(y1, (ty + 1) * OCCLUSION_TILE - 1);
+
+            for (int y = py0; y <= py1; y++) {
+                for (int x = px0; x <= px1; x++) {
+                    if (z_min < o->depth[y][x]) { return true; }
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+bool occlusion_test_box(occlusion_t *o, vec3s box_min, vec3s box_max) {
+    const u64 t_start = time_ns();
+    const bool res = test_box(o, box_min, box_max);
+    o->stats.ns_test += time_ns() - t_start;
+    o->stats.tests++;
+    o->stats.occluded += res ? 0 : 1;
+    return res;
+}
+
+bool occlusion_dump(const occlusion_t *o, const char *path) {
+    u8 *pixels = malloc(OCCLUSION_WIDTH * OCCLUSION_HEIGHT);
+
+    // depth is mostly close to 1, stretch [nearest, 1] to [0, 255]
+    f32 d_min = 1.0f;
+    for (int ty = 0; ty < OCCLUSION_TILES_Y; ty++) {
+        for (int tx = 0; tx < OCCLUSION_TILES_X; tx++) {
+            d_min = min(d_min, o->tile_min[ty][tx]);
+        }
+    }
+
+    const f32 scale = d_min < 1.0f ? 255.0f / (1.0f - d_min) : 0.0f;
+
+    // flip so that row 0 is the top of the image
+    for (int y = 0; y < OCCLUSION_HEIGHT; y++) {
+        for (int x = 0; x < OCCLUSION_WIDTH; x++) {
+            pixels[(OCCLUSION_HEIGHT - 1 - y) * OCCLUSION_WIDTH + x] =
+                (u8) clamp((o->depth[y][x] - d_min) * scale, 0.0f, 255.0f);
+        }
+    }
+
+    const int res =
+        stbi_write_png(
+            path,
+            OCCLUSION_WIDTH,
+            OCCLUSION_HEIGHT,
+            1,
+            pixels,
+            OCCLUSION_WIDTH);
+
+    free(pixels);
+    return res != 0;
+}
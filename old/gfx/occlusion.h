@@ -0,0 +1,48 @@
+#pragma once
+
+#include "util/math.h"
+#include "util/types.h"
+
+// software depth buffer for occlusion culling, independent of the GPU so it
+// can be used (and dumped) headlessly
+#define OCCLUSION_WIDTH 256
+#define OCCLUSION_HEIGHT 144
+
+// side length of min/max hierarchy tiles
+#define OCCLUSION_TILE 8
+#define OCCLUSION_TILES_X (OCCLUSION_WIDTH / OCCLUSION_TILE)
+#define OCCLUSION_TILES_Y (OCCLUSION_HEIGHT / OCCLUSION_TILE)
+
+typedef struct occlusion {
+    mat4s view_proj;
+
+    // depth in [0, 1] (1 = far or uncovered), row 0 is the bottom of the
+    // screen. pixel rows are OCCLUSION_WIDTH floats, 16-byte aligned
+    f32 depth[OCCLUSION_HEIGHT][OCCLUSION_WIDTH] __attribute__((aligned(16)));
+
+    // min/max depth of each OCCLUSION_TILE^2 tile, see occlusion_end
+    f32 tile_min[OCCLUSION_TILES_Y][OCCLUSION_TILES_X];
+    f32 tile_max[OCCLUSION_TILES_Y][OCCLUSION_TILES_X];
+
+    // since occlusion_begin
+    struct {
+        int occluders, tris, tests, occluded;
+        u64 ns_raster, ns_test;
+    } stats;
+} occlusion_t;
+
+// clear buffer for rasterizing occluders with view_proj
+void occlusion_begin(occlusion_t *o, mat4s view_proj);
+
+// rasterize convex polygon of n (<= 8) world space points as an occluder
+// back facing (clockwise on screen) polygons are ignored, same as the GPU
+void occlusion_add_polygon(occlusion_t *o, const vec3s *points, int n);
+
+// finish rasterizing, builds the min/max hierarchy
+void occlusion_end(occlusion_t *o);
+
+// returns false if world space box is off screen or entirely behind occluders
+bool occlusion_test_box(occlusion_t *o, vec3s box_min, vec3s box_max);
+
+// write depth to grayscale png at path, returns false on failure
+bool occlusion_dump(const occlusion_t *o, const char *path);
@@ -11,12 +11,47 @@
 #include "imgui.h"
 #include "level/wall.h"
 #include "state.h"
+#include "util/file.h"
+#include "util/hash.h"
 #include "util/sort.h"
+#include "util/rand.h"
+#include "util/time.h"
 
 #define LEVEL_VBUF_SIZE (32 * 1024 * 1024)
 #define LEVEL_IBUF_SIZE (16 * 1024 * 1024)
+#define LEVEL_BATCH_IBUF_SIZE (2 * LEVEL_IBUF_SIZE)
 #define SPRITE_INSTBUF_SIZE (8 * 1024 * 1024)
 
+// render pass views/projections are equal for the view cache if they are
+// equal to 1 / RENDERER_VIEW_QUANTUM
+#define RENDERER_VIEW_QUANTUM 1024.0f
+
+// #define DO_VERIFY_VIEW_CACHE
+
+// occluders are side segments within this distance of the camera
+#define OCCLUDER_MAX_DIST 32.0f
+
+// sector bounds are grown by this much when testing them for occlusion
+#define OCCLUSION_MARGIN 1.0f
+
+// #define DO_DUMP_OCCLUSION
+
+// size of grid for estimate_overdraw
+#define OVERDRAW_GRID_WIDTH 64
+#define OVERDRAW_GRID_HEIGHT 36
+
+// fraction of pixels which may differ from the reference image in
+// renderer_render_soft (float differences between builds)
+#define RENDERER_SOFT_MAX_DIFF 0.001f
+
+// #define DO_VERIFY_SPRITE_SORT
+// #define DO_BENCH_SPRITE_SORT
+
+// mirror all level/sprite draws on the CPU rasterizer (see softrast.h) to
+// produce reference images and measure shading cost, see soft_draw_level.
+// renderer_render_soft always uses the mirror
+// #define DO_SOFTRAST
+
 #include "shader/level.glsl.h"
 #include "shader/sprite.glsl.h"
 
@@ -28,6 +63,50 @@ typedef struct {
     f32 flags;
 } render_vertex_t;
 
+#ifdef RENDERER_PACKED_VERTICES
+// render_vertex_t as stored in level_vbuf, see put_vertex. id is split as
+// id[0] + (id[1] << 16) with a signed low half, see level.glsl. pos is last so
+// that no (4 byte) attribute read goes past the end of a vertex
+typedef struct {
+    i16 id[2];
+    i16 index;
+    i16 flags;
+    u16 uv[2];
+    vec3s pos;
+} level_vertex_t;
+
+STATIC_ASSERT(sizeof(level_vertex_t) == 24, "level_vertex_t is not packed");
+#else
+typedef render_vertex_t level_vertex_t;
+#endif // ifdef RENDERER_PACKED_VERTICES
+
+ALWAYS_INLINE void put_vertex(level_vertex_t *dst, render_vertex_t v) {
+#ifdef RENDERER_PACKED_VERTICES
+    const int id = (int) v.id;
+    const i16 id_lo = (i16) (u16) (id & 0xFFFF);
+    *dst = (level_vertex_t) {
+        .id = { id_lo, (i16) ((id - id_lo) >> 16) },
+        .index = (i16) v.index,
+        .flags = (i16) v.flags,
+        .uv = {
+            (u16) roundf(clamp(v.uv.x, 0.0f, 1.0f) * 65535.0f),
+            (u16) roundf(clamp(v.uv.y, 0.0f, 1.0f) * 65535.0f),
+        },
+        .pos = v.pos,
+    };
+#else
+    *dst = v;
+#endif // ifdef RENDERER_PACKED_VERTICES
+}
+
+// dynbuf rounds allocations up to 16 bytes, vertex allocations are also kept
+// to whole vertices so that every sector's vertices start at a vertex index
+static usize vertex_alloc_size(int n) {
+    usize size = n * sizeof(level_vertex_t);
+    while (size % 16 != 0) { size += sizeof(level_vertex_t); }
+    return size;
+}
+
 typedef struct {
     vec3s pos;
     vec2s uv;
@@ -114,29 +193,54 @@ static void make_pipelines(renderer_t *r) {
         .index_type = SG_INDEXTYPE_UINT16,
         .layout = {
             .buffers[0] = {
-                .stride = sizeof(render_vertex_t),
+                .stride = sizeof(level_vertex_t),
             },
             .attrs = {
+#ifdef RENDERER_PACKED_VERTICES
+                // (non-normalized) shorts are converted to floats, second
+                // components of index/flags are ignored by the shader
+                [ATTR_level_vs_a_position] = {
+                    .offset = offsetof(level_vertex_t, pos),
+                    .format = SG_VERTEXFORMAT_FLOAT3,
+                },
+                [ATTR_level_vs_a_texcoord0] = {
+                    .offset = offsetof(level_vertex_t, uv),
+                    .format = SG_VERTEXFORMAT_USHORT2N,
+                },
+                [ATTR_level_vs_a_id] = {
+                    .offset = offsetof(level_vertex_t, id),
+                    .format = SG_VERTEXFORMAT_SHORT2,
+                },
+                [ATTR_level_vs_a_index] = {
+                    .offset = offsetof(level_vertex_t, index),
+                    .format = SG_VERTEXFORMAT_SHORT2,
+                },
+                [ATTR_level_vs_a_flags] = {
+                    .offset = offsetof(level_vertex_t, flags),
+                    .format = SG_VERTEXFORMAT_SHORT2,
+                },
+#else
                 [ATTR_level_vs_a_position] = {
-                    .offset = offsetof(render_vertex_t, pos),
+                    .offset = offsetof(level_vertex_t, pos),
                     .format = SG_VERTEXFORMAT_FLOAT3,
                 },
                 [ATTR_level_vs_a_texcoord0] = {
-                    .offset = offsetof(render_vertex_t, uv),
+                    .offset = offsetof(level_vertex_t, uv),
                     .format = SG_VERTEXFORMAT_FLOAT2,
                 },
                 [ATTR_level_vs_a_id] = {
-                    .offset = offsetof(render_vertex_t, id),
+                    .offset = offsetof(level_vertex_t, id),
                     .format = SG_VERTEXFORMAT_FLOAT,
                 },
                 [ATTR_level_vs_a_index] = {
-                    .offset = offsetof(render_vertex_t, index),
+                    .offset = offsetof(level_vertex_t, index),
                     .format = SG_VERTEXFORMAT_FLOAT,
                 },
                 [ATTR_level_vs_a_flags] = {
-                    .offset = offsetof(render_vertex_t, flags),
+                    .offset = offsetof(level_vertex_t, flags),
                     .format = SG_VERTEXFORMAT_FLOAT,
                 },
+#endif // ifdef RENDERER_PACKED_VERTICES
             }
         },
         .colors = {
@@ -185,37 +289,48 @@ static void make_pipelines(renderer_t *r) {
         .cull_mode = SG_CULLMODE_BACK,
     };
 
-    r->pipeline_level = sg_make_pipeline(&level_pip_desc);
+    // level geometry draws wherever stencil >= ref, which is the portal
+    // depth of the pass (see do_render_pass)
+    for (int i = 0; i < RENDERER_MAX_PORTAL_DEPTH; i++) {
+        sg_pipeline_desc desc = level_pip_desc;
+        desc.index_type = SG_INDEXTYPE_UINT32; // see batch_indices
+        desc.stencil.front.compare = SG_COMPAREFUNC_LESS_EQUAL;
+        desc.stencil.ref = i;
+        r->pipeline_level[i] = sg_make_pipeline(&desc);
+    }
 
-    // portal pipeline draws 1s on test fail (which is always)
+    // portal mark pipeline increments stencil where it is equal to ref and
+    // the portal is not occluded, writes neither color nor depth
     sg_pipeline_desc portal_pip_desc = level_pip_desc;
-    portal_pip_desc.colors[0].write_mask = 0;
+    portal_pip_desc.colors[0].write_mask = SG_COLORMASK_NONE;
     portal_pip_desc.colors[0].blend.enabled = false;
-    portal_pip_desc.colors[1].write_mask = 0;
+    portal_pip_desc.colors[1].write_mask = SG_COLORMASK_NONE;
     portal_pip_desc.depth.write_enabled = false;
-    portal_pip_desc.stencil = (sg_stencil_state) {
-        // overwritten by gl* functions
-        .enabled = true,
-        .front = {
-            .compare = SG_COMPAREFUNC_EQUAL,
-            .fail_op = SG_STENCILOP_KEEP,
-            .depth_fail_op = SG_STENCILOP_KEEP,
-            .pass_op = SG_STENCILOP_INCR_CLAMP,
-        },
-        .back = {
-            .compare = SG_COMPAREFUNC_NEVER,
-            .fail_op = SG_STENCILOP_KEEP,
-            .depth_fail_op = SG_STENCILOP_KEEP,
-            .pass_op = SG_STENCILOP_KEEP,
-        },
-        .ref = 0,
-        .write_mask = 0xFF,
-        .read_mask = 0xFF
+    portal_pip_desc.stencil.front = (sg_stencil_face_state) {
+        .compare = SG_COMPAREFUNC_EQUAL,
+        .fail_op = SG_STENCILOP_KEEP,
+        .depth_fail_op = SG_STENCILOP_KEEP,
+        .pass_op = SG_STENCILOP_INCR_CLAMP,
     };
 
-    r->pipeline_portal = sg_make_pipeline(&portal_pip_desc);
+    // portal unmark pipeline decrements the marked (ref + 1) stencil back to
+    // ref and writes the portal's depth over what was drawn through it
+    sg_pipeline_desc portal_unmark_pip_desc = portal_pip_desc;
+    portal_unmark_pip_desc.depth.write_enabled = true;
+    portal_unmark_pip_desc.depth.compare = SG_COMPAREFUNC_ALWAYS;
+    portal_unmark_pip_desc.stencil.front.pass_op = SG_STENCILOP_DECR_CLAMP;
+
+    for (int i = 0; i < RENDERER_MAX_PORTAL_DEPTH; i++) {
+        sg_pipeline_desc desc = portal_pip_desc;
+        desc.stencil.ref = i;
+        r->pipeline_portal_mark[i] = sg_make_pipeline(&desc);
+
+        desc = portal_unmark_pip_desc;
+        desc.stencil.ref = i + 1;
+        r->pipeline_portal_unmark[i] = sg_make_pipeline(&desc);
+    }
 
-    r->pipeline_sprite = sg_make_pipeline(&(sg_pipeline_desc) {
+    const sg_pipeline_desc sprite_pip_desc = {
         .shader = r->shader_sprite,
         .primitive_type = SG_PRIMITIVETYPE_TRIANGLES,
         .index_type = SG_INDEXTYPE_UINT16,
@@ -318,35 +433,126 @@ static void make_pipelines(renderer_t *r) {
         },
         .face_winding = SG_FACEWINDING_CCW,
         .cull_mode = SG_CULLMODE_BACK,
-    });
+    };
+
+    // sprites draw wherever stencil >= ref, same as level geometry
+    for (int i = 0; i < RENDERER_MAX_PORTAL_DEPTH; i++) {
+        sg_pipeline_desc desc = sprite_pip_desc;
+        desc.stencil.front.compare = SG_COMPAREFUNC_LESS_EQUAL;
+        desc.stencil.ref = i;
+        r->pipeline_sprite[i] = sg_make_pipeline(&desc);
+    }
+}
+
+static void destroy_pipelines(renderer_t *r) {
+    for (int i = 0; i < RENDERER_MAX_PORTAL_DEPTH; i++) {
+        sg_destroy_pipeline(r->pipeline_level[i]);
+        sg_dealloc_pipeline(r->pipeline_level[i]);
+        sg_destroy_pipeline(r->pipeline_portal_mark[i]);
+        sg_dealloc_pipeline(r->pipeline_portal_mark[i]);
+        sg_destroy_pipeline(r->pipeline_portal_unmark[i]);
+        sg_dealloc_pipeline(r->pipeline_portal_unmark[i]);
+        sg_destroy_pipeline(r->pipeline_sprite[i]);
+        sg_dealloc_pipeline(r->pipeline_sprite[i]);
+    }
 }
 
 void renderer_on_shader_reload(sg_shader*, void *userdata) {
     renderer_t *r = userdata;
-    sg_destroy_pipeline(r->pipeline_level);
-    sg_dealloc_pipeline(r->pipeline_level);
-    sg_destroy_pipeline(r->pipeline_portal);
-    sg_dealloc_pipeline(r->pipeline_portal);
-    sg_destroy_pipeline(r->pipeline_sprite);
-    sg_dealloc_pipeline(r->pipeline_sprite);
+    destroy_pipelines(r);
     make_pipelines(r);
 }
 
-void renderer_init(renderer_t *r) {
+// compares render_view_key_t hashes stored as view cache map keys
+static int view_key_cmp(void *p, void *q, void*) {
+    return (p > q) - (p < q);
+}
+
+// sprite sort key, back to front by clip w then by atlas layer so that sprites
+// of equal depth sampling the same layer are adjacent
+static u32 sprite_sort_key(f32 w, int layer) {
+    // bits of positive floats order as integers, invert for back to front
+    const f32 d = max(w, 0.0f);
+    u32 bits;
+    memcpy(&bits, &d, sizeof(bits));
+    return (~bits & 0xFFFFFF00) | (u32) clamp(layer, 0, 0xFF);
+}
+
+#ifdef DO_BENCH_SPRITE_SORT
+static int bench_key_cmp(const u32 *a, const u32 *b, void*) {
+    return *a < *b ? -1 : (*a > *b ? 1 : 0);
+}
+
+// time radix_sort_u32 against qsort on 10k sprite keys, and check that it
+// sorts the same (and stably)
+static void bench_sprite_sort() {
+    const int n = 10000;
+    u32 *keys = malloc(n * sizeof(u32)), *vals = malloc(n * sizeof(u32)),
+        *tmp_keys = malloc(n * sizeof(u32)), *tmp_vals = malloc(n * sizeof(u32)),
+        *expected = malloc(n * sizeof(u32));
+
+    rand_t rand = rand_create(0x5EED);
+    for (int i = 0; i < n; i++) {
+        keys[i] =
+            sprite_sort_key(rand_f32(&rand, 0.1f, 64.0f), rand_n(&rand, 0, 7));
+        vals[i] = i;
+    }
+
+    memcpy(expected, keys, n * sizeof(u32));
+    memcpy(tmp_keys, keys, n * sizeof(u32));
+
+    const u64 t_qsort = time_ns();
+    sort(expected, n, sizeof(u32), (f_sort_cmp) bench_key_cmp, NULL);
+    const u64 ns_qsort = time_ns() - t_qsort;
+
+    // keys of original order, vals index into it
+    u32 *orig = tmp_keys;
+    tmp_keys = malloc(n * sizeof(u32));
+
+    const u64 t_radix = time_ns();
+    radix_sort_u32(keys, vals, tmp_keys, tmp_vals, n);
+    const u64 ns_radix = time_ns() - t_radix;
+
+    for (int i = 0; i < n; i++) {
+        if (keys[i] != expected[i] || orig[vals[i]] != keys[i]) {
+            WARN("radix sort mismatch at %d", i);
+            break;
+        }
+
+        if (i != 0 && keys[i] == keys[i - 1] && vals[i] < vals[i - 1]) {
+            WARN("radix sort not stable at %d", i);
+            break;
+        }
+    }
+
+    LOG(
+        "sprite sort (%d): radix %" PRIu64 "ns, qsort %" PRIu64 "ns",
+        n, ns_radix, ns_qsort);
+
+    free(keys);
+    free(vals);
+    free(tmp_keys);
+    free(tmp_vals);
+    free(expected);
+    free(orig);
+}
+#endif // ifdef DO_BENCH_SPRITE_SORT
+
+void renderer_init_headless(renderer_t *r) {
     *r = (renderer_t) { 0 };
     r->version = 1;
-
-    gfx_load_shader(
-        &r->shader_level,
-        level_level_shader_desc,
-        renderer_on_shader_reload,
-        r);
-    gfx_load_shader(
-        &r->shader_sprite,
-        sprite_sprite_shader_desc,
-        renderer_on_shader_reload,
-        r);
-    make_pipelines(r);
+    r->headless = true;
+
+    map_init(
+        &r->view_cache.map,
+        map_hash_id,
+        NULL,
+        NULL,
+        NULL,
+        view_key_cmp,
+        NULL,
+        NULL,
+        NULL);
 
     dynbuf_init(
         &r->db_indices,
@@ -360,6 +566,59 @@ void renderer_init(renderer_t *r) {
         LEVEL_VBUF_SIZE,
         DYNBUF_OWNS_MEMORY);
 
+    r->instance_data.ptr = malloc(SPRITE_INSTBUF_SIZE);
+    r->instance_data.size = SPRITE_INSTBUF_SIZE;
+
+    const int render_sizes[4] = {
+        sizeof(sector_render_t),
+        sizeof(side_render_t),
+        sizeof(sprite_render_t),
+        sizeof(decal_render_t),
+    };
+
+    const int render_indices[4] = {
+        T_SECTOR_INDEX,
+        T_SIDE_INDEX,
+        T_OBJECT_INDEX,
+        T_DECAL_INDEX,
+    };
+
+    for (int i = 0; i < 4; i++) {
+        renderer_data_array_t *data = &r->data_arrays[i];
+        *data = (renderer_data_array_t) {
+            .render_size = render_sizes[i],
+            .renders = calloc(2048, render_sizes[i]),
+            .data = r->data.buf[render_indices[i]],
+            // bitmaps are zeroed automatically
+        };
+        LOG("array %d: %p, %p", i, data->renders, data->data);
+    }
+
+#ifdef DO_BENCH_SPRITE_SORT
+    bench_sprite_sort();
+#endif // ifdef DO_BENCH_SPRITE_SORT
+
+#ifdef DO_SOFTRAST
+    r->soft = calloc(1, sizeof(*r->soft));
+#endif // ifdef DO_SOFTRAST
+}
+
+void renderer_init(renderer_t *r) {
+    renderer_init_headless(r);
+    r->headless = false;
+
+    gfx_load_shader(
+        &r->shader_level,
+        level_level_shader_desc,
+        renderer_on_shader_reload,
+        r);
+    gfx_load_shader(
+        &r->shader_sprite,
+        sprite_sprite_shader_desc,
+        renderer_on_shader_reload,
+        r);
+    make_pipelines(r);
+
     r->level_ibuf =
         sg_make_buffer(
             &(sg_buffer_desc) {
@@ -368,6 +627,14 @@ void renderer_init(renderer_t *r) {
                 .usage = SG_USAGE_STREAM
             });
 
+    r->level_batch_ibuf =
+        sg_make_buffer(
+            &(sg_buffer_desc) {
+                .type = SG_BUFFERTYPE_INDEXBUFFER,
+                .size = LEVEL_BATCH_IBUF_SIZE,
+                .usage = SG_USAGE_STREAM
+            });
+
     r->level_vbuf =
         sg_make_buffer(
             &(sg_buffer_desc) {
@@ -419,9 +686,6 @@ void renderer_init(renderer_t *r) {
                 .size = SPRITE_INSTBUF_SIZE,
             });
 
-    r->instance_data.ptr = malloc(SPRITE_INSTBUF_SIZE);
-    r->instance_data.size = SPRITE_INSTBUF_SIZE;
-
     r->data_image =
         sg_make_image(
             &(sg_image_desc) {
@@ -434,31 +698,6 @@ void renderer_init(renderer_t *r) {
                 .mag_filter = SG_FILTER_NEAREST,
                 .usage = SG_USAGE_STREAM
             });
-
-    const int render_sizes[4] = {
-        sizeof(sector_render_t),
-        sizeof(side_render_t),
-        sizeof(sprite_render_t),
-        sizeof(decal_render_t),
-    };
-
-    const int render_indices[4] = {
-        T_SECTOR_INDEX,
-        T_SIDE_INDEX,
-        T_OBJECT_INDEX,
-        T_DECAL_INDEX,
-    };
-
-    for (int i = 0; i < 4; i++) {
-        renderer_data_array_t *data = &r->data_arrays[i];
-        *data = (renderer_data_array_t) {
-            .render_size = render_sizes[i],
-            .renders = malloc(2048 * render_sizes[i]),
-            .data = r->data.buf[render_indices[i]],
-            // bitmaps are zeroed automatically
-        };
-        LOG("array %d: %p, %p", i, data->renders, data->data);
-    }
 }
 
 void renderer_set_level(renderer_t *r, level_t *level) {
@@ -482,20 +721,47 @@ void renderer_destroy_for_level(renderer_t *r) {
 }
 
 void renderer_destroy(renderer_t *r) {
-    gfx_unload_shader(&r->shader_level);
-    sg_destroy_pipeline(r->pipeline_level);
-    sg_destroy_pipeline(r->pipeline_portal);
-    sg_destroy_pipeline(r->pipeline_sprite);
-    sg_destroy_buffer(r->level_ibuf);
-    sg_destroy_buffer(r->level_vbuf);
-    sg_destroy_buffer(r->sprite_ibuf);
-    sg_destroy_buffer(r->sprite_vbuf);
-    sg_destroy_buffer(r->sprite_instbuf);
+    if (!r->headless) {
+        gfx_unload_shader(&r->shader_level);
+        destroy_pipelines(r);
+        sg_destroy_buffer(r->level_ibuf);
+        sg_destroy_buffer(r->level_batch_ibuf);
+        sg_destroy_buffer(r->level_vbuf);
+        sg_destroy_buffer(r->sprite_ibuf);
+        sg_destroy_buffer(r->sprite_vbuf);
+        sg_destroy_buffer(r->sprite_instbuf);
+    }
 
     free(r->instance_data.ptr);
 
     dynbuf_destroy(&r->db_indices);
     dynbuf_destroy(&r->db_vertices);
+    dynlist_free(r->batch_indices);
+
+    if (r->soft) {
+        softrast_destroy(r->soft);
+        free(r->soft);
+    }
+    dynlist_free(r->soft_vertices);
+
+    map_destroy(&r->view_cache.map);
+    dynlist_each(r->view_cache.views, it) {
+        dynlist_free((*it.el)->sectors);
+        dynlist_free((*it.el)->portals);
+        dynlist_free((*it.el)->runs);
+        free(*it.el);
+    }
+    dynlist_free(r->view_cache.views);
+
+    dynlist_free(r->sector_order.depths);
+    dynlist_free(r->sector_order.dists);
+    dynlist_free(r->sector_order.queue);
+
+    dynlist_free(r->sprite_sort.keys);
+    dynlist_free(r->sprite_sort.vals);
+    dynlist_free(r->sprite_sort.tmp_keys);
+    dynlist_free(r->sprite_sort.tmp_vals);
+    dynlist_free(r->sprite_sort.instances);
 
     if (r->frame_info.data) {
         free(r->frame_info.data);
@@ -507,7 +773,7 @@ static void mesh_decal(
     decal_t *decal,
     u16 *indices,
     int *ni,
-    render_vertex_t *vertices,
+    level_vertex_t *vertices,
     int *nv) {
     decal->render->indices = &indices[*ni];
     decal->render->vertices = &vertices[*nv];
@@ -516,7 +782,7 @@ static void mesh_decal(
     const int index = decal->render->index;
 
     atlas_lookup_t lookup;
-    atlas_lookup(state->atlas, decal->tex, &lookup);
+    atlas_lookup_handle(state->atlas, &decal->tex_handle, decal->tex, &lookup);
 
     const vec2s size =
         glms_vec2_divs(aabbf_size(AABB_TO_F(lookup.box_px)), PX_PER_UNIT);
@@ -576,40 +842,40 @@ static void mesh_decal(
     }
 
     // bottom left
-    vertices[(*nv)++] = (render_vertex_t) {
+    put_vertex(&vertices[(*nv)++], (render_vertex_t) {
         .pos = verts[0],
         .uv = wind_cw ? VEC2(0.0f, 0.0f) : VEC2(1.0f, 0.0f),
         .id = (T_DECAL << 16) | ((int) decal->index),
         .index = index,
         .flags = RENDERER_VFLAG_NONE,
-    };
+    });
 
     // bottom right
-    vertices[(*nv)++] = (render_vertex_t) {
+    put_vertex(&vertices[(*nv)++], (render_vertex_t) {
         .pos = verts[1],
         .uv = wind_cw ? VEC2(1.0f, 0.0f) : VEC2(0.0f, 0.0f),
         .id = (T_DECAL << 16) | ((int) decal->index),
         .index = index,
         .flags = RENDERER_VFLAG_NONE,
-    };
+    });
 
     // top left
-    vertices[(*nv)++] = (render_vertex_t) {
+    put_vertex(&vertices[(*nv)++], (render_vertex_t) {
         .pos = verts[2],
         .uv = wind_cw ? VEC2(0.0f, 1.0f) : VEC2(1.0f, 1.0f),
         .id = (T_DECAL << 16) | ((int) decal->index),
         .index = index,
         .flags = RENDERER_VFLAG_NONE,
-    };
+    });
 
     // top right
-    vertices[(*nv)++] = (render_vertex_t) {
+    put_vertex(&vertices[(*nv)++], (render_vertex_t) {
         .pos = verts[3],
         .uv = wind_cw ? VEC2(1.0f, 1.0f) : VEC2(0.0f, 1.0f),
         .id = (T_DECAL << 16) | ((int) decal->index),
         .index = index,
         .flags = RENDERER_VFLAG_NONE,
-    };
+    });
 
     indices[(*ni)++] = base + (wind_cw ? 0 : 2);
     indices[(*ni)++] = base + (wind_cw ? 1 : 1);
@@ -652,7 +918,7 @@ static int prepare_decal(renderer_t *r, decal_t *decal) {
     };
 
     atlas_lookup_t lookup;
-    atlas_lookup(state->atlas, decal->tex, &lookup);
+    atlas_lookup_handle(state->atlas, &decal->tex_handle, decal->tex, &lookup);
     dr_data->tex = lookup.id;
 
     // TODO: will break if done before these have been updated
@@ -763,7 +1029,7 @@ static void mesh_side(
     const side_segment_t *seg,
     u16 *indices,
     int *ni,
-    render_vertex_t *vertices,
+    level_vertex_t *vertices,
     int *nv) {
     vertex_t *vs[2];
     side_get_vertices(side, vs);
@@ -792,7 +1058,7 @@ static void mesh_side(
     const int index = side->render->index;
 
     // bottom left
-    vertices[(*nv)++] = (render_vertex_t) {
+    put_vertex(&vertices[(*nv)++], (render_vertex_t) {
         .pos =
             VEC3(
                 vs[0]->pos.x,
@@ -802,10 +1068,10 @@ static void mesh_side(
         .id = (T_SIDE << 16) | ((int) side->index),
         .index = index,
         .flags = flags,
-    };
+    });
 
     // bottom right
-    vertices[(*nv)++] = (render_vertex_t) {
+    put_vertex(&vertices[(*nv)++], (render_vertex_t) {
         .pos =
             VEC3(
                 vs[1]->pos.x,
@@ -815,10 +1081,10 @@ static void mesh_side(
         .id = (T_SIDE << 16) | ((int) side->index),
         .index = index,
         .flags = flags,
-    };
+    });
 
     // top left
-    vertices[(*nv)++] = (render_vertex_t) {
+    put_vertex(&vertices[(*nv)++], (render_vertex_t) {
         .pos =
             VEC3(
                 vs[0]->pos.x,
@@ -828,10 +1094,10 @@ static void mesh_side(
         .id = (T_SIDE << 16) | ((int) side->index),
         .index = index,
         .flags = flags,
-    };
+    });
 
     // top right
-    vertices[(*nv)++] = (render_vertex_t) {
+    put_vertex(&vertices[(*nv)++], (render_vertex_t) {
         .pos =
             VEC3(
                 vs[1]->pos.x,
@@ -841,7 +1107,7 @@ static void mesh_side(
         .id = (T_SIDE << 16) | ((int) side->index),
         .index = index,
         .flags = flags,
-    };
+    });
 
     indices[(*ni)++] = base + 2;
     indices[(*ni)++] = base + 1;
@@ -992,20 +1258,17 @@ remesh:
     sr->n_indices = ni_expected;
 
     sr->vertices =
-        dynbuf_alloc(
-                &r->db_vertices, 
-                sizeof(render_vertex_t) 
-                * nv_expected);
+        dynbuf_alloc(&r->db_vertices, vertex_alloc_size(nv_expected));
     sr->n_vertices = nv_expected;
 
     u16 *indices = sr->indices;
-    render_vertex_t *vertices = sr->vertices;
+    level_vertex_t *vertices = sr->vertices;
 
     // floor plane
     dynlist_each(sector->tris, it) {
         for (int j = 0; j < 3; j++) {
             indices[ni++] = nv;
-            vertices[nv++] = (render_vertex_t) {
+            put_vertex(&vertices[nv++], (render_vertex_t) {
                 .pos =
                     VEC3(
                         it.el->vs[j]->pos.x,
@@ -1015,7 +1278,7 @@ remesh:
                 .id = (T_SECTOR << 16) | ((int) sector->index),
                 .index = index,
                 .flags = RENDERER_VFLAG_NONE,
-            };
+            });
         }
     }
 
@@ -1023,7 +1286,7 @@ remesh:
     dynlist_each(sector->tris, it) {
         for (int j = 0; j < 3; j++) {
             indices[ni++] = nv;
-            vertices[nv++] = (render_vertex_t) {
+            put_vertex(&vertices[nv++], (render_vertex_t) {
                 .pos =
                     VEC3(
                         it.el->vs[2 - j]->pos.x,
@@ -1033,7 +1296,7 @@ remesh:
                 .id = (T_SECTOR << 16) | ((int) sector->index),
                 .index = index,
                 .flags = RENDERER_VFLAG_IS_CEIL,
-            };
+            });
         }
     }
 
@@ -1158,11 +1421,6 @@ static int prepare_object(
     renderer_t *r,
     object_t *obj,
     sprite_instance_t *inst) {
-
-    // TODO: store lookup results on object render
-    atlas_lookup_t lookup;
-    atlas_lookup(state->atlas, obj->type->sprite, &lookup);
-
     int res = PREPARE_OK;
 
     int index;
@@ -1179,24 +1437,29 @@ static int prepare_object(
             &sr_data,
             &index);
 
-    switch (da_res) {
-    case DATA_REALLOC_KEPT:
+    if (da_res == DATA_REALLOC_FAIL) {
+        ASSERT(false);
+    }
+
+    sprite_render_t *sr = obj->render;
+    const atlas_lookup_t *lookup = &sr->lookup;
+    atlas_lookup_handle(
+        state->atlas, &obj->sprite_handle, obj->type->sprite, &sr->lookup);
+
+    if (da_res == DATA_REALLOC_KEPT) {
         res = PREPARE_OK;
         goto prepare_instance;
-    case DATA_REALLOC_FAIL:
-        ASSERT(false);
     }
 
     res = PREPARE_DATA_UPDATE;
 
-    sprite_render_t *sr = obj->render;
     sr->index = index;
     sr->is_object = true;
     sr->object.ptr = obj;
     sr->object.r_version = r->version;
     sr->object.version = obj->version;
 
-    sr_data->tex = lookup.id;
+    sr_data->tex = lookup->id;
 
     if (obj->sector->render) {
         sr_data->sector_index = obj->sector->render->index;
@@ -1210,7 +1473,7 @@ prepare_instance:
         .size =
             aabbf_size(
                 aabbf_scale_min(
-                    AABB_TO_F(lookup.box_px),
+                    AABB_TO_F(lookup->box_px),
                     VEC2(1.0f / PX_PER_UNIT))),
         .id = (T_OBJECT << 16) | ((int) obj->index),
         .index = index,
@@ -1509,84 +1772,335 @@ typedef struct render_pass {
     const struct render_pass *from;
 } render_pass_t;
 
-static int sector_render_portal_cmp(
-    const sector_render_portal_t **a,
-    const sector_render_portal_t **b,
+static int render_view_portal_cmp(
+    const render_view_portal_t *a,
+    const render_view_portal_t *b,
     vec3s *ref_pos) {
     const f32
         d_a =
             glms_vec2_norm2(
                 glms_vec2_sub(
-                    glms_vec2(*ref_pos), wall_midpoint((*a)->side->wall))),
+                    glms_vec2(*ref_pos), wall_midpoint(a->portal->side->wall))),
         d_b =
             glms_vec2_norm2(
                 glms_vec2_sub(
-                    glms_vec2(*ref_pos), wall_midpoint((*b)->side->wall)));
+                    glms_vec2(*ref_pos), wall_midpoint(b->portal->side->wall)));
     return d_a - d_b;
 }
 
-static void do_render_pass(
-    renderer_t *r,
-    const render_pass_t *pass) {
-    // TODO: formalize limits
-    if (pass->depth >= 8) {
-        return;
-    }
+// sg_apply_pipeline/sg_apply_uniforms/sg_apply_bindings/sg_draw, counted in
+// renderer_t::stats. nothing is submitted if headless, see
+// renderer_render_soft
+static void apply_pipeline(renderer_t *r, sg_pipeline pipeline) {
+    if (!r->headless) { sg_apply_pipeline(pipeline); }
+    r->stats.pipelines++;
+}
 
-    char name[256];
-    snprintf(
-        name,
-        sizeof(name),
-        "PASS (side: %d -> %d/st: %d/dp: %d)",
-        pass->entry_side ? pass->entry_side->index : -1,
-        pass->exit_side ? pass->exit_side->index : -1,
-        pass->stencil_ref,
-        pass->depth);
-    const bool ui = r->debug_ui && igTreeNode_Str(name);
-    igTreeNodeSetOpen(igGetItemID(), true);
-    if (ui) { igText("SCISSOR: %" PRIaabb, FMTaabb(pass->scissor)); }
-    if (ui) {
-        igText("VIEW:\n %" PRIm4, FMTm4(pass->view));
+static void apply_uniforms(
+    renderer_t *r, sg_shader_stage stage, int slot, const sg_range *data) {
+    if (!r->headless) { sg_apply_uniforms(stage, slot, data); }
+}
+
+static void apply_bindings(renderer_t *r, const sg_bindings *bind) {
+    if (!r->headless) { sg_apply_bindings(bind); }
+}
+
+static void draw(renderer_t *r, int base, int n, int instances) {
+    if (!r->headless) { sg_draw(base, n, instances); }
+    r->stats.draws++;
+}
+
+// inverse of put_vertex
+static softrast_vertex_t soft_vertex(const level_vertex_t *v) {
+#ifdef RENDERER_PACKED_VERTICES
+    return (softrast_vertex_t) {
+        .pos = v->pos,
+        .uv = VEC2(v->uv[0] / 65535.0f, v->uv[1] / 65535.0f),
+        .id = v->id[0] + (v->id[1] << 16),
+        .index = v->index,
+        .flags = v->flags,
+    };
+#else
+    return (softrast_vertex_t) {
+        .pos = v->pos,
+        .uv = v->uv,
+        .id = (int) v->id,
+        .index = (int) v->index,
+        .flags = (int) v->flags,
+    };
+#endif // ifdef RENDERER_PACKED_VERTICES
+}
+
+static softrast_pass_t soft_pass(
+    renderer_t *r, const render_pass_t *pass, u8 ref, bool is_portal_pass) {
+    return (softrast_pass_t) {
+        .view = pass->view,
+        .proj = pass->proj,
+        .cam_pos = r->cam.pos,
+        .yaw = pass->yaw,
+        .stencil_ref = ref,
+        .is_portal_pass = is_portal_pass,
+    };
+}
+
+// mirror of draw(r, first, n, 1) with pipeline on r->soft, indices are u16
+// (level_ibuf) or u32 (level_batch_ibuf) into vertices
+static void soft_draw_level(
+    renderer_t *r,
+    softrast_pipeline_t pipeline,
+    const softrast_pass_t *pass,
+    const level_vertex_t *vertices,
+    const void *indices,
+    usize index_size,
+    int first,
+    int n) {
+    dynlist_resize(r->soft_vertices, n);
+
+    for (int i = 0; i < n; i++) {
+        const u32 index =
+            index_size == sizeof(u32) ?
+                ((const u32*) indices)[first + i]
+                : ((const u16*) indices)[first + i];
+        r->soft_vertices[i] = soft_vertex(&vertices[index]);
     }
 
-    // first - draw and stencil portals
-    level_vs_params_t vs_params;
-    vs_params.view = pass->view;
-    vs_params.proj = pass->proj;
+    softrast_draw_level(r->soft, pipeline, pass, r->soft_vertices, n);
+}
 
-    level_fs_params_t fs_params;
-    fs_params.cam_pos = r->cam.pos;
-    fs_params.is_portal_pass = true;
+// draw run of n batch indices from first with pipeline_level
+static void draw_level(
+    renderer_t *r, const render_pass_t *pass, usize first, usize n) {
+    draw(r, first, n, 1);
+    r->stats.level_draws++;
 
-    sg_bindings bind =
-        (sg_bindings) {
-            .vs_images = {
-                [SLOT_level_data_image] = r->data_image
-            },
-            .fs_images = {
-                [SLOT_level_atlas] = state->atlas->image,
-                [SLOT_level_atlas_coords] = state->atlas->coords_image,
-                [SLOT_level_atlas_layers] = state->atlas->layer_image,
-                [SLOT_level_palette] = state->palette->image,
-                [SLOT_level_data_image] = r->data_image,
-            },
-            .index_buffer = r->level_ibuf,
-            .vertex_buffers[0] = r->level_vbuf,
-        };
+    if (r->soft) {
+        const softrast_pass_t soft =
+            soft_pass(r, pass, pass->stencil_ref, false);
+        soft_draw_level(
+            r,
+            SOFTRAST_PIPELINE_LEVEL,
+            &soft,
+            r->db_vertices.ptr,
+            r->batch_indices,
+            sizeof(u32),
+            first,
+            n);
+    }
+}
 
-    // accumulate visible sectors
-    DYNLIST(sector_t*) sectors = NULL; 
+// rebuild batch_indices from db_indices, see renderer_t::batch_indices
+static void build_batch_indices(renderer_t *r) {
+    usize n = 0;
     level_dynlist_each(r->level->sectors, it) {
-        *dynlist_push(sectors) = *it.el;
+        n += (*it.el)->render ? (*it.el)->render->n_indices : 0;
     }
 
-    // accumulate list of distance-sorted portals
-    DYNLIST(sector_render_portal_t*) portals = NULL;
+    if (n * sizeof(u32) > LEVEL_BATCH_IBUF_SIZE) {
+        WARN("too many level indices to batch (%" PRIu64 ")", (u64) n);
+        n = 0;
+    }
 
-    dynlist_each(sectors, it) {
-        if (r->debug_ui) {
-            igText("rendering sector %d", (*it.el)->index);
-        }
+    dynlist_resize(r->batch_indices, n);
+
+    n = 0;
+    level_dynlist_each(r->level->sectors, it) {
+        sector_render_t *sr = (*it.el)->render;
+        if (!sr) { continue; }
+
+        sr->batch_first = n;
+        if (!sr->indices || !sr->vertices) { continue; }
+        if (n + sr->n_indices > (usize) dynlist_size(r->batch_indices)) {
+            continue;
+        }
+
+        const u16 *indices = sr->indices;
+        ASSERT(
+            (sr->vertices - r->db_vertices.ptr) % sizeof(level_vertex_t) == 0);
+        const u32 base =
+            (sr->vertices - r->db_vertices.ptr) / sizeof(level_vertex_t);
+
+        for (usize i = 0; i < sr->n_indices; i++) {
+            r->batch_indices[n++] = base + indices[i];
+        }
+    }
+}
+
+// rasterize solid side segments near the camera as occluders
+static void build_occlusion(renderer_t *r) {
+    occlusion_begin(&r->occlusion, r->view_proj);
+
+    const vec2s cam = glms_vec2(r->cam.pos);
+
+    level_dynlist_each(r->level->sides, it) {
+        side_t *side = *it.el;
+        if (!side->wall || !side->sector) { continue; }
+
+        if (glms_vec2_distance(cam, wall_midpoint(side->wall))
+                - (side->wall->len / 2.0f)
+                > OCCLUDER_MAX_DIST) {
+            continue;
+        }
+
+        vertex_t *vs[2];
+        side_get_vertices(side, vs);
+
+        side_segment_t segs[4];
+        side_get_segments(side, segs);
+
+        for (int i = 0; i < 4; i++) {
+            const side_segment_t *seg = &segs[i];
+            if (!seg->present || !seg->mesh || seg->portal) { continue; }
+
+            // same winding as mesh_side
+            const vec3s ps[4] = {
+                VEC3(vs[0]->pos, seg->z0),
+                VEC3(vs[0]->pos, seg->z1),
+                VEC3(vs[1]->pos, seg->z1),
+                VEC3(vs[1]->pos, seg->z0),
+            };
+            occlusion_add_polygon(&r->occlusion, ps, 4);
+        }
+    }
+
+    occlusion_end(&r->occlusion);
+
+#ifdef DO_DUMP_OCCLUSION
+    occlusion_dump(&r->occlusion, "occlusion.png");
+#endif // ifdef DO_DUMP_OCCLUSION
+}
+
+// true if sector (and anything in it) might be visible past occluders
+static bool sector_unoccluded(renderer_t *r, const sector_t *sector) {
+    // boxes don't account for slopes
+    if (sector->floor.slope_enabled || sector->ceil.slope_enabled) {
+        return true;
+    }
+
+    // margin for sprites sticking out of the sector
+    return occlusion_test_box(
+        &r->occlusion,
+        VEC3(glms_vec2_subs(sector->min, OCCLUSION_MARGIN), sector->floor.z),
+        VEC3(glms_vec2_adds(sector->max, OCCLUSION_MARGIN), sector->ceil.z));
+}
+
+static int sector_order_cmp(
+    const sector_t **a,
+    const sector_t **b,
+    renderer_t *r) {
+    const int
+        d_a = r->sector_order.depths[(*a)->index],
+        d_b = r->sector_order.depths[(*b)->index];
+    if (d_a != d_b) { return d_a < d_b ? -1 : 1; }
+
+    const f32
+        e_a = r->sector_order.dists[(*a)->index],
+        e_b = r->sector_order.dists[(*b)->index];
+    return e_a < e_b ? -1 : (e_a > e_b ? 1 : 0);
+}
+
+// sort sectors front to back for early depth rejection: by breadth first
+// (connected) portal graph distance from pass sector, then by distance from
+// the eye to their bounds
+static void sort_sectors(
+    renderer_t *r,
+    const render_pass_t *pass,
+    DYNLIST(sector_t*) sectors) {
+    const int n = dynlist_size(r->level->sectors);
+    if (n != (int) dynlist_size(r->sector_order.depths)) {
+        dynlist_resize(r->sector_order.depths, n);
+        dynlist_resize(r->sector_order.dists, n);
+    }
+
+    for (int i = 0; i < n; i++) {
+        r->sector_order.depths[i] = INT_MAX;
+    }
+
+    vec3s eye;
+    deconstruct_view_matrix(pass->view, NULL, &eye, NULL, NULL);
+
+    dynlist_each(sectors, it) {
+        const sector_t *sector = *it.el;
+        const vec2s d =
+            glms_vec2_maxv(
+                glms_vec2_maxv(
+                    glms_vec2_sub(sector->min, glms_vec2(eye)),
+                    glms_vec2_sub(glms_vec2(eye), sector->max)),
+                VEC2(0));
+        r->sector_order.dists[sector->index] = glms_vec2_norm2(d);
+    }
+
+    // sectors not reachable from pass sector keep INT_MAX and go last
+    DYNLIST(sector_t*) queue = r->sector_order.queue;
+    dynlist_resize(queue, 0);
+
+    if (pass->sector) {
+        r->sector_order.depths[pass->sector->index] = 0;
+        *dynlist_push(queue) = pass->sector;
+    }
+
+    for (int i = 0; i < (int) dynlist_size(queue); i++) {
+        sector_t *sector = queue[i];
+        const int depth = r->sector_order.depths[sector->index];
+
+        llist_each(sector_sides, &sector->sides, it) {
+            const side_t *side = it.el;
+            if (!side->portal
+                || !side->portal->sector
+                || (side->flags & SIDE_FLAG_DISCONNECT)) {
+                continue;
+            }
+
+            sector_t *next = side->portal->sector;
+            int *pdepth = &r->sector_order.depths[next->index];
+
+            if (*pdepth == INT_MAX) {
+                *pdepth = depth + 1;
+                *dynlist_push(queue) = next;
+            }
+        }
+    }
+
+    r->sector_order.queue = queue;
+
+    sort(
+        sectors,
+        dynlist_size(sectors),
+        sizeof(sectors[0]),
+        (f_sort_cmp) sector_order_cmp,
+        r);
+}
+
+// fill view with visible sectors and distance-sorted visible portals of pass
+static void cull_view(
+    renderer_t *r,
+    const render_pass_t *pass,
+    render_view_t *view,
+    bool ui) {
+    dynlist_resize(view->sectors, 0);
+    dynlist_resize(view->portals, 0);
+
+    // occlusion buffer is only built for the main view
+    const bool occlude = pass->depth == 0 && !r->no_occlusion;
+
+    // accumulate visible sectors
+    level_dynlist_each(r->level->sectors, it) {
+        if (occlude && !sector_unoccluded(r, *it.el)) {
+            r->stats.occluded_sectors++;
+            continue;
+        }
+
+        *dynlist_push(view->sectors) = *it.el;
+    }
+
+    if (!r->no_sector_sort) {
+        sort_sectors(r, pass, view->sectors);
+    }
+
+    // accumulate list of visible portals
+    dynlist_each(view->sectors, it) {
+        if (r->debug_ui) {
+            igText("rendering sector %d", (*it.el)->index);
+        }
 
         sector_render_t *sr = (*it.el)->render;
         if (!sr->indices && !sr->vertices) { continue; }
@@ -1640,8 +2154,31 @@ static void do_render_pass(
                 continue;
             }
 
-            srp->scissor = scissor;
-            *dynlist_push(portals) = srp;
+            if (occlude) {
+                vertex_t *vs[2];
+                side_get_vertices(side, vs);
+
+                if (!occlusion_test_box(
+                        &r->occlusion,
+                        VEC3(glms_vec2_minv(vs[0]->pos, vs[1]->pos),
+                             side->sector->floor.z),
+                        VEC3(glms_vec2_maxv(vs[0]->pos, vs[1]->pos),
+                             side->sector->ceil.z))) {
+                    r->stats.occluded_portals++;
+                    continue;
+                }
+            }
+
+            render_view_portal_t *vp = dynlist_push(view->portals);
+            vp->portal = srp;
+            vp->scissor = scissor;
+            portal_view_proj(
+                side,
+                side->portal,
+                pass->proj,
+                pass->view,
+                &vp->proj,
+                &vp->view);
         }
     }
 
@@ -1651,60 +2188,447 @@ static void do_render_pass(
             : r->cam.pos;
 
     sort(
-        portals,
-        dynlist_size(portals),
-        sizeof(portals[0]), 
-        (f_sort_cmp) sector_render_portal_cmp,
+        view->portals,
+        dynlist_size(view->portals),
+        sizeof(view->portals[0]),
+        (f_sort_cmp) render_view_portal_cmp,
         &ref_pos);
+}
+
+static int view_run_first_cmp(
+    const render_view_run_t *a, const render_view_run_t *b, void*) {
+    return a->first < b->first ? -1 : (a->first > b->first ? 1 : 0);
+}
+
+static int view_run_rank_cmp(
+    const render_view_run_t *a, const render_view_run_t *b, void*) {
+    return a->rank - b->rank;
+}
+
+// merge batch_indices ranges of view's drawn sectors which are next to each
+// other in the buffer into runs, ordered by their frontmost sector so that
+// draws stay roughly front to back (see sort_sectors). nothing is uploaded
+static void build_view_runs(renderer_t *r, render_view_t *view) {
+    dynlist_resize(view->runs, 0);
+    view->n_run_sectors = 0;
+
+    dynlist_each(view->sectors, it) {
+        const sector_render_t *sr = (*it.el)->render;
+        if (!sr->indices && !sr->vertices) { continue; }
+        if (sr->n_indices == 0 || sr->n_vertices == 0) { continue; }
+
+        // not batched, see build_batch_indices
+        if (sr->batch_first + sr->n_indices
+                > (usize) dynlist_size(r->batch_indices)) {
+            continue;
+        }
+
+        *dynlist_push(view->runs) =
+            (render_view_run_t) {
+                .first = sr->batch_first,
+                .n = sr->n_indices,
+                .rank = it.i,
+            };
+        view->n_run_sectors++;
+    }
+
+    sort(
+        view->runs,
+        dynlist_size(view->runs),
+        sizeof(view->runs[0]),
+        (f_sort_cmp) view_run_first_cmp,
+        NULL);
+
+    int n = 0;
+    dynlist_each(view->runs, it) {
+        render_view_run_t *last = n == 0 ? NULL : &view->runs[n - 1];
+        if (last && last->first + last->n == it.el->first) {
+            last->n += it.el->n;
+            last->rank = min(last->rank, it.el->rank);
+        } else {
+            view->runs[n++] = *it.el;
+        }
+    }
+    dynlist_resize(view->runs, n);
+
+    sort(
+        view->runs,
+        dynlist_size(view->runs),
+        sizeof(view->runs[0]),
+        (f_sort_cmp) view_run_rank_cmp,
+        NULL);
+}
+
+#ifdef DO_VERIFY_VIEW_CACHE
+// checks that a cached view matches a freshly culled one
+static void verify_view(
+    renderer_t *r,
+    const render_pass_t *pass,
+    const render_view_t *view) {
+    render_view_t fresh = { 0 };
+    cull_view(r, pass, &fresh, false);
+
+    if (dynlist_size(fresh.portals) != dynlist_size(view->portals)) {
+        WARN(
+            "cached view has %d portals, expected %d",
+            (int) dynlist_size(view->portals),
+            (int) dynlist_size(fresh.portals));
+    } else {
+        dynlist_each(fresh.portals, it) {
+            const render_view_portal_t *vp = &view->portals[it.i];
+            if (vp->portal != it.el->portal
+                || !glms_ivec2_eq(vp->scissor.min, it.el->scissor.min)
+                || !glms_ivec2_eq(vp->scissor.max, it.el->scissor.max)) {
+                WARN("cached view portal %d differs", it.i);
+            }
+        }
+    }
+
+    dynlist_free(fresh.sectors);
+    dynlist_free(fresh.portals);
+}
+#endif // ifdef DO_VERIFY_VIEW_CACHE
+
+// get culling results for pass, from the cache if an equivalent pass has
+// already been culled this frame
+static const render_view_t *get_view(
+    renderer_t *r,
+    const render_pass_t *pass,
+    bool ui) {
+    render_view_key_t key;
+    memset(&key, 0, sizeof(key)); // padding is hashed
+    key.exit_side = pass->exit_side;
+    key.depth = pass->depth;
+    key.scissor = pass->scissor;
+
+    for (int i = 0; i < 16; i++) {
+        key.view[i] =
+            (i32) roundf(pass->view.raw[i / 4][i % 4] * RENDERER_VIEW_QUANTUM);
+        key.proj[i] =
+            (i32) roundf(pass->proj.raw[i / 4][i % 4] * RENDERER_VIEW_QUANTUM);
+    }
+
+    const hash_t hash = hash_add_bytes(HASH_FNV1A_INIT, &key, sizeof(key));
+
+    const int *pindex = map_find(int, &r->view_cache.map, hash);
+    if (pindex) {
+        const render_view_t *view = r->view_cache.views[*pindex];
+
+        if (!memcmp(&view->key, &key, sizeof(key))) {
+            r->stats.view_hits++;
+
+#ifdef DO_VERIFY_VIEW_CACHE
+            verify_view(r, pass, view);
+#endif // ifdef DO_VERIFY_VIEW_CACHE
+
+            return view;
+        }
+    }
+
+    // views are kept around between frames to reuse their lists
+    const int index = r->view_cache.n_views++;
+    if (index == (int) dynlist_size(r->view_cache.views)) {
+        render_view_t *view = calloc(1, sizeof(*view));
+        *dynlist_push(r->view_cache.views) = view;
+    }
+
+    render_view_t *view = r->view_cache.views[index];
+    view->key = key;
+    cull_view(r, pass, view, ui);
+    build_view_runs(r, view);
+
+    // on hash collision the old view keeps the slot
+    if (!pindex) {
+        map_insert(&r->view_cache.map, hash, index);
+    }
+
+    r->stats.view_misses++;
+    return view;
+}
+
+// returns false if sprite instance is outside of pass frustum or scissor rect,
+// otherwise *pw is the clip w (view depth) of its center
+static bool cull_sprite(
+    const render_pass_t *pass,
+    const sprite_instance_t *inst,
+    f32 *pw) {
+    // billboard rotates around offset, see sprite.glsl
+    const f32 half_w = inst->size.x / 2.0f;
+    const vec3s
+        box_min = glms_vec3_add(inst->offset, VEC3(-half_w, -half_w, 0)),
+        box_max =
+            glms_vec3_add(inst->offset, VEC3(half_w, half_w, inst->size.y));
+
+    // bits of clip planes which all corners are outside of
+    int out_all = 0x3F;
+    bool behind = false;
+    f32 x_min = 1e30f, y_min = 1e30f, x_max = -1e30f, y_max = -1e30f;
+
+    for (int i = 0; i < 8; i++) {
+        const vec4s p =
+            glms_mat4_mulv(
+                pass->view_proj,
+                VEC4(
+                    (i & 1) ? box_max.x : box_min.x,
+                    (i & 2) ? box_max.y : box_min.y,
+                    (i & 4) ? box_max.z : box_min.z,
+                    1.0f));
+
+        out_all &=
+            ((p.x < -p.w) << 0) | ((p.x > p.w) << 1)
+            | ((p.y < -p.w) << 2) | ((p.y > p.w) << 3)
+            | ((p.z < -p.w) << 4) | ((p.z > p.w) << 5);
+
+        if (p.w <= 0.0f) {
+            behind = true;
+            continue;
+        }
+
+        // same pixel mapping as side_clip
+        const f32
+            x = 0.5f * (p.x / p.w + 1.0f) * (TARGET_3D_WIDTH - 1),
+            y = 0.5f * (p.y / p.w + 1.0f) * (TARGET_3D_HEIGHT - 1);
+        x_min = min(x_min, x);
+        y_min = min(y_min, y);
+        x_max = max(x_max, x);
+        y_max = max(y_max, y);
+    }
+
+    if (out_all) { return false; }
+
+    *pw =
+        glms_mat4_mulv(
+            pass->view_proj,
+            VEC4(
+                glms_vec3_add(inst->offset, VEC3(0, 0, inst->size.y / 2.0f)),
+                1.0f)).w;
+
+    // crosses the eye plane, screen rect would be wrong
+    if (behind) { return true; }
+
+    // portal rect
+    const aabb_t rect =
+        AABB_MM(
+            IVEC2((int) floorf(x_min), (int) floorf(y_min)),
+            IVEC2((int) floorf(x_max) + 1, (int) floorf(y_max) + 1));
+    return aabb_collides(rect, pass->scissor);
+}
+
+// sort pass sprite instances [base, r->n_sprites) by r->sprite_sort.keys
+static void sort_sprites(renderer_t *r, int base) {
+    const int n = r->n_sprites - base;
+    if (n == 0) { return; }
+
+    const u64 t_start = time_ns();
+
+    ASSERT((int) dynlist_size(r->sprite_sort.keys) == n);
+    dynlist_resize(r->sprite_sort.vals, n);
+    dynlist_resize(r->sprite_sort.tmp_keys, n);
+    dynlist_resize(r->sprite_sort.tmp_vals, n);
+    dynlist_resize(r->sprite_sort.instances, n);
+
+    for (int i = 0; i < n; i++) {
+        r->sprite_sort.vals[i] = i;
+    }
+
+    radix_sort_u32(
+        r->sprite_sort.keys,
+        r->sprite_sort.vals,
+        r->sprite_sort.tmp_keys,
+        r->sprite_sort.tmp_vals,
+        n);
+
+    sprite_instance_t *instances = &r->instance_data.ptr[base];
+    for (int i = 0; i < n; i++) {
+        r->sprite_sort.instances[i] = instances[r->sprite_sort.vals[i]];
+    }
+
+    memcpy(
+        instances,
+        r->sprite_sort.instances,
+        n * sizeof(sprite_instance_t));
+
+#ifdef DO_VERIFY_SPRITE_SORT
+    for (int i = 1; i < n; i++) {
+        if (r->sprite_sort.keys[i - 1] > r->sprite_sort.keys[i]) {
+            WARN("sprite %d out of order", i);
+        }
+    }
+#endif // ifdef DO_VERIFY_SPRITE_SORT
+
+    r->stats.ns_sprite_sort += time_ns() - t_start;
+}
+
+// estimate level geometry overdraw of a pass on the CPU: sector bounds are
+// "drawn" in submission order into a coarse grid of depths, where a cell is
+// counted as shaded if the box's nearest point passes the depth test and then
+// takes on the box's farthest depth
+static void estimate_overdraw(
+    renderer_t *r,
+    const render_pass_t *pass,
+    const render_view_t *view) {
+    f32 grid[OVERDRAW_GRID_HEIGHT][OVERDRAW_GRID_WIDTH];
+    for (int y = 0; y < OVERDRAW_GRID_HEIGHT; y++) {
+        for (int x = 0; x < OVERDRAW_GRID_WIDTH; x++) {
+            grid[y][x] = INFINITY;
+        }
+    }
+
+    int shaded = 0, covered = 0;
+
+    dynlist_each(view->sectors, it) {
+        const sector_t *sector = *it.el;
+        const sector_render_t *sr = sector->render;
+        if (!sr->indices || sr->n_indices == 0) { continue; }
+
+        vec2s lo = VEC2(1e30f), hi = VEC2(-1e30f);
+        f32 z_lo = 1e30f, z_hi = -1e30f;
+        bool around_eye = false;
+
+        for (int i = 0; i < 8; i++) {
+            const vec4s p =
+                glms_mat4_mulv(
+                    pass->view_proj,
+                    VEC4(
+                        (i & 1) ? sector->max.x : sector->min.x,
+                        (i & 2) ? sector->max.y : sector->min.y,
+                        (i & 4) ? sector->ceil.z : sector->floor.z,
+                        1.0f));
+
+            if (p.w <= 0.0f) {
+                around_eye = true;
+                continue;
+            }
+
+            const vec2s q = VEC2(p.x / p.w, p.y / p.w);
+            lo = glms_vec2_minv(lo, q);
+            hi = glms_vec2_maxv(hi, q);
+            z_lo = min(z_lo, p.w);
+            z_hi = max(z_hi, p.w);
+        }
+
+        // around/behind eye: covers the whole screen from depth 0
+        if (around_eye) {
+            lo = VEC2(-1.0f);
+            hi = VEC2(1.0f);
+            z_lo = 0.0f;
+            z_hi = max(z_hi, 0.0f);
+        }
+
+        const int
+            x0 = max(0, (int) ((lo.x * 0.5f + 0.5f) * OVERDRAW_GRID_WIDTH)),
+            x1 =
+                min(OVERDRAW_GRID_WIDTH - 1,
+                    (int) ((hi.x * 0.5f + 0.5f) * OVERDRAW_GRID_WIDTH)),
+            y0 = max(0, (int) ((lo.y * 0.5f + 0.5f) * OVERDRAW_GRID_HEIGHT)),
+            y1 =
+                min(OVERDRAW_GRID_HEIGHT - 1,
+                    (int) ((hi.y * 0.5f + 0.5f) * OVERDRAW_GRID_HEIGHT));
+
+        for (int y = y0; y <= y1; y++) {
+            for (int x = x0; x <= x1; x++) {
+                if (z_lo >= grid[y][x]) { continue; }
+                covered += grid[y][x] == INFINITY ? 1 : 0;
+                shaded++;
+                grid[y][x] = min(grid[y][x], z_hi);
+            }
+        }
+    }
+
+    r->stats.overdraw_shaded += shaded;
+    r->stats.overdraw_covered += covered;
+}
+
+static void do_render_pass(
+    renderer_t *r,
+    const render_pass_t *pass) {
+    if (pass->depth >= RENDERER_MAX_PORTAL_DEPTH) {
+        return;
+    }
+
+    char name[256];
+    snprintf(
+        name,
+        sizeof(name),
+        "PASS (side: %d -> %d/st: %d/dp: %d)",
+        pass->entry_side ? pass->entry_side->index : -1,
+        pass->exit_side ? pass->exit_side->index : -1,
+        pass->stencil_ref,
+        pass->depth);
+    const bool ui = r->debug_ui && igTreeNode_Str(name);
+    if (r->debug_ui) { igTreeNodeSetOpen(igGetItemID(), true); }
+    if (ui) { igText("SCISSOR: %" PRIaabb, FMTaabb(pass->scissor)); }
+    if (ui) {
+        igText("VIEW:\n %" PRIm4, FMTm4(pass->view));
+    }
+
+    // first - draw and stencil portals
+    level_vs_params_t vs_params;
+    vs_params.view = pass->view;
+    vs_params.proj = pass->proj;
+
+    level_fs_params_t fs_params;
+    fs_params.cam_pos = r->cam.pos;
+    fs_params.is_portal_pass = true;
+
+    sg_bindings bind =
+        (sg_bindings) {
+            .vs_images = {
+                [SLOT_level_data_image] = r->data_image
+            },
+            .fs_images = {
+                [SLOT_level_atlas] = state->atlas->image,
+                [SLOT_level_atlas_coords] = state->atlas->coords_image,
+                [SLOT_level_atlas_layers] = state->atlas->layer_image,
+                [SLOT_level_palette] = state->palette->image,
+                [SLOT_level_data_image] = r->data_image,
+            },
+            .index_buffer = r->level_ibuf,
+            .vertex_buffers[0] = r->level_vbuf,
+        };
 
-    dynlist_each(portals, it) {
-        sector_render_portal_t *srp = *it.el;
+    const render_view_t *view = get_view(r, pass, ui);
+
+    dynlist_each(view->portals, it) {
+        const render_view_portal_t *vp = it.el;
+        sector_render_portal_t *srp = vp->portal;
         side_t *side = srp->side;
         sector_render_t *sr = srp->sector->render;
 
-        mat4s view_portal, proj_portal;
-        portal_view_proj(
-            side,
-            side->portal,
-            pass->proj,
-            pass->view,
-            &proj_portal,
-            &view_portal);
-
-        // draw portal outline with EQUAL for stenciling, but INCR where pass
-        sg_apply_pipeline(r->pipeline_portal);
+        // mark portal: INCR stencil where it is ref and the portal is visible
+        apply_pipeline(r, r->pipeline_portal_mark[pass->stencil_ref]);
 
-        sg_apply_uniforms(
+        apply_uniforms(
+            r,
             SG_SHADERSTAGE_VS, SLOT_level_vs_params,
             &(sg_range) { &vs_params, sizeof(vs_params) });
 
-        sg_apply_uniforms(
+        apply_uniforms(
+            r,
             SG_SHADERSTAGE_FS, SLOT_level_fs_params,
             &(sg_range) { &fs_params, sizeof(fs_params) });
 
+        bind.index_buffer = r->level_ibuf;
         bind.index_buffer_offset = sr->indices - r->db_indices.ptr;
         bind.vertex_buffer_offsets[0] = sr->vertices - r->db_vertices.ptr;
-        sg_apply_bindings(&bind);
-
-        glEnable(GL_STENCIL_TEST);
-        glStencilFuncSeparate(GL_FRONT, GL_EQUAL, pass->stencil_ref, 0xFF);
-        glStencilOpSeparate(GL_FRONT, GL_KEEP, GL_KEEP, GL_INCR);
-        glColorMaski(0, GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
-        glColorMaski(1, GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
-        glEnable(GL_DEPTH_TEST);
-        glDepthFunc(GL_LEQUAL);
-
-        sg_draw(
-            (int) (((u16*) srp->indices) - ((u16*) (sr->indices))), 6, 1);
-
-        // reset to "expected state" before messing with sokol pipeline
-        glEnable(GL_DEPTH_TEST);
-        glDepthFunc(GL_LEQUAL);
-        glStencilFuncSeparate(GL_FRONT, GL_EQUAL, 0, 0xFF);
-        glStencilOpSeparate(GL_FRONT, GL_KEEP, GL_KEEP, GL_INCR);
-        glColorMaski(0, GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
-        glColorMaski(1, GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
-        glDepthMask(GL_TRUE);
+        apply_bindings(r, &bind);
+
+        draw(r, (int) (((u16*) srp->indices) - ((u16*) (sr->indices))), 6, 1);
+        r->stats.portals++;
+
+        if (r->soft) {
+            const softrast_pass_t soft =
+                soft_pass(r, pass, pass->stencil_ref, true);
+            soft_draw_level(
+                r,
+                SOFTRAST_PIPELINE_PORTAL_MARK,
+                &soft,
+                sr->vertices,
+                srp->indices,
+                sizeof(u16),
+                0,
+                6);
+        }
 
         // recursively draw inside of portal
         if (ui) {
@@ -1712,17 +2636,17 @@ static void do_render_pass(
                 "DOING PORTAL %d (from %d)",
                 side->index,
                 pass->exit_side ? pass->exit_side->index : -1);
-            igText("  SCISSOR: %" PRIaabb, FMTaabb(srp->scissor));
+            igText("  SCISSOR: %" PRIaabb, FMTaabb(vp->scissor));
         }
         do_render_pass(
             r,
             &(render_pass_t) {
-                .proj = proj_portal,
-                .view = view_portal,
-                .view_proj = glms_mat4_mul(proj_portal, view_portal),
+                .proj = vp->proj,
+                .view = vp->view,
+                .view_proj = glms_mat4_mul(vp->proj, vp->view),
                 .yaw =
                     pass->yaw + portal_angle(r->level, side, side->portal),
-                .scissor = srp->scissor,
+                .scissor = vp->scissor,
                 .stencil_ref = pass->stencil_ref + 1,
                 .depth = pass->depth + 1,
                 .entry_side = side,
@@ -1731,157 +2655,163 @@ static void do_render_pass(
                 .from = pass,
             });
 
-        // draw again to decrement
-        sg_apply_pipeline(r->pipeline_portal);
+        // unmark portal: DECR stencil back to ref where it was marked and
+        // paint the portal's depth over what was drawn through it
+        apply_pipeline(r, r->pipeline_portal_unmark[pass->stencil_ref]);
 
-        sg_apply_uniforms(
+        apply_uniforms(
+            r,
             SG_SHADERSTAGE_VS, SLOT_level_vs_params,
             &(sg_range) { &vs_params, sizeof(vs_params) });
 
-        sg_apply_uniforms(
+        apply_uniforms(
+            r,
             SG_SHADERSTAGE_FS, SLOT_level_fs_params,
             &(sg_range) { &fs_params, sizeof(fs_params) });
 
+        // recursive pass has rebound buffers
+        bind.index_buffer = r->level_ibuf;
         bind.index_buffer_offset = sr->indices - r->db_indices.ptr;
         bind.vertex_buffer_offsets[0] = sr->vertices - r->db_vertices.ptr;
-
-        // SECOND DRAW:
-        // draw to paint proper depth over this part of the scene
-
-        // do not write to stencil, color, ONLY depth
-        glEnable(GL_STENCIL_TEST);
-        glStencilFuncSeparate(GL_FRONT, GL_EQUAL, pass->stencil_ref + 1, 0xFF);
-        glStencilOpSeparate(GL_FRONT, GL_KEEP, GL_KEEP, GL_KEEP);
-        glColorMaski(0, GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
-        glColorMaski(1, GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
-        glEnable(GL_DEPTH_TEST);
-        glDepthMask(GL_TRUE);
-        glDepthFunc(GL_ALWAYS);
-
-        sg_apply_bindings(&bind);
-        sg_draw(
-            (int) (((u16*) srp->indices) - ((u16*) (sr->indices))), 6, 1);
+        apply_bindings(r, &bind);
+
+        draw(r, (int) (((u16*) srp->indices) - ((u16*) (sr->indices))), 6, 1);
+
+        if (r->soft) {
+            const softrast_pass_t soft =
+                soft_pass(r, pass, pass->stencil_ref + 1, true);
+            soft_draw_level(
+                r,
+                SOFTRAST_PIPELINE_PORTAL_UNMARK,
+                &soft,
+                sr->vertices,
+                srp->indices,
+                sizeof(u16),
+                0,
+                6);
+        }
 
         if (r->debug_ui) {
             igText("drawing into %d depth buffer", side->index);
         }
+    }
+    // draw regular level geometry where stencil >= ref
+    apply_pipeline(r, r->pipeline_level[pass->stencil_ref]);
 
-        // reset to "expected state" before messing with sokol pipeline
-        glDepthFunc(GL_LEQUAL);
-        glDepthMask(GL_TRUE);
-        glEnable(GL_STENCIL_TEST);
-        glEnable(GL_DEPTH_TEST);
-        glStencilFuncSeparate(GL_FRONT, GL_EQUAL, 0, 0xFF);
-        glStencilOpSeparate(GL_FRONT, GL_KEEP, GL_KEEP, GL_INCR);
-        glColorMaski(0, GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
-        glColorMaski(1, GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
-
-        glEnable(GL_DEPTH_TEST);
-        glEnable(GL_STENCIL_TEST);
-        glStencilMask(0xFF);
-        glStencilFuncSeparate(GL_FRONT, GL_EQUAL, 0, 0xFF);
-        glStencilOpSeparate(GL_FRONT, GL_KEEP, GL_KEEP, GL_INCR);
-        glColorMaski(0, GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
-        glColorMaski(1, GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
-        glDepthMask(GL_TRUE);
-
-        // THIRD DRAW: decrement on failure to reset to original stencil
-        // value
-        sg_apply_bindings(&bind);
-
-        // fail when inside, and decrement on failure
-        glEnable(GL_STENCIL_TEST);
-        glStencilFuncSeparate(GL_FRONT, GL_NOTEQUAL, pass->stencil_ref + 1, 0xFF);
-        glStencilOpSeparate(GL_FRONT, GL_DECR, GL_KEEP, GL_KEEP);
-        glColorMaski(0, GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
-        glColorMaski(1, GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
-        glDepthMask(GL_FALSE);
-        glDisable(GL_DEPTH_TEST);
-
-        sg_draw(
-            (int) (((u16*) srp->indices) - ((u16*) (sr->indices))), 6, 1);
-
-        // reset to "expected state" before messing with sokol pipeline
-        glEnable(GL_DEPTH_TEST);
-        glEnable(GL_STENCIL_TEST);
-        glStencilFuncSeparate(GL_FRONT, GL_EQUAL, 0, 0xFF);
-        glStencilOpSeparate(GL_FRONT, GL_KEEP, GL_KEEP, GL_INCR);
-        glColorMaski(0, GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
-        glColorMaski(1, GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
-        glDepthMask(GL_TRUE);
-    }
-
-    // draw regular level geometry
-    sg_apply_pipeline(r->pipeline_level);
-
-    sg_apply_uniforms(
+    apply_uniforms(
+        r,
         SG_SHADERSTAGE_VS, SLOT_level_vs_params,
         &(sg_range) { &vs_params, sizeof(vs_params) });
 
     fs_params.is_portal_pass = false;
-    sg_apply_uniforms(
+    apply_uniforms(
+        r,
         SG_SHADERSTAGE_FS, SLOT_level_fs_params,
         &(sg_range) { &fs_params, sizeof(fs_params) });
 
+    const bool occlude = pass->depth == 0 && !r->no_occlusion;
+
+    // sprites outside of the pass frustum/portal rect are culled, the rest are
+    // sorted back to front before upload, see sort_sprites
     const int base_sprites = r->n_sprites;
-    dynlist_each(sectors, it) {
+    dynlist_resize(r->sprite_sort.keys, 0);
+
+    dynlist_each(view->sectors, it) {
+        sector_t *sector = *it.el;
+
         // objects
-        dlist_each(sector_list, &(*it.el)->objects, it_o) {
-            prepare_object(r, it_o.el, &r->instance_data.ptr[r->n_sprites++]);
+        dlist_each(sector_list, &sector->objects, it_o) {
+            sprite_instance_t *inst = &r->instance_data.ptr[r->n_sprites++];
+            prepare_object(r, it_o.el, inst);
+
+            f32 w;
+            if (!cull_sprite(pass, inst, &w)) {
+                r->n_sprites--;
+                r->stats.culled_sprites++;
+                continue;
+            }
+
+            // billboard rotates around offset, see sprite.glsl
+            const f32 half_w = inst->size.x / 2.0f;
+            if (occlude
+                && !occlusion_test_box(
+                    &r->occlusion,
+                    glms_vec3_add(inst->offset, VEC3(-half_w, -half_w, 0)),
+                    glms_vec3_add(
+                        inst->offset, VEC3(half_w, half_w, inst->size.y)))) {
+                r->n_sprites--;
+                r->stats.occluded_sprites++;
+                continue;
+            }
+
+            *dynlist_push(r->sprite_sort.keys) =
+                sprite_sort_key(w, it_o.el->render->lookup.layer);
         }
 
         // particles
-        dynlist_each((*it.el)->particles, it_p) {
+        dynlist_each(sector->particles, it_p) {
             particle_t *p = &r->level->particles[*it_p.el];
-            prepare_particle(r, p, &r->instance_data.ptr[r->n_sprites++]);
-        }
+            sprite_instance_t *inst = &r->instance_data.ptr[r->n_sprites++];
+            prepare_particle(r, p, inst);
 
-        sector_render_t *sr = (*it.el)->render;
-        if (!sr->indices && !sr->vertices) { continue; }
-        if (sr->n_indices == 0 || sr->n_vertices == 0) { continue; }
+            f32 w;
+            if (!cull_sprite(pass, inst, &w)) {
+                r->n_sprites--;
+                r->stats.culled_sprites++;
+                continue;
+            }
 
-        bind.index_buffer_offset = sr->indices - r->db_indices.ptr;
-        bind.vertex_buffer_offsets[0] = sr->vertices - r->db_vertices.ptr;
-        sg_apply_bindings(&bind);
+            *dynlist_push(r->sprite_sort.keys) =
+                sprite_sort_key(
+                    w, r->particle_data.ptrs[p->type]->lookup.layer);
+        }
+    }
 
-        // only draw where EQUAL, do not INCR
-        glEnable(GL_STENCIL_TEST);
-        glStencilFuncSeparate(GL_FRONT, GL_LEQUAL, pass->stencil_ref, 0xFF);
-        glStencilOpSeparate(GL_FRONT, GL_KEEP, GL_KEEP, GL_KEEP);
-        glDepthFunc(GL_LEQUAL);
+    sort_sprites(r, base_sprites);
+    r->stats.sprites += r->n_sprites - base_sprites;
 
-        sg_draw(0, sr->n_indices, 1);
+    bind.index_buffer = r->level_batch_ibuf;
+    bind.index_buffer_offset = 0;
+    bind.vertex_buffer_offsets[0] = 0;
+    apply_bindings(r, &bind);
 
-        // reset to "expected" state
-        glDepthFunc(GL_LEQUAL);
-        glStencilFuncSeparate(GL_FRONT, GL_EQUAL, 0, 0xFF);
-        glStencilOpSeparate(GL_FRONT, GL_KEEP, GL_KEEP, GL_KEEP);
+    r->stats.level_sectors += view->n_run_sectors;
+    dynlist_each(view->runs, it) {
+        draw_level(r, pass, it.el->first, it.el->n);
+    }
+
+    if (pass->depth == 0 && r->debug_ui) {
+        estimate_overdraw(r, pass, view);
     }
 
     // draw accumulated sprite instances
     {
         const int inst_bytes =
             (r->n_sprites - base_sprites) * sizeof(sprite_instance_t);
-        sg_append_buffer(
-            r->sprite_instbuf,
-            &(sg_range) {
-                .size = inst_bytes,
-                .ptr = &r->instance_data.ptr[base_sprites]
-            });
+        if (!r->headless) {
+            sg_append_buffer(
+                r->sprite_instbuf,
+                &(sg_range) {
+                    .size = inst_bytes,
+                    .ptr = &r->instance_data.ptr[base_sprites]
+                });
+        }
 
         sprite_vs_params_t vs_params;
         vs_params.yaw = pass->yaw;
         vs_params.view = pass->view;
         vs_params.proj = pass->proj;
 
-        sg_apply_pipeline(r->pipeline_sprite);
-        sg_apply_uniforms(
+        apply_pipeline(r, r->pipeline_sprite[pass->stencil_ref]);
+        apply_uniforms(
+            r,
             SG_SHADERSTAGE_VS, SLOT_sprite_vs_params,
             &(sg_range) { &vs_params, sizeof(vs_params) });
 
         sprite_fs_params_t fs_params;
         fs_params.cam_pos = r->cam.pos;
-        sg_apply_uniforms(
+        apply_uniforms(
+            r,
             SG_SHADERSTAGE_FS, SLOT_sprite_fs_params,
             &(sg_range) { &fs_params, sizeof(fs_params) });
 
@@ -1904,26 +2834,232 @@ static void do_render_pass(
                     base_sprites * sizeof(sprite_instance_t)
             };
 
-        glEnable(GL_STENCIL_TEST);
-        glStencilFuncSeparate(GL_FRONT, GL_LEQUAL, pass->stencil_ref, 0xFF);
-        glStencilOpSeparate(GL_FRONT, GL_KEEP, GL_KEEP, GL_KEEP);
-        glDepthFunc(GL_LEQUAL);
-
-        sg_apply_bindings(&bind);
-        sg_draw(0, 6, r->n_sprites - base_sprites);
-
-        glEnable(GL_STENCIL_TEST);
-        glDepthFunc(GL_LEQUAL);
-        glStencilFuncSeparate(GL_FRONT, GL_EQUAL, 0, 0xFF);
-        glStencilOpSeparate(GL_FRONT, GL_KEEP, GL_KEEP, GL_KEEP);
+        apply_bindings(r, &bind);
+        draw(r, 0, 6, r->n_sprites - base_sprites);
+
+        if (r->soft) {
+            const softrast_pass_t soft =
+                soft_pass(r, pass, pass->stencil_ref, false);
+            softrast_draw_sprites(
+                r->soft,
+                &soft,
+                &r->instance_data.ptr[base_sprites],
+                r->n_sprites - base_sprites);
+        }
     }
 
     if (ui) { 
         igTreePop(); 
     }
+}
+
+// id of render_vertex_t which v was made from, see put_vertex
+static int vertex_id(const level_vertex_t *v) {
+#ifdef RENDERER_PACKED_VERTICES
+    return v->id[0] + (v->id[1] << 16);
+#else
+    return (int) v->id;
+#endif // ifdef RENDERER_PACKED_VERTICES
+}
+
+// hash of vertices of sector with any of n ids, in mesh order
+static hash_t hash_vertices(const sector_render_t *sr, const int *ids, int n) {
+    hash_t hash = HASH_FNV1A_INIT;
+    const level_vertex_t *vertices = sr->vertices;
+
+    for (usize i = 0; i < sr->n_vertices; i++) {
+        const int id = vertex_id(&vertices[i]);
+        for (int j = 0; j < n; j++) {
+            if (id != ids[j]) { continue; }
+            hash = hash_add_bytes(hash, &vertices[i], sizeof(vertices[i]));
+            break;
+        }
+    }
+
+    return hash;
+}
 
-    dynlist_free(portals);
-    dynlist_free(sectors);
+ALWAYS_INLINE hash_t hash_data_row(
+    const renderer_t *r, hash_t hash, int type_index, int index) {
+    return
+        hash_add_bytes(
+            hash,
+            r->data.buf[type_index][index],
+            sizeof(r->data.buf[type_index][index]));
+}
+
+typedef struct {
+    char s[96];
+} golden_line_t;
+
+// one line per sector and side, see renderer_check_golden
+static void golden_lines(renderer_t *r, DYNLIST(golden_line_t) *lines) {
+    DYNLIST(int) ids = NULL;
+
+    *dynlist_push(*lines) = (golden_line_t) { 0 };
+    snprintf(
+        (*lines)[0].s, sizeof((*lines)[0].s),
+        "vertex %d", (int) sizeof(level_vertex_t));
+
+    level_dynlist_each(r->level->sectors, it) {
+        sector_t *sector = *it.el;
+        const sector_render_t *sr = sector->render;
+
+        // planes and sector decals
+        dynlist_resize(ids, 0);
+        *dynlist_push(ids) = (T_SECTOR << 16) | ((int) sector->index);
+
+        hash_t data =
+            hash_data_row(r, HASH_FNV1A_INIT, T_SECTOR_INDEX, sr->index);
+
+        llist_each(node, &sector->decals, it_d) {
+            *dynlist_push(ids) = (T_DECAL << 16) | ((int) it_d.el->index);
+            data =
+                hash_data_row(
+                    r, data, T_DECAL_INDEX, it_d.el->render->index);
+        }
+
+        golden_line_t *line = dynlist_push(*lines);
+        snprintf(
+            line->s, sizeof(line->s),
+            "sector %d %016" PRIx64 " %016" PRIx64 " %016" PRIx64,
+            (int) sector->index,
+            hash_vertices(sr, ids, dynlist_size(ids)),
+            hash_add_bytes(
+                HASH_FNV1A_INIT,
+                sr->indices,
+                sr->n_indices * sizeof(u16)),
+            data);
+
+        llist_each(sector_sides, &sector->sides, it_s) {
+            side_t *side = it_s.el;
+
+            dynlist_resize(ids, 0);
+            *dynlist_push(ids) = (T_SIDE << 16) | ((int) side->index);
+
+            // sides of unmeshed (empty) sectors are never prepared
+            data =
+                side->render && side->render->side == side
+                    ? hash_data_row(
+                        r, HASH_FNV1A_INIT, T_SIDE_INDEX, side->render->index)
+                    : HASH_FNV1A_INIT;
+
+            llist_each(node, &side->decals, it_d) {
+                *dynlist_push(ids) = (T_DECAL << 16) | ((int) it_d.el->index);
+                data =
+                    hash_data_row(
+                        r, data, T_DECAL_INDEX, it_d.el->render->index);
+            }
+
+            line = dynlist_push(*lines);
+            snprintf(
+                line->s, sizeof(line->s),
+                "side %d %016" PRIx64 " %016" PRIx64,
+                (int) side->index,
+                hash_vertices(sr, ids, dynlist_size(ids)),
+                data);
+        }
+    }
+
+    dynlist_free(ids);
+}
+
+bool renderer_check_golden(renderer_t *r, const char *path, bool update) {
+    ASSERT(r->level);
+
+    // remesh everything from a fresh state so that hashes do not depend on
+    // allocation history
+    renderer_set_level(r, r->level);
+    memset(r->data.buf, 0, sizeof(r->data.buf));
+
+    const u64 t_prepare = time_ns();
+    level_dynlist_each(r->level->sectors, it) {
+        prepare_sector(r, *it.el);
+    }
+    const u64 ns_prepare = time_ns() - t_prepare;
+
+    const u64 t_hash = time_ns();
+    DYNLIST(golden_line_t) lines = NULL;
+    golden_lines(r, &lines);
+    const u64 ns_hash = time_ns() - t_hash;
+
+    r->level_dirty = true;
+    r->data.dirty = true;
+
+    LOG(
+        "golden: %d lines, prepare %.3f ms, hash %.3f ms",
+        dynlist_size(lines),
+        ns_prepare / 1000000.0,
+        ns_hash / 1000000.0);
+
+    bool ok = true;
+
+    if (update) {
+        FILE *f = fopen(path, "wb");
+        if (!f) {
+            WARN("could not write golden %s", path);
+            ok = false;
+            goto done;
+        }
+
+        dynlist_each(lines, it) {
+            fprintf(f, "%s\n", it.el->s);
+        }
+
+        fclose(f);
+        LOG("wrote golden %s", path);
+        goto done;
+    }
+
+    // a missing golden is a failure, it is only written on update
+    char *golden;
+    usize len;
+    if (file_read_str(path, &golden, &len)) {
+        WARN("could not read golden %s", path);
+        ok = false;
+        goto done;
+    }
+
+    // compare line by line, report first mismatch with its sector
+    const char *p = golden, *sector_line = NULL;
+    int n_compared = 0;
+    dynlist_each(lines, it) {
+        const char *end = strchr(p, '\n');
+        const int n = end ? (int) (end - p) : (int) strlen(p);
+
+        if (!strncmp(it.el->s, "sector", 6)) {
+            sector_line = it.el->s;
+        }
+
+        if ((int) strlen(it.el->s) != n || strncmp(it.el->s, p, n)) {
+            WARN(
+                "golden mismatch at line %d (in %s)",
+                it.i + 1,
+                sector_line ? sector_line : "header");
+            WARN("  expected: %.*s", n, p);
+            WARN("  got:      %s", it.el->s);
+            ok = false;
+            break;
+        }
+
+        p = end ? end + 1 : p + n;
+        n_compared++;
+    }
+
+    if (ok && *p) {
+        WARN("golden %s has extra lines after %d", path, n_compared);
+        ok = false;
+    }
+
+    free(golden);
+
+    if (ok) {
+        LOG("golden %s ok", path);
+    }
+
+done:
+    dynlist_free(lines);
+    return ok;
 }
 
 void renderer_render(renderer_t *r) {
@@ -1932,6 +3068,10 @@ void renderer_render(renderer_t *r) {
     }
 
     r->n_sprites = 0;
+    memset(&r->stats, 0, sizeof(r->stats));
+    memset(&state->atlas->stats, 0, sizeof(state->atlas->stats));
+    map_clear(&r->view_cache.map);
+    r->view_cache.n_views = 0;
 
     for (int i = 0; i < 4; i++) {
         bitmap_fill(r->data_arrays[i].frame_bits, 2048, false);
@@ -1948,24 +3088,40 @@ void renderer_render(renderer_t *r) {
 
     if (r->level_dirty) {
         r->level_dirty = false;
+        build_batch_indices(r);
+
+        if (!r->headless) {
+            sg_append_buffer(
+                r->level_ibuf,
+                &(sg_range) {
+                    .size = r->db_indices.used,
+                    .ptr = r->db_indices.ptr
+                });
+
+            sg_append_buffer(
+                r->level_vbuf,
+                &(sg_range) {
+                    .size = r->db_vertices.used,
+                    .ptr = r->db_vertices.ptr
+                });
+
+            sg_append_buffer(
+                r->level_batch_ibuf,
+                &(sg_range) {
+                    .size = dynlist_size_bytes(r->batch_indices),
+                    .ptr = r->batch_indices
+                });
+        }
 
-        sg_append_buffer(
-            r->level_ibuf,
-            &(sg_range) {
-                .size = r->db_indices.used,
-                .ptr = r->db_indices.ptr
-            });
-
-        sg_append_buffer(
-            r->level_vbuf,
-            &(sg_range) {
-                .size = r->db_vertices.used,
-                .ptr = r->db_vertices.ptr
-            });
+        r->level_upload.vertex_bytes = r->db_vertices.used;
+        r->level_upload.index_bytes =
+            r->db_indices.used + dynlist_size_bytes(r->batch_indices);
+        r->stats.upload_bytes +=
+            r->level_upload.vertex_bytes + r->level_upload.index_bytes;
     }
 
     // update dirty images
-    if (r->data.dirty) {
+    if (r->data.dirty && !r->headless) {
         r->data.dirty = false;
 
         sg_update_image(
@@ -2004,6 +3160,18 @@ void renderer_render(renderer_t *r) {
     r->view_proj = glms_mat4_mul(r->proj, r->view);
     r->frustum_box = extract_view_proj_aabb_2d(&r->view_proj);
 
+    if (!r->no_occlusion) {
+        build_occlusion(r);
+    }
+
+    if (r->soft) {
+        softrast_begin(
+            r->soft,
+            &r->data.buf[0][0][0],
+            state->atlas,
+            r->soft_palette ? state->palette : NULL);
+    }
+
     do_render_pass(
         r,
         &(render_pass_t) {
@@ -2017,6 +3185,10 @@ void renderer_render(renderer_t *r) {
             .from = NULL
         });
 
+    if (r->soft) {
+        softrast_end(r->soft);
+    }
+
     if (r->n_sprites > (int) (
         SPRITE_INSTBUF_SIZE 
             / sizeof(sprite_instance_t))) {
@@ -2028,11 +3200,141 @@ void renderer_render(renderer_t *r) {
                 / sizeof(sprite_instance_t));
     }
 
+    if (r->debug_ui) {
+        igText(
+            "DRAWS: %d, PIPELINES: %d, PORTALS: %d",
+            r->stats.draws,
+            r->stats.pipelines,
+            r->stats.portals);
+        igText(
+            "LEVEL DRAWS: %d (%d SECTORS)",
+            r->stats.level_draws,
+            r->stats.level_sectors);
+        igText(
+            "VIEW CACHE HIT/MISS: %d/%d",
+            r->stats.view_hits,
+            r->stats.view_misses);
+        igText(
+            "SPRITES: %d (%d CULLED), SORT (ms): %.3f",
+            r->stats.sprites,
+            r->stats.culled_sprites,
+            r->stats.ns_sprite_sort / 1000000.0);
+        igText(
+            "LEVEL VBUF: %d KiB (%d B/VERTEX), LAST UPLOAD: %d/%d KiB (V/I)",
+            (int) (r->db_vertices.used / 1024),
+            (int) sizeof(level_vertex_t),
+            (int) (r->level_upload.vertex_bytes / 1024),
+            (int) (r->level_upload.index_bytes / 1024));
+        igText("LEVEL UPLOAD THIS FRAME: %d B", (int) r->stats.upload_bytes);
+        igText(
+            "ATLAS LOOKUPS BY NAME/HANDLE: %d/%d",
+            state->atlas->stats.name_lookups,
+            state->atlas->stats.handle_hits);
+
+        bool sector_sort = !r->no_sector_sort;
+        if (igCheckbox("SECTOR SORT", &sector_sort)) {
+            r->no_sector_sort = !sector_sort;
+        }
+
+        igText(
+            "OVERDRAW (EST.): %.2f (%d/%d CELLS)",
+            r->stats.overdraw_covered ?
+                r->stats.overdraw_shaded / (f32) r->stats.overdraw_covered
+                : 0.0f,
+            r->stats.overdraw_shaded,
+            r->stats.overdraw_covered);
+
+        bool occlusion = !r->no_occlusion;
+        if (igCheckbox("OCCLUSION", &occlusion)) {
+            r->no_occlusion = !occlusion;
+        }
+
+        if (!r->no_occlusion) {
+            const occlusion_t *o = &r->occlusion;
+            igText(
+                "OCCLUDERS: %d (%d TRIS), RASTER/TEST (ms): %.3f/%.3f",
+                o->stats.occluders,
+                o->stats.tris,
+                o->stats.ns_raster / 1000000.0,
+                o->stats.ns_test / 1000000.0);
+            igText(
+                "OCCLUDED: %d/%d (%d SECTORS, %d PORTALS, %d SPRITES)",
+                o->stats.occluded,
+                o->stats.tests,
+                r->stats.occluded_sectors,
+                r->stats.occluded_portals,
+                r->stats.occluded_sprites);
+        }
+
+        if (r->soft) {
+            const softrast_t *s = r->soft;
+            igText(
+                "SOFTRAST: %d DRAWS, %d TRIS, %d/%d FRAGS (SHADED/PASSED)",
+                s->stats.draws,
+                s->stats.tris,
+                s->stats.shaded,
+                s->stats.fragments);
+            igText(
+                "SOFTRAST RASTER/SHADE (ms): %.3f/%.3f (%.1f NS/FRAG)",
+                s->stats.ns_raster / 1000000.0,
+                s->stats.ns_shade / 1000000.0,
+                s->stats.shaded ?
+                    s->stats.ns_shade / (f64) s->stats.shaded
+                    : 0.0);
+
+            igCheckbox("SOFTRAST PALETTE", &r->soft_palette);
+
+            if (igButton("DUMP SOFTRAST", (ImVec2) { 0, 0 })) {
+                if (!softrast_write_png(s, "softrast.png")) {
+                    WARN("could not write softrast.png");
+                }
+            }
+        }
+    }
+
     if (r->debug_ui) { 
         igEnd(); 
     }
 }
 
+bool renderer_render_soft(renderer_t *r, const char *path, bool update) {
+    if (!r->soft) {
+        r->soft = calloc(1, sizeof(*r->soft));
+    }
+
+    renderer_render(r);
+
+    if (update) {
+        if (!softrast_write_png(r->soft, path)) {
+            WARN("could not write %s", path);
+            return false;
+        }
+
+        LOG("wrote %s", path);
+        return true;
+    }
+
+    const f32 diff = softrast_diff(r->soft, path);
+    if (diff < 0.0f) {
+        WARN("could not read %s", path);
+        return false;
+    }
+
+    LOG(
+        "softrast: %d draws, %d tris, %.3f%% of pixels differ from %s",
+        r->soft->stats.draws,
+        r->soft->stats.tris,
+        diff * 100.0f,
+        path);
+
+    if (diff > RENDERER_SOFT_MAX_DIFF) {
+        WARN("softrast mismatch against %s", path);
+        return false;
+    }
+
+    return true;
+}
+
 vec4s renderer_info_at(renderer_t *r, ivec2s pos) {
     const ivec2s frame_size = IVEC2(TARGET_3D_WIDTH, TARGET_3D_HEIGHT);
 
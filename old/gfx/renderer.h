@@ -3,7 +3,10 @@
 #include "gfx/atlas.h"
 #include "gfx/sokol.h"
 #include "gfx/dynbuf.h"
+#include "gfx/occlusion.h"
+#include "gfx/softrast.h"
 #include "gfx/renderer_types.h"
+#include "util/map.h"
 #include "defs.h"
 
 #define RENDERER_PIXELFORMAT_COLOR SG_PIXELFORMAT_RGBA8
@@ -16,6 +19,9 @@
 
 #define LEVEL_WIREFRAME_IBUF_SIZE (LEVEL_IBUF_SIZE)
 
+// max portal recursion depth, portal depth is also the stencil ref of a pass
+#define RENDERER_MAX_PORTAL_DEPTH 8
+
 typedef struct sprite_instance {
     vec3s offset;
     vec2s size;
@@ -29,7 +35,6 @@ typedef struct sector_render_portal {
     sector_t *sector;
     side_t *side;
     void *indices;
-    aabb_t scissor;
 } sector_render_portal_t;
 
 typedef struct sector_render {
@@ -47,9 +52,50 @@ typedef struct sector_render {
     // counts
     usize n_vertices, n_indices;
 
+    // index of first index in renderer_t::batch_indices
+    usize batch_first;
+
     DYNLIST(sector_render_portal_t) portals;
 } sector_render_t;
 
+// portal visible from a render pass, see render_view_t
+typedef struct render_view_portal {
+    sector_render_portal_t *portal;
+    aabb_t scissor;
+
+    // view/proj through portal
+    mat4s view, proj;
+} render_view_portal_t;
+
+// render pass parameters, view/proj are quantized (RENDERER_VIEW_QUANTUM) so
+// that the same view reached through different portal paths has the same key
+typedef struct render_view_key {
+    side_t *exit_side;
+    int depth;
+    aabb_t scissor;
+    i32 view[16], proj[16];
+} render_view_key_t;
+
+// range of renderer_t::batch_indices drawn with one call, rank is the position
+// of its frontmost sector in render_view_t::sectors
+typedef struct render_view_run {
+    usize first, n;
+    int rank;
+} render_view_run_t;
+
+// culling results for a render pass, cached for a frame by key
+typedef struct render_view {
+    render_view_key_t key;
+    DYNLIST(sector_t*) sectors;
+
+    // distance-sorted
+    DYNLIST(render_view_portal_t) portals;
+
+    // level geometry draws, see build_view_runs
+    DYNLIST(render_view_run_t) runs;
+    int n_run_sectors;
+} render_view_t;
+
 typedef struct side_render {
     int index;
 
@@ -146,12 +192,25 @@ typedef struct renderer {
             renderer_data_array_t data_arrays[4];
         };
     };
-    
-    sg_pipeline pipeline_level, pipeline_portal, pipeline_sprite;
+
+    // no GPU resources, see renderer_init_headless
+    bool headless;
+
+    // per portal depth, see make_pipelines
+    sg_pipeline
+        pipeline_level[RENDERER_MAX_PORTAL_DEPTH],
+        pipeline_portal_mark[RENDERER_MAX_PORTAL_DEPTH],
+        pipeline_portal_unmark[RENDERER_MAX_PORTAL_DEPTH],
+        pipeline_sprite[RENDERER_MAX_PORTAL_DEPTH];
     sg_shader shader_level, shader_sprite;
 
     bool level_dirty;
-    sg_buffer level_vbuf, level_ibuf;
+    sg_buffer level_vbuf, level_ibuf, level_batch_ibuf;
+
+    // copy of db_indices with absolute u32 indices, sectors packed back to
+    // back so that runs of sectors can be drawn with one call, see
+    // build_view_runs
+    DYNLIST(u32) batch_indices;
 
     sg_buffer sprite_vbuf, sprite_ibuf, sprite_instbuf;
 
@@ -169,6 +228,71 @@ typedef struct renderer {
 
     int n_sprites;
 
+    // scratch for sort_sprites
+    struct {
+        DYNLIST(u32) keys, vals, tmp_keys, tmp_vals;
+        DYNLIST(sprite_instance_t) instances;
+    } sprite_sort;
+
+    // occlusion buffer for main view, see build_occlusion
+    occlusion_t occlusion;
+    bool no_occlusion;
+
+    // CPU mirror of level and sprite draws, allocated with DO_SOFTRAST or by
+    // renderer_render_soft
+    softrast_t *soft;
+    DYNLIST(softrast_vertex_t) soft_vertices;
+
+    // map softrast output to the palette, off like in common.glsl
+    bool soft_palette;
+
+    // scratch for sort_sectors, depths/dists indexed by sector index
+    struct {
+        DYNLIST(int) depths;
+        DYNLIST(f32) dists;
+        DYNLIST(sector_t*) queue;
+    } sector_order;
+    bool no_sector_sort;
+
+    // sizes of last level buffer upload, vertices/indices (incl. batch)
+    struct {
+        usize vertex_bytes, index_bytes;
+    } level_upload;
+
+    // per frame render_view_t cache, key hash -> index into views
+    struct {
+        map_t map;
+
+        // reused across frames, first n_views are valid
+        DYNLIST(render_view_t*) views;
+        int n_views;
+    } view_cache;
+
+    // per frame
+    struct {
+        // all draw calls, pipeline changes, portals drawn through
+        int draws, pipelines, portals;
+
+        // level geometry draw calls, sectors drawn (one call each unbatched)
+        int level_draws, level_sectors;
+
+        // render passes which could/could not reuse a cached view
+        int view_hits, view_misses;
+
+        // culled by occlusion buffer
+        int occluded_sectors, occluded_portals, occluded_sprites;
+
+        // main view grid cells shaded/covered, see estimate_overdraw
+        int overdraw_shaded, overdraw_covered;
+
+        // sprites drawn, culled by pass frustum/portal rect
+        int sprites, culled_sprites;
+        u64 ns_sprite_sort;
+
+        // level buffer bytes uploaded this frame (incl. view indices)
+        usize upload_bytes;
+    } stats;
+
     dynbuf_t db_vertices, db_indices;
 
     // arbitary, when bumped will invalidate all renderer data (force re-mesh)
@@ -178,6 +302,11 @@ typedef struct renderer {
 
 void renderer_init(renderer_t*);
 
+// init without GPU resources (no sokol context needed). meshing and data rows
+// work as usual, renderer_render only draws into the CPU mirror (if any), see
+// renderer_check_golden and renderer_render_soft
+void renderer_init_headless(renderer_t*);
+
 void renderer_set_level(renderer_t*, level_t*);
 
 void renderer_destroy_for_level(renderer_t*);
@@ -186,4 +315,16 @@ void renderer_destroy(renderer_t*);
 
 void renderer_render(renderer_t*);
 
+// remesh all sectors of the current level and compare hashes of their
+// vertices, indices and data rows to golden file at path, or (over)write the
+// golden file if update. returns false on mismatch or if the golden cannot be
+// read/written, which is logged with the first differing sector/side
+bool renderer_check_golden(renderer_t*, const char *path, bool update);
+
+// renderer_render into the CPU mirror (allocated if needed), then write its
+// color to png at path if update or compare against it otherwise. works
+// headless. returns false on failure or if the images differ, see
+// softrast_diff
+bool renderer_render_soft(renderer_t*, const char *path, bool update);
+
 vec4s renderer_info_at(renderer_t*, ivec2s pos);
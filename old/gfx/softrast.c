@@ -0,0 +1,651 @@
+#include "gfx/softrast.h"
+#include "gfx/atlas.h"
+#include "gfx/palette.h"
+#include "gfx/renderer.h"
+#include "util/assert.h"
+#include "util/image.h"
+#include "util/time.h"
+#include "ext/stb_image_write.h"
+
+// pos_w (3), pos_v (3), uv (2), color (4, sprites only)
+#define N_VARYINGS 12
+
+#define V_POS_W 0
+#define V_POS_V 3
+#define V_UV 6
+#define V_COLOR 8
+
+// clip space vertex with varyings
+typedef struct {
+    vec4s pos;
+    f32 v[N_VARYINGS];
+} clip_vertex_t;
+
+// flat (per triangle) attributes, see level.glsl/sprite.glsl
+typedef struct {
+    int id, index, flags;
+} flat_t;
+
+// fragment which passed depth/stencil with (unnormalized) barycentrics
+struct softrast_frag {
+    int x, y;
+    f32 b[3], z;
+};
+
+// screen space point, x/y in pixels and z in [0, 1]
+typedef struct {
+    f32 x, y, z, inv_w;
+} point_t;
+
+ALWAYS_INLINE f32 glsl_mod(f32 x, f32 y) {
+    return y == 0.0f ? 0.0f : x - y * floorf(x / y);
+}
+
+ALWAYS_INLINE f32 smoothstep(f32 e0, f32 e1, f32 x) {
+    const f32 t = clamp((x - e0) / (e1 - e0), 0.0f, 1.0f);
+    return t * t * (3.0f - 2.0f * t);
+}
+
+// see common.glsl
+static f32 satan2(vec2s p, f32 w) {
+    const f32 a = fabsf(p.x) < 1e-8f ? (PI / 2.0f) : atanf(fabsf(p.y / p.x));
+    const f32 sy = 2.0f * smoothstep(-w, w, p.y) - 1.0f;
+    return fabsf(a + PI * min(0.0f, sign(p.x))) * sy;
+}
+
+// row of data image, see lookup_data in common.glsl
+static const vec4s *lookup_data(
+    const softrast_t *s, int type_index, int index) {
+    type_index = clamp(type_index, 0, T_COUNT - 1);
+    index = clamp(index, 0, RENDERER_DATA_IMG_LENGTH - 1);
+    return
+        &s->data[
+            ((type_index * RENDERER_DATA_IMG_LENGTH) + index)
+                * RENDERER_DATA_IMG_WIDTH_VEC4S];
+}
+
+// type index of vertex id, find_lsb(id >> 16) in level.glsl
+ALWAYS_INLINE int id_type_index(int id) {
+    const int type = (id >> 16) & 0xFFFF;
+    return type ? __builtin_ctz(type) : 0;
+}
+
+// atlas_coords/atlas_layers lookup for texture_id
+static void atlas_rect(
+    const softrast_t *s,
+    int texture_id,
+    vec2s *pmin,
+    vec2s *psize,
+    int *player) {
+    texture_id = clamp(texture_id, 0, ATLAS_MAX_TEXTURES - 1);
+    const vec4s coord = s->atlas->coords_data[texture_id];
+    *pmin = VEC2(coord.x, coord.y);
+    *psize = VEC2(coord.z - coord.x, coord.w - coord.y);
+    *player = clamp((int) s->atlas->layer_data[texture_id], 0, ATLAS_DEPTH - 1);
+}
+
+// nearest, repeating sample of atlas layer at uv
+static vec4s sample_atlas(const softrast_t *s, int layer, vec2s uv) {
+    const u8 *data = s->atlas->data[layer];
+    if (!data) { return VEC4(0.0f); }
+
+    const int
+        x = ((int) floorf(uv.x * ATLAS_SIZE)) & (ATLAS_SIZE - 1),
+        y = ((int) floorf(uv.y * ATLAS_SIZE)) & (ATLAS_SIZE - 1);
+    const u8 *p = &data[(y * ATLAS_SIZE + x) * 4];
+    return glms_vec4_divs(VEC4(p[0], p[1], p[2], p[3]), 255.0f);
+}
+
+// see common.glsl
+static vec4s post_process(vec4s color, vec3s pos_v, f32 light) {
+    const f32 t = clamp(fabsf(-pos_v.z) / 32.0f, 0.0f, 1.0f);
+    for (int i = 0; i < 3; i++) {
+        color.raw[i] = lerp(color.raw[i] * light, 0.1f, t);
+    }
+    return color;
+}
+
+// level.glsl fragment shader, returns false on discard
+static bool shade_level(
+    const softrast_t *s,
+    const softrast_pass_t *pass,
+    const flat_t *f,
+    const f32 *v,
+    vec4s *out) {
+    if (!pass->is_portal_pass && (f->flags & RENDERER_VFLAG_PORTAL)) {
+        return false;
+    }
+
+    const int type = (f->id >> 16) & 0xFFFF;
+    const vec4s *data = lookup_data(s, id_type_index(f->id), f->index);
+    const vec3s pos_w = VEC3(v[V_POS_W], v[V_POS_W + 1], v[V_POS_W + 2]);
+    const vec3s pos_v = VEC3(v[V_POS_V], v[V_POS_V + 1], v[V_POS_V + 2]);
+    const vec2s uv = VEC2(v[V_UV], v[V_UV + 1]);
+
+    const side_render_data_t *rd_side = (const side_render_data_t*) data;
+    const sector_render_data_t *rd_sector = (const sector_render_data_t*) data;
+    const decal_render_data_t *rd_decal = (const decal_render_data_t*) data;
+
+    int texture_id = 0;
+    if (type & T_SIDE) {
+        rd_sector =
+            (const sector_render_data_t*)
+                lookup_data(s, T_SECTOR_INDEX, (int) rd_side->sector_index);
+
+        const int stflags = (int) rd_side->stflags;
+        texture_id = (int) rd_side->tex_mid;
+
+        if (stflags & STF_EZPORT) {
+            if (f->flags & RENDERER_VFLAG_SEG_BOTTOM) {
+                texture_id = (int) rd_side->tex_low;
+            } else if (f->flags & RENDERER_VFLAG_SEG_TOP) {
+                texture_id = (int) rd_side->tex_high;
+            }
+        } else {
+            const f32 z_base =
+                (f->flags & RENDERER_VFLAG_SEG_TOP) ?
+                    rd_side->nz_ceil
+                    : rd_side->z_floor;
+            const f32 split_z = pos_w.z - z_base;
+
+            f32
+                split_bottom = rd_side->split_bottom,
+                split_top = rd_side->split_top;
+
+            if (stflags & STF_BOT_ABS) { split_bottom -= z_base; }
+            if (stflags & STF_TOP_ABS) { split_top -= z_base; }
+
+            if (split_z < split_bottom) {
+                texture_id = (int) rd_side->tex_low;
+            } else if (split_z > split_top) {
+                texture_id = (int) rd_side->tex_high;
+            }
+        }
+    } else if (type & T_SECTOR) {
+        texture_id =
+            (int) ((f->flags & RENDERER_VFLAG_IS_CEIL) ?
+                rd_sector->tex_ceil
+                : rd_sector->tex_floor);
+    } else if (type & T_DECAL) {
+        texture_id = (int) rd_decal->tex;
+        rd_sector =
+            (const sector_render_data_t*)
+                lookup_data(s, T_SECTOR_INDEX, (int) rd_decal->sector_index);
+    }
+
+    vec2s atlas_min, atlas_size;
+    int atlas_layer;
+    atlas_rect(s, texture_id, &atlas_min, &atlas_size, &atlas_layer);
+
+    const f32 unit = 1.0f / ATLAS_SIZE;
+
+    f32 light = rd_sector->light;
+    vec2s uv1 = atlas_min;
+    if (type & T_SIDE) {
+        const vec2s offs =
+            glms_vec2_sub(
+                VEC2(uv.x * rd_side->len, pos_w.z),
+                glms_vec2_divs(rd_side->offsets, PX_PER_UNIT));
+
+        light +=
+            0.1f
+                * sinf(
+                    satan2(
+                        VEC2(rd_side->normal.y, rd_side->normal.x), 0.01f));
+
+        uv1.x += glsl_mod(offs.x * PX_PER_UNIT * unit, atlas_size.x);
+        uv1.y += glsl_mod(offs.y * PX_PER_UNIT * unit, atlas_size.y);
+    } else if (type & T_SECTOR) {
+        uv1.x += glsl_mod(pos_w.x * PX_PER_UNIT * unit, atlas_size.x);
+        uv1.y += glsl_mod(pos_w.y * PX_PER_UNIT * unit, atlas_size.y);
+    } else if (type & T_DECAL) {
+        uv1 = glms_vec2_add(atlas_min, glms_vec2_mul(uv, atlas_size));
+    }
+
+    *out = post_process(sample_atlas(s, atlas_layer, uv1), pos_v, light);
+    return true;
+}
+
+// sprite.glsl fragment shader, returns false on discard
+static bool shade_sprite(
+    const softrast_t *s,
+    const flat_t *f,
+    const f32 *v,
+    vec4s *out) {
+    const sprite_render_data_t *rd =
+        (const sprite_render_data_t*) lookup_data(s, T_OBJECT_INDEX, f->index);
+    const sector_render_data_t *rd_sector =
+        (const sector_render_data_t*)
+            lookup_data(s, T_SECTOR_INDEX, (int) rd->sector_index);
+
+    vec2s atlas_min, atlas_size;
+    int atlas_layer;
+    atlas_rect(s, (int) rd->tex, &atlas_min, &atlas_size, &atlas_layer);
+
+    const vec2s uv1 =
+        glms_vec2_add(
+            atlas_min,
+            glms_vec2_mul(VEC2(v[V_UV], v[V_UV + 1]), atlas_size));
+
+    const vec4s color =
+        glms_vec4_mul(
+            VEC4(v[V_COLOR], v[V_COLOR + 1], v[V_COLOR + 2], v[V_COLOR + 3]),
+            sample_atlas(s, atlas_layer, uv1));
+
+    *out =
+        post_process(
+            color,
+            VEC3(v[V_POS_V], v[V_POS_V + 1], v[V_POS_V + 2]),
+            rd_sector->light);
+    return out->a >= 0.0001f;
+}
+
+static clip_vertex_t transform(
+    const softrast_pass_t *pass, vec3s pos_w, vec2s uv, vec4s color) {
+    const vec4s pos_v = glms_mat4_mulv(pass->view, VEC4(pos_w, 1.0f));
+
+    clip_vertex_t cv = {
+        .pos = glms_mat4_mulv(pass->proj, VEC4(glms_vec3(pos_v), 1.0f)),
+    };
+
+    for (int i = 0; i < 3; i++) {
+        cv.v[V_POS_W + i] = pos_w.raw[i];
+        cv.v[V_POS_V + i] = pos_v.raw[i];
+    }
+
+    cv.v[V_UV] = uv.x;
+    cv.v[V_UV + 1] = uv.y;
+
+    for (int i = 0; i < 4; i++) {
+        cv.v[V_COLOR + i] = color.raw[i];
+    }
+
+    return cv;
+}
+
+// clip triangle against near plane (z >= -w), returns number of points out
+static int clip_near(const clip_vertex_t *ps, clip_vertex_t *out) {
+    int n_out = 0;
+
+    for (int i = 0; i < 3; i++) {
+        const clip_vertex_t *p = &ps[i], *q = &ps[(i + 1) % 3];
+        const f32 dp = p->pos.z + p->pos.w, dq = q->pos.z + q->pos.w;
+
+        if (dp >= 0.0f) {
+            out[n_out++] = *p;
+        }
+
+        if ((dp >= 0.0f) != (dq >= 0.0f)) {
+            const f32 t = dp / (dp - dq);
+            clip_vertex_t *c = &out[n_out++];
+            c->pos = glms_vec4_lerp(p->pos, q->pos, t);
+            for (int j = 0; j < N_VARYINGS; j++) {
+                c->v[j] = lerp(p->v[j], q->v[j], t);
+            }
+        }
+    }
+
+    return n_out;
+}
+
+static point_t clip_to_screen(vec4s p) {
+    const f32 inv_w = 1.0f / p.w;
+    return (point_t) {
+        .x = ((p.x * inv_w) * 0.5f + 0.5f) * SOFTRAST_WIDTH,
+        .y = ((p.y * inv_w) * 0.5f + 0.5f) * SOFTRAST_HEIGHT,
+        .z = (p.z * inv_w) * 0.5f + 0.5f,
+        .inv_w = inv_w,
+    };
+}
+
+ALWAYS_INLINE bool stencil_test(softrast_pipeline_t pipeline, u8 ref, u8 st) {
+    switch (pipeline) {
+    case SOFTRAST_PIPELINE_PORTAL_MARK:
+    case SOFTRAST_PIPELINE_PORTAL_UNMARK:
+        return st == ref;
+    default:
+        return ref <= st;
+    }
+}
+
+static void raster_tri(
+    softrast_t *s,
+    softrast_pipeline_t pipeline,
+    const softrast_pass_t *pass,
+    const clip_vertex_t *cvs[3],
+    const flat_t *flat) {
+    const u64 t_raster = time_ns();
+
+    point_t ps[3];
+    for (int i = 0; i < 3; i++) {
+        ps[i] = clip_to_screen(cvs[i]->pos);
+    }
+
+    // twice the signed area, CCW (front facing) is positive. back faces are
+    // culled by all pipelines
+    const f32 area =
+        (ps[1].x - ps[0].x) * (ps[2].y - ps[0].y)
+            - (ps[1].y - ps[0].y) * (ps[2].x - ps[0].x);
+    if (area <= 0.0f) { return; }
+
+    const f32
+        x_min = min(ps[0].x, min(ps[1].x, ps[2].x)),
+        x_max = max(ps[0].x, max(ps[1].x, ps[2].x)),
+        y_min = min(ps[0].y, min(ps[1].y, ps[2].y)),
+        y_max = max(ps[0].y, max(ps[1].y, ps[2].y));
+
+    const int
+        x0 = max(0, (int) floorf(x_min)),
+        x1 = min(SOFTRAST_WIDTH - 1, (int) ceilf(x_max)),
+        y0 = max(0, (int) floorf(y_min)),
+        y1 = min(SOFTRAST_HEIGHT - 1, (int) ceilf(y_max));
+    if (x0 > x1 || y0 > y1) { return; }
+
+    s->stats.tris++;
+
+    // edge functions e_i = a_i * x + b_i * y + c_i, positive inside, where
+    // e_i is the edge opposite of p_i
+    f32 a[3], b[3], c[3];
+    for (int i = 0; i < 3; i++) {
+        const point_t p = ps[(i + 1) % 3], q = ps[(i + 2) % 3];
+        a[i] = -(q.y - p.y);
+        b[i] = q.x - p.x;
+        c[i] = (q.y - p.y) * p.x - (q.x - p.x) * p.y;
+    }
+
+    const bool depth_always = pipeline == SOFTRAST_PIPELINE_PORTAL_UNMARK;
+
+    dynlist_resize(s->frags, 0);
+
+    for (int y = y0; y <= y1; y++) {
+        const f32 py = y + 0.5f;
+        for (int x = x0; x <= x1; x++) {
+            const f32 px = x + 0.5f;
+
+            f32 e[3];
+            for (int i = 0; i < 3; i++) {
+                e[i] = a[i] * px + b[i] * py + c[i];
+            }
+
+            if (e[0] < 0.0f || e[1] < 0.0f || e[2] < 0.0f) { continue; }
+
+            // depth clip
+            const f32 z =
+                (e[0] * ps[0].z + e[1] * ps[1].z + e[2] * ps[2].z) / area;
+            if (z < 0.0f || z > 1.0f) { continue; }
+
+            if (!stencil_test(pipeline, pass->stencil_ref, s->stencil[y][x])) {
+                continue;
+            }
+
+            if (!depth_always && z > s->depth[y][x]) { continue; }
+
+            *dynlist_push(s->frags) = (struct softrast_frag) {
+                .x = x, .y = y,
+                .b = {
+                    e[0] * ps[0].inv_w,
+                    e[1] * ps[1].inv_w,
+                    e[2] * ps[2].inv_w,
+                },
+                .z = z,
+            };
+        }
+    }
+
+    s->stats.fragments += dynlist_size(s->frags);
+
+    const u64 t_shade = time_ns();
+    s->stats.ns_raster += t_shade - t_raster;
+
+    dynlist_each(s->frags, it) {
+        const struct softrast_frag *fr = it.el;
+
+        vec4s color = VEC4(0.0f);
+        bool keep = true;
+
+        // portal pipelines do not write color, shader never discards since
+        // is_portal_pass is set
+        if (pipeline == SOFTRAST_PIPELINE_LEVEL
+            || pipeline == SOFTRAST_PIPELINE_SPRITE) {
+            // perspective correct varyings
+            const f32 inv = 1.0f / (fr->b[0] + fr->b[1] + fr->b[2]);
+            f32 v[N_VARYINGS];
+            for (int i = 0; i < N_VARYINGS; i++) {
+                v[i] =
+                    (fr->b[0] * cvs[0]->v[i]
+                        + fr->b[1] * cvs[1]->v[i]
+                        + fr->b[2] * cvs[2]->v[i]) * inv;
+            }
+
+            keep =
+                pipeline == SOFTRAST_PIPELINE_LEVEL ?
+                    shade_level(s, pass, flat, v, &color)
+                    : shade_sprite(s, flat, v, &color);
+            s->stats.shaded++;
+        }
+
+        if (!keep) { continue; }
+
+        u8 *st = &s->stencil[fr->y][fr->x];
+        switch (pipeline) {
+        case SOFTRAST_PIPELINE_PORTAL_MARK:
+            *st = min(*st + 1, 0xFF);
+            break;
+        case SOFTRAST_PIPELINE_PORTAL_UNMARK:
+            *st = max(*st - 1, 0);
+            s->depth[fr->y][fr->x] = fr->z;
+            break;
+        default:
+            s->depth[fr->y][fr->x] = fr->z;
+
+            // SRC_ALPHA, ONE_MINUS_SRC_ALPHA for color and alpha
+            u8 *dst = s->color[fr->y][fr->x];
+            const f32 alpha = clamp(color.a, 0.0f, 1.0f);
+            for (int i = 0; i < 4; i++) {
+                const f32 src = clamp(color.raw[i], 0.0f, 1.0f);
+                dst[i] =
+                    (u8) roundf(
+                        (src * alpha + (dst[i] / 255.0f) * (1.0f - alpha))
+                            * 255.0f);
+            }
+        }
+    }
+
+    s->stats.ns_shade += time_ns() - t_shade;
+}
+
+static void draw_tri(
+    softrast_t *s,
+    softrast_pipeline_t pipeline,
+    const softrast_pass_t *pass,
+    const clip_vertex_t tri[3],
+    const flat_t *flat) {
+    clip_vertex_t clipped[4];
+    const int n = clip_near(tri, clipped);
+
+    for (int i = 1; i < n - 1; i++) {
+        raster_tri(
+            s,
+            pipeline,
+            pass,
+            (const clip_vertex_t*[3]) {
+                &clipped[0], &clipped[i], &clipped[i + 1]
+            },
+            flat);
+    }
+}
+
+void softrast_destroy(softrast_t *s) {
+    dynlist_free(s->frags);
+}
+
+void softrast_begin(
+    softrast_t *s,
+    const vec4s *data,
+    const atlas_t *atlas,
+    const palette_t *palette) {
+    s->data = data;
+    s->atlas = atlas;
+    s->palette = palette;
+    memset(&s->stats, 0, sizeof(s->stats));
+
+    // see primary pass action in main.c, depth is clamped to 1
+    const u8 clear[4] = { 51, 77, 77, 255 };
+    for (int y = 0; y < SOFTRAST_HEIGHT; y++) {
+        for (int x = 0; x < SOFTRAST_WIDTH; x++) {
+            memcpy(s->color[y][x], clear, 4);
+            s->depth[y][x] = 1.0f;
+        }
+    }
+
+    memset(s->stencil, 0, sizeof(s->stencil));
+}
+
+void softrast_end(softrast_t *s) {
+    if (!s->palette) { return; }
+
+    for (int y = 0; y < SOFTRAST_HEIGHT; y++) {
+        for (int x = 0; x < SOFTRAST_WIDTH; x++) {
+            u8 *p = s->color[y][x];
+            const u32 abgr =
+                p[0] | (p[1] << 8) | (p[2] << 16) | ((u32) p[3] << 24);
+            const u32 c = s->palette->colors[palette_nearest(s->palette, abgr)];
+            p[0] = (c >> 0) & 0xFF;
+            p[1] = (c >> 8) & 0xFF;
+            p[2] = (c >> 16) & 0xFF;
+        }
+    }
+}
+
+void softrast_draw_level(
+    softrast_t *s,
+    softrast_pipeline_t pipeline,
+    const softrast_pass_t *pass,
+    const softrast_vertex_t *vertices,
+    int n) {
+    ASSERT(n % 3 == 0);
+    s->stats.draws++;
+
+    for (int i = 0; i < n; i += 3) {
+        clip_vertex_t tri[3];
+        for (int j = 0; j < 3; j++) {
+            tri[j] =
+                transform(
+                    pass, vertices[i + j].pos, vertices[i + j].uv, VEC4(0.0f));
+        }
+
+        // flat attributes come from the last (provoking) vertex
+        const softrast_vertex_t *pv = &vertices[i + 2];
+        draw_tri(
+            s,
+            pipeline,
+            pass,
+            tri,
+            &(flat_t) { .id = pv->id, .index = pv->index, .flags = pv->flags });
+    }
+}
+
+void softrast_draw_sprites(
+    softrast_t *s,
+    const softrast_pass_t *pass,
+    const sprite_instance_t *instances,
+    int n) {
+    // sprite_ibuf/sprite_vbuf, see renderer_init
+    static const u16 indices[6] = { 0, 1, 2, 2, 3, 0 };
+    static const vec2s corners[4] = {
+        { { 0, 0 } }, { { 1, 0 } }, { { 1, 1 } }, { { 0, 1 } },
+    };
+
+    s->stats.draws++;
+
+    const f32 a = -pass->yaw - (PI / 2.0f);
+
+    for (int i = 0; i < n; i++) {
+        const sprite_instance_t *inst = &instances[i];
+
+        // see sprite.glsl
+        clip_vertex_t vs[4];
+        for (int j = 0; j < 4; j++) {
+            const vec2s p = corners[j];
+            vs[j] =
+                transform(
+                    pass,
+                    VEC3(
+                        inst->offset.x
+                            + inst->size.x * ((p.x - 0.5f) * cosf(a)),
+                        inst->offset.y
+                            + inst->size.x * ((p.x - 0.5f) * sinf(a)),
+                        inst->offset.z + inst->size.y * p.y),
+                    p,
+                    glms_vec4_adds(inst->color, inst->flags));
+        }
+
+        const flat_t flat = {
+            .id = (int) inst->id,
+            .index = (int) inst->index,
+        };
+        for (int j = 0; j < 6; j += 3) {
+            draw_tri(
+                s,
+                SOFTRAST_PIPELINE_SPRITE,
+                pass,
+                (clip_vertex_t[3]) {
+                    vs[indices[j]], vs[indices[j + 1]], vs[indices[j + 2]]
+                },
+                &flat);
+        }
+    }
+}
+
+bool softrast_write_png(const softrast_t *s, const char *path) {
+    // flip so that row 0 is the top of the image
+    stbi_flip_vertically_on_write(true);
+    const int res =
+        stbi_write_png(
+            path,
+            SOFTRAST_WIDTH,
+            SOFTRAST_HEIGHT,
+            4,
+            s->color,
+            SOFTRAST_WIDTH * 4);
+    stbi_flip_vertically_on_write(false);
+    return res != 0;
+}
+
+f32 softrast_diff(const softrast_t *s, const char *path) {
+    u8 *ref;
+    ivec2s size;
+    if (load_image_rgba(path, &ref, &size)) { return -1.0f; }
+
+    if (size.x != SOFTRAST_WIDTH || size.y != SOFTRAST_HEIGHT) {
+        WARN("%s is %" PRIv2i ", expected %dx%d",
+            path, FMTv2i(size), SOFTRAST_WIDTH, SOFTRAST_HEIGHT);
+        stbi_image_free(ref);
+        return -1.0f;
+    }
+
+    // YCoCg distance with luma weighted over chroma, load_image_rgba flips so
+    // rows line up with color
+    int n_diff = 0;
+    for (int y = 0; y < SOFTRAST_HEIGHT; y++) {
+        for (int x = 0; x < SOFTRAST_WIDTH; x++) {
+            const u8
+                *p = s->color[y][x],
+                *q = &ref[(y * SOFTRAST_WIDTH + x) * 4];
+            const f32
+                dr = (p[0] - q[0]) / 255.0f,
+                dg = (p[1] - q[1]) / 255.0f,
+                db = (p[2] - q[2]) / 255.0f,
+                dy = 0.25f * dr + 0.5f * dg + 0.25f * db,
+                dco = 0.5f * dr - 0.5f * db,
+                dcg = -0.25f * dr + 0.5f * dg - 0.25f * db;
+
+            if (4.0f * dy * dy + dco * dco + dcg * dcg > 0.002f) {
+                n_diff++;
+            }
+        }
+    }
+
+    stbi_image_free(ref);
+    return n_diff / (f32) (SOFTRAST_WIDTH * SOFTRAST_HEIGHT);
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "gfx/renderer_types.h"
+#include "util/dynlist.h"
+#include "util/math.h"
+#include "util/types.h"
+#include "defs.h"
+#include "config.h"
+
+// CPU implementation of the level and sprite pipelines (level.glsl,
+// sprite.glsl) at the size of TARGET_3D, consuming the same vertex, data image
+// and atlas inputs as the GPU. used to produce reference images headlessly
+// and to measure the cost of the shading math, see DO_SOFTRAST in renderer.c
+#define SOFTRAST_WIDTH TARGET_3D_WIDTH
+#define SOFTRAST_HEIGHT TARGET_3D_HEIGHT
+
+typedef struct sprite_instance sprite_instance_t;
+
+// same as the renderer pipelines of the same name, see make_pipelines
+typedef enum {
+    // stencil >= ref, depth <=, writes color and depth
+    SOFTRAST_PIPELINE_LEVEL,
+
+    // stencil == ref, depth <=, increments stencil
+    SOFTRAST_PIPELINE_PORTAL_MARK,
+
+    // stencil == ref, writes depth always, decrements stencil
+    SOFTRAST_PIPELINE_PORTAL_UNMARK,
+
+    // same as SOFTRAST_PIPELINE_LEVEL with sprite shading
+    SOFTRAST_PIPELINE_SPRITE,
+} softrast_pipeline_t;
+
+// level vertex shader inputs
+typedef struct softrast_vertex {
+    vec3s pos;
+    vec2s uv;
+    int id, index, flags;
+} softrast_vertex_t;
+
+// uniforms of a draw
+typedef struct softrast_pass {
+    mat4s view, proj;
+    vec3s cam_pos;
+    f32 yaw;
+    u8 stencil_ref;
+    bool is_portal_pass;
+} softrast_pass_t;
+
+typedef struct softrast {
+    // rgba, row 0 is the bottom of the image (same as the GPU target)
+    u8 color[SOFTRAST_HEIGHT][SOFTRAST_WIDTH][4];
+    f32 depth[SOFTRAST_HEIGHT][SOFTRAST_WIDTH];
+    u8 stencil[SOFTRAST_HEIGHT][SOFTRAST_WIDTH];
+
+    // inputs, see softrast_begin
+    const vec4s *data;
+    const atlas_t *atlas;
+    const palette_t *palette;
+
+    // fragments of the current triangle which passed depth/stencil
+    DYNLIST(struct softrast_frag) frags;
+
+    // since softrast_begin
+    struct {
+        int draws, tris, fragments, shaded;
+        u64 ns_raster, ns_shade;
+    } stats;
+} softrast_t;
+
+void softrast_destroy(softrast_t *s);
+
+// clear buffers (same values as the primary pass action) and set inputs for
+// the frame. data is renderer_t::data.buf. if palette is not NULL, colors are
+// mapped to the nearest palette color in softrast_end
+void softrast_begin(
+    softrast_t *s,
+    const vec4s *data,
+    const atlas_t *atlas,
+    const palette_t *palette);
+
+// finish frame, applies palette
+void softrast_end(softrast_t *s);
+
+// draw triangle list of n vertices with pipeline
+void softrast_draw_level(
+    softrast_t *s,
+    softrast_pipeline_t pipeline,
+    const softrast_pass_t *pass,
+    const softrast_vertex_t *vertices,
+    int n);
+
+// draw n sprite instances (SOFTRAST_PIPELINE_SPRITE)
+void softrast_draw_sprites(
+    softrast_t *s,
+    const softrast_pass_t *pass,
+    const sprite_instance_t *instances,
+    int n);
+
+// write color to png at path, returns false on failure
+bool softrast_write_png(const softrast_t *s, const char *path);
+
+// compare color to reference png at path, returns fraction of pixels which
+// differ perceptibly (weighted luma/chroma distance) or -1 on failure
+f32 softrast_diff(const softrast_t *s, const char *path);
@@ -3,7 +3,16 @@
 #include "level/level.h"
 #include "level/lptr.h"
 #include "reload.h"
-#include "state.h"
+#include "util/sort.h"
+
+// #define DO_VERIFY_ACTORS
+
+#ifdef DO_VERIFY_ACTORS
+#include "util/time.h"
+#endif // ifdef DO_VERIFY_ACTORS
+
+#define WHEEL_MASK (ACTOR_WHEEL_SLOTS - 1)
+#define WHEEL_SPAN(_l) (1ull << (ACTOR_WHEEL_BITS * (_l)))
 
 static actor_t **lptr_pactor(level_t *level, lptr_t ptr) {
     switch (LPTR_TYPE(ptr)) {
@@ -14,12 +23,133 @@ static actor_t **lptr_pactor(level_t *level, lptr_t ptr) {
     }
 }
 
+static int cmp_actor_seq(actor_t **a, actor_t **b, void*) {
+    return (*a)->seq < (*b)->seq ? -1 : ((*a)->seq > (*b)->seq ? 1 : 0);
+}
+
+static void link_actor(actor_list_t *list, actor_t *actor) {
+    dlist_append(listnode, list, actor);
+    actor->list = list;
+}
+
+static void unlink_actor(actor_t *actor) {
+    if (actor->list) {
+        dlist_remove(listnode, actor->list, actor);
+        actor->list = NULL;
+    }
+}
+
+// put actor in the wheel slot for actor->wake_tick
+static void wheel_insert(level_t *level, actor_t *actor) {
+    const u64 delta = actor->wake_tick - level->sched.tick;
+
+    int l = 0;
+    while (l < ACTOR_WHEEL_LEVELS - 1 && delta >= WHEEL_SPAN(l + 1)) {
+        l++;
+    }
+
+    link_actor(
+        &level->sched.wheel[l][
+            (actor->wake_tick >> (ACTOR_WHEEL_BITS * l)) & WHEEL_MASK],
+        actor);
+}
+
+// move actor from its schedule list to the woken list, or straight into
+// level->actors if it comes after the currently acting actor so that it acts
+// in this tick, just as if it had been awake and polling
+static void wake(level_t *level, actor_t *actor) {
+    unlink_actor(actor);
+    level->sched.n_sleeping--;
+    level->sched.wakes++;
+
+    const actor_t *current = level->sched.current;
+    if (current && actor->seq > current->seq) {
+        actor_t *at = current->listnode.next;
+        while (at && at->seq < actor->seq) {
+            at = at->listnode.next;
+        }
+
+        if (at) {
+            dlist_insert_before(listnode, &level->actors, at, actor);
+            actor->list = &level->actors;
+        } else {
+            link_actor(&level->actors, actor);
+        }
+
+        actor->state = ACTOR_STATE_AWAKE;
+        return;
+    }
+
+    actor->state = ACTOR_STATE_WOKEN;
+    *dynlist_push(level->sched.woken) = actor;
+}
+
+// move awake actor out of level->actors into the list for "state"
+static void enter_state(level_t *level, actor_t *actor, int state) {
+    if (state == ACTOR_STATE_TIMER
+        && actor->wake_tick <= level->sched.tick) {
+        // already due, keep acting
+        return;
+    }
+
+    unlink_actor(actor);
+    actor->state = state;
+    level->sched.n_sleeping++;
+
+    switch (state) {
+    case ACTOR_STATE_TIMER:
+        wheel_insert(level, actor);
+        break;
+    case ACTOR_STATE_TAG:
+        link_actor(&level->sched.tag_waits[actor->wait_tag], actor);
+        break;
+    case ACTOR_STATE_ASLEEP:
+        link_actor(&level->sched.asleep, actor);
+        break;
+    default: ASSERT(false);
+    }
+}
+
+// request sleep in "state", entered once the actor is done acting
+static void request_state(level_t *level, actor_t *actor, int state) {
+    if (actor->state != ACTOR_STATE_AWAKE
+        && actor->state != ACTOR_STATE_WOKEN) {
+        // already sleeping, goes back to sleep without acting once its turn
+        // comes
+        wake(level, actor);
+    }
+
+    actor->request = state;
+}
+
+static void free_actor(actor_t *actor) {
+    if (actor->storage) {
+        *actor->storage = NULL;
+    }
+
+    unlink_actor(actor);
+
+    if (actor->flags & AF_PARAM_OWNED) {
+        free(actor->param);
+    }
+
+#ifdef RELOADABLE
+    if (g_reload_host) {
+        g_reload_host->del_fn((void**) &actor->act);
+    }
+#endif //ifdef RELOADABLE
+    free(actor);
+}
+
 void actor_add(level_t *level, actor_t actor, lptr_t ptr) {
     // TODO: allow camera actors to bypass, or something?
     /* ASSERT(state->mode == GAMEMODE_GAME, "cannot add actors in edit mode"); */
 
     actor_t *p = calloc(1, sizeof(actor_t));
     *p = actor;
+    p->state = ACTOR_STATE_AWAKE;
+    p->request = ACTOR_STATE_AWAKE;
+    p->seq = level->sched.next_seq++;
 
     if (!LPTR_IS_NULL(ptr)) {
         if (LPTR_TYPE(ptr) & T_HAS_ACTOR) {
@@ -34,7 +164,7 @@ void actor_add(level_t *level, actor_t actor, lptr_t ptr) {
 
     // APPEND (not prepend!) to list so that if this actor was added by another,
     // it will run after and not before
-    dlist_append(listnode, &level->actors, p);
+    link_actor(&level->actors, p);
 
 #ifdef RELOADABLE
     if (g_reload_host) {
@@ -42,3 +172,260 @@ void actor_add(level_t *level, actor_t actor, lptr_t ptr) {
     }
 #endif // ifdef RELOADABLE
 }
+
+void actor_done(level_t *level, actor_t *actor) {
+    actor->flags |= AF_DONE;
+    actor_wake(level, actor);
+}
+
+void actor_sleep(level_t *level, actor_t *actor, int ticks) {
+    if (ticks < 0) {
+        request_state(level, actor, ACTOR_STATE_ASLEEP);
+        return;
+    }
+
+    if ((u64) ticks >= WHEEL_SPAN(ACTOR_WHEEL_LEVELS)) {
+        WARN("actor sleeping for too long (%d ticks), clamping", ticks);
+        ticks = WHEEL_SPAN(ACTOR_WHEEL_LEVELS) - 1;
+    }
+
+    actor->wake_tick = level->sched.tick + ticks;
+    request_state(level, actor, ACTOR_STATE_TIMER);
+}
+
+void actor_wait_tag(level_t *level, actor_t *actor, int tag) {
+    ASSERT(tag > TAG_NONE && tag < TAG_MAX, "invalid tag %d", tag);
+    actor->wait_tag = tag;
+    request_state(level, actor, ACTOR_STATE_TAG);
+}
+
+void actor_wake(level_t *level, actor_t *actor) {
+    switch (actor->state) {
+    case ACTOR_STATE_AWAKE:
+    case ACTOR_STATE_WOKEN:
+        actor->request = ACTOR_STATE_AWAKE;
+        break;
+    default:
+        wake(level, actor);
+    }
+}
+
+void actor_wake_tag(level_t *level, int tag) {
+    actor_list_t *list = &level->sched.tag_waits[tag];
+    while (list->head) {
+        wake(level, list->head);
+    }
+}
+
+// advance timer wheel to the next tick, waking actors whose timers expire
+static void advance_wheel(level_t *level) {
+    const u64 now = ++level->sched.tick;
+
+    // redistribute the current slot of each level which has come around
+    // into lower levels, highest first
+    for (int l = ACTOR_WHEEL_LEVELS - 1; l > 0; l--) {
+        if (now & (WHEEL_SPAN(l) - 1)) {
+            continue;
+        }
+
+        actor_list_t *slot =
+            &level->sched.wheel[l][(now >> (ACTOR_WHEEL_BITS * l)) & WHEEL_MASK];
+
+        while (slot->head) {
+            actor_t *actor = slot->head;
+            unlink_actor(actor);
+            wheel_insert(level, actor);
+        }
+    }
+
+    actor_list_t *slot = &level->sched.wheel[0][now & WHEEL_MASK];
+    while (slot->head) {
+        ASSERT(slot->head->wake_tick == now);
+        wake(level, slot->head);
+    }
+}
+
+// merge woken actors back into level->actors, keeping it in order of addition
+// so that actors act in the same order as if they had never slept
+static void merge_woken(level_t *level) {
+    const int n = dynlist_size(level->sched.woken);
+    if (n == 0) {
+        return;
+    }
+
+    if (n > 1) {
+        sort(
+            level->sched.woken,
+            n,
+            sizeof(level->sched.woken[0]),
+            (f_sort_cmp) cmp_actor_seq,
+            NULL);
+    }
+
+    actor_t *at = level->actors.head;
+    dynlist_each(level->sched.woken, it) {
+        actor_t *actor = *it.el;
+
+        while (at && at->seq < actor->seq) {
+            at = at->listnode.next;
+        }
+
+        if (at) {
+            dlist_insert_before(listnode, &level->actors, at, actor);
+            actor->list = &level->actors;
+        } else {
+            link_actor(&level->actors, actor);
+        }
+
+        actor->state = ACTOR_STATE_AWAKE;
+    }
+
+    dynlist_resize(level->sched.woken, 0);
+}
+
+#ifdef DO_VERIFY_ACTORS
+// checks that schedule lists are consistent and periodically logs how long
+// ticks took
+static void verify_actors(level_t *level, u64 ns_tick) {
+    static u64 n_ticks, ns_total;
+
+    int n_sleeping = 0;
+    u32 last_seq = 0;
+    dlist_each(listnode, &level->actors, it) {
+        if (it.el->state != ACTOR_STATE_AWAKE
+            || it.el->list != &level->actors) {
+            WARN("awake actor %u in bad state %d", it.el->seq, it.el->state);
+        }
+
+        if (it.i != 0 && it.el->seq <= last_seq) {
+            WARN("awake actors out of order (%u after %u)", it.el->seq, last_seq);
+        }
+
+        last_seq = it.el->seq;
+    }
+
+    for (int l = 0; l < ACTOR_WHEEL_LEVELS; l++) {
+        for (int i = 0; i < ACTOR_WHEEL_SLOTS; i++) {
+            dlist_each(listnode, &level->sched.wheel[l][i], it) {
+                if (it.el->state != ACTOR_STATE_TIMER
+                    || it.el->wake_tick <= level->sched.tick) {
+                    WARN("bad timer for actor %u", it.el->seq);
+                }
+
+                n_sleeping++;
+            }
+        }
+    }
+
+    for (int i = 0; i < TAG_MAX; i++) {
+        dlist_each(listnode, &level->sched.tag_waits[i], it) {
+            if (it.el->state != ACTOR_STATE_TAG || it.el->wait_tag != i) {
+                WARN("bad tag wait for actor %u", it.el->seq);
+            }
+
+            n_sleeping++;
+        }
+    }
+
+    dlist_each(listnode, &level->sched.asleep, it) {
+        n_sleeping++;
+    }
+
+    if (n_sleeping != level->sched.n_sleeping) {
+        WARN(
+            "%d actors sleeping, expected %d",
+            n_sleeping, level->sched.n_sleeping);
+    }
+
+    ns_total += ns_tick;
+
+    if (++n_ticks % 600 == 0) {
+        LOG(
+            "actors: %d awake, %d sleeping, %.1f us/tick",
+            level->sched.n_awake,
+            level->sched.n_sleeping,
+            ns_total / (f64) (n_ticks * 1000));
+    }
+}
+#endif // ifdef DO_VERIFY_ACTORS
+
+void actor_tick(level_t *level) {
+#ifdef DO_VERIFY_ACTORS
+    const u64 t_tick = time_ns();
+#endif // ifdef DO_VERIFY_ACTORS
+
+    advance_wheel(level);
+    merge_woken(level);
+
+    int n_awake = 0;
+
+    actor_t *actor = level->actors.head;
+    while (actor) {
+        if (actor->flags & AF_DONE) {
+            actor_t *next = actor->listnode.next;
+            free_actor(actor);
+            actor = next;
+            continue;
+        }
+
+        // requests from outside of act take effect before acting
+        if (actor->request == ACTOR_STATE_AWAKE) {
+            level->sched.current = actor;
+            actor->act(level, actor, actor->param);
+            level->sched.current = NULL;
+            n_awake++;
+        }
+
+        // next is only read after acting so that actors added by this one run
+        // in this tick
+        actor_t *next = actor->listnode.next;
+
+        if (actor->request != ACTOR_STATE_AWAKE
+            && !(actor->flags & AF_DONE)) {
+            const int request = actor->request;
+            actor->request = ACTOR_STATE_AWAKE;
+            enter_state(level, actor, request);
+        }
+
+        actor = next;
+    }
+
+    level->sched.n_awake = n_awake;
+
+#ifdef DO_VERIFY_ACTORS
+    verify_actors(level, time_ns() - t_tick);
+#endif // ifdef DO_VERIFY_ACTORS
+}
+
+// free all actors in list, without touching their (possibly already freed)
+// owners
+static void destroy_list(actor_list_t *list) {
+    while (list->head) {
+        list->head->storage = NULL;
+        free_actor(list->head);
+    }
+}
+
+void actor_destroy_all(level_t *level) {
+    destroy_list(&level->actors);
+
+    for (int l = 0; l < ACTOR_WHEEL_LEVELS; l++) {
+        for (int i = 0; i < ACTOR_WHEEL_SLOTS; i++) {
+            destroy_list(&level->sched.wheel[l][i]);
+        }
+    }
+
+    for (int i = 0; i < TAG_MAX; i++) {
+        destroy_list(&level->sched.tag_waits[i]);
+    }
+
+    destroy_list(&level->sched.asleep);
+
+    dynlist_each(level->sched.woken, it) {
+        (*it.el)->storage = NULL;
+        free_actor(*it.el);
+    }
+
+    dynlist_free(level->sched.woken);
+    level->sched.n_sleeping = 0;
+}
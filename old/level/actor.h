@@ -7,3 +7,27 @@
 // add actor to level (can optionally be associated with some thing "owner")
 void actor_add(level_t *level, actor_t actor, lptr_t owner);
 
+// mark actor as done, it is removed on the next tick even if sleeping
+void actor_done(level_t *level, actor_t *actor);
+
+// put actor to sleep for "ticks" ticks, or until actor_wake if ticks < 0.
+// if the actor is awake this takes effect once it is done acting, so an actor
+// may put itself to sleep from its act function.
+void actor_sleep(level_t *level, actor_t *actor, int ticks);
+
+// put actor to sleep until the value of "tag" is set, see actor_sleep
+void actor_wait_tag(level_t *level, actor_t *actor, int tag);
+
+// wake actor if it is sleeping or cancel its pending sleep if it is awake.
+// actors are always acted in order of addition: if woken by an actor added
+// before it, the woken actor acts in this tick, otherwise from the next tick on
+void actor_wake(level_t *level, actor_t *actor);
+
+// wake all actors waiting on tag, see tag_set_value
+void actor_wake_tag(level_t *level, int tag);
+
+// tick timers and act all awake actors, see level_tick
+void actor_tick(level_t *level);
+
+// free all actors, see level_destroy
+void actor_destroy_all(level_t *level);
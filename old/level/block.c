@@ -1,79 +1,208 @@
 #include "level/block.h"
 #include "level/level_defs.h"
 #include "level/level.h"
+#include "util/map.h"
 
-ivec2s level_block_to_blockpos(level_t *level, block_t *block) {
-    const int i = (int) (block - level->blocks.arr);
-    return IVEC2(i % level->blocks.size.x, i / level->blocks.size.x);
+static const block_range_t NO_BLOCKS = { .valid = false };
+
+// floor(a / b) for b > 0
+ALWAYS_INLINE int div_floor(int a, int b) {
+    return (a / b) - ((a % b) < 0);
 }
 
-block_t *level_get_block(level_t *level, ivec2s block_pos) {
-    if (!level->blocks.arr) {
-        return NULL;
+// page position of block at blockpos
+ALWAYS_INLINE ivec2s blockpos_to_pagepos(ivec2s bpos) {
+    return IVEC2(
+        div_floor(bpos.x, BLOCK_PAGE_SIZE),
+        div_floor(bpos.y, BLOCK_PAGE_SIZE));
+}
+
+static block_page_t *get_page(level_t *level, ivec2s ppos, bool create) {
+    block_page_t *last = level->blocks.last;
+    if (last && last->pos.x == ppos.x && last->pos.y == ppos.y) {
+        return last;
     }
 
-    if (block_pos.x < level->blocks.offset.x
-        || block_pos.y < level->blocks.offset.y
-        || block_pos.x >= (level->blocks.offset.x + level->blocks.size.x)
-        || block_pos.y >= (level->blocks.offset.y + level->blocks.size.y)) {
-        return NULL;
+    const u64 key = map_ivec2_to_u64(ppos);
+    block_page_t **ppage =
+        map_find(block_page_t*, &level->blocks.pages, &key);
+
+    block_page_t *page = ppage ? *ppage : NULL;
+
+    if (!page && create) {
+        page = calloc(1, sizeof(*page));
+        page->pos = ppos;
+
+        for (int i = 0; i < BLOCK_PAGE_SIZE * BLOCK_PAGE_SIZE; i++) {
+            dlist_init(&page->blocks[i].objects);
+            page->blocks[i].pos =
+                IVEC2(
+                    ppos.x * BLOCK_PAGE_SIZE + (i % BLOCK_PAGE_SIZE),
+                    ppos.y * BLOCK_PAGE_SIZE + (i / BLOCK_PAGE_SIZE));
+        }
+
+        map_insert(&level->blocks.pages, &key, page);
     }
 
-    return &level->blocks.arr[
-        (block_pos.y - level->blocks.offset.y) * level->blocks.size.x
-            + (block_pos.x - level->blocks.offset.x)];
+    if (page) {
+        level->blocks.last = page;
+    }
+
+    return page;
 }
 
-void level_blocks_remove_sector(level_t *level, sector_t *sect) {
-    if (!level->blocks.arr) { return; }
+static block_t *get_block(level_t *level, ivec2s bpos, bool create) {
+    const ivec2s ppos = blockpos_to_pagepos(bpos);
+    block_page_t *page = get_page(level, ppos, create);
 
-    const ivec2s
-        bmin = level_pos_to_block(sect->min),
-        bmax = level_pos_to_block(sect->max);
+    if (!page) { return NULL; }
 
-    for (int by = bmin.y; by <= bmax.y; by++) {
-        for (int bx = bmin.x; bx <= bmax.x; bx++) {
-            block_t *block = level_get_block(level, IVEC2(bx, by));
+    return &page->blocks[
+        (bpos.y - ppos.y * BLOCK_PAGE_SIZE) * BLOCK_PAGE_SIZE
+            + (bpos.x - ppos.x * BLOCK_PAGE_SIZE)];
+}
 
-            if (!block) {
-                WARN("removing from bad block %d, %d", bx, by);
-                continue;
-            }
+static void free_page(block_page_t *page) {
+    for (int i = 0; i < BLOCK_PAGE_SIZE * BLOCK_PAGE_SIZE; i++) {
+        block_t *block = &page->blocks[i];
+        dynlist_free(block->sectors);
+        dynlist_free(block->walls);
+        dynlist_free(block->subsectors);
 
-            dynlist_each(block->sectors, it) {
-                if (*it.el == sect) {
-                    dynlist_remove_it(block->sectors, it);
-                    break;
-                }
-            }
+        dlist_each(block_list, &block->objects, it) {
+            dlist_init_node(&it.el->block_list);
+            it.el->block = NULL;
         }
     }
-}
 
-void level_blocks_remove_wall(level_t *level, wall_t *wall) {
-    if (!level->blocks.arr) { return; }
+    free(page);
+}
 
+// true if block position is within level bounds
+static bool blockpos_in_bounds(level_t *level, ivec2s bpos) {
     const ivec2s
-        bmin = level_pos_to_block(wall->v0->pos),
-        bmax = level_pos_to_block(wall->v1->pos);
+        bmin = level_pos_to_block(IVEC_TO_V(level->bounds.min)),
+        bmax = level_pos_to_block(IVEC_TO_V(level->bounds.max));
 
-    for (int by = bmin.y; by <= bmax.y; by++) {
-        for (int bx = bmin.x; bx <= bmax.x; bx++) {
-            block_t *block = level_get_block(level, IVEC2(bx, by));
-            ASSERT(block);
+    return bpos.x >= bmin.x
+        && bpos.y >= bmin.y
+        && bpos.x <= bmax.x
+        && bpos.y <= bmax.y;
+}
 
-            dynlist_each(block->walls, it) {
-                if (*it.el == wall) {
-                    dynlist_remove_it(block->walls, it);
-                    break;
-                }
-            }
-        }
+void level_init_blocks(level_t *level) {
+    map_init(
+        &level->blocks.pages,
+        map_hash_u64,
+        NULL,
+        NULL,
+        map_dup_u64,
+        map_cmp_u64,
+        map_default_free,
+        NULL,
+        NULL);
+}
+
+void level_destroy_blocks(level_t *level) {
+    map_each(u64*, block_page_t*, &level->blocks.pages, it) {
+        free_page(it.value);
+    }
+
+    map_destroy(&level->blocks.pages);
+    level->blocks.last = NULL;
+    level->blocks.ready = false;
+}
+
+usize level_blocks_memory(const level_t *level) {
+    return map_size(&level->blocks.pages) * sizeof(block_page_t);
+}
+
+ivec2s level_block_to_blockpos(level_t *level, block_t *block) {
+    return block->pos;
+}
+
+block_t *level_get_block(level_t *level, ivec2s block_pos) {
+    if (!level->blocks.ready) {
+        return NULL;
+    }
+
+    return get_block(level, block_pos, false);
+}
+
+// block range spanned by the rectangle mi -> ma, invalid if either is NaN
+static block_range_t block_range_from(vec2s mi, vec2s ma) {
+    if (isnan(mi.x) || isnan(mi.y) || isnan(ma.x) || isnan(ma.y)) {
+        return (block_range_t) { .valid = false };
     }
+
+    const ivec2s
+        a = level_pos_to_block(mi),
+        b = level_pos_to_block(ma);
+
+    return (block_range_t) {
+        .min = IVEC2(min(a.x, b.x), min(a.y, b.y)),
+        .max = IVEC2(max(a.x, b.x), max(a.y, b.y)),
+        .valid = true
+    };
+}
+
+ALWAYS_INLINE bool block_range_contains(block_range_t r, int bx, int by) {
+    return r.valid
+        && bx >= r.min.x && bx <= r.max.x
+        && by >= r.min.y && by <= r.max.y;
+}
+
+ALWAYS_INLINE bool block_range_eq(block_range_t a, block_range_t b) {
+    return a.valid == b.valid
+        && (!a.valid
+            || (a.min.x == b.min.x && a.min.y == b.min.y
+                && a.max.x == b.max.x && a.max.y == b.max.y));
+}
+
+// remove first instance of _x from block dynlist field _f for all existing
+// blocks in range _r which are not in range _keep
+#define REMOVE_FROM_RANGE(_level, _r, _keep, _f, _x) do {                    \
+        const block_range_t __r = (_r), __keep = (_keep);                    \
+        for (int by = __r.min.y; __r.valid && by <= __r.max.y; by++) {       \
+            for (int bx = __r.min.x; bx <= __r.max.x; bx++) {                \
+                if (block_range_contains(__keep, bx, by)) { continue; }      \
+                block_t *block = level_get_block((_level), IVEC2(bx, by));   \
+                if (!block) { continue; }                                    \
+                dynlist_each(block->_f, it) {                                \
+                    if (*it.el == (_x)) {                                    \
+                        dynlist_remove_it(block->_f, it);                    \
+                        break;                                               \
+                    }                                                        \
+                }                                                            \
+            }                                                                \
+        }                                                                    \
+    } while (0)
+
+// add _x to block dynlist field _f for all blocks in range _r which are not in
+// range _skip
+#define ADD_TO_RANGE(_level, _r, _skip, _f, _x) do {                         \
+        const block_range_t __r = (_r), __skip = (_skip);                    \
+        for (int by = __r.min.y; __r.valid && by <= __r.max.y; by++) {       \
+            for (int bx = __r.min.x; bx <= __r.max.x; bx++) {                \
+                if (block_range_contains(__skip, bx, by)) { continue; }      \
+                block_t *block = get_block((_level), IVEC2(bx, by), true);   \
+                *dynlist_push(block->_f) = (_x);                             \
+            }                                                                \
+        }                                                                    \
+    } while (0)
+
+void level_blocks_remove_sector(level_t *level, sector_t *sect) {
+    REMOVE_FROM_RANGE(level, sect->blocks, NO_BLOCKS, sectors, sect);
+    sect->blocks = NO_BLOCKS;
+}
+
+void level_blocks_remove_wall(level_t *level, wall_t *wall) {
+    REMOVE_FROM_RANGE(level, wall->blocks, NO_BLOCKS, walls, wall);
+    wall->blocks = NO_BLOCKS;
 }
 
 void level_blocks_remove_object(level_t *level, object_t *object) {
-    if (!level->blocks.arr) { return; }
+    if (!level->blocks.ready) { return; }
 
     if (!object->block) {
         WARN("object %d has no block", object->index);
@@ -83,21 +212,25 @@ void level_blocks_remove_object(level_t *level, object_t *object) {
 }
 
 void level_reset_blocks(level_t *level) {
+    level_destroy_blocks(level);
+    level_init_blocks(level);
     level_resize_blocks(level);
 
-    const ivec2s offset = level->blocks.offset, size = level->blocks.size;
-    for (int by = offset.y; by < offset.y + size.y; by++) {
-        for (int bx = offset.x; bx < offset.x + size.x; bx++) {
-            block_t *block = level_get_block(level, IVEC2(bx, by));
-            dynlist_free(block->sectors);
-            dynlist_free(block->walls);
-            dynlist_free(block->subsectors);
-            dlist_init(&block->objects);
+    // nothing is in any blocks anymore
+    level_dynlist_each(level->sectors, it) {
+        (*it.el)->blocks = NO_BLOCKS;
+
+        dynlist_each((*it.el)->subs, it_s) {
+            it_s.el->blocks = NO_BLOCKS;
         }
     }
 
+    level_dynlist_each(level->walls, it) {
+        (*it.el)->blocks = NO_BLOCKS;
+    }
+
     level_dynlist_each(level->sectors, it) {
-        level_update_sector_blocks(level, *it.el, NULL, NULL);
+        level_update_sector_blocks(level, *it.el);
 
         dynlist_each((*it.el)->subs, it_s) {
             level_set_subsector_blocks(level, it_s.el);
@@ -105,88 +238,35 @@ void level_reset_blocks(level_t *level) {
     }
 
     level_dynlist_each(level->walls, it) {
-        level_update_wall_blocks(level, *it.el, NULL, NULL);
+        level_update_wall_blocks(level, *it.el);
     }
 
     level_dynlist_each(level->objects, it) {
         dlist_init_node(&(*it.el)->block_list);
 
         block_t *block =
-            level_get_block(level, level_pos_to_block((*it.el)->pos));
+            get_block(level, level_pos_to_block((*it.el)->pos), true);
 
         dlist_prepend(block_list, &block->objects, *it.el);
+        (*it.el)->block = block;
     }
 }
 
 void level_resize_blocks(level_t *level) {
-    const ivec2s
-        old_size = level->blocks.size,
-        old_offset = level->blocks.offset,
-        new_size = IVEC2(
-            max((level->bounds.max.x - level->bounds.min.x) / BLOCK_SIZE, 1) + 1,
-            max((level->bounds.max.y - level->bounds.min.y) / BLOCK_SIZE, 1) + 1
-        ),
-        new_offset = IVEC2(
-            level->bounds.min.x / BLOCK_SIZE,
-            level->bounds.min.y / BLOCK_SIZE
-        );
-
-    if (level->blocks.arr
-        && new_size.x == old_size.x
-        && new_size.y == old_size.y
-        && new_offset.x == old_offset.x
-        && new_offset.y == old_offset.y) {
-        // nothing to do
-        return;
-    }
-
-    // realloc
-    block_t *old_arr = level->blocks.arr;
-    block_t *new_arr = calloc(1, new_size.x * new_size.y * sizeof(block_t));
-
-    // copy
-    if (old_arr) {
-        for (int by = old_offset.y; by < old_offset.y + old_size.y; by++) {
-            for (int bx = old_offset.x; bx < old_offset.x + old_size.x; bx++) {
-                block_t *old =
-                    &old_arr[
-                        (by - old_offset.y) * old_size.x + (bx - old_offset.x)];
-
-                // out of bounds? deallocate
-                if (bx - new_offset.x < 0
-                    || by - new_offset.y < 0
-                    || bx - new_offset.x >= new_size.x
-                    || by - new_offset.y >= new_size.y) {
-                    dynlist_free(old->sectors);
-                    dynlist_free(old->walls);
-
-                    dlist_each(block_list, &old->objects, it) {
-                        dlist_init_node(&it.el->block_list);
-                    }
-                } else {
-                    new_arr[
-                        (by - new_offset.y) * new_size.x
-                            + (bx - new_offset.x)] = *old;
-                }
-            }
-        }
-
-        free(old_arr);
-    }
-
-    // reassign
-    level->blocks.arr = new_arr;
-    level->blocks.offset = new_offset;
-    level->blocks.size = new_size;
+    // nothing to reallocate, pages are created as blocks are written to
+    level->blocks.ready = true;
 }
 
-void level_traverse_blocks(
+// see level_traverse_blocks, if "create" then blocks which do not exist yet are
+// created, otherwise they are skipped.
+static void traverse_blocks(
     level_t *level,
     vec2s from,
     vec2s to,
+    bool create,
     traverse_blocks_f callback,
     void *userdata) {
-    if (!level->blocks.arr) { return; }
+    if (!level->blocks.ready) { return; }
 
     // DDA: see lodev.org/cgtutor/raycasting.html
     const vec2s
@@ -216,14 +296,15 @@ void level_traverse_blocks(
     const ivec2s bstep = IVEC2(dir.x < 0 ? -1 : 1, dir.y < 0 ? -1 : 1);
 
     while (true) {
-        block_t *block = level_get_block(level, bpos);
+        block_t *block = get_block(level, bpos, create);
 
-        if (!block) {
+        if (!create && !blockpos_in_bounds(level, bpos)) {
             WARN("out of blockmap range at %d, %d", bpos.x, bpos.y);
             return;
         }
 
-        if (!callback(level, block, bpos, userdata)) {
+        // blocks which were never written to are empty
+        if (block && !callback(level, block, bpos, userdata)) {
             return;
         }
 
@@ -241,13 +322,24 @@ void level_traverse_blocks(
     }
 }
 
-void level_traverse_block_area(
+void level_traverse_blocks(
+    level_t *level,
+    vec2s from,
+    vec2s to,
+    traverse_blocks_f callback,
+    void *userdata) {
+    traverse_blocks(level, from, to, false, callback, userdata);
+}
+
+// see level_traverse_block_area, "create" as in traverse_blocks
+static void traverse_block_area(
     level_t *level,
     vec2s mi,
     vec2s ma,
+    bool create,
     traverse_blocks_f callback,
     void *userdata) {
-    if (!level->blocks.arr) { return; }
+    if (!level->blocks.ready) { return; }
 
     const ivec2s
         bmin = level_pos_to_block(mi),
@@ -255,8 +347,8 @@ void level_traverse_block_area(
 
     for (int by = bmin.y; by <= bmax.y; by++) {
         for (int bx = bmin.x; bx <= bmax.x; bx++) {
-            block_t *block = level_get_block(level, IVEC2(bx, by));
-            if (!block) { WARN("no block?"); continue; }
+            block_t *block = get_block(level, IVEC2(bx, by), create);
+            if (!block) { continue; }
 
             if (!callback(level, block, IVEC2(bx, by), userdata)) {
                 return;
@@ -265,21 +357,13 @@ void level_traverse_block_area(
     }
 }
 
-static bool update_wall_blocks_traverse_remove(
+void level_traverse_block_area(
     level_t *level,
-    block_t *block,
-    ivec2s bpos, // Parameter name added for clarity, can remain unnamed
-    void *userdata) { // Changed from wall_t *w
-    wall_t *w = (wall_t *)userdata; // Cast userdata to wall_t*
-    dynlist_each(block->walls, it) {
-        if (*it.el == w) {
-            dynlist_remove_it(block->walls, it);
-            return true;
-        }
-    }
-
-    WARN("wall not found in block");
-    return true;
+    vec2s mi,
+    vec2s ma,
+    traverse_blocks_f callback,
+    void *userdata) {
+    traverse_block_area(level, mi, ma, false, callback, userdata);
 }
 
 static bool update_wall_blocks_traverse_add(
@@ -292,110 +376,211 @@ static bool update_wall_blocks_traverse_add(
     return true;
 }
 
-void level_update_wall_blocks(
-    level_t *level,
-    wall_t *wall,
-    const vec2s *old_v0,
-    const vec2s *old_v1) {
-    if (old_v0 && old_v1) {
-        level_traverse_blocks(
-            level,
-            *old_v0,
-            *old_v1,
-            (traverse_blocks_f) update_wall_blocks_traverse_remove,
-            wall);
+void level_update_wall_blocks(level_t *level, wall_t *wall) {
+    if (!level->blocks.ready) { return; }
+
+    // nothing to do if wall has not moved
+    if (wall->blocks.valid
+        && glms_vec2_eqv(wall->last_pos[0], wall->v0->pos)
+        && glms_vec2_eqv(wall->last_pos[1], wall->v1->pos)) {
+        return;
     }
 
-    level_traverse_blocks(
+    // walls are added along their line, not to their entire block range, so
+    // there is no way to only partially move them
+    level_blocks_remove_wall(level, wall);
+
+    traverse_blocks(
         level,
         wall->v0->pos,
         wall->v1->pos,
+        true,
         (traverse_blocks_f) update_wall_blocks_traverse_add,
         wall);
+
+    wall->last_pos[0] = wall->v0->pos;
+    wall->last_pos[1] = wall->v1->pos;
+    wall->blocks = block_range_from(wall->v0->pos, wall->v1->pos);
 }
 
-void level_update_sector_blocks(
+void level_update_sector_blocks(level_t *level, sector_t *sector) {
+    if (!level->blocks.ready) { return; }
+
+    const block_range_t
+        old = sector->blocks,
+        new = block_range_from(sector->min, sector->max);
+
+    if (block_range_eq(old, new)) { return; }
+
+    // only touch blocks which are not in both ranges
+    REMOVE_FROM_RANGE(level, old, new, sectors, sector);
+    ADD_TO_RANGE(level, new, old, sectors, sector);
+    sector->blocks = new;
+}
+
+void level_set_subsector_blocks(level_t *level, subsector_t *sub) {
+    if (!level->blocks.ready) { return; }
+
+    level_blocks_remove_subsector(level, sub);
+
+    const block_range_t r = block_range_from(sub->min, sub->max);
+    ADD_TO_RANGE(level, r, NO_BLOCKS, subsectors, sub->id);
+    sub->blocks = r;
+}
+
+void level_blocks_remove_subsector(
+    level_t *level,
+    subsector_t *sub) {
+    REMOVE_FROM_RANGE(level, sub->blocks, NO_BLOCKS, subsectors, sub->id);
+    sub->blocks = NO_BLOCKS;
+}
+
+#undef REMOVE_FROM_RANGE
+#undef ADD_TO_RANGE
+
+// see level_check_blocks
+typedef struct {
+    wall_t *wall;
+    int n_blocks;
+} check_wall_blocks_t;
+
+static bool check_wall_blocks_traverse(
     level_t *level,
-    sector_t *sector,
-    const vec2s *old_min,
-    const vec2s *old_max) {
-    // remove from old blocks
-    if (old_min && old_max) {
-        const ivec2s
-            bmin = level_pos_to_block(*old_min),
-            bmax = level_pos_to_block(*old_max);
-
-        for (int by = bmin.y; by <= bmax.y; by++) {
-            for (int bx = bmin.x; bx <= bmax.x; bx++) {
+    block_t *block,
+    ivec2s bpos,
+    check_wall_blocks_t *data) {
+    int n = 0;
+    dynlist_each(block->walls, it) { n += *it.el == data->wall; }
+
+    if (n != 1) {
+        WARN(
+            "wall %d is in block (%d, %d) %d times",
+            data->wall->index, bpos.x, bpos.y, n);
+    }
+
+    data->n_blocks++;
+    return true;
+}
+
+bool level_check_blocks(level_t *level) {
+    if (!level->blocks.ready) { return true; }
+
+    // count entries which a rebuild would produce and check that each is
+    // present exactly once, then compare against the total number of entries
+    // to catch stale ones
+    int n_sectors = 0, n_subsectors = 0, n_walls = 0, n_objects = 0;
+
+    level_dynlist_each(level->sectors, it) {
+        sector_t *sector = *it.el;
+        const block_range_t r = block_range_from(sector->min, sector->max);
+
+        if (!block_range_eq(r, sector->blocks)) {
+            WARN("sector %d has stale block range", sector->index);
+        }
+
+        for (int by = r.min.y; r.valid && by <= r.max.y; by++) {
+            for (int bx = r.min.x; bx <= r.max.x; bx++) {
                 block_t *block = level_get_block(level, IVEC2(bx, by));
-                if (!block) { continue; }
 
-                dynlist_each(block->sectors, it) {
-                    if (*it.el == sector) {
-                        dynlist_remove_it(block->sectors, it);
-                        return;
+                int n = 0;
+                if (block) {
+                    dynlist_each(block->sectors, it_s) {
+                        n += *it_s.el == sector;
                     }
                 }
+
+                if (n != 1) {
+                    WARN(
+                        "sector %d is in block (%d, %d) %d times",
+                        sector->index, bx, by, n);
+                }
+
+                n_sectors++;
             }
         }
-    }
 
-    // add to new blocks
-    const ivec2s
-        bmin = level_pos_to_block(sector->min),
-        bmax = level_pos_to_block(sector->max);
+        dynlist_each(sector->subs, it_s) {
+            subsector_t *sub = it_s.el;
+            const block_range_t r = block_range_from(sub->min, sub->max);
 
-    for (int by = bmin.y; by <= bmax.y; by++) {
-        for (int bx = bmin.x; bx <= bmax.x; bx++) {
-            block_t *block = level_get_block(level, IVEC2(bx, by));
-            if (!block) { WARN("out of bounds?"); continue; }
+            for (int by = r.min.y; r.valid && by <= r.max.y; by++) {
+                for (int bx = r.min.x; bx <= r.max.x; bx++) {
+                    block_t *block = level_get_block(level, IVEC2(bx, by));
+
+                    int n = 0;
+                    if (block) {
+                        dynlist_each(block->subsectors, it_b) {
+                            n += *it_b.el == sub->id;
+                        }
+                    }
+
+                    if (n != 1) {
+                        WARN(
+                            "subsector %d is in block (%d, %d) %d times",
+                            sub->id, bx, by, n);
+                    }
 
-            *dynlist_push(block->sectors) = sector;
+                    n_subsectors++;
+                }
+            }
         }
     }
-}
 
-static bool set_subsector_blocks_traverse(
-    level_t *level,
-    block_t *block,
-    ivec2s pos,
-    void *userdata) { // Changed from subsector_t *sub
-    subsector_t *sub = (subsector_t *)userdata; // Cast userdata to subsector_t*
-    *dynlist_push(block->subsectors) = sub->id;
-    return true;
-}
+    level_dynlist_each(level->walls, it) {
+        wall_t *wall = *it.el;
 
-void level_set_subsector_blocks(level_t *level, subsector_t *sub) {
-    level_traverse_block_area(
-        level,
-        sub->min,
-        sub->max,
-        set_subsector_blocks_traverse, // No cast needed here if signatures match
-        sub);
-}
+        // blocks are created if missing so that the wall is reported as
+        // missing from them
+        check_wall_blocks_t data = { .wall = wall, .n_blocks = 0 };
+        traverse_blocks(
+            level,
+            wall->v0->pos,
+            wall->v1->pos,
+            true,
+            (traverse_blocks_f) check_wall_blocks_traverse,
+            &data);
 
-static bool remove_subsector_blocks_traverse(
-    level_t *level,
-    block_t *block,
-    ivec2s,
-    subsector_t *sub) {
-    dynlist_each(block->subsectors, it) {
-        if (*it.el == sub->id) {
-            dynlist_remove_it(block->subsectors, it);
-            break;
+        n_walls += data.n_blocks;
+    }
+
+    level_dynlist_each(level->objects, it) {
+        object_t *object = *it.el;
+        if (!object->block) { continue; }
+
+        if (object->block != level_get_block(level, level_pos_to_block(object->pos))) {
+            WARN("object %d is in wrong block", object->index);
         }
+
+        n_objects++;
     }
 
-    return true;
-}
+    int n[4] = { 0, 0, 0, 0 };
+    map_each(u64*, block_page_t*, &level->blocks.pages, it_p) {
+        for (int i = 0; i < BLOCK_PAGE_SIZE * BLOCK_PAGE_SIZE; i++) {
+            const block_t *block = &it_p.value->blocks[i];
+            n[0] += dynlist_size(block->sectors);
+            n[1] += dynlist_size(block->subsectors);
+            n[2] += dynlist_size(block->walls);
 
-void level_blocks_remove_subsector(
-    level_t *level,
-    subsector_t *sub) {
-    level_traverse_block_area(
-        level,
-        sub->min,
-        sub->max,
-        (traverse_blocks_f) remove_subsector_blocks_traverse,
-        sub);
+            dlist_each(block_list, &block->objects, it_o) {
+                n[3]++;
+            }
+        }
+    }
+
+    const bool ok =
+        n[0] == n_sectors
+        && n[1] == n_subsectors
+        && n[2] == n_walls
+        && n[3] == n_objects;
+
+    if (!ok) {
+        WARN(
+            "block entries (sectors/subsectors/walls/objects) "
+            "%d/%d/%d/%d, expected %d/%d/%d/%d",
+            n[0], n[1], n[2], n[3],
+            n_sectors, n_subsectors, n_walls, n_objects);
+    }
+
+    return ok;
 }
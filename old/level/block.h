@@ -9,6 +9,13 @@ ALWAYS_INLINE ivec2s level_pos_to_block(vec2s point) {
     return IVEC2(point.x / BLOCK_SIZE, point.y / BLOCK_SIZE);
 }
 
+// initialize/destroy block data, see level_init/level_destroy
+void level_init_blocks(level_t *level);
+void level_destroy_blocks(level_t *level);
+
+// number of bytes used by block pages (not including block contents)
+usize level_blocks_memory(const level_t *level);
+
 // get block position from block
 ivec2s level_block_to_blockpos(level_t *level, block_t *block);
 
@@ -46,17 +53,13 @@ void level_traverse_block_area(
     traverse_blocks_f callback,
     void *userdata);
 
-void level_update_wall_blocks(
-    level_t *level,
-    wall_t *wall,
-    const vec2s *old_v0,
-    const vec2s *old_v1);
+// (re)insert wall into blocks along its line if it has moved since it was last
+// inserted
+void level_update_wall_blocks(level_t *level, wall_t *wall);
 
-void level_update_sector_blocks(
-    level_t *level,
-    sector_t *sector,
-    const vec2s *old_min,
-    const vec2s *old_max);
+// move sector into blocks for its current bounds, only blocks which differ
+// between its last block range and its current one are touched
+void level_update_sector_blocks(level_t *level, sector_t *sector);
 
 void level_set_subsector_blocks(
     level_t *level,
@@ -65,3 +68,7 @@ void level_set_subsector_blocks(
 void level_blocks_remove_subsector(
     level_t *level,
     subsector_t *sub);
+
+// checks block contents against what a full rebuild would produce, warning
+// about and returning false on any mismatch
+bool level_check_blocks(level_t *level);
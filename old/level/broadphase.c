@@ -0,0 +1,345 @@
+#include "level/broadphase.h"
+#include "level/level_defs.h"
+#include "level/level.h"
+#include "util/map.h"
+#include "util/sort.h"
+
+// #define DO_VERIFY_BROADPHASE
+
+#ifdef DO_VERIFY_BROADPHASE
+#include "util/time.h"
+#endif // ifdef DO_VERIFY_BROADPHASE
+
+static int cmp_object_index(object_t **a, object_t **b, void*) {
+    return ((int) (*a)->index) - ((int) (*b)->index);
+}
+
+// range of cells covered by circle
+static block_range_t circle_cells(vec2s pos, f32 r) {
+    return (block_range_t) {
+        .min = broadphase_pos_to_cell(glms_vec2_subs(pos, r)),
+        .max = broadphase_pos_to_cell(glms_vec2_adds(pos, r)),
+        .valid = true
+    };
+}
+
+void broadphase_init(level_t *level) {
+    map_init(
+        &level->broadphase.cells,
+        map_hash_u64,
+        NULL, NULL, map_dup_u64,
+        map_cmp_u64,
+        map_default_free, NULL, NULL);
+    level->broadphase.stamp = 0;
+}
+
+void broadphase_destroy(level_t *level) {
+    map_each(u64*, DYNLIST(object_t*), &level->broadphase.cells, it) {
+        DYNLIST(object_t*) l = it.value;
+        dynlist_free(l);
+    }
+
+    map_destroy(&level->broadphase.cells);
+    dynlist_free(level->broadphase.scratch);
+}
+
+static void add_to_cell(level_t *level, ivec2s pos, object_t *object) {
+    const u64 key = map_ivec2_to_u64(pos);
+
+    DYNLIST(object_t*) *cell =
+        map_find(DYNLIST(object_t*), &level->broadphase.cells, &key);
+
+    if (!cell) {
+        cell =
+            (DYNLIST(object_t*)*)
+                map_insert(&level->broadphase.cells, &key, NULL);
+    }
+
+    *dynlist_push(*cell) = object;
+}
+
+static void remove_from_cell(level_t *level, ivec2s pos, object_t *object) {
+    const u64 key = map_ivec2_to_u64(pos);
+
+    DYNLIST(object_t*) *cell =
+        map_find(DYNLIST(object_t*), &level->broadphase.cells, &key);
+
+    ASSERT(cell, "object %d not in broadphase cell", object->index);
+
+    dynlist_each(*cell, it) {
+        if (*it.el == object) {
+            dynlist_remove_it(*cell, it);
+            break;
+        }
+    }
+
+    // drop empty cells so that the map only grows with occupied area
+    if (dynlist_size(*cell) == 0) {
+        dynlist_free(*cell);
+        map_remove(&level->broadphase.cells, &key);
+    }
+}
+
+void broadphase_update(level_t *level, object_t *object) {
+    const block_range_t
+        old = object->cells,
+        new = circle_cells(object->pos, object->type->radius);
+
+    if (old.valid
+        && old.min.x == new.min.x && old.min.y == new.min.y
+        && old.max.x == new.max.x && old.max.y == new.max.y) {
+        return;
+    }
+
+    // only touch cells which are in one range but not the other
+    if (old.valid) {
+        for (int y = old.min.y; y <= old.max.y; y++) {
+            for (int x = old.min.x; x <= old.max.x; x++) {
+                if (x >= new.min.x && x <= new.max.x
+                    && y >= new.min.y && y <= new.max.y) {
+                    continue;
+                }
+
+                remove_from_cell(level, IVEC2(x, y), object);
+            }
+        }
+    }
+
+    for (int y = new.min.y; y <= new.max.y; y++) {
+        for (int x = new.min.x; x <= new.max.x; x++) {
+            if (old.valid
+                && x >= old.min.x && x <= old.max.x
+                && y >= old.min.y && y <= old.max.y) {
+                continue;
+            }
+
+            add_to_cell(level, IVEC2(x, y), object);
+        }
+    }
+
+    object->cells = new;
+}
+
+void broadphase_remove(level_t *level, object_t *object) {
+    if (!object->cells.valid) {
+        return;
+    }
+
+    for (int y = object->cells.min.y; y <= object->cells.max.y; y++) {
+        for (int x = object->cells.min.x; x <= object->cells.max.x; x++) {
+            remove_from_cell(level, IVEC2(x, y), object);
+        }
+    }
+
+    object->cells = (block_range_t) { .valid = false };
+}
+
+#ifdef DO_VERIFY_BROADPHASE
+// checks query results against a brute force search over all objects and
+// periodically logs how long each took
+static void verify_query(
+    level_t *level,
+    vec2s mi,
+    vec2s ma,
+    const DYNLIST(object_t*) res,
+    int start,
+    u64 ns_query) {
+    static u64 n_queries, ns_grid, ns_brute;
+
+    const u64 t_brute = time_ns();
+
+    const ivec2s
+        cmi = broadphase_pos_to_cell(mi),
+        cma = broadphase_pos_to_cell(ma);
+
+    int n = 0;
+    level_dynlist_each(level->objects, it) {
+        const block_range_t r = (*it.el)->cells;
+        if (!r.valid
+            || r.max.x < cmi.x || r.min.x > cma.x
+            || r.max.y < cmi.y || r.min.y > cma.y) {
+            continue;
+        }
+
+        bool found = false;
+        for (int i = start; i < (int) dynlist_size(res); i++) {
+            if (res[i] == *it.el) { found = true; break; }
+        }
+
+        if (!found) {
+            WARN("broadphase query missed object %d", (*it.el)->index);
+        }
+
+        n++;
+    }
+
+    ns_brute += time_ns() - t_brute;
+    ns_grid += ns_query;
+
+    if (n != (int) dynlist_size(res) - start) {
+        WARN(
+            "broadphase query returned %d objects, expected %d",
+            (int) dynlist_size(res) - start, n);
+    }
+
+    for (int i = start + 1; i < (int) dynlist_size(res); i++) {
+        if (res[i - 1]->index >= res[i]->index) {
+            WARN("broadphase query results out of order");
+            break;
+        }
+    }
+
+    if (++n_queries % 10000 == 0) {
+        LOG(
+            "broadphase: %d objects, %d cells, grid %.1f ns/query, "
+            "brute force %.1f ns/query",
+            level_get_list_count(level, T_OBJECT),
+            (int) map_size(&level->broadphase.cells),
+            ns_grid / (f64) n_queries,
+            ns_brute / (f64) n_queries);
+    }
+}
+
+// checks that segment query results contain every object touching the swept
+// segment, found by brute force
+static void verify_segment_query(
+    level_t *level,
+    vec2s from,
+    vec2s to,
+    f32 r,
+    const DYNLIST(object_t*) res,
+    int start) {
+    level_dynlist_each(level->objects, it) {
+        const object_t *object = *it.el;
+        if (!object->cells.valid) { continue; }
+
+        const vec2s p = point_project_segment(object->pos, from, to);
+        if (glms_vec2_distance(p, object->pos) > object->type->radius + r) {
+            continue;
+        }
+
+        bool found = false;
+        for (int i = start; i < (int) dynlist_size(res); i++) {
+            if (res[i] == object) { found = true; break; }
+        }
+
+        if (!found) {
+            WARN("broadphase segment query missed object %d", object->index);
+        }
+    }
+}
+#endif // ifdef DO_VERIFY_BROADPHASE
+
+// append objects in cell at pos to out which are not yet stamped
+static void query_cell(
+    level_t *level,
+    ivec2s pos,
+    u32 stamp,
+    DYNLIST(object_t*) *out) {
+    const u64 key = map_ivec2_to_u64(pos);
+    DYNLIST(object_t*) *cell =
+        map_find(DYNLIST(object_t*), &level->broadphase.cells, &key);
+
+    if (!cell) { return; }
+
+    dynlist_each(*cell, it) {
+        if ((*it.el)->broadphase_stamp == stamp) { continue; }
+        (*it.el)->broadphase_stamp = stamp;
+        *dynlist_push(*out) = *it.el;
+    }
+}
+
+// cell contents are ordered by insertion, sort for determinism
+static void sort_results(DYNLIST(object_t*) out, int start) {
+    if (dynlist_size(out) - start > 1) {
+        sort(
+            &out[start],
+            dynlist_size(out) - start,
+            sizeof(out[0]),
+            (f_sort_cmp) cmp_object_index,
+            NULL);
+    }
+}
+
+void broadphase_query(
+    level_t *level,
+    vec2s mi,
+    vec2s ma,
+    DYNLIST(object_t*) *out) {
+#ifdef DO_VERIFY_BROADPHASE
+    const u64 t_query = time_ns();
+#endif // ifdef DO_VERIFY_BROADPHASE
+
+    const int start = dynlist_size(*out);
+    const u32 stamp = ++level->broadphase.stamp;
+
+    const ivec2s
+        cmi = broadphase_pos_to_cell(mi),
+        cma = broadphase_pos_to_cell(ma);
+
+    for (int y = cmi.y; y <= cma.y; y++) {
+        for (int x = cmi.x; x <= cma.x; x++) {
+            query_cell(level, IVEC2(x, y), stamp, out);
+        }
+    }
+
+    sort_results(*out, start);
+
+#ifdef DO_VERIFY_BROADPHASE
+    verify_query(level, mi, ma, *out, start, time_ns() - t_query);
+#endif // ifdef DO_VERIFY_BROADPHASE
+}
+
+void broadphase_query_segment(
+    level_t *level,
+    vec2s from,
+    vec2s to,
+    f32 r,
+    DYNLIST(object_t*) *out) {
+    const int start = dynlist_size(*out);
+    const u32 stamp = ++level->broadphase.stamp;
+
+    // margin so that segments running along cell edges don't miss cells
+    const f32 rq = r + 0.0001f;
+
+    const vec2s d = glms_vec2_sub(to, from);
+    const int
+        y_min =
+            (int) floorf((min(from.y, to.y) - rq) / BROADPHASE_CELL_SIZE),
+        y_max =
+            (int) floorf((max(from.y, to.y) + rq) / BROADPHASE_CELL_SIZE);
+
+    // walk rows of cells, in each only visiting the x range of the part of the
+    // segment which is within r of the row
+    for (int y = y_min; y <= y_max; y++) {
+        f32 t0 = 0.0f, t1 = 1.0f;
+
+        if (fabsf(d.y) > 0.0000001f) {
+            const f32
+                ta = ((y * BROADPHASE_CELL_SIZE) - rq - from.y) / d.y,
+                tb = (((y + 1) * BROADPHASE_CELL_SIZE) + rq - from.y) / d.y;
+
+            t0 = max(t0, min(ta, tb));
+            t1 = min(t1, max(ta, tb));
+
+            if (t0 > t1) { continue; }
+        }
+
+        const f32
+            xa = from.x + d.x * t0,
+            xb = from.x + d.x * t1;
+        const int
+            x_min = (int) floorf((min(xa, xb) - rq) / BROADPHASE_CELL_SIZE),
+            x_max = (int) floorf((max(xa, xb) + rq) / BROADPHASE_CELL_SIZE);
+
+        for (int x = x_min; x <= x_max; x++) {
+            query_cell(level, IVEC2(x, y), stamp, out);
+        }
+    }
+
+    sort_results(*out, start);
+
+#ifdef DO_VERIFY_BROADPHASE
+    verify_segment_query(level, from, to, r, *out, start);
+#endif // ifdef DO_VERIFY_BROADPHASE
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "util/dynlist.h"
+#include "util/math.h"
+#include "defs.h"
+#include "config.h"
+
+// level pos -> broadphase cell pos
+ALWAYS_INLINE ivec2s broadphase_pos_to_cell(vec2s pos) {
+    return IVEC2(
+        (int) floorf(pos.x / BROADPHASE_CELL_SIZE),
+        (int) floorf(pos.y / BROADPHASE_CELL_SIZE));
+}
+
+// initialize/destroy broadphase, see level_init/level_destroy
+void broadphase_init(level_t *level);
+void broadphase_destroy(level_t *level);
+
+// (re)insert object into every cell overlapped by its radius, does nothing if
+// the set of cells has not changed
+void broadphase_update(level_t *level, object_t *object);
+
+// remove object from broadphase
+void broadphase_remove(level_t *level, object_t *object);
+
+// append objects whose cells overlap [mi, ma] to "out", each object at most
+// once and sorted by index so that results do not depend on insertion order
+// NOTE: this is conservative, objects must still be tested exactly
+void broadphase_query(
+    level_t *level,
+    vec2s mi,
+    vec2s ma,
+    DYNLIST(object_t*) *out);
+
+// append objects whose cells overlap the segment from -> to swept by a circle
+// of radius r to "out", only visiting cells along the segment. results are
+// ordered as for broadphase_query.
+// NOTE: this is conservative, objects must still be tested exactly
+void broadphase_query_segment(
+    level_t *level,
+    vec2s from,
+    vec2s to,
+    f32 r,
+    DYNLIST(object_t*) *out);
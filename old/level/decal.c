@@ -51,6 +51,7 @@ void decal_recalculate(level_t *level, decal_t *decal) {
 
     // TODO: animations, etc.
     memcpy(&decal->tex, &decal->tex_base, sizeof(decal->tex));
+    decal->tex_handle = (atlas_handle_t) { 0 };
 
     // clamp
     if (decal->is_on_side) {
@@ -11,6 +11,7 @@
 #include "level/sidemat.h"
 #include "level/tag.h"
 #include "level/vertex.h"
+#include "level/visibility.h"
 #include "level/wall.h"
 #include "util/math.h"
 #include "util/str.h"
@@ -26,6 +27,7 @@
 
 #define IO_MAGIC ((int) 0xDEADBEEF)
 #define IO_ARRAY_MAGIC ((int) 0x50505050)
+#define IO_VIS_MAGIC ((int) 0x56495342)
 
 typedef struct io_type io_type_t;
 typedef struct io io_t;
@@ -580,6 +582,155 @@ static int array_type_write(io_t *io, FILE *fp, io_type type) {
     return IO_OK;
 }
 
+// baked visibility is written after all arrays as rows of [start, end) runs of
+// sector save positions (save_index - 1), one row per sector in save order:
+// IO_VIS_MAGIC, count, { n_runs, { start, end } * n_runs } * count
+static int vis_read(
+    io_t *io,
+    const u8 **pp,
+    const u8 *end,
+    DYNLIST(u32) **prows,
+    int *pcount) {
+    int magic, count;
+    *pp += read_int(io, &IO_TYPES[IOT_INT], *pp, end - *pp, &magic);
+    *pp += read_int(io, &IO_TYPES[IOT_INT], *pp, end - *pp, &count);
+    DEBUG_IO("reading visibility for %d sectors", count);
+
+    if (magic != IO_VIS_MAGIC || count < 0) {
+        return IO_BAD_VIS;
+    }
+
+    DYNLIST(u32) *rows = calloc(max(count, 1), sizeof(rows[0]));
+    *prows = rows;
+    *pcount = count;
+
+    for (int i = 0; i < count; i++) {
+        int n_runs;
+        *pp += read_int(io, &IO_TYPES[IOT_INT], *pp, end - *pp, &n_runs);
+
+        if (n_runs < 0 || (end - *pp) < n_runs * 2 * (int) sizeof(int)) {
+            return IO_BAD_VIS;
+        }
+
+        int last = 0;
+        for (int j = 0; j < n_runs * 2; j++) {
+            int x;
+            *pp += read_int(io, &IO_TYPES[IOT_INT], *pp, end - *pp, &x);
+
+            // runs must be sorted, non-empty and within count
+            if (x < last || x > count || ((j % 2) == 1 && x == last)) {
+                return IO_BAD_VIS;
+            }
+
+            *dynlist_push(rows[i]) = x;
+            last = x;
+        }
+    }
+
+    return IO_OK;
+}
+
+static void vis_write(io_t *io, FILE *fp) {
+    level_t *level = io->level;
+
+    const int
+        magic = IO_VIS_MAGIC,
+        count = level_get_list_count(level, T_SECTOR);
+
+    write_int(io, &IO_TYPES[IOT_INT], fp, &magic);
+    write_int(io, &IO_TYPES[IOT_INT], fp, &count);
+
+    BITMAP
+        *scratch = bitmap_alloc(level->visibility.n),
+        *bits = bitmap_alloc(max(count, 1));
+
+    level_dynlist_each(level->sectors, it) {
+        // remap sector indices -> save positions
+        bitmap_fill(bits, count, false);
+
+        const BITMAP *row = visibility_row(level, *it.el, scratch);
+        if (row) {
+            bitmap_each_set(
+                row,
+                min(level->visibility.n, dynlist_size(level->sectors)),
+                i) {
+                if (level->sectors[i]) {
+                    bitmap_set(bits, level->sectors[i]->save_index - 1);
+                }
+            }
+        }
+
+        int n_runs = 0;
+        for (int i = 0; (i = bitmap_find(bits, count, i, true)) != INT_MAX;) {
+            i = min(bitmap_find(bits, count, i, false), count);
+            n_runs++;
+        }
+
+        write_int(io, &IO_TYPES[IOT_INT], fp, &n_runs);
+
+        for (int i = 0; (i = bitmap_find(bits, count, i, true)) != INT_MAX;) {
+            const int run_end = min(bitmap_find(bits, count, i, false), count);
+            write_int(io, &IO_TYPES[IOT_INT], fp, &i);
+            write_int(io, &IO_TYPES[IOT_INT], fp, &run_end);
+            i = run_end;
+        }
+    }
+
+    bitmap_free(scratch);
+    bitmap_free(bits);
+}
+
+// set visibility rows from vis_read, false if they do not match the level
+static bool vis_apply(level_t *level, DYNLIST(u32) *rows, int count) {
+    if (count != level_get_list_count(level, T_SECTOR)) {
+        WARN(
+            "baked visibility is for %d sectors, level has %d",
+            count, level_get_list_count(level, T_SECTOR));
+        return false;
+    }
+
+    // save position -> sector, sectors are loaded in save order
+    sector_t **sectors = calloc(max(count, 1), sizeof(sectors[0]));
+    int n = 0;
+    level_dynlist_each(level->sectors, it) {
+        sectors[n++] = *it.el;
+    }
+
+    const int n_sectors = dynlist_size(level->sectors);
+    BITMAP *bits = bitmap_alloc(n_sectors);
+
+    for (int i = 0; i < count; i++) {
+        bitmap_fill(bits, n_sectors, false);
+
+        for (int j = 0; j < dynlist_size(rows[i]); j += 2) {
+            for (u32 k = rows[i][j]; k < rows[i][j + 1]; k++) {
+                bitmap_set(bits, sectors[k]->index);
+            }
+        }
+
+        visibility_set_row(level, sectors[i], bits, n_sectors);
+    }
+
+    bitmap_free(bits);
+    free(sectors);
+
+    // rows are complete, don't let the load's own sector recalculations
+    // replace them with incremental ones
+    dynlist_resize(level->dirty_vis_sectors, 0);
+    level->visibility.baked = true;
+    return true;
+}
+
+static void vis_free_rows(DYNLIST(u32) *rows, int count) {
+    if (!rows) { return; }
+
+    for (int i = 0; i < count; i++) {
+        dynlist_free(rows[i]);
+    }
+
+    free(rows);
+}
+
 int io_load_level(level_t *level, const u8 *src, usize n) {
     io_t io = { .level = level };
     const u8 *p = src, *end = src + n;
@@ -625,12 +776,36 @@ int io_load_level(level_t *level, const u8 *src, usize n) {
         DEBUG_IO("  type %d: %d elements", type, array_type_count(&io, type));
     }
 
-    p += read_int(&io, &IO_TYPES[IOT_INT], src, n, &magic);
+    // optional baked visibility
+    DYNLIST(u32) *vis_rows = NULL;
+    int vis_count = 0;
+
+    if (end - p >= (int) sizeof(int)) {
+        p += read_int(&io, &IO_TYPES[IOT_INT], p, end - p, &magic);
+        p -= sizeof(int);
+
+        if (magic == IO_VIS_MAGIC) {
+            const int res = vis_read(&io, &p, end, &vis_rows, &vis_count);
+            if (res != IO_OK) {
+                vis_free_rows(vis_rows, vis_count);
+                return res;
+            }
+        }
+    }
+
+    if (end - p < (int) sizeof(int)) {
+        vis_free_rows(vis_rows, vis_count);
+        return IO_BAD_END_MAGIC;
+    }
+
+    p += read_int(&io, &IO_TYPES[IOT_INT], p, end - p, &magic);
     if (magic != IO_MAGIC) {
+        vis_free_rows(vis_rows, vis_count);
         return IO_BAD_END_MAGIC;
     }
 
     if (p != end) {
+        vis_free_rows(vis_rows, vis_count);
         return IO_EXTRA_DATA;
     }
 
@@ -760,11 +935,15 @@ int io_load_level(level_t *level, const u8 *src, usize n) {
 
 #undef ADD_TAGS
 
-    // compute sector visibility
-    level_dynlist_each(level->sectors, it) {
-        sector_compute_visibility(level, *it.el);
+    // use baked sector visibility if there is any, otherwise compute it
+    if (!vis_rows || !vis_apply(level, vis_rows, vis_count)) {
+        level_dynlist_each(level->sectors, it) {
+            sector_compute_visibility(level, *it.el);
+        }
     }
 
+    vis_free_rows(vis_rows, vis_count);
+
     level_reset_blocks(level);
 
     // load object sectors
@@ -810,6 +989,10 @@ int io_save_level(FILE *fp, level_t *level) {
     array_type_write(&io, fp, IOT_DECAL);   // decal
     array_type_write(&io, fp, IOT_OBJECT);  // object
 
+    if (level->visibility.baked) {
+        vis_write(&io, fp);
+    }
+
     write_int(&io, &IO_TYPES[IOT_INT], fp, &magic);
     return IO_OK;
 }
@@ -2,7 +2,7 @@
 
 #include "level/level_defs.h"
 
-#define IO_VERSION ((int) 0x00000001)
+#define IO_VERSION ((int) 0x00000002)
 
 // IO status
 enum {
@@ -18,6 +18,8 @@ enum {
     IO_BAD_TEXTURE          = 6,
 
     IO_UNKNOWN_VERSION = 8,
+
+    IO_BAD_VIS              = 9,
 };
 
 // read level from buffer
@@ -1,5 +1,9 @@
 #include "level/level.h"
+#include "level/actor.h"
 #include "level/lptr.h"
+#include "level/locate.h"
+#include "level/los.h"
+#include "level/nav.h"
 #include "level/object.h"
 #include "level/particle.h"
 #include "level/portal.h"
@@ -9,11 +13,14 @@
 #include "level/sidemat.h"
 #include "level/wall.h"
 #include "level/block.h"
+#include "level/broadphase.h"
+#include "level/visibility.h"
 #include "reload.h"
 #include "state.h"
 #include "util/macros.h"
 #include "util/math.h"
 #include "util/bitmap.h"
+#include "util/time.h"
 
 // userdata for level dynlists
 typedef struct level_dynlist_data {
@@ -204,6 +211,15 @@ void level_init(level_t *level) {
     dynlist_alloc(level->objects);
     level_dynlist_init(level, (DYNLIST(void*)*) &level->objects, true);
 
+    // empty bounds, grown as sectors are added
+    level->bounds.min = IVEC2(U16_MAX, U16_MAX);
+    level->bounds.max = IVEC2(0, 0);
+
+    level_init_blocks(level);
+    broadphase_init(level);
+    los_init(level);
+    nav_init(level);
+
     // create 0-index materials (NOMAT)
     sidemat_t *sidemat = sidemat_new(level);
     snprintf(sidemat->name.name, sizeof(sidemat->name.name), "%s", "NOMAT");
@@ -213,9 +229,11 @@ void level_init(level_t *level) {
 }
 
 void level_destroy(level_t *level) {
-    if (level->visibility.matrix) {
-        free(level->visibility.matrix);
-    }
+    visibility_destroy(level);
+    level_destroy_blocks(level);
+    broadphase_destroy(level);
+    los_destroy(level);
+    nav_destroy(level);
 
     for (int i = 0; i < TAG_MAX; i++) {
         if (level->tag_lists[i]) {
@@ -223,20 +241,7 @@ void level_destroy(level_t *level) {
         }
     }
 
-    // destroy actors
-    dlist_each(listnode, &level->actors, it) {
-#ifdef RELOADABLE
-        if (g_reload_host) {
-            g_reload_host->del_fn((void**) &it.el->act);
-        }
-#endif //ifdef RELOADABLE
-
-        dlist_remove(listnode, &level->actors, it.el);
-        if (it.el->flags & AF_PARAM_OWNED) {
-            free(it.el->param);
-        }
-        free(it.el);
-    }
+    actor_destroy_all(level);
 
 #ifdef MAPEDITOR
     level_dynlist_each(level->vertices, it) {
@@ -262,6 +267,12 @@ void level_destroy(level_t *level) {
 
 #undef DESTROY_DYNLIST
 
+    for (int i = 0; i < OT_COUNT; i++) {
+        dynlist_free(level->objects_by_type[i]);
+    }
+
+    dynlist_free(level->awake_objects);
+
     bitmap_free(level->subsector_ids);
     dynlist_free(level->subsectors);
 
@@ -269,6 +280,80 @@ void level_destroy(level_t *level) {
     dynlist_free(level->particles);
 }
 
+// #define DO_VERIFY_VIS
+// #define DO_VERIFY_BLOCKS
+
+#ifdef DO_VERIFY_VIS
+// traces visibility of every sector into a scratch matrix and compares it
+// against the incrementally maintained rows, warning about any rows which
+// differ. a pair must be visible iff both sectors' traces see each other.
+static void verify_visibility(level_t *level) {
+    const int
+        n_sectors = dynlist_size(level->sectors),
+        row_bytes = BITMAP_SIZE_TO_BYTES(n_sectors);
+
+    BITMAP
+        *scratch = bitmap_alloc(level->visibility.n),
+        *traced = bitmap_calloc(n_sectors * row_bytes * 8),
+        *has_trace = bitmap_calloc(n_sectors);
+
+    const u64 start = time_ns();
+    level_dynlist_each(level->sectors, it) {
+        if (sector_trace_visibility(
+                level, *it.el, &traced[(*it.el)->index * row_bytes])) {
+            bitmap_set(has_trace, (*it.el)->index);
+        }
+    }
+    const u64 elapsed = time_ns() - start;
+
+    int n_bad = 0;
+
+    level_dynlist_each(level->sectors, it) {
+        const int index = (*it.el)->index;
+        const BITMAP *row = visibility_row(level, *it.el, scratch);
+        if (!row || !bitmap_get(has_trace, index)) { continue; }
+
+        for (int i = 0; i < n_sectors; i++) {
+            // sectors which cannot be traced keep whatever they had
+            if (i != index && !bitmap_get(has_trace, i)) { continue; }
+
+            const bool
+                live = bitmap_get(row, i),
+                expected =
+                    bitmap_get(&traced[index * row_bytes], i)
+                        && bitmap_get(&traced[i * row_bytes], index);
+
+            // also check that direct lookups agree with decoded rows
+            if (live != expected
+                || live != visibility_get(level, *it.el, i)
+                || (level->sectors[i]
+                    && live != visibility_get(level, level->sectors[i], index))) {
+                WARN(
+                    "visibility mismatch for sector %d at sector %d",
+                    index, i);
+                n_bad++;
+                break;
+            }
+        }
+    }
+
+    if (n_bad != 0) {
+        WARN(
+            "%d/%d visibility rows differ (full trace took %.3f ms, "
+            "%" PRIu64 " KiB %s)",
+            n_bad,
+            level_get_list_count(level, T_SECTOR),
+            elapsed / 1000000.0,
+            (u64) (visibility_memory(level) / 1024),
+            visibility_is_sparse(level) ? "sparse" : "dense");
+    }
+
+    bitmap_free(scratch);
+    bitmap_free(traced);
+    bitmap_free(has_trace);
+}
+#endif // ifdef DO_VERIFY_VIS
+
 void level_update(level_t *level, f32 dt) {
     // update sectors for dirty sides
     while (dynlist_size(level->dirty_sides) != 0) {
@@ -301,41 +386,19 @@ void level_update(level_t *level, f32 dt) {
 
     dynlist_resize(level->dirty_vis_sectors, 0);
 
-    level_dynlist_each(level->objects, it) {
-        object_t *o = *it.el;
+#ifdef DO_VERIFY_VIS
+    verify_visibility(level);
+#endif // ifdef DO_VERIFY_VIS
 
-        if (o->sector) {
-            object_update(level, o, dt);
-        }
-    }
+#ifdef DO_VERIFY_BLOCKS
+    level_check_blocks(level);
+#endif // ifdef DO_VERIFY_BLOCKS
+
+    objects_update(level, dt);
 }
 
 void level_tick(level_t *level) {
-    dlist_each(listnode, &level->actors, it) {
-        actor_t *actor = it.el;
-
-        if (actor->flags & AF_DONE) {
-            if (actor->storage) {
-                *actor->storage = NULL;
-            }
-
-            dlist_remove(listnode, &level->actors, actor);
-
-            if (actor->flags & AF_PARAM_OWNED) {
-                free(actor->param);
-            }
-
-#ifdef RELOADABLE
-            if (g_reload_host) {
-                g_reload_host->del_fn((void**) &it.el->act);
-            }
-#endif //ifdef RELOADABLE
-            free(actor);
-            continue;
-        } else {
-            actor->act(level, actor, actor->param);
-        }
-    }
+    actor_tick(level);
 
     // tick particles
     int i = -1;
@@ -1127,100 +1190,6 @@ vertex_t *level_nearest_vertex(
     return v;
 }
 
-sector_t *level_find_point_sector(
-    level_t *level,
-    vec2s point,
-    sector_t *sector) {
-    if (sector && sector_contains_point(sector, point)) {
-        return sector;
-    }
-
-    if (!level->blocks.arr) {
-        // use only current sector data, cannot rely on blocks
-        if (!sector) {
-            // fall back to simple linear search
-            level_dynlist_each(level->sectors, it) {
-                sector_t *s = *it.el;
-
-                if (point.x < s->min.x
-                    || point.x > s->max.x
-                    || point.y < s->min.y
-                    || point.y > s->max.y) {
-                    continue;
-                }
-
-                if (sector_contains_point(s, point)) {
-                    return (sector_t*) s;
-                }
-            }
-
-            return NULL;
-        } else {
-            // BFS neighbors in a circular queue, point is likely to be in one
-            // of the neighboring sectors
-            enum { QUEUE_MAX = 64 };
-            sector_t *queue[QUEUE_MAX] = { sector };
-            int i = 0, n = 1;
-
-            // keep track of which sectors have been traversed
-            const int nsectors = dynlist_size(level->sectors);
-            BITMAP_DECL(hits, nsectors);
-            bitmap_fill(hits, nsectors, false);
-
-            while (n != 0) {
-                // get front of queue and advance to next
-                sector_t *sect = queue[i];
-                i = (i + 1) % (QUEUE_MAX);
-                n--;
-
-                if (bitmap_get(hits, sect->index)) {
-                    continue;
-                }
-
-                bitmap_set(hits, sect->index);
-
-                if (sector_contains_point(sect, point)) {
-                    return sect;
-                }
-
-                // check neighbors
-                llist_each(sector_sides, &sect->sides, it) {
-                    if (it.el->portal
-                        && it.el->portal->sector
-                        && !bitmap_get(hits, it.el->portal->sector->index)) {
-                        if (n == QUEUE_MAX) {
-                            WARN("l_find_point_sector out of queue space!");
-                            return NULL;
-                        }
-
-                        queue[(i + n) % QUEUE_MAX] = it.el->portal->sector;
-                        n++;
-                    }
-                }
-            }
-        }
-    } else {
-        // block data is OK, use it
-        block_t *block =
-            level_get_block(level, level_pos_to_block(point));
-
-        if (!block) {
-            return NULL;
-            LOG("no block for find point");
-            DUMPTRACE();
-        }
-
-        // TODO: better
-        dynlist_each(block->sectors, it) {
-            if (sector_contains_point(*it.el, point)) {
-                return *it.el;
-            }
-        }
-    }
-
-    return NULL;
-}
-
 void level_nearest_side_pos(
     const level_t *level,
     vec2s pos,
@@ -1249,41 +1218,28 @@ void level_nearest_side_pos(
     }
 }
 
-// NOTE: can return NULL when level is loading
-static BITMAP *get_visibility_map(level_t *level, sector_t *s) {
-    if (!level->visibility.matrix) { return NULL; }
-
-    return
-        &level->visibility.matrix[
-            s->index * BITMAP_SIZE_TO_BYTES(level->visibility.n)];
-}
-
 bool level_is_sector_visible_from(level_t *level, sector_t *a, sector_t *b) {
-    BITMAP *bits = get_visibility_map(level, a);
-    return bits && bitmap_get(bits, b->index);
+    return visibility_get(level, a, b->index);
 }
 
 // ORs visible sectors from sector s with bitmap contents
+// scratch must be able to hold level->visibility.n bits
 static void or_visible_sectors(
     level_t *level,
     sector_t *s,
-    BITMAP *bits) {
-    BITMAP *sect_bits = get_visibility_map(level, s);
+    BITMAP *bits,
+    BITMAP *scratch) {
+    // NOTE: can be NULL when level is loading
+    const BITMAP *sect_bits = visibility_row(level, s, scratch);
 
     if (!sect_bits) { return; }
 
-    int i = -1;
-    while (
-        (i = bitmap_find(
-                sect_bits,
-                dynlist_size(level->sectors),
-                i + 1, true)) != INT_MAX) {
-        // check if sector agrees
-        sector_t *other = level->sectors[i];
-        if (bitmap_get(get_visibility_map(level, other), s->index)) {
-            bitmap_set(bits, i);
-        }
-    }
+    // rows only hold pairs which both sectors agree on (see
+    // visibility_set_row), no need to check the other sector's row
+    bitmap_or(
+        bits,
+        sect_bits,
+        min(dynlist_size(level->sectors), level->visibility.n));
 }
 
 int level_get_visible_sectors(
@@ -1297,26 +1253,33 @@ int level_get_visible_sectors(
     BITMAP_DECL(bits, n_sectors);
     bitmap_fill(bits, n_sectors, 0);
 
+    BITMAP *scratch =
+        visibility_is_sparse(level) ?
+            bitmap_alloc(level->visibility.n)
+            : NULL;
+
     // fill with s
-    or_visible_sectors(level, s, bits);
+    or_visible_sectors(level, s, bits, scratch);
 
     if (flags & LEVEL_GET_VISIBLE_SECTORS_PORTALS) {
         // add any sectors visible from portals
         llist_each(sector_sides, &s->sides, it) {
             if ((it.el->flags & SIDE_FLAG_DISCONNECT)
                 && it.el->portal->sector) {
-                or_visible_sectors(level, it.el->portal->sector, bits);
+                or_visible_sectors(
+                    level, it.el->portal->sector, bits, scratch);
             }
         }
     }
 
     int n = 0;
-    int i = -1;
-    while ((i = bitmap_find(bits, n_sectors, i + 1, true)) != INT_MAX) {
+    bitmap_each_set(bits, n_sectors, i) {
         *dynlist_push(*out) = level->sectors[i];
         n++;
     }
 
+    if (scratch) { bitmap_free(scratch); }
+
     return n;
 }
 
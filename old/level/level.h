@@ -177,14 +177,6 @@ vertex_t *level_nearest_vertex(
     vec2s point,
     f32 *dist);
 
-// "updates" the sector of a point by searching in nearby sectors first to see
-// if they contain the point
-// returns SECTOR_NONE if the point is not in a sector
-sector_t *level_find_point_sector(
-    level_t *level,
-    vec2s point,
-    sector_t *sector);
-
 // nearest position to pos which is on a side
 void level_nearest_side_pos(
     const level_t *level,
@@ -8,6 +8,7 @@
 #include "util/dynlist.h"
 #include "util/dlist.h"
 #include "util/llist.h"
+#include "util/map.h"
 #include "config.h"
 #include "defs.h"
 
@@ -65,6 +66,14 @@ typedef struct vertex {
     LEVEL_DECL_STRUCT_FIELDS()
 } vertex_t;
 
+// inclusive range of block positions something is inserted into, see block.h
+typedef struct block_range {
+    ivec2s min, max;
+
+    // false if not in any blocks
+    bool valid;
+} block_range_t;
+
 typedef struct wall {
     // READ VALUES
 
@@ -85,7 +94,11 @@ typedef struct wall {
     vec2s normal;          // normal (right of v0 -> v1)
     vec2s d;               // v1 - v0
     f32 len;            // length(d)
+
+    // vertex positions as of last insertion into blocks, and the blocks
+    // spanned by them
     vec2s last_pos[2];
+    block_range_t blocks;
 
     LEVEL_DECL_STRUCT_FIELDS()
 } wall_t;
@@ -106,6 +119,7 @@ typedef struct side {
     side_func_type_index func_type;  // functional type
 
     int tag;                         // function tag
+    int tag_slot;                    // index in level->tag_lists[tag]
 
     int flags;                       // see SIDE_FLAG_*
     side_texinfo_t tex_info;         // sidetex overrides
@@ -232,6 +246,9 @@ typedef struct subsector {
     vec2s min, max;
     bool tag : 1;
 
+    // blocks this subsector is in
+    block_range_t blocks;
+
     // sector this sector was accessed from, used only when computing visibility
     subsector_t *from;
 } subsector_t;
@@ -254,6 +271,7 @@ typedef struct sector {
     int flags;                         // see SECTOR_FLAG_*
     sectmat_t *mat;                   // sector material
     int tag;                          // function tag, TAG_NONE if none
+    int tag_slot;                     // index in level->tag_lists[tag]
 
 #define SECTOR_FUNCDATA_MAXSIZE 16
     union {
@@ -264,6 +282,7 @@ typedef struct sector {
     // COMPUTED VALUES
     int n_sides;                // number of sides in sector
     vec2s min, max;             // minimum/maximum bounds of this sector
+    block_range_t blocks;       // blocks this sector is in
     DLIST(object_t) objects;    // objects in sector
     int n_decals;               // number of decals on sector
     LLIST(decal_t) decals;      // decals on sector
@@ -277,6 +296,10 @@ typedef struct sector {
     // NOTE: does not include neighbors via disconnected portals
     DYNLIST(struct sector*) neighbors;
 
+    // hash of subsector/portal geometry as of last recalculate, visibility is
+    // only recomputed when this changes. 0 if never computed.
+    hash_t vis_hash;
+
     // see renderer.c
     sector_render_t *render;
 
@@ -324,6 +347,7 @@ typedef struct decal {
     resource_t tex_base;          // base texture (does not change)
     ivec2s tex_offsets;           // texture offsets
     int tag;                      // function tag, TAG_NONE if none
+    int tag_slot;                 // index in level->tag_lists[tag]
 
 #define DECAL_FUNCDATA_MAXSIZE 8
     union {
@@ -337,6 +361,7 @@ typedef struct decal {
     // COMPUTED VALUES
     LLIST_NODE(decal_t) node;      // linked list of decals on side or sector
     resource_t tex;             // current render texture
+    atlas_handle_t tex_handle;  // of tex, see atlas_lookup_handle
 
     // see renderer.c
     decal_render_t *render;
@@ -384,6 +409,18 @@ typedef struct object {
     DLIST_NODE(object_t) block_list;
     actor_t *actor;
 
+    // broadphase cells this object is in, see level/broadphase.h
+    block_range_t cells;
+    u32 broadphase_stamp;
+
+    // index in level->awake_objects, -1 if asleep. consecutive updates for
+    // which the object has been at rest, see objects_update.
+    int awake_slot;
+    int rest_frames;
+
+    // of type->sprite, see atlas_lookup_handle
+    atlas_handle_t sprite_handle;
+
     sprite_render_t *render;
 
     LEVEL_DECL_STRUCT_FIELDS()
@@ -442,8 +479,78 @@ typedef struct block {
     DYNLIST(wall_t*) walls;
     DYNLIST(int) subsectors;
     DLIST(object_t) objects;
+
+    // block position
+    ivec2s pos;
 } block_t;
 
+// BLOCK_PAGE_SIZE x BLOCK_PAGE_SIZE dense blocks
+typedef struct block_page {
+    // page position, block position / BLOCK_PAGE_SIZE
+    ivec2s pos;
+
+    // row-major
+    block_t blocks[BLOCK_PAGE_SIZE * BLOCK_PAGE_SIZE];
+} block_page_t;
+
+// edge of the navigation graph, see level/nav.h
+typedef struct nav_edge {
+    // subsector id of destination node
+    int to;
+
+    // entry side if this edge goes through a disconnected portal, else NULL
+    side_t *portal;
+
+    // point at which the edge is crossed, on the side of the source node
+    vec2s cross;
+
+    // distance source -> cross -> destination, after portal_transform
+    f32 len;
+
+    // width of shared line/portal (INFINITY within a sector), floor height
+    // difference (destination - source) and min. ceiling - max. floor across
+    // the edge
+    f32 width, dz, clearance;
+} nav_edge_t;
+
+// node of the navigation graph, one per subsector
+typedef struct nav_node {
+    // centroid of subsector, NAN if there is no subsector for this id
+    vec2s pos;
+
+    DYNLIST(nav_edge_t) edges;
+
+    // (source node, edge index) of every edge which ends at this node
+    DYNLIST(ivec2s) in;
+
+    // search state, only valid if stamp == level->nav.stamp
+    u32 stamp;
+    bool closed;
+    int parent, parent_edge, heap_pos;
+    f32 g, f;
+} nav_node_t;
+
+// distances to the nearest of a set of goals for every navigation node, see
+// nav_field_update
+typedef struct nav_field {
+    // goal points and their subsector ids as of last build
+    DYNLIST(vec2s) goal_pos;
+    DYNLIST(int) goals;
+
+    // agent size and navigation graph version as of last build, version is -1
+    // if never built
+    f32 radius, height;
+    int version;
+
+    // by node: cost to nearest goal (INFINITY if unreachable) and index of
+    // edge to take towards it (-1 at goals and if unreachable)
+    DYNLIST(f32) dist;
+    DYNLIST(int) next;
+} nav_field_t;
+
+// list of actors linked through actor_t::listnode
+typedef DLIST(actor_t) actor_list_t;
+
 typedef struct level {
     // arbitrary "version" number, bumped whenever anything is recalc'd
     int version;
@@ -462,8 +569,45 @@ typedef struct level {
     DYNLIST(decal_t*) decals;
     DYNLIST(object_t*) objects;
 
-    // all actors in level
-    DLIST(actor_t) actors;
+    // objects by type, sorted by index, see object_find_type
+    DYNLIST(object_t*) objects_by_type[OT_COUNT];
+
+    // objects which are not at rest and are updated every frame, sorted by
+    // index unless awake_objects_unsorted. see object_wake.
+    DYNLIST(object_t*) awake_objects;
+    bool awake_objects_unsorted;
+
+    // all awake actors in level, in order of addition
+    actor_list_t actors;
+
+    // actor scheduling, see level/actor.h
+    struct {
+        // number of level ticks so far
+        u64 tick;
+
+        // sequence number for the next added actor
+        u32 next_seq;
+
+        // hierarchical timer wheel of actors sleeping for some number of
+        // ticks. each slot of wheel level n spans ACTOR_WHEEL_SLOTS^n ticks.
+        actor_list_t wheel[ACTOR_WHEEL_LEVELS][ACTOR_WHEEL_SLOTS];
+
+        // actors waiting on a tag value change, by tag
+        actor_list_t tag_waits[TAG_MAX];
+
+        // actors asleep until explicitly woken
+        actor_list_t asleep;
+
+        // actors woken since the last tick, not in any list
+        DYNLIST(actor_t*) woken;
+
+        // actor currently acting in actor_tick, NULL outside of it
+        actor_t *current;
+
+        // counters: actors awake, actors sleeping, actors woken
+        int n_awake, n_sleeping;
+        u64 wakes;
+    } sched;
 
     // TODO: doc for subsectors
     BITMAP *subsector_ids;
@@ -478,28 +622,114 @@ typedef struct level {
     // table of tag values
     int tag_values[TAG_MAX];
 
-    // lptr tag lists
+    // lptr tag lists, sectors first (tag_n_sectors[tag] of them) then other
+    // types in no particular order. elements know their index in their list,
+    // see tag_slot.
     DYNLIST(lptr_t) tag_lists[TAG_MAX];
+    int tag_n_sectors[TAG_MAX];
+
+    // bit set for tags with non-empty tag lists
+    BITMAP_DECL(tags_used, TAG_MAX);
 
-    // n x n visibility matrix bitmap
-    // where n is number of sectors rounded up to 64
+    // sector visibility, see level/visibility.h
+    // n is the row capacity, a power of two >= 64 which is doubled when the
+    // number of sectors exceeds it (never shrinks). up to VISIBILITY_DENSE_MAX
+    // this is a dense n x n bit matrix, past that rows are stored sparsely.
     struct {
         int n;
 
-        // BITMAP *matrix[n];
+        // BITMAP *matrix[n], NULL if sparse
         u8 *matrix;
+
+        // DYNLIST(u32) runs[n], sorted [start, end) pairs of visible sector
+        // indices per row, NULL if dense
+        DYNLIST(u32) *runs;
+
+        // DYNLIST(u32) traced[n], runs of each sector's own most recent trace.
+        // rows only hold the pairs which both sectors' traces agree on
+        DYNLIST(u32) *traced;
+
+        // true if rows are from visibility_bake and have not been recomputed
+        // since, only then are they saved with the level
+        bool baked;
     } visibility;
 
-    // level bounds, also define bounds for "blocks" array
+    // level bounds, also define bounds for block traversal
+    // NOTE: only grow, never shrink until level is reloaded
     struct {
         ivec2s min, max;
     } bounds;
 
-    // 2D array of collision blocks
+    // sparse grid of collision blocks, allocated in pages as blocks are
+    // written to so that empty regions of the level cost nothing
     struct {
-        block_t *arr;
-        ivec2s offset, size;
+        // u64 packed page pos -> block_page_t*
+        map_t pages;
+
+        // most recently accessed page
+        block_page_t *last;
+
+        // false while level is loading and blocks cannot be relied upon
+        bool ready;
     } blocks;
+
+    // uniform hash grid of objects for object/object collision, see
+    // level/broadphase.h
+    struct {
+        // u64 packed cell pos -> DYNLIST(object_t*)
+        map_t cells;
+
+        // bumped for every query, objects whose broadphase_stamp matches are
+        // already in the results of the current query
+        u32 stamp;
+
+        // reused output list for queries whose results are consumed before
+        // anything else can query again (collide_objects, path_trace)
+        DYNLIST(object_t*) scratch;
+    } broadphase;
+
+    // navigation graph over subsectors, see level/nav.h
+    struct {
+        // nodes by subsector id, rebuilt whenever level version changes
+        DYNLIST(nav_node_t) nodes;
+
+        // level version which nodes were built for, -1 if never built
+        int version;
+
+        // entry sides of all disconnected portals, for the search heuristic
+        DYNLIST(side_t*) portals;
+
+        // open set: binary min-heap of node indices ordered by f
+        DYNLIST(int) heap;
+
+        // bumped for every search, invalidates node search state
+        u32 stamp;
+
+        // counters: searches done, nodes expanded
+        u64 queries, expanded;
+
+        // fields towards the player shared by all chasing actors of the same
+        // size, see nav_player_field. stamp is bumped for every call, last_use
+        // is the stamp of the last call which returned each field
+        nav_field_t player_fields[NAV_PLAYER_FIELDS];
+        u32 player_field_stamp, player_field_last_use[NAV_PLAYER_FIELDS];
+    } nav;
+
+    // line of sight cache, see level/los.h
+    struct {
+        // u64 packed (origin index, target index) -> los_entry_t*
+        map_t entries;
+
+        // level version for which has_disconnect was computed
+        int disconnect_version;
+
+        // true if any side is a disconnected portal, sector visibility does
+        // not account for these so it cannot be used for early rejection
+        bool has_disconnect;
+
+        // counters: results reused, traces done, rejections via visibility
+        u64 hits, misses, rejects;
+    } los;
 } level_t;
 
 // actor flags
@@ -509,18 +739,41 @@ enum {
     AF_DONE         = 1 << 1
 };
 
+// actor scheduling states, see level/actor.h
+enum {
+    ACTOR_STATE_AWAKE = 0,
+    ACTOR_STATE_TIMER,
+    ACTOR_STATE_TAG,
+    ACTOR_STATE_ASLEEP,
+    ACTOR_STATE_WOKEN
+};
+
 // actor "act" function
 typedef void (*actor_f)(level_t*, actor_t*, void*);
 
 // actor, see l_add_actor
-// act is called at level tick rate until flags & AF_DONE
+// act is called at level tick rate until flags & AF_DONE, unless sleeping
 typedef struct actor {
+    // node in "list", which is level->actors or the schedule list for the
+    // actor's state. NULL if the actor is in no list (ACTOR_STATE_WOKEN).
     DLIST_NODE(struct actor) listnode;
+    actor_list_t *list;
     actor_t **storage; // pointer to where actor is stored on its acted-on
                        // level element. fx. sector_t::actor
     void *param;
     u8 flags;
     actor_f act;
+
+    // ACTOR_STATE_*, and state requested by actor_sleep/actor_wait_tag which
+    // is entered once the actor is done acting
+    u8 state, request;
+
+    // order of addition, awake actors always act in this order
+    u32 seq;
+
+    // tick to wake at (ACTOR_STATE_TIMER) or tag waited on (ACTOR_STATE_TAG)
+    u64 wake_tick;
+    int wait_tag;
 } actor_t;
 
 typedef void (*object_update_f)(level_t*, object_t*);
@@ -0,0 +1,248 @@
+#include "level/locate.h"
+#include "level/block.h"
+#include "level/level.h"
+#include "level/sector.h"
+#include "util/bitmap.h"
+
+// #define DO_VERIFY_FIND_POINT
+
+#ifdef DO_VERIFY_FIND_POINT
+#include "util/time.h"
+#endif // ifdef DO_VERIFY_FIND_POINT
+
+// point location without subsector walking: BFS through portals or linear
+// search if there are no blocks, otherwise check every sector in the block
+static sector_t *find_point_sector_slow(
+    level_t *level,
+    vec2s point,
+    sector_t *sector) {
+    if (sector && sector_contains_point(sector, point)) {
+        return sector;
+    }
+
+    if (!level->blocks.ready) {
+        // use only current sector data, cannot rely on blocks
+        if (!sector) {
+            // fall back to simple linear search
+            level_dynlist_each(level->sectors, it) {
+                sector_t *s = *it.el;
+
+                if (point.x < s->min.x
+                    || point.x > s->max.x
+                    || point.y < s->min.y
+                    || point.y > s->max.y) {
+                    continue;
+                }
+
+                if (sector_contains_point(s, point)) {
+                    return (sector_t*) s;
+                }
+            }
+
+            return NULL;
+        } else {
+            // BFS neighbors in a circular queue, point is likely to be in one
+            // of the neighboring sectors
+            enum { QUEUE_MAX = 64 };
+            sector_t *queue[QUEUE_MAX] = { sector };
+            int i = 0, n = 1;
+
+            // keep track of which sectors have been traversed
+            const int nsectors = dynlist_size(level->sectors);
+            BITMAP_DECL(hits, nsectors);
+            bitmap_fill(hits, nsectors, false);
+
+            while (n != 0) {
+                // get front of queue and advance to next
+                sector_t *sect = queue[i];
+                i = (i + 1) % (QUEUE_MAX);
+                n--;
+
+                if (bitmap_get(hits, sect->index)) {
+                    continue;
+                }
+
+                bitmap_set(hits, sect->index);
+
+                if (sector_contains_point(sect, point)) {
+                    return sect;
+                }
+
+                // check neighbors
+                llist_each(sector_sides, &sect->sides, it) {
+                    if (it.el->portal
+                        && it.el->portal->sector
+                        && !bitmap_get(hits, it.el->portal->sector->index)) {
+                        if (n == QUEUE_MAX) {
+                            WARN("l_find_point_sector out of queue space!");
+                            return NULL;
+                        }
+
+                        queue[(i + n) % QUEUE_MAX] = it.el->portal->sector;
+                        n++;
+                    }
+                }
+            }
+        }
+    } else {
+        // block data is OK, use it
+        block_t *block =
+            level_get_block(level, level_pos_to_block(point));
+
+        if (!block) {
+            return NULL;
+            LOG("no block for find point");
+            DUMPTRACE();
+        }
+
+        // TODO: better
+        dynlist_each(block->sectors, it) {
+            if (sector_contains_point(*it.el, point)) {
+                return *it.el;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+// walk from subsector "sub" towards point by repeatedly crossing the line which
+// point is furthest outside of. returns NULL if the walk runs into a line with
+// no neighbor (wall, T-junction) or takes too long
+static subsector_t *walk_point_subsector(
+    level_t *level,
+    vec2s point,
+    subsector_t *sub) {
+    // subsectors are convex, so this only runs long on strange geometry
+    enum { WALK_MAX = 64 };
+
+    for (int n = 0; sub && n < WALK_MAX; n++) {
+        // point is inside if it is left of or on every line
+        sect_line_t *line = NULL;
+        f32 d_line = 0.0f;
+        dynlist_each(sub->lines, it) {
+            const vec2s a = it.el->a->pos, b = it.el->b->pos;
+            const f32 d =
+                point_side(point, a, b) / glms_vec2_distance(a, b);
+
+            if (d < d_line) {
+                line = it.el;
+                d_line = d;
+            }
+        }
+
+        if (!line) {
+            return sub;
+        }
+
+        subsector_t *next = NULL;
+        dynlist_each(sub->neighbors, it) {
+            if (it.el->line == line) {
+                next = level->subsectors[it.el->id];
+                break;
+            }
+        }
+
+        sub = next;
+    }
+
+    return NULL;
+}
+
+subsector_t *level_find_point_subsector(
+    level_t *level,
+    vec2s point,
+    subsector_t *sub) {
+    subsector_t *res = walk_point_subsector(level, point, sub);
+
+    if (!res) {
+        sector_t *sector =
+            find_point_sector_slow(level, point, sub ? sub->parent : NULL);
+        res = sector ? sector_find_subsector(sector, point) : NULL;
+    }
+
+    return res;
+}
+
+static sector_t *find_point_sector_hinted(
+    level_t *level,
+    vec2s point,
+    sector_t *sector) {
+    if (!sector || dynlist_size(sector->subs) == 0) {
+        return find_point_sector_slow(level, point, sector);
+    }
+
+    // start from subsector with the nearest bounding box, which usually
+    // already contains point
+    subsector_t *start = NULL;
+    f32 d_start = 1e30f;
+    dynlist_each(sector->subs, it) {
+        const vec2s d =
+            glms_vec2_maxv(
+                glms_vec2_sub(it.el->min, point),
+                glms_vec2_sub(point, it.el->max));
+        const f32 d2 = glms_vec2_norm2(glms_vec2_maxv(d, GLMS_VEC2_ZERO));
+
+        if (d2 < d_start) {
+            start = it.el;
+            d_start = d2;
+
+            if (d2 == 0.0f) { break; }
+        }
+    }
+
+    subsector_t *sub = walk_point_subsector(level, point, start);
+    return sub ? sub->parent : find_point_sector_slow(level, point, sector);
+}
+
+#ifdef DO_VERIFY_FIND_POINT
+// checks hinted point location against an unhinted search on every call and
+// periodically logs how long each took
+static sector_t *verify_find_point_sector(
+    level_t *level,
+    vec2s point,
+    sector_t *sector) {
+    static u64 n_calls, ns_hinted, ns_slow;
+
+    u64 start = time_ns();
+    sector_t *res = find_point_sector_hinted(level, point, sector);
+    ns_hinted += time_ns() - start;
+
+    start = time_ns();
+    sector_t *expected = find_point_sector_slow(level, point, NULL);
+    ns_slow += time_ns() - start;
+
+    // points on shared lines can legitimately be found in either sector, so
+    // only require that the result actually contains the point
+    if (!res != !expected
+        || (res && !sector_contains_point(res, point))) {
+        WARN(
+            "find point sector mismatch at (%f, %f): got %d, expected %d",
+            point.x, point.y,
+            res ? res->index : -1,
+            expected ? expected->index : -1);
+    }
+
+    if (++n_calls % 100000 == 0) {
+        LOG(
+            "find point sector: %" PRIu64 " calls, hinted %.1f ns/call, "
+            "unhinted %.1f ns/call",
+            n_calls,
+            ns_hinted / (f64) n_calls,
+            ns_slow / (f64) n_calls);
+    }
+
+    return res;
+}
+#endif // ifdef DO_VERIFY_FIND_POINT
+
+sector_t *level_find_point_sector(
+    level_t *level,
+    vec2s point,
+    sector_t *sector) {
+#ifdef DO_VERIFY_FIND_POINT
+    return verify_find_point_sector(level, point, sector);
+#else
+    return find_point_sector_hinted(level, point, sector);
+#endif // ifdef DO_VERIFY_FIND_POINT
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "util/math.h"
+#include "defs.h"
+
+// "updates" the sector of a point by walking across subsectors from "sector"
+// (the last known sector of the point, if any) and falling back to searching
+// blocks if that fails
+// returns SECTOR_NONE if the point is not in a sector
+sector_t *level_find_point_sector(
+    level_t *level,
+    vec2s point,
+    sector_t *sector);
+
+// like level_find_point_sector, but starts walking at (and returns) a subsector
+// returns NULL if the point is not in a subsector
+subsector_t *level_find_point_subsector(
+    level_t *level,
+    vec2s point,
+    subsector_t *sub);
@@ -0,0 +1,186 @@
+#include "level/los.h"
+#include "level/level_defs.h"
+#include "level/level.h"
+#include "level/path.h"
+#include "level/side.h"
+#include "util/map.h"
+
+// cached result of one (origin, target) line of sight check
+typedef struct {
+    // generations of origin/target, detects reuse of object indices
+    u8 gen[2];
+    sector_t *sectors[2];
+    ivec2s buckets[2];
+    int z_bucket;
+    int version;
+    bool result;
+} los_entry_t;
+
+ALWAYS_INLINE ivec2s pos_to_bucket(vec2s pos) {
+    return IVEC2(
+        (int) floorf(pos.x / LOS_BUCKET_SIZE),
+        (int) floorf(pos.y / LOS_BUCKET_SIZE));
+}
+
+typedef struct {
+    object_t *origin;
+    bool result;
+} sightline_data_t;
+
+static int resolve_sightline(
+    level_t *level,
+    const path_hit_t *hit,
+    vec2s *from,
+    vec2s *to,
+    sightline_data_t *data) {
+    bool stopped = true;
+
+    side_t *portal = hit->wall.side->portal;
+
+    if (portal && portal->sector) {
+        side_segment_t segs[4];
+        side_get_segments(hit->wall.side, segs);
+
+        // TODO: use a more refined "eye height"
+        if (segs[SIDE_SEGMENT_MIDDLE].present
+            && data->origin->z + data->origin->type->height
+                >= segs[SIDE_SEGMENT_MIDDLE].z0
+            && data->origin->z + data->origin->type->height
+                <= segs[SIDE_SEGMENT_MIDDLE].z1) {
+            stopped = false;
+        }
+    }
+
+    int res = PATH_TRACE_CONTINUE;
+    f32 portal_angle = 0.0f;
+    if (path_trace_resolve_portal(
+            level, hit, from, to, &res, &portal_angle,
+            PATH_TRACE_RESOLVE_PORTAL_NONE)) {
+        return res;
+    }
+
+    // do not process further collisions
+    if (!stopped) {
+        return PATH_TRACE_CONTINUE;
+    }
+
+    data->result = false;
+    return PATH_TRACE_STOP;
+}
+
+static bool trace_sightline(
+    level_t *level,
+    object_t *origin,
+    object_t *target) {
+    sightline_data_t data = { .origin = origin, .result = true };
+    vec2s from = origin->pos, to = target->pos;
+    path_trace(
+        level,
+        &from,
+        &to,
+        0.0f,
+        (path_trace_resolve_f) resolve_sightline,
+        &data,
+        PATH_TRACE_NONE);
+    return data.result;
+}
+
+// true if sector visibility can be trusted to reject sightlines
+static bool can_reject_with_visibility(level_t *level) {
+    // visibility is only up to date once dirty sectors have been processed
+    if (dynlist_size(level->dirty_vis_sectors) != 0) {
+        return false;
+    }
+
+    // sector visibility does not see through disconnected portals, but traces
+    // do. only rescan sides when something has changed.
+    if (level->los.disconnect_version != level->version) {
+        level->los.disconnect_version = level->version;
+        level->los.has_disconnect = false;
+
+        level_dynlist_each(level->sides, it) {
+            if ((*it.el)->flags & SIDE_FLAG_DISCONNECT) {
+                level->los.has_disconnect = true;
+                break;
+            }
+        }
+    }
+
+    return !level->los.has_disconnect;
+}
+
+void los_init(level_t *level) {
+    map_init(
+        &level->los.entries,
+        map_hash_u64,
+        NULL, NULL, map_dup_u64,
+        map_cmp_u64,
+        map_default_free,
+        map_default_free,
+        NULL);
+    level->los.disconnect_version = -1;
+}
+
+void los_destroy(level_t *level) {
+    map_destroy(&level->los.entries);
+}
+
+bool los_check(level_t *level, object_t *origin, object_t *target) {
+    if (origin->sector
+        && target->sector
+        && origin->sector != target->sector
+        && can_reject_with_visibility(level)
+        && !level_is_sector_visible_from(
+            level, target->sector, origin->sector)) {
+        level->los.rejects++;
+        return false;
+    }
+
+    const u64 key = map_ivec2_to_u64(IVEC2(origin->index, target->index));
+
+    const los_entry_t current = {
+        .gen = { origin->gen, target->gen },
+        .sectors = { origin->sector, target->sector },
+        .buckets = {
+            pos_to_bucket(origin->pos),
+            pos_to_bucket(target->pos)
+        },
+        .z_bucket = (int) floorf(origin->z / LOS_BUCKET_SIZE),
+        .version = level->version,
+    };
+
+    los_entry_t **pentry = map_find(los_entry_t*, &level->los.entries, &key);
+    los_entry_t *entry = pentry ? *pentry : NULL;
+
+    if (entry
+        && entry->gen[0] == current.gen[0]
+        && entry->gen[1] == current.gen[1]
+        && entry->sectors[0] == current.sectors[0]
+        && entry->sectors[1] == current.sectors[1]
+        && entry->buckets[0].x == current.buckets[0].x
+        && entry->buckets[0].y == current.buckets[0].y
+        && entry->buckets[1].x == current.buckets[1].x
+        && entry->buckets[1].y == current.buckets[1].y
+        && entry->z_bucket == current.z_bucket
+        && entry->version == current.version) {
+        level->los.hits++;
+        return entry->result;
+    }
+
+    level->los.misses++;
+
+    if (!entry) {
+        // entries for deleted objects are never removed, so just start over
+        // once there are too many
+        if (map_size(&level->los.entries) >= LOS_CACHE_MAX) {
+            map_clear(&level->los.entries);
+        }
+
+        entry = malloc(sizeof(*entry));
+        map_insert(&level->los.entries, &key, entry);
+    }
+
+    *entry = current;
+    entry->result = trace_sightline(level, origin, target);
+    return entry->result;
+}
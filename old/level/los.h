@@ -0,0 +1,14 @@
+#pragma once
+
+#include "defs.h"
+
+// initialize/destroy line of sight cache, see level_init/level_destroy
+void los_init(level_t *level);
+void los_destroy(level_t *level);
+
+// true if "origin" can see "target" from its eye height
+// rejects early if target's sector is not visible from origin's, otherwise
+// reuses the last result for this pair as long as neither object has changed
+// sector or LOS_BUCKET_SIZE bucket and the level version is unchanged. only
+// then is a sightline actually traced.
+bool los_check(level_t *level, object_t *origin, object_t *target);
@@ -0,0 +1,650 @@
+#include "level/nav.h"
+#include "level/level_defs.h"
+#include "level/level.h"
+#include "level/locate.h"
+#include "level/portal.h"
+#include "level/sector.h"
+#include "level/side.h"
+#include "level/wall.h"
+
+// #define DO_VERIFY_NAV
+
+#ifdef DO_VERIFY_NAV
+#include "util/time.h"
+#endif // ifdef DO_VERIFY_NAV
+
+static bool line_is_wall(const sect_line_t *line, const wall_t *wall) {
+    return
+        (glms_vec2_eqv_eps(line->a->pos, wall->v0->pos)
+         && glms_vec2_eqv_eps(line->b->pos, wall->v1->pos))
+        || (glms_vec2_eqv_eps(line->a->pos, wall->v1->pos)
+            && glms_vec2_eqv_eps(line->b->pos, wall->v0->pos));
+}
+
+// side of sector which lies along line, NULL if there is none
+static side_t *find_line_side(sector_t *sector, const sect_line_t *line) {
+    llist_each(sector_sides, &sector->sides, it) {
+        if (line_is_wall(line, it.el->wall)) {
+            return it.el;
+        }
+    }
+
+    return NULL;
+}
+
+// subsector of sector which has a line along wall, NULL if there is none
+static subsector_t *find_wall_subsector(sector_t *sector, const wall_t *wall) {
+    dynlist_each(sector->subs, it) {
+        dynlist_each(it.el->lines, it_l) {
+            if (line_is_wall(it_l.el, wall)) {
+                return it.el;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+static void edge_set_heights(
+    const sector_t *from,
+    const sector_t *to,
+    nav_edge_t *edge) {
+    edge->dz = to->floor.z - from->floor.z;
+    edge->clearance =
+        min(from->ceil.z, to->ceil.z) - max(from->floor.z, to->floor.z);
+}
+
+static void clear_nodes(level_t *level) {
+    dynlist_each(level->nav.nodes, it) {
+        dynlist_free(it.el->edges);
+        dynlist_free(it.el->in);
+    }
+
+    dynlist_resize(level->nav.nodes, 0);
+    dynlist_resize(level->nav.portals, 0);
+}
+
+void nav_init(level_t *level) {
+    level->nav.version = -1;
+
+    for (int i = 0; i < NAV_PLAYER_FIELDS; i++) {
+        nav_field_init(&level->nav.player_fields[i]);
+    }
+}
+
+void nav_destroy(level_t *level) {
+    for (int i = 0; i < NAV_PLAYER_FIELDS; i++) {
+        nav_field_destroy(&level->nav.player_fields[i]);
+    }
+
+    clear_nodes(level);
+    dynlist_free(level->nav.nodes);
+    dynlist_free(level->nav.portals);
+    dynlist_free(level->nav.heap);
+}
+
+void nav_update(level_t *level) {
+    if (level->nav.version == level->version) {
+        return;
+    }
+
+    level->nav.version = level->version;
+    clear_nodes(level);
+
+    const int n = dynlist_size(level->subsectors);
+    dynlist_resize(level->nav.nodes, n);
+
+    nav_node_t *nodes = level->nav.nodes;
+
+    for (int i = 0; i < n; i++) {
+        nodes[i] = (nav_node_t) { .pos = VEC2(NAN) };
+
+        const subsector_t *sub = level->subsectors[i];
+        if (!sub) { continue; }
+
+        vec2s sum = VEC2(0);
+        dynlist_each(sub->lines, it) {
+            sum = glms_vec2_add(sum, it.el->a->pos);
+        }
+
+        nodes[i].pos = glms_vec2_divs(sum, dynlist_size(sub->lines));
+    }
+
+    // edges across lines shared with neighbors. within a sector these are
+    // always open, between sectors only if the line is a (connected) portal
+    for (int i = 0; i < n; i++) {
+        subsector_t *sub = level->subsectors[i];
+        if (!sub) { continue; }
+
+        dynlist_each(sub->neighbors, it) {
+            subsector_t *other = level->subsectors[it.el->id];
+            if (!other) { continue; }
+
+            if (other->parent != sub->parent) {
+                const side_t *side = find_line_side(sub->parent, it.el->line);
+
+                if (!side
+                    || !side->portal
+                    || side->portal != side_other(side)
+                    || side->portal->sector != other->parent) {
+                    continue;
+                }
+            }
+
+            const sect_line_t *line = it.el->line;
+
+            // lines between subsectors of the same sector only come from
+            // splitting it into convex pieces and don't narrow anything, an
+            // agent which fits into the sector fits across them
+            nav_edge_t edge = {
+                .to = other->id,
+                .portal = NULL,
+                .cross =
+                    glms_vec2_scale(
+                        glms_vec2_add(line->a->pos, line->b->pos), 0.5f),
+                .width =
+                    other->parent == sub->parent ?
+                        INFINITY
+                        : glms_vec2_distance(line->a->pos, line->b->pos),
+            };
+
+            edge.len =
+                glms_vec2_distance(nodes[i].pos, edge.cross)
+                    + glms_vec2_distance(edge.cross, nodes[other->id].pos);
+
+            edge_set_heights(sub->parent, other->parent, &edge);
+            *dynlist_push(nodes[i].edges) = edge;
+        }
+    }
+
+    // edges through disconnected portals, which are not neighbors
+    level_dynlist_each(level->sides, it) {
+        side_t *side = *it.el;
+
+        if (!(side->flags & SIDE_FLAG_DISCONNECT)
+            || !side->sector
+            || !side->portal
+            || !side->portal->sector) {
+            continue;
+        }
+
+        subsector_t
+            *from = find_wall_subsector(side->sector, side->wall),
+            *to = find_wall_subsector(side->portal->sector, side->portal->wall);
+
+        if (!from || !to) {
+            WARN(
+                "no subsector for disconnected portal on side %d",
+                side->index);
+            continue;
+        }
+
+        const vec2s
+            cross = wall_midpoint(side->wall),
+            exit = portal_transform(level, side, side->portal, cross);
+
+        nav_edge_t edge = {
+            .to = to->id,
+            .portal = side,
+            .cross = cross,
+            .len =
+                glms_vec2_distance(nodes[from->id].pos, cross)
+                    + glms_vec2_distance(exit, nodes[to->id].pos),
+            .width = min(side->wall->len, side->portal->wall->len),
+        };
+
+        edge_set_heights(side->sector, side->portal->sector, &edge);
+        *dynlist_push(nodes[from->id].edges) = edge;
+        *dynlist_push(level->nav.portals) = side;
+    }
+
+    // reverse edges for flow fields
+    for (int i = 0; i < n; i++) {
+        dynlist_each(nodes[i].edges, it) {
+            *dynlist_push(nodes[it.el->to].in) = IVEC2(i, it.i);
+        }
+    }
+}
+
+// cost of edge for an agent, INFINITY if it cannot be crossed
+static f32 edge_cost(const nav_edge_t *edge, f32 radius, f32 height) {
+    if (edge->width < 2.0f * radius
+        || edge->clearance < height
+        || edge->dz > NAV_STEP_HEIGHT) {
+        return INFINITY;
+    }
+
+    return edge->len + (fabsf(edge->dz) * NAV_STEP_COST);
+}
+
+// lower bound for cost from pos to goal. edge lengths are at least the
+// distance between node positions, but a path through a disconnected portal
+// can end up anywhere once it reaches the portal's entry
+static f32 heuristic(const level_t *level, vec2s pos, vec2s goal) {
+    f32 h = glms_vec2_distance(pos, goal);
+
+    dynlist_each(level->nav.portals, it) {
+        h = min(h, glms_vec2_distance(pos, wall_midpoint((*it.el)->wall)));
+    }
+
+    return h;
+}
+
+// true if node a should be popped before node b, ties broken by index so that
+// paths do not depend on heap history
+ALWAYS_INLINE bool node_before(const level_t *level, int a, int b) {
+    const nav_node_t *nodes = level->nav.nodes;
+    return nodes[a].f < nodes[b].f || (nodes[a].f == nodes[b].f && a < b);
+}
+
+static void heap_swap(level_t *level, int i, int j) {
+    int *heap = level->nav.heap;
+    const int t = heap[i];
+    heap[i] = heap[j];
+    heap[j] = t;
+    level->nav.nodes[heap[i]].heap_pos = i;
+    level->nav.nodes[heap[j]].heap_pos = j;
+}
+
+static void heap_up(level_t *level, int i) {
+    while (i > 0) {
+        const int parent = (i - 1) / 2;
+
+        if (!node_before(level, level->nav.heap[i], level->nav.heap[parent])) {
+            break;
+        }
+
+        heap_swap(level, i, parent);
+        i = parent;
+    }
+}
+
+static void heap_down(level_t *level, int i) {
+    const int n = dynlist_size(level->nav.heap);
+
+    while (true) {
+        const int l = (2 * i) + 1, r = l + 1;
+        int first = i;
+
+        if (l < n
+            && node_before(level, level->nav.heap[l], level->nav.heap[first])) {
+            first = l;
+        }
+
+        if (r < n
+            && node_before(level, level->nav.heap[r], level->nav.heap[first])) {
+            first = r;
+        }
+
+        if (first == i) {
+            break;
+        }
+
+        heap_swap(level, i, first);
+        i = first;
+    }
+}
+
+static void heap_push(level_t *level, int node) {
+    *dynlist_push(level->nav.heap) = node;
+    level->nav.nodes[node].heap_pos = dynlist_size(level->nav.heap) - 1;
+    heap_up(level, level->nav.nodes[node].heap_pos);
+}
+
+static int heap_pop(level_t *level) {
+    const int top = level->nav.heap[0], last = dynlist_pop(level->nav.heap);
+
+    if (dynlist_size(level->nav.heap) != 0) {
+        level->nav.heap[0] = last;
+        level->nav.nodes[last].heap_pos = 0;
+        heap_down(level, 0);
+    }
+
+    level->nav.nodes[top].heap_pos = -1;
+    return top;
+}
+
+// find subsector for point, trying hint sector first
+static subsector_t *find_subsector(level_t *level, vec2s p, sector_t *hint) {
+    subsector_t *sub = hint ? sector_find_subsector(hint, p) : NULL;
+    return sub ? sub : level_find_point_subsector(level, p, NULL);
+}
+
+// appends path ending at node "goal" to "path"
+static void append_path(
+    level_t *level,
+    int goal,
+    vec2s to,
+    DYNLIST(nav_waypoint_t) *path) {
+    const nav_node_t *nodes = level->nav.nodes;
+
+    int n = 0;
+    for (int i = goal; nodes[i].parent != -1; i = nodes[i].parent) {
+        n++;
+    }
+
+    const int start = dynlist_size(*path);
+    dynlist_resize(*path, start + n + 1);
+
+    (*path)[start + n] = (nav_waypoint_t) { .pos = to, .portal = NULL };
+
+    for (int i = goal, j = start + n - 1;
+         nodes[i].parent != -1;
+         i = nodes[i].parent, j--) {
+        const nav_edge_t *edge =
+            &nodes[nodes[i].parent].edges[nodes[i].parent_edge];
+
+        (*path)[j] =
+            (nav_waypoint_t) { .pos = edge->cross, .portal = edge->portal };
+    }
+}
+
+bool nav_find_path(
+    level_t *level,
+    vec2s from,
+    sector_t *from_sector,
+    vec2s to,
+    sector_t *to_sector,
+    f32 radius,
+    f32 height,
+    DYNLIST(nav_waypoint_t) *path) {
+#ifdef DO_VERIFY_NAV
+    const u64 t_start = time_ns();
+    const u64 expanded_start = level->nav.expanded;
+#endif // ifdef DO_VERIFY_NAV
+
+    nav_update(level);
+
+    subsector_t
+        *start = find_subsector(level, from, from_sector),
+        *goal = find_subsector(level, to, to_sector);
+
+    if (!start || !goal) {
+        return false;
+    }
+
+    level->nav.queries++;
+
+    nav_node_t *nodes = level->nav.nodes;
+    const u32 stamp = ++level->nav.stamp;
+    const vec2s goal_pos = nodes[goal->id].pos;
+
+    dynlist_resize(level->nav.heap, 0);
+
+    nav_node_t *s = &nodes[start->id];
+    s->stamp = stamp;
+    s->closed = false;
+    s->parent = -1;
+    s->parent_edge = -1;
+    s->heap_pos = -1;
+    s->g = 0.0f;
+    s->f = heuristic(level, s->pos, goal_pos);
+
+    heap_push(level, start->id);
+
+    bool found = false;
+    while (dynlist_size(level->nav.heap) != 0) {
+        const int i = heap_pop(level);
+        nav_node_t *node = &nodes[i];
+        node->closed = true;
+        level->nav.expanded++;
+
+        if (i == goal->id) {
+            found = true;
+            break;
+        }
+
+        dynlist_each(node->edges, it) {
+            const f32 cost = edge_cost(it.el, radius, height);
+            if (isinf(cost)) { continue; }
+
+            nav_node_t *next = &nodes[it.el->to];
+
+            if (next->stamp != stamp) {
+                next->stamp = stamp;
+                next->closed = false;
+                next->heap_pos = -1;
+                next->g = INFINITY;
+            }
+
+            const f32 g = node->g + cost;
+            if (next->closed || g >= next->g) {
+                continue;
+            }
+
+            next->g = g;
+            next->f = g + heuristic(level, next->pos, goal_pos);
+            next->parent = i;
+            next->parent_edge = it.i;
+
+            if (next->heap_pos == -1) {
+                heap_push(level, it.el->to);
+            } else {
+                heap_up(level, next->heap_pos);
+            }
+        }
+    }
+
+    if (found) {
+        append_path(level, goal->id, to, path);
+    }
+
+#ifdef DO_VERIFY_NAV
+    static u64 n_queries, ns_total, n_expanded;
+    n_queries++;
+    ns_total += time_ns() - t_start;
+    n_expanded += level->nav.expanded - expanded_start;
+
+    if (n_queries % 1000 == 0) {
+        LOG(
+            "nav: %d nodes, %d portals, %.1f us/query, %.1f nodes/query",
+            (int) dynlist_size(level->nav.nodes),
+            (int) dynlist_size(level->nav.portals),
+            (ns_total / (f64) n_queries) / 1000.0,
+            n_expanded / (f64) n_queries);
+    }
+#endif // ifdef DO_VERIFY_NAV
+
+    return found;
+}
+
+void nav_field_init(nav_field_t *field) {
+    *field = (nav_field_t) { .version = -1 };
+}
+
+void nav_field_destroy(nav_field_t *field) {
+    dynlist_free(field->goal_pos);
+    dynlist_free(field->goals);
+    dynlist_free(field->dist);
+    dynlist_free(field->next);
+}
+
+nav_field_t *nav_player_field(level_t *level, f32 radius, f32 height) {
+    const u32 stamp = ++level->nav.player_field_stamp;
+
+    // field for exactly this size, otherwise replace least recently used
+    int i_lru = 0;
+    for (int i = 0; i < NAV_PLAYER_FIELDS; i++) {
+        nav_field_t *field = &level->nav.player_fields[i];
+
+        if (field->version != -1
+            && field->radius == radius
+            && field->height == height) {
+            level->nav.player_field_last_use[i] = stamp;
+            return field;
+        }
+
+        if (stamp - level->nav.player_field_last_use[i]
+                > stamp - level->nav.player_field_last_use[i_lru]) {
+            i_lru = i;
+        }
+    }
+
+    level->nav.player_field_last_use[i_lru] = stamp;
+    return &level->nav.player_fields[i_lru];
+}
+
+// multi-source dijkstra from field goals along reversed edges
+static void field_flood(level_t *level, nav_field_t *field) {
+    nav_node_t *nodes = level->nav.nodes;
+    const int n = dynlist_size(nodes);
+    const u32 stamp = ++level->nav.stamp;
+
+    dynlist_resize(field->dist, n);
+    dynlist_resize(field->next, n);
+
+    for (int i = 0; i < n; i++) {
+        field->dist[i] = INFINITY;
+        field->next[i] = -1;
+    }
+
+    dynlist_resize(level->nav.heap, 0);
+
+    dynlist_each(field->goals, it) {
+        if (*it.el == -1) { continue; }
+
+        nav_node_t *node = &nodes[*it.el];
+        if (node->stamp == stamp) { continue; }
+
+        node->stamp = stamp;
+        node->closed = false;
+        node->g = node->f = 0.0f;
+        node->heap_pos = -1;
+        heap_push(level, *it.el);
+    }
+
+    while (dynlist_size(level->nav.heap) != 0) {
+        const int i = heap_pop(level);
+        nav_node_t *node = &nodes[i];
+        node->closed = true;
+        field->dist[i] = node->g;
+        level->nav.expanded++;
+
+        dynlist_each(node->in, it) {
+            const int j = it.el->x;
+            const nav_edge_t *edge = &nodes[j].edges[it.el->y];
+
+            const f32 cost = edge_cost(edge, field->radius, field->height);
+            if (isinf(cost)) { continue; }
+
+            nav_node_t *prev = &nodes[j];
+
+            if (prev->stamp != stamp) {
+                prev->stamp = stamp;
+                prev->closed = false;
+                prev->heap_pos = -1;
+                prev->g = INFINITY;
+            }
+
+            const f32 g = node->g + cost;
+            if (prev->closed || g >= prev->g) {
+                continue;
+            }
+
+            prev->g = g;
+            prev->f = g;
+            field->next[j] = it.el->y;
+
+            if (prev->heap_pos == -1) {
+                heap_push(level, j);
+            } else {
+                heap_up(level, prev->heap_pos);
+            }
+        }
+    }
+}
+
+void nav_field_update(
+    level_t *level,
+    nav_field_t *field,
+    const vec2s *goals,
+    sector_t *const *sectors,
+    int n,
+    f32 radius,
+    f32 height) {
+    nav_update(level);
+
+    // goal points can always move freely within their subsectors
+    dynlist_resize(field->goal_pos, 0);
+    for (int i = 0; i < n; i++) {
+        *dynlist_push(field->goal_pos) = goals[i];
+    }
+
+    bool changed =
+        field->version != level->nav.version
+        || field->radius != radius
+        || field->height != height;
+
+    if ((int) dynlist_size(field->goals) != n) {
+        dynlist_resize(field->goals, n);
+        changed = true;
+    }
+
+    // goals which are not in any subsector are kept as -1 and ignored
+    for (int i = 0; i < n; i++) {
+        subsector_t *sub = find_subsector(level, goals[i], sectors[i]);
+        const int id = sub ? sub->id : -1;
+
+        if (field->goals[i] != id) {
+            field->goals[i] = id;
+            changed = true;
+        }
+    }
+
+    if (!changed) {
+        return;
+    }
+
+#ifdef DO_VERIFY_NAV
+    const u64 t_start = time_ns();
+#endif // ifdef DO_VERIFY_NAV
+
+    field->version = level->nav.version;
+    field->radius = radius;
+    field->height = height;
+    field_flood(level, field);
+
+#ifdef DO_VERIFY_NAV
+    LOG(
+        "nav: flooded %d nodes from %d goal(s) in %.1f us",
+        (int) dynlist_size(level->nav.nodes),
+        (int) dynlist_size(field->goals),
+        (time_ns() - t_start) / 1000.0);
+#endif // ifdef DO_VERIFY_NAV
+}
+
+bool nav_field_sample(
+    level_t *level,
+    const nav_field_t *field,
+    vec2s pos,
+    sector_t *sector,
+    nav_waypoint_t *waypoint) {
+    subsector_t *sub = find_subsector(level, pos, sector);
+
+    if (!sub
+        || sub->id >= (int) dynlist_size(field->dist)
+        || isinf(field->dist[sub->id])) {
+        return false;
+    }
+
+    const int next = field->next[sub->id];
+
+    if (next == -1) {
+        // at a goal, walk to its point
+        dynlist_each(field->goals, it) {
+            if (*it.el == sub->id) {
+                *waypoint = (nav_waypoint_t) {
+                    .pos = field->goal_pos[it.i],
+                    .portal = NULL
+                };
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    const nav_edge_t *edge = &level->nav.nodes[sub->id].edges[next];
+    *waypoint = (nav_waypoint_t) { .pos = edge->cross, .portal = edge->portal };
+    return true;
+}
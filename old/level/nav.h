@@ -0,0 +1,67 @@
+#pragma once
+
+#include "util/dynlist.h"
+#include "util/math.h"
+#include "defs.h"
+
+// point on a path returned by nav_find_path
+typedef struct nav_waypoint {
+    vec2s pos;
+
+    // if non-NULL, pos is on this (disconnected portal) side and the path
+    // continues from portal_transform(pos) on the other side of the portal
+    side_t *portal;
+} nav_waypoint_t;
+
+// initialize/destroy navigation data, see level_init/level_destroy
+void nav_init(level_t *level);
+void nav_destroy(level_t *level);
+
+// (re)build navigation graph if the level has changed since it was last built
+void nav_update(level_t *level);
+
+// find path for an agent with "radius" and "height" from "from" in from_sector
+// to "to" in to_sector with A* over the subsector graph
+// appends waypoints (shared line/portal crossings, then "to") to path
+// returns false and leaves path untouched if there is no path
+bool nav_find_path(
+    level_t *level,
+    vec2s from,
+    sector_t *from_sector,
+    vec2s to,
+    sector_t *to_sector,
+    f32 radius,
+    f32 height,
+    DYNLIST(nav_waypoint_t) *path);
+
+// initialize/destroy a flow field
+void nav_field_init(nav_field_t *field);
+void nav_field_destroy(nav_field_t *field);
+
+// make field lead to the nearest of n goals (points in sectors) for an agent
+// with "radius" and "height" by flooding out from the goals' subsectors
+// only rebuilds if the goals' subsectors, the agent size or the navigation
+// graph have changed, so this is cheap to call every tick
+void nav_field_update(
+    level_t *level,
+    nav_field_t *field,
+    const vec2s *goals,
+    sector_t *const *sectors,
+    int n,
+    f32 radius,
+    f32 height);
+
+// field towards the player for agents with "radius" and "height", to be passed
+// to nav_field_update. fields are cached per agent size so that actors of
+// different sizes do not rebuild each other's field every tick. with more than
+// NAV_PLAYER_FIELDS sizes the least recently used field is rebuilt
+nav_field_t *nav_player_field(level_t *level, f32 radius, f32 height);
+
+// sample field at pos in sector, giving the next waypoint to walk towards
+// returns false if pos is not on the navigation graph or cannot reach a goal
+bool nav_field_sample(
+    level_t *level,
+    const nav_field_t *field,
+    vec2s pos,
+    sector_t *sector,
+    nav_waypoint_t *waypoint);
@@ -2,14 +2,19 @@
 #include "editor/editor.h"
 #include "level/level_defs.h"
 #include "level/level.h"
+#include "level/locate.h"
 #include "level/block.h"
+#include "level/broadphase.h"
 #include "level/lptr.h"
+#include "level/los.h"
+#include "level/nav.h"
 #include "level/actor.h"
 #include "level/path.h"
 #include "level/portal.h"
 #include "level/side.h"
 #include "state.h"
 #include "util/input.h"
+#include "util/sort.h"
 
 enum {
     AI_STATE_SLEEP = 0,
@@ -20,6 +25,10 @@ enum {
 typedef struct {
     vec2s dir;
 
+    // navigation waypoint being walked towards, if has_waypoint
+    vec2s waypoint;
+    bool has_waypoint;
+
     int dir_tick;
     int hit_tick;
     int see_tick;
@@ -40,11 +49,83 @@ void objects_init() {
     }
 }
 
+// #define DO_VERIFY_OBJECT_QUERY
+// #define DO_VERIFY_OBJECT_SLEEP
+
+#if defined(DO_VERIFY_OBJECT_QUERY) || defined(DO_VERIFY_OBJECT_SLEEP)
+#include "util/time.h"
+#endif
+
+// position of object (or where it would be inserted) in its type list, which
+// is sorted by index
+static int type_index_find(DYNLIST(object_t*) list, const object_t *o) {
+    int lo = 0, hi = dynlist_size(list);
+
+    while (lo < hi) {
+        const int mid = (lo + hi) / 2;
+        if (list[mid]->index < o->index) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
+
+static void type_index_add(level_t *level, object_t *o) {
+    DYNLIST(object_t*) *list = &level->objects_by_type[o->type_index];
+    *dynlist_insert(*list, type_index_find(*list, o)) = o;
+}
+
+// removes object from its type list. objects which are not yet in one (fx.
+// loaded objects before their type is set) are ignored
+static void type_index_remove(level_t *level, object_t *o) {
+    DYNLIST(object_t*) *list = &level->objects_by_type[o->type_index];
+    const int i = type_index_find(*list, o);
+
+    if (i < (int) dynlist_size(*list) && (*list)[i] == o) {
+        dynlist_remove(*list, i);
+    }
+}
+
+static int cmp_object_index(object_t **a, object_t **b, void*) {
+    return ((int) (*a)->index) - ((int) (*b)->index);
+}
+
+// true if object is in level->awake_objects. objects are woken by object_new
+// and object_set_type and stay awake until they are at rest, see
+// objects_update
+static bool is_awake(level_t *level, object_t *o) {
+    return o->awake_slot >= 0
+        && o->awake_slot < (int) dynlist_size(level->awake_objects)
+        && level->awake_objects[o->awake_slot] == o;
+}
+
+// swap-removes object from awake list, order is restored on next update
+static void awake_remove(level_t *level, object_t *o) {
+    if (!is_awake(level, o)) {
+        return;
+    }
+
+    object_t *last = dynlist_pop(level->awake_objects);
+    if (last != o) {
+        level->awake_objects[o->awake_slot] = last;
+        last->awake_slot = o->awake_slot;
+        level->awake_objects_unsorted = true;
+    }
+
+    o->awake_slot = -1;
+}
+
 object_t *object_new(level_t *level) {
     object_t *o = level_alloc(level, level->objects);
     o->state = OS_DEFAULT;
     o->type_index = OT_PLACEHOLDER;
     o->type = &OBJECT_TYPES[OT_PLACEHOLDER];
+    type_index_add(level, o);
+    o->awake_slot = -1;
+    object_wake(level, o);
     return o;
 }
 
@@ -70,11 +151,14 @@ void object_delete(level_t *level, object_t *o) {
     }
 
     if (o->actor) {
-        o->actor->flags |= AF_DONE;
         o->actor->storage = NULL;
+        actor_done(level, o->actor);
     }
 
     level_blocks_remove_object(level, o);
+    broadphase_remove(level, o);
+    type_index_remove(level, o);
+    awake_remove(level, o);
     level_free(level, level->objects, o);
 }
 
@@ -95,8 +179,11 @@ void object_set_type(
         WARN("setting type for object @ %p to the same?", object);
     }
 
+    type_index_remove(level, object);
     object->type_index = type;
     object->type = &OBJECT_TYPES[type];
+    object->sprite_handle = (atlas_handle_t) { 0 };
+    type_index_add(level, object);
     object->funcdata.raw = 0;
 
     if (object->type->ex_size > 0) {
@@ -112,10 +199,17 @@ void object_set_type(
         object->ex = NULL;
     }
 
+    // radius may have changed
+    if (object->cells.valid) {
+        broadphase_update(level, object);
+    }
+
+    object_wake(level, object);
+
     // complete current actor
     if (object->actor) {
         object->actor->storage = NULL;
-        object->actor->flags |= AF_DONE;
+        actor_done(level, object->actor);
         object->actor = NULL;
     }
 
@@ -134,6 +228,156 @@ void object_set_type(
     }
 }
 
+void object_wake(level_t *level, object_t *object) {
+    object->rest_frames = 0;
+
+    if (is_awake(level, object)) {
+        return;
+    }
+
+    const int n = dynlist_size(level->awake_objects);
+    if (n != 0 && level->awake_objects[n - 1]->index > object->index) {
+        level->awake_objects_unsorted = true;
+    }
+
+    object->awake_slot = n;
+    *dynlist_push(level->awake_objects) = object;
+}
+
+void object_wake_sector(level_t *level, sector_t *sector) {
+    dlist_each(sector_list, &sector->objects, it) {
+        object_wake(level, it.el);
+    }
+}
+
+void object_push(level_t *level, object_t *object, vec3s dv) {
+    object->vel_xyz = glms_vec3_add(object->vel_xyz, dv);
+    object_wake(level, object);
+}
+
+object_t *object_find_type(level_t *level, object_type_index type_index) {
+    DYNLIST(object_t*) list = level->objects_by_type[type_index];
+    return dynlist_size(list) != 0 ? list[0] : NULL;
+}
+
+object_t *object_get_player(level_t *level) {
+    return object_find_type(level, OT_PLAYER);
+}
+
+#ifdef DO_VERIFY_OBJECT_QUERY
+// checks radius query results against a scan of all objects and periodically
+// logs how long each took
+static void verify_query_radius(
+    level_t *level,
+    vec2s pos,
+    f32 radius,
+    object_type_index type_index,
+    const DYNLIST(object_t*) res,
+    int start,
+    u64 ns_query) {
+    static u64 n_queries, ns_indexed, ns_scan;
+
+    const u64 t_scan = time_ns();
+
+    int n = 0;
+    level_dynlist_each(level->objects, it) {
+        object_t *o = *it.el;
+        if ((type_index != OT_COUNT && o->type_index != type_index)
+            || glms_vec2_norm(glms_vec2_sub(o->pos, pos))
+                > radius + o->type->radius) {
+            continue;
+        }
+
+        n++;
+    }
+
+    ns_scan += time_ns() - t_scan;
+    ns_indexed += ns_query;
+
+    if (n != (int) dynlist_size(res) - start) {
+        WARN(
+            "object radius query returned %d objects, expected %d",
+            (int) dynlist_size(res) - start, n);
+    }
+
+    if (++n_queries % 10000 == 0) {
+        LOG(
+            "object radius query: %d objects, indexed %.1f ns/query, "
+            "scan %.1f ns/query",
+            level_get_list_count(level, T_OBJECT),
+            ns_indexed / (f64) n_queries,
+            ns_scan / (f64) n_queries);
+    }
+}
+#endif // ifdef DO_VERIFY_OBJECT_QUERY
+
+void object_query_radius(
+    level_t *level,
+    vec2s pos,
+    f32 radius,
+    object_type_index type_index,
+    DYNLIST(object_t*) *out) {
+#ifdef DO_VERIFY_OBJECT_QUERY
+    const u64 t_query = time_ns();
+#endif // ifdef DO_VERIFY_OBJECT_QUERY
+
+    const int start = dynlist_size(*out);
+
+    // number of broadphase cells along each side of the query area
+    const int cells_side =
+        (int) ceilf((2.0f * radius) / BROADPHASE_CELL_SIZE) + 1;
+
+    DYNLIST(object_t*) candidates = NULL;
+    const bool use_type_list =
+        type_index != OT_COUNT
+        && (int) dynlist_size(level->objects_by_type[type_index])
+            <= cells_side * cells_side;
+
+    if (use_type_list) {
+        // few enough objects of this type that checking all of them is cheaper
+        // than walking the broadphase
+        candidates = level->objects_by_type[type_index];
+    } else {
+        // objects are inserted into the broadphase by their own radius, so this
+        // finds everything which could overlap the query circle
+        broadphase_query(
+            level,
+            glms_vec2_subs(pos, radius),
+            glms_vec2_adds(pos, radius),
+            &candidates);
+    }
+
+    dynlist_each(candidates, it) {
+        object_t *o = *it.el;
+
+        if ((type_index != OT_COUNT && o->type_index != type_index)
+            || glms_vec2_norm(glms_vec2_sub(o->pos, pos))
+                > radius + o->type->radius) {
+            continue;
+        }
+
+        *dynlist_push(*out) = o;
+    }
+
+    if (!use_type_list) {
+        dynlist_free(candidates);
+    }
+
+    if (dynlist_size(*out) - start > 1) {
+        sort(
+            &(*out)[start],
+            dynlist_size(*out) - start,
+            sizeof((*out)[0]),
+            (f_sort_cmp) cmp_object_index,
+            NULL);
+    }
+
+#ifdef DO_VERIFY_OBJECT_QUERY
+    verify_query_radius(
+        level, pos, radius, type_index, *out, start, time_ns() - t_query);
+#endif // ifdef DO_VERIFY_OBJECT_QUERY
+}
+
 static int resolve_normal(
     level_t *level,
     const path_hit_t *hit,
@@ -211,6 +455,58 @@ static int resolve_normal(
     return PATH_TRACE_RETRY;
 }
 
+// stop solid object "obj" moving from -> *to at the first solid object in the
+// way, sliding its velocity along the contact
+static void collide_objects(
+    level_t *level,
+    object_t *obj,
+    vec2s from,
+    vec2s *to) {
+    const f32 r = obj->type->radius;
+    const vec2s v = glms_vec2_sub(*to, from);
+
+    DYNLIST(object_t*) *candidates = &level->broadphase.scratch;
+    dynlist_resize(*candidates, 0);
+    broadphase_query(
+        level,
+        glms_vec2_subs(glms_vec2_minv(from, *to), r),
+        glms_vec2_adds(glms_vec2_maxv(from, *to), r),
+        candidates);
+
+    // candidates are sorted by index and only strictly earlier hits replace
+    // the current one, so ties always resolve the same way
+    object_t *hit = NULL;
+    f32 t_hit = 1.0f;
+    dynlist_each(*candidates, it) {
+        object_t *other = *it.el;
+        if (other == obj || !(other->type->flags & OTF_SOLID)) {
+            continue;
+        }
+
+        f32 t;
+        if (sweep_circle_circle_contact(
+                other->pos, other->type->radius, from, r, v, &t)
+            && (!hit || t < t_hit)) {
+            hit = other;
+            t_hit = t;
+        }
+    }
+
+    if (!hit) {
+        return;
+    }
+
+    object_wake(level, hit);
+    *to = glms_vec2_add(from, glms_vec2_scale(v, t_hit));
+
+    // remove velocity into the other object
+    const vec2s normal = glms_vec2_normalize(glms_vec2_sub(*to, hit->pos));
+    const f32 d = glms_vec2_dot(obj->vel, normal);
+    if (d < 0.0f) {
+        obj->vel = glms_vec2_sub(obj->vel, glms_vec2_scale(normal, d));
+    }
+}
+
 static void update_move(level_t *level, object_t *obj, f32 dt) {
     if (!(obj->type->flags &  OTF_PROJECTILE)) {
         const f32 drag = 8.0f;
@@ -248,6 +544,10 @@ static void update_move(level_t *level, object_t *obj, f32 dt) {
         obj,
         path_trace_flags);
 
+    if (obj->type->flags & OTF_SOLID) {
+        collide_objects(level, obj, from, &to);
+    }
+
     if (!level_find_point_sector(level, to, obj->sector)) {
         WARN("object %d attempting move out of sector", obj->index);
     } else if (!glms_vec2_eqv_eps(from, to)) {
@@ -284,6 +584,13 @@ void object_move(level_t *level, object_t *object, vec2s pos) {
         return;
     }
 
+    // only wake sleeping objects: awake objects (fx. moving themselves in
+    // update_move) must keep their rest frames, otherwise anything drifting
+    // slower than OBJECT_REST_SPEED would never fall asleep
+    if (!is_awake(level, object)) {
+        object_wake(level, object);
+    }
+
     object->pos.x = max(pos.x, 0);
     object->pos.y = max(pos.y, 0);
 
@@ -342,6 +649,8 @@ void object_move(level_t *level, object_t *object, vec2s pos) {
             object->block = newblock;
         }
     }
+
+    broadphase_update(level, object);
 }
 
 void object_update(level_t *level, object_t *obj, f32 dt) {
@@ -359,6 +668,114 @@ void object_update(level_t *level, object_t *obj, f32 dt) {
     update_move(level, obj, dt);
 }
 
+// true if object can sleep and is not moving while standing on the floor
+static bool is_at_rest(const object_t *o) {
+    return !o->type->update_fn
+        && !(o->type->flags & OTF_PROJECTILE)
+        && glms_vec2_norm2(o->vel) < OBJECT_REST_SPEED * OBJECT_REST_SPEED
+        && o->vel_z == 0.0f
+        && o->z <= o->sector->floor.z;
+}
+
+#ifdef DO_VERIFY_OBJECT_SLEEP
+// checks that sleeping objects have not been moved without being woken and
+// periodically logs how long updates took
+static void verify_sleep(level_t *level, u64 ns_update) {
+    static u64 n_updates, ns_total;
+
+    level_dynlist_each(level->objects, it) {
+        object_t *o = *it.el;
+        if (!o->sector || is_awake(level, o)) {
+            continue;
+        }
+
+        if (!glms_vec3_eqv(o->vel_xyz, VEC3(0))
+            || o->z != o->sector->floor.z) {
+            WARN("sleeping object %d is moving", o->index);
+        }
+    }
+
+    for (int i = 1; i < (int) dynlist_size(level->awake_objects); i++) {
+        if (level->awake_objects[i - 1]->index
+                >= level->awake_objects[i]->index) {
+            WARN("awake objects out of order");
+            break;
+        }
+    }
+
+    ns_total += ns_update;
+
+    if (++n_updates % 600 == 0) {
+        LOG(
+            "objects: %d awake, %d asleep, %.1f us/update",
+            (int) dynlist_size(level->awake_objects),
+            level_get_list_count(level, T_OBJECT)
+                - (int) dynlist_size(level->awake_objects),
+            ns_total / (f64) (n_updates * 1000));
+    }
+}
+#endif // ifdef DO_VERIFY_OBJECT_SLEEP
+
+void objects_update(level_t *level, f32 dt) {
+#ifdef DO_VERIFY_OBJECT_SLEEP
+    const u64 t_update = time_ns();
+#endif // ifdef DO_VERIFY_OBJECT_SLEEP
+
+    // update in index order, same as if all objects were awake
+    if (level->awake_objects_unsorted) {
+        sort(
+            level->awake_objects,
+            dynlist_size(level->awake_objects),
+            sizeof(level->awake_objects[0]),
+            (f_sort_cmp) cmp_object_index,
+            NULL);
+
+        dynlist_each(level->awake_objects, it) {
+            (*it.el)->awake_slot = it.i;
+        }
+
+        level->awake_objects_unsorted = false;
+    }
+
+    // objects can be woken (appended) while updating, so index every time
+    for (int i = 0; i < (int) dynlist_size(level->awake_objects); i++) {
+        object_t *o = level->awake_objects[i];
+        if (!o->sector) {
+            continue;
+        }
+
+        object_update(level, o, dt);
+
+        if (is_at_rest(o)) {
+            o->rest_frames++;
+        } else {
+            o->rest_frames = 0;
+        }
+    }
+
+    // put objects which have been at rest for long enough to sleep, keeping
+    // the rest in order
+    int n = 0;
+    dynlist_each(level->awake_objects, it) {
+        object_t *o = *it.el;
+
+        if (o->rest_frames >= OBJECT_REST_FRAMES) {
+            o->vel = VEC2(0);
+            o->awake_slot = -1;
+            continue;
+        }
+
+        o->awake_slot = n;
+        level->awake_objects[n++] = o;
+    }
+
+    dynlist_resize(level->awake_objects, n);
+
+#ifdef DO_VERIFY_OBJECT_SLEEP
+    verify_sleep(level, time_ns() - t_update);
+#endif // ifdef DO_VERIFY_OBJECT_SLEEP
+}
+
 // generic controls
 static void update_control(level_t *level, object_t *o) {
     if (!state->allow_input) {
@@ -459,50 +876,62 @@ void act_player(level_t*, actor_t *a, object_t *obj) {
     /* } */
 }
 
-typedef struct {
-    object_t *origin;
-    bool result;
-} sightline_data_t;
-
-static int resolve_sightline(
+// find direction towards the next waypoint from obj to target, false if there
+// is no path. all actors chasing the player share one flow field, which is only
+// rebuilt when the player changes subsector, other targets get an A* search
+static bool nav_dir(
     level_t *level,
-    const path_hit_t *hit,
-    vec2s *from,
-    vec2s *to,
-    sightline_data_t *data) {
-    bool stopped = true;
-
-    side_t *portal = hit->wall.side->portal;
+    object_t *obj,
+    object_t *target,
+    vec2s *dir,
+    vec2s *waypoint) {
+    if (target->type_index != OT_PLAYER) {
+        DYNLIST(nav_waypoint_t) path = NULL;
+
+        const bool found =
+            nav_find_path(
+                level,
+                obj->pos, obj->sector,
+                target->pos, target->sector,
+                obj->type->radius, obj->type->height,
+                &path);
+
+        if (found) {
+            int i = 0;
+            while (i < (int) dynlist_size(path) - 1
+                   && !path[i].portal
+                   && glms_vec2_distance(path[i].pos, obj->pos)
+                        < obj->type->radius) {
+                i++;
+            }
 
-    if (portal && portal->sector) {
-        side_segment_t segs[4];
-        side_get_segments(hit->wall.side, segs);
-
-        // TODO: use a more refined "eye height"
-        if (segs[SIDE_SEGMENT_MIDDLE].present
-            && data->origin->z + data->origin->type->height
-                >= segs[SIDE_SEGMENT_MIDDLE].z0
-            && data->origin->z + data->origin->type->height
-                <= segs[SIDE_SEGMENT_MIDDLE].z1) {
-            stopped = false;
+            *waypoint = path[i].pos;
+            *dir = glms_vec2_normalize(glms_vec2_sub(path[i].pos, obj->pos));
         }
-    }
 
-    int res = PATH_TRACE_CONTINUE;
-    f32 portal_angle = 0.0f;
-    if (path_trace_resolve_portal(
-            level, hit, from, to, &res, &portal_angle,
-            PATH_TRACE_RESOLVE_PORTAL_NONE)) {
-        return res;
+        dynlist_free(path);
+        return found;
     }
 
-    // do not process further collisions
-    if (!stopped) {
-        return PATH_TRACE_CONTINUE;
+    nav_field_t *field =
+        nav_player_field(level, obj->type->radius, obj->type->height);
+    nav_field_update(
+        level,
+        field,
+        &target->pos,
+        &target->sector,
+        1,
+        obj->type->radius,
+        obj->type->height);
+
+    nav_waypoint_t next;
+    if (!nav_field_sample(level, field, obj->pos, obj->sector, &next)) {
+        return false;
     }
 
-    data->result = false;
-    return PATH_TRACE_STOP;
+    *waypoint = next.pos;
+    *dir = glms_vec2_normalize(glms_vec2_sub(next.pos, obj->pos));
+    return true;
 }
 
 void act_boy(level_t *level, actor_t *a, object_t *obj) {
@@ -513,34 +942,18 @@ void act_boy(level_t *level, actor_t *a, object_t *obj) {
         return;
     }
 
-    object_t *target = NULL;
-    level_dynlist_each(level->objects, it) {
-        object_t *o = *it.el;
-        if (o->type_index == OT_PLAYER) {
-            target = o;
-            break;
-        }
-    }
-
+    object_t *target = object_get_player(level);
     ASSERT(target);
 
-    sightline_data_t sl_data = { .origin = obj, .result = true };
-    vec2s from = obj->pos, to = target->pos;
-    path_trace(
-        level,
-        &from,
-        &to,
-        0.0f,
-        (path_trace_resolve_f) resolve_sightline,
-        &sl_data,
-        PATH_TRACE_NONE);
+    const bool sees_target = los_check(level, obj, target);
 
-    if (!sl_data.result && ex->ai_state == AI_STATE_SLEEP) {
-        // keep sleeping until we see the target
+    if (!sees_target && ex->ai_state == AI_STATE_SLEEP) {
+        // keep sleeping until we see the target, look again every 1/4s
+        actor_sleep(level, a, TICKS_PER_SECOND / 4);
         return;
     }
 
-    if (sl_data.result) {
+    if (sees_target) {
         ex->see_tick = state->time.tick;
     }
 
@@ -554,7 +967,7 @@ void act_boy(level_t *level, actor_t *a, object_t *obj) {
         ex->dir_tick = 0;
     }
 
-    if (ex->hit_tick > ex->dir_tick && !sl_data.result) {
+    if (ex->hit_tick > ex->dir_tick && !sees_target) {
         // did we just hit a wall? go in random direction within wall normal
         ex->dir_tick = state->time.tick;
 
@@ -571,8 +984,17 @@ void act_boy(level_t *level, actor_t *a, object_t *obj) {
         /*     const f32 s = sign(dot(n, d)); */
         /*     ex->walkdir = (v2) { s * d.x, s * d.y }; */
         /* } else { */
+        // path around whatever we hit if we are after the target, otherwise
         // walk a random direction
-        ex->dir = glms_vec2_normalize(rand_v2(&state->rand, VEC2(-1), VEC2(+1)));
+        ex->has_waypoint =
+            ex->ai_state == AI_STATE_WALK
+                && nav_dir(level, obj, target, &ex->dir, &ex->waypoint);
+
+        if (!ex->has_waypoint) {
+            ex->dir =
+                glms_vec2_normalize(
+                    rand_v2(&state->rand, VEC2(-1), VEC2(+1)));
+        }
         /* } */
     } else if (ex->ai_state == AI_STATE_IDLE) {
         // random walk direction
@@ -585,18 +1007,32 @@ void act_boy(level_t *level, actor_t *a, object_t *obj) {
         // - walkdirtick is old (> 2s)
         // - just started walking (walkdirtick == 0)
         // - we hit a wall, but we can see the player
+        // - we reached the waypoint we were walking to
         if (ex->dir_tick == 0
             || (state->time.tick - ex->dir_tick) > 240
-            || ((ex->hit_tick > ex->dir_tick) && sl_data.result)) {
+            || ((ex->hit_tick > ex->dir_tick) && sees_target)
+            || (ex->has_waypoint
+                && glms_vec2_distance(ex->waypoint, obj->pos)
+                    < obj->type->radius)) {
             LOG("DOING! %d", ex->hit_tick);
             ex->dir_tick = state->time.tick;
-            ex->dir = glms_vec2_normalize(glms_vec2_sub(target->pos, obj->pos));
+
+            // walk straight at target if it is visible, otherwise navigate
+            ex->has_waypoint =
+                !sees_target
+                    && nav_dir(level, obj, target, &ex->dir, &ex->waypoint);
+
+            if (!ex->has_waypoint) {
+                ex->dir =
+                    glms_vec2_normalize(glms_vec2_sub(target->pos, obj->pos));
+            }
         }
     }
 
-    obj->vel = glms_vec2_add(obj->vel, glms_vec2_scale(ex->dir, 0.5f));
+    const vec2s dv = glms_vec2_scale(ex->dir, 0.5f);
+    object_push(level, obj, VEC3(dv.x, dv.y, 0.0f));
 
-    if (sl_data.result && ex->cooldown == 0) {
+    if (sees_target && ex->cooldown == 0) {
         // TODO: check for melee
 
         /* const v2 pos_to_target = { */
@@ -715,7 +1151,7 @@ object_type_t OBJECT_TYPES[OT_COUNT] = {
         .sprite = AS_RESOURCE("OBOY0"),
         .height = 1.35f,
         .radius = 0.5f,
-        .flags = OTF_NONE,
+        .flags = OTF_SOLID,
         .act_fn = (actor_f) act_boy,
         .ex_size = sizeof(object_boy_t),
         .ex_init = &((object_boy_t) {
@@ -726,7 +1162,7 @@ object_type_t OBJECT_TYPES[OT_COUNT] = {
         .sprite = AS_RESOURCE(TEXTURE_NOTEX),
         .height = 1.65f,
         .radius = 0.25f,
-        .flags = OTF_INVISIBLE,
+        .flags = OTF_INVISIBLE | OTF_SOLID,
         .act_fn = (actor_f) act_player,
         .update_fn = (object_update_f) update_player,
         /* .exsize = sizeof(object_player_t), */
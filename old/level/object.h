@@ -1,5 +1,7 @@
 #pragma once
 
+#include "util/dynlist.h"
+#include "util/math.h"
 #include "defs.h"
 
 // init object tables
@@ -17,9 +19,37 @@ void object_set_type(
     object_t *object,
     object_type_index type_index);
 
+// wake object if it is asleep (at rest, not being updated)
+void object_wake(level_t *level, object_t *object);
+
+// wake all objects in sector, fx. when its geometry or planes change
+void object_wake_sector(level_t *level, sector_t *sector);
+
+// add dv to object's velocity and wake it
+void object_push(level_t *level, object_t *object, vec3s dv);
+
+// first (lowest index) object of type, NULL if there are none. O(1)
+object_t *object_find_type(level_t *level, object_type_index type_index);
+
+// player object, NULL if there is none
+object_t *object_get_player(level_t *level);
+
+// append objects of type "type_index" (OT_COUNT for any type) which overlap the
+// circle at pos with radius to "out", sorted by index
+void object_query_radius(
+    level_t *level,
+    vec2s pos,
+    f32 radius,
+    object_type_index type_index,
+    DYNLIST(object_t*) *out);
+
 // set object position
 void object_move(level_t *level, object_t *object, vec2s pos);
 
 // perform per-frame update on object
 // dt is expected in seconds
 void object_update(level_t *level, object_t *obj, f32 dt);
+
+// perform per-frame update on all awake objects, putting objects which have
+// been at rest for OBJECT_REST_FRAMES to sleep
+void objects_update(level_t *level, f32 dt);
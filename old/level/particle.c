@@ -1,5 +1,6 @@
 #include "level/particle.h"
 #include "level/level.h"
+#include "level/locate.h"
 #include "level/path.h"
 #include "level/side.h"
 #include "gfx/renderer.h"
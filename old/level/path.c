@@ -2,6 +2,7 @@
 #include "level/level.h"
 #include "level/level_defs.h"
 #include "level/block.h"
+#include "level/broadphase.h"
 #include "level/lptr.h"
 #include "level/portal.h"
 #include "level/sector.h"
@@ -139,16 +140,99 @@ typedef struct {
     path_trace_resolve_f resolve;
     void *resolve_userdata;
     bool add_sectors;
+
+    // if PATH_TRACE_ADD_OBJECTS, object hits along the whole line sorted by
+    // t, and the next one to add to a block. see add_object_hits
+    DYNLIST(path_hit_t) object_hits;
+    int next_object;
 } traverse_data_t;
 
 static int path_hit_t_cmp(const path_hit_t *a, const path_hit_t *b, void*) {
     return (int) sign(a->t - b->t);
 }
 
+// find hits of all objects from the broadphase along from -> to in
+// data->object_hits
+static void add_object_hits(level_t *level, traverse_data_t *data) {
+    const vec2s from = *data->from, to = *data->to;
+
+    dynlist_resize(data->object_hits, 0);
+    data->next_object = 0;
+
+    DYNLIST(object_t*) *candidates = &level->broadphase.scratch;
+    dynlist_resize(*candidates, 0);
+    broadphase_query_segment(level, from, to, data->radius, candidates);
+
+    dynlist_each(*candidates, it) {
+        object_t *object = *it.el;
+        f32 t = 0.0f;
+
+        if (data->radius == 0.0f) {
+            f32 ts[2];
+            int n;
+            if (!(n = intersect_circle_seg(
+                    object->pos, object->type->radius,
+                    to, from,
+                    ts, NULL))) {
+                continue;
+            }
+
+            t = ts[0];
+        } else {
+            if (!sweep_circle_circle(
+                    object->pos, object->type->radius,
+                    from, data->radius,
+                    glms_vec2_sub(to, from),
+                    &t)) {
+                continue;
+            }
+        }
+
+        *dynlist_push(data->object_hits) = (path_hit_t) {
+            .swept_pos = glms_vec2_lerp(from, to, t),
+            .t = t,
+            .type = T_OBJECT,
+            .object = {
+                .ptr = object
+            }
+        };
+    }
+
+    sort(
+        data->object_hits,
+        dynlist_size(data->object_hits),
+        sizeof(data->object_hits[0]),
+        (f_sort_cmp) path_hit_t_cmp,
+        NULL);
+}
+
+// t at which from -> to leaves block at bpos
+static f32 block_exit_t(vec2s from, vec2s to, ivec2s bpos) {
+    if (glms_ivec2_eq(bpos, level_pos_to_block(to))) {
+        return INFINITY;
+    }
+
+    const vec2s
+        delta = glms_vec2_sub(to, from),
+        bmin = glms_vec2_scale(IVEC_TO_V(bpos), BLOCK_SIZE),
+        bmax = glms_vec2_adds(bmin, BLOCK_SIZE);
+
+    f32 t = INFINITY;
+
+    for (int i = 0; i < 2; i++) {
+        if (fabsf(delta.raw[i]) < 0.0000001f) { continue; }
+
+        const f32 edge = delta.raw[i] > 0 ? bmax.raw[i] : bmin.raw[i];
+        t = min(t, (edge - from.raw[i]) / delta.raw[i]);
+    }
+
+    return t;
+}
+
 static bool path_trace_traverse(
     level_t *level,
     block_t *block,
-    ivec2s,
+    ivec2s bpos,
     traverse_data_t *data) {
 
     // accumulate hits in list, need to sort by t
@@ -274,38 +358,14 @@ static bool path_trace_traverse(
     }
 
     if (data->flags & PATH_TRACE_ADD_OBJECTS) {
-        dlist_each(block_list, &block->objects, it) {
-            f32 t = 0.0f;
-
-            if (data->radius == 0.0f) {
-                f32 ts[2];
-                int n;
-                if (!(n = intersect_circle_seg(
-                        it.el->pos, it.el->type->radius,
-                        *data->to, *data->from,
-                        ts, NULL))) {
-                    continue;
-                }
-
-                t = ts[0];
-            } else {
-                if (!sweep_circle_circle(
-                        it.el->pos, it.el->type->radius,
-                        *data->from, data->radius,
-                        glms_vec2_sub(*data->to, *data->from),
-                        &t)) {
-                    continue;
-                }
-            }
-
-            *dynlist_push(hits) = (path_hit_t) {
-                .swept_pos = glms_vec2_lerp(*data->from, *data->to, t),
-                .t = t,
-                .type = T_OBJECT,
-                .object = {
-                    .ptr = it.el
-                }
-            };
+        // objects can overlap the line from a block it does not pass through,
+        // so hits are found once per line from the broadphase instead of from
+        // block object lists. add the ones before the line leaves this block.
+        const f32 t_exit = block_exit_t(*data->from, *data->to, bpos);
+
+        while (data->next_object < dynlist_size(data->object_hits)
+               && data->object_hits[data->next_object].t <= t_exit) {
+            *dynlist_push(hits) = data->object_hits[data->next_object++];
         }
     }
 
@@ -463,7 +523,11 @@ retry:;
         n_attempts++;
 
         if (n_attempts > RETRY_MAX) {
-            return;
+            break;
+        }
+
+        if (flags & PATH_TRACE_ADD_OBJECTS) {
+            add_object_hits(level, &data);
         }
 
         data.res = PATH_TRACE_CONTINUE;
@@ -474,13 +538,14 @@ retry:;
             (traverse_blocks_f) path_trace_traverse,
             &data);
 
-        switch (data.res) {
-        case PATH_TRACE_RETRY: continue;
-        case PATH_TRACE_STOP: return;
+        if (data.res == PATH_TRACE_RETRY) {
+            continue;
         }
 
         break;
     }
+
+    dynlist_free(data.object_hits);
 }
 
 typedef struct {
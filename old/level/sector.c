@@ -4,9 +4,11 @@
 #include "level/decal.h"
 #include "level/level.h"
 #include "level/lptr.h"
+#include "level/object.h"
 #include "level/particle.h"
 #include "level/side.h"
 #include "level/tag.h"
+#include "level/visibility.h"
 #include "util/hash.h"
 #include "util/map.h"
 #include "util/rand.h"
@@ -487,9 +489,72 @@ sector_t *sector_new(
     return s;
 }
 
-static bool traverse_compute_visible(level_t *level, sector_t *sector, void*) {
+// mark every sector whose visibility can have changed due to a change in
+// "sector" as dirty: the sector, its neighbors, and all sectors which can see
+// either of them (only they can have sightlines passing through the change)
+static void mark_visibility_dirty(level_t *level, sector_t *sector) {
+    // incremental rows would mix with baked ones, drop the bake instead
+    if (level->visibility.baked) {
+        LOG("sector %d changed, baked visibility is now stale", sector->index);
+        level->visibility.baked = false;
+    }
+
     *dynlist_push(level->dirty_vis_sectors) = LPTR_FROM(sector);
-    return true;
+
+    dynlist_each(sector->neighbors, it) {
+        *dynlist_push(level->dirty_vis_sectors) = LPTR_FROM(*it.el);
+    }
+
+    level_dynlist_each(level->sectors, it) {
+        sector_t *other = *it.el;
+        if (other == sector) { continue; }
+
+        bool dirty = visibility_get(level, other, sector->index);
+
+        dynlist_each(sector->neighbors, it_n) {
+            if (dirty) { break; }
+            dirty = visibility_get(level, other, (*it_n.el)->index);
+        }
+
+        if (dirty) {
+            *dynlist_push(level->dirty_vis_sectors) = LPTR_FROM(other);
+        }
+    }
+}
+
+ALWAYS_INLINE hash_t hash_add_vec2(hash_t hash, vec2s v) {
+    u32 xy[2];
+    memcpy(xy, v.raw, sizeof(xy));
+    return hash_add_u32(hash_add_u32(hash, xy[0]), xy[1]);
+}
+
+// hash everything which sector_compute_visibility depends on for this sector:
+// its subsector lines, subsector adjacency, and portal connectivity
+static hash_t compute_vis_hash(const sector_t *sector) {
+    hash_t hash = 0x12345;
+    hash = hash_add_int(hash, sector->index);
+
+    dynlist_each(sector->subs, it) {
+        hash = hash_add_int(hash, dynlist_size(it.el->lines));
+        hash = hash_add_int(hash, dynlist_size(it.el->neighbors));
+
+        dynlist_each(it.el->lines, it_l) {
+            hash = hash_add_vec2(hash, it_l.el->a->pos);
+            hash = hash_add_vec2(hash, it_l.el->b->pos);
+        }
+    }
+
+    llist_each(sector_sides, &sector->sides, it) {
+        if (!it.el->portal) { continue; }
+
+        hash = hash_add_int(hash, it.el->index);
+        hash = hash_add_int(hash, it.el->flags & SIDE_FLAG_DISCONNECT);
+        hash = hash_add_int(
+            hash, it.el->portal->sector ? it.el->portal->sector->index : -1);
+    }
+
+    // 0 is reserved for "never computed"
+    return hash ? hash : 1;
 }
 
 void sector_delete(level_t *level, sector_t *s) {
@@ -506,16 +571,9 @@ void sector_delete(level_t *level, sector_t *s) {
     level_blocks_remove_sector(level, s);
 
     // TODO
-    for (int by = level->blocks.offset.y;
-         by < level->blocks.offset.y + level->blocks.size.y;
-         by++) {
-        for (int bx = level->blocks.offset.y;
-             bx < level->blocks.offset.y + level->blocks.size.y;
-             bx++) {
-            block_t *block = level_get_block(level, IVEC2(bx, by));
-            if (!block) { continue; } // TODO:!!!
-
-            dynlist_each(block->sectors, it) {
+    map_each(u64, block_page_t*, &level->blocks.pages, it_p) {
+        for (int i = 0; i < BLOCK_PAGE_SIZE * BLOCK_PAGE_SIZE; i++) {
+            dynlist_each(it_p.value->blocks[i].sectors, it) {
                 ASSERT(
                     *it.el != s,
                     "failed to remove sector %d from blocks",
@@ -559,8 +617,10 @@ void sector_delete(level_t *level, sector_t *s) {
     }
     dynlist_free(s->subs);
 
-    // force neighbors to recalcualte visibility on next update
-    sector_traverse_neighbors(level, s, traverse_compute_visible, NULL);
+    // force anything which could see this sector to recalculate visibility on
+    // next update, then drop this sector from the matrix
+    mark_visibility_dirty(level, s);
+    visibility_clear(level, s);
 
     // force neighbors to recalc
     dynlist_each(s->neighbors, it) {
@@ -878,42 +938,9 @@ static bool is_line_visible_via(
         || point_side(target->b->pos, a, b) >= 0;
 }
 
-void sector_compute_visibility(level_t *level, sector_t *sector) {
-    if (dynlist_size(sector->subs) == 0) { return; }
-
-    {
-        // ensure capacity of visibility matrix
-        const int
-            n_old = level->visibility.n,
-            n_new = round_up_to_mult(dynlist_size(level->sectors), 64);
-
-        if (n_old != n_new) {
-            u8 *old = level->visibility.matrix;
-
-            level->visibility.matrix =
-                calloc(1, n_new * BITMAP_SIZE_TO_BYTES(n_new));
-            level->visibility.n = n_new;
-
-            if (old) {
-                // copy rows again
-                for (int i = 0; i < n_old; i++) {
-                    memcpy(
-                        &level->visibility.matrix[
-                            i * BITMAP_SIZE_TO_BYTES(n_new)],
-                        &old[i * BITMAP_SIZE_TO_BYTES(n_old)],
-                        BITMAP_SIZE_TO_BYTES(n_old));
-                }
-            }
+bool sector_trace_visibility(level_t *level, sector_t *sector, BITMAP *bits) {
+    if (dynlist_size(sector->subs) == 0) { return false; }
 
-            if (old) {
-                free(old);
-            }
-        }
-    }
-
-    BITMAP *bits =
-        &level->visibility.matrix[
-            sector->index * BITMAP_SIZE_TO_BYTES(level->visibility.n)];
     bitmap_fill(bits, dynlist_size(level->sectors), false);
 
     // sectors are always visible from themselves
@@ -999,6 +1026,18 @@ void sector_compute_visibility(level_t *level, sector_t *sector) {
     }
 
     dynlist_free(queue);
+    return true;
+}
+
+void sector_compute_visibility(level_t *level, sector_t *sector) {
+    const int n_sectors = dynlist_size(level->sectors);
+    BITMAP *bits = bitmap_alloc(n_sectors);
+
+    if (sector_trace_visibility(level, sector, bits)) {
+        visibility_set_row(level, sector, bits, n_sectors);
+    }
+
+    bitmap_free(bits);
 }
 
 void sector_recalculate(level_t *level, sector_t *sector) {
@@ -1052,6 +1091,12 @@ void sector_recalculate(level_t *level, sector_t *sector) {
         (*it.el)->level_flags &= ~LF_MARK;
     }
 
+    // objects resting here or next door may need to move now
+    object_wake_sector(level, sector);
+    dynlist_each(sector->neighbors, it) {
+        object_wake_sector(level, *it.el);
+    }
+
     if (n_sides == 0) {
         LOG("removing empty sector %d", sector->index);
         sector_delete(level, sector);
@@ -1204,6 +1249,7 @@ done_sorting:
         sector->n_sides = 0;
         sector->min = VEC2(NAN);
         sector->max = VEC2(NAN);
+        level_blocks_remove_sector(level, sector);
         return;
     }
 
@@ -1215,33 +1261,19 @@ done_sorting:
     sector->min = p_min;
     sector->max = p_max;
 
-    const vec2s old_min = sector->min, old_max = sector->max;
-
     if (change) {
-        // TODO: this can be done more effeciently, check if current and previous
-        // bounds are entirely contained within existing boundaries
-        // recalculate overall level bounds on change
-        level->bounds.min = IVEC2(U16_MAX, U16_MAX);
-        level->bounds.max = IVEC2(0, 0);
-        level_dynlist_each(level->sectors, it) {
-            sector_t *s = *it.el;
-            level->bounds.min.x = min(level->bounds.min.x, s->min.x);
-            level->bounds.min.y = min(level->bounds.min.y, s->min.y);
-            level->bounds.max.x = max(level->bounds.max.x, s->max.x);
-            level->bounds.max.y = max(level->bounds.max.y, s->max.y);
-        }
+        // grow level bounds to include sector, blocks are allocated as needed
+        // so there is nothing to reallocate
+        level->bounds.min.x = min(level->bounds.min.x, floorf(sector->min.x));
+        level->bounds.min.y = min(level->bounds.min.y, floorf(sector->min.y));
+        level->bounds.max.x = max(level->bounds.max.x, ceilf(sector->max.x));
+        level->bounds.max.y = max(level->bounds.max.y, ceilf(sector->max.y));
 
         level_resize_blocks(level);
     }
 
-    if (!glms_vec2_eqv_eps(sector->min, old_min)
-        || !glms_vec2_eqv_eps(sector->max, old_max)) {
-        level_update_sector_blocks(
-            level,
-            sector,
-            &old_min,
-            &old_max);
-    }
+    // move between only those blocks which differ from its last block range
+    level_update_sector_blocks(level, sector);
 
     // assign subsectors IDs, assign into block map
     dynlist_each(sector->subs, it) {
@@ -1259,9 +1291,13 @@ done_sorting:
             it.el);
     }
 
-    // this sector + all possible neighbors must have visibility recalculated
-    sector_traverse_neighbors(
-        level, sector, traverse_compute_visible, NULL);
+    // if visibility-relevant geometry changed, this sector + anything which
+    // could see through it must have visibility recalculated
+    const hash_t vis_hash = compute_vis_hash(sector);
+    if (vis_hash != sector->vis_hash) {
+        sector->vis_hash = vis_hash;
+        mark_visibility_dirty(level, sector);
+    }
 
     // enqueue sides for update
     llist_each(sector_sides, &sector->sides, it) {
@@ -61,7 +61,11 @@ int sector_get_sides(
     side_t **sides,
     int n_sides);
 
-// update sector's PVS
+// trace sector's PVS into bits (at least as many bits as there are sectors)
+// without touching level->visibility, false if sector has no subsectors
+bool sector_trace_visibility(level_t *level, sector_t *sector, BITMAP *bits);
+
+// update sector's PVS, see visibility_set_row
 void sector_compute_visibility(level_t *level, sector_t *sector);
 
 // recalculates fields after update to sides, etc.
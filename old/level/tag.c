@@ -1,7 +1,10 @@
 #include "level/tag.h"
+#include "level/actor.h"
 #include "level/level_defs.h"
 #include "level/lptr.h"
 
+// #define DO_VERIFY_TAGS
+
 int *lptr_ptag(level_t *level, lptr_t ptr) {
     switch (LPTR_TYPE(ptr)) {
     case T_SIDE: return &LPTR_SIDE(level, ptr)->tag;
@@ -11,15 +14,112 @@ int *lptr_ptag(level_t *level, lptr_t ptr) {
     }
 }
 
-int tag_suggest(level_t *level) {
-    // always start from 1 (first valid tag)
-    for (int i = 1; i < TAG_MAX; i++) {
-        if (dynlist_size(level->tag_lists[i]) == 0) {
-            return i;
+// pointer to lptr_t tag_slot field, crashes if not T_HAS_TAG
+static int *lptr_ptag_slot(level_t *level, lptr_t ptr) {
+    switch (LPTR_TYPE(ptr)) {
+    case T_SIDE: return &LPTR_SIDE(level, ptr)->tag_slot;
+    case T_SECTOR: return &LPTR_SECTOR(level, ptr)->tag_slot;
+    case T_DECAL: return &LPTR_DECAL(level, ptr)->tag_slot;
+    default: ASSERT(false);
+    }
+}
+
+// put ptr at index i of tag list
+static void put_slot(level_t *level, int tag, int i, lptr_t ptr) {
+    level->tag_lists[tag][i] = ptr;
+    *lptr_ptag_slot(level, ptr) = i;
+}
+
+static void swap_slots(level_t *level, int tag, int i, int j) {
+    const lptr_t p = level->tag_lists[tag][i], q = level->tag_lists[tag][j];
+    put_slot(level, tag, i, q);
+    put_slot(level, tag, j, p);
+}
+
+static void list_add(level_t *level, int tag, lptr_t ptr) {
+    *dynlist_push(level->tag_lists[tag]) = ptr;
+    put_slot(level, tag, dynlist_size(level->tag_lists[tag]) - 1, ptr);
+
+    // keep sectors first
+    if (LPTR_TYPE(ptr) == T_SECTOR) {
+        swap_slots(
+            level,
+            tag,
+            level->tag_n_sectors[tag],
+            dynlist_size(level->tag_lists[tag]) - 1);
+        level->tag_n_sectors[tag]++;
+    }
+
+    bitmap_set(level->tags_used, tag);
+}
+
+static void list_remove(level_t *level, int tag, lptr_t ptr) {
+    int i = *lptr_ptag_slot(level, ptr);
+
+    ASSERT(
+        i >= 0
+            && i < (int) dynlist_size(level->tag_lists[tag])
+            && LPTR_EQ(level->tag_lists[tag][i], ptr));
+
+    // move hole to the end of the sectors, then to the end of the list
+    if (LPTR_TYPE(ptr) == T_SECTOR) {
+        const int last_sector = --level->tag_n_sectors[tag];
+        swap_slots(level, tag, i, last_sector);
+        i = last_sector;
+    }
+
+    const int last = dynlist_size(level->tag_lists[tag]) - 1;
+    swap_slots(level, tag, i, last);
+    dynlist_pop(level->tag_lists[tag]);
+
+    if (last == 0) {
+        bitmap_clr(level->tags_used, tag);
+    }
+}
+
+#ifdef DO_VERIFY_TAGS
+// checks tag list slots, sector partition and used bitmap for tag
+static void verify_tag(level_t *level, int tag) {
+    const DYNLIST(lptr_t) list = level->tag_lists[tag];
+
+    int n_sectors = 0;
+    dynlist_each(list, it) {
+        if (*lptr_ptag(level, *it.el) != tag
+            || *lptr_ptag_slot(level, *it.el) != it.i) {
+            WARN("bad tag slot %d in tag %d", it.i, tag);
         }
+
+        if (LPTR_TYPE(*it.el) == T_SECTOR) {
+            if (it.i != n_sectors) {
+                WARN("sector not at start of tag %d list", tag);
+            }
+
+            n_sectors++;
+        }
+    }
+
+    if (n_sectors != level->tag_n_sectors[tag]) {
+        WARN(
+            "tag %d has %d sectors, expected %d",
+            tag, n_sectors, level->tag_n_sectors[tag]);
+    }
+
+    if (bitmap_get(level->tags_used, tag) != (dynlist_size(list) != 0)) {
+        WARN("tag %d used bit is wrong", tag);
     }
+}
+#endif // ifdef DO_VERIFY_TAGS
+
+int tag_suggest(level_t *level) {
+    // always start from 1 (first valid tag)
+    const int tag = bitmap_find(level->tags_used, TAG_MAX, 1, false);
+    return tag == INT_MAX ? TAG_NONE : tag;
+}
 
-    return TAG_NONE;
+int tag_find(level_t *level, int tag, lptr_t *ptrs, int n) {
+    const int n_tagged = dynlist_size(level->tag_lists[tag]);
+    memcpy(ptrs, level->tag_lists[tag], min(n, n_tagged) * sizeof(lptr_t));
+    return n_tagged;
 }
 
 int tag_set_value(level_t *level, int tag, int val) {
@@ -28,15 +128,14 @@ int tag_set_value(level_t *level, int tag, int val) {
     // TODO: maybe don't do this in l_set_tag? kind of a weird spot, maybe
     // these should be done via some sort of flag on the tagged objects
     // trigger tagchange events
-    dynlist_each(level->tag_lists[tag], it) {
-        if (LPTR_TYPE(*it.el) == T_SECTOR) {
-            sector_t *s = LPTR_SECTOR(level, *it.el);
-            const sector_func_type_t *sft =
-                &SECTOR_FUNC_TYPE[s->func_type];
-            if (sft->tag_change) { sft->tag_change(level, s); }
-        }
+    for (int i = 0; i < level->tag_n_sectors[tag]; i++) {
+        sector_t *s = LPTR_SECTOR(level, level->tag_lists[tag][i]);
+        const sector_func_type_t *sft =
+            &SECTOR_FUNC_TYPE[s->func_type];
+        if (sft->tag_change) { sft->tag_change(level, s); }
     }
 
+    actor_wake_tag(level, tag);
     return val;
 }
 
@@ -54,26 +153,20 @@ void tag_set(level_t *level, lptr_t ptr, int tag) {
 
     // remove from old tag list
     if (*ptag != TAG_NONE) {
-        bool found = false;
-        dynlist_each(level->tag_lists[*ptag], it) {
-            if (LPTR_EQ(*it.el, ptr)) {
-                dynlist_remove_it(level->tag_lists[*ptag], it);
-                found = true;
-                break;
-            }
-        }
+        list_remove(level, *ptag, ptr);
 
-        ASSERT(found);
+#ifdef DO_VERIFY_TAGS
+        verify_tag(level, *ptag);
+#endif // ifdef DO_VERIFY_TAGS
     }
 
     *ptag = tag;
 
     if (tag != TAG_NONE) {
-        // should not be in existing taglist
-        dynlist_each(level->tag_lists[tag], it) {
-            ASSERT(!LPTR_EQ(*it.el, ptr));
-        }
+        list_add(level, tag, ptr);
 
-        *dynlist_push(level->tag_lists[tag]) = ptr;
+#ifdef DO_VERIFY_TAGS
+        verify_tag(level, tag);
+#endif // ifdef DO_VERIFY_TAGS
     }
 }
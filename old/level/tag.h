@@ -8,10 +8,11 @@
 // pointer to lptr_t tag field, crashes if not T_HAS_TAG
 int *lptr_ptag(level_t *level, lptr_t ptr);
 
-// suggest a new, unused tag
+// suggest a new, unused tag. O(TAG_MAX / 64)
 int tag_suggest(level_t *level);
 
-// find level objects with the specified tag
+// find level objects with the specified tag, copies up to n of them to ptrs
+// (sectors first) and returns the total number of tagged objects
 int tag_find(level_t *level, int tag, lptr_t *ptrs, int n);
 
 // set tag value
@@ -20,5 +21,5 @@ int tag_set_value(level_t *level, int tag, int val);
 // get tag value
 int tag_get_value(level_t *level, int tag);
 
-// sets tag on a taggable pointer (T_SIDE, T_SECTOR, T_DECAL)
+// sets tag on a taggable pointer (T_SIDE, T_SECTOR, T_DECAL). O(1)
 void tag_set(level_t *level, lptr_t ptr, int tag);
@@ -0,0 +1,754 @@
+#include "level/visibility.h"
+#include "level/level_defs.h"
+#include "level/level.h"
+#include "level/portal.h"
+#include "level/sector.h"
+#include "util/time.h"
+
+// #define DO_VERIFY_VIS_RUNS
+
+// sparse rows are DYNLIST(u32)s of [start, end) pairs of visible sector
+// indices, sorted by start and never adjacent or overlapping
+
+// encode first n bits of "bits" into runs
+static void runs_encode(DYNLIST(u32) *runs, const BITMAP *bits, int n) {
+    dynlist_resize(*runs, 0);
+
+    int i = 0;
+    while ((i = bitmap_find(bits, n, i, true)) != INT_MAX) {
+        const int end = min(bitmap_find(bits, n, i, false), n);
+        *dynlist_push(*runs) = i;
+        *dynlist_push(*runs) = end;
+        i = end;
+    }
+
+    // rows are mostly empty or a handful of runs, don't hold onto capacity
+    if (dynlist_size(*runs) == 0) {
+        dynlist_free(*runs);
+    }
+}
+
+// decode runs into bitmap of n bits
+static void runs_decode(const DYNLIST(u32) runs, BITMAP *bits, int n) {
+    bitmap_fill(bits, n, false);
+
+    for (int i = 0; i < dynlist_size(runs); i += 2) {
+        for (u32 j = runs[i]; j < runs[i + 1]; j++) {
+            bitmap_set(bits, j);
+        }
+    }
+}
+
+// binary search for the index of the first run which ends after i, the number
+// of runs if there is none
+static int runs_find(const DYNLIST(u32) runs, int i) {
+    int lo = 0, hi = dynlist_size(runs) / 2;
+
+    while (lo < hi) {
+        const int mid = (lo + hi) / 2;
+        if ((u32) i >= runs[mid * 2 + 1]) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
+
+// true if i is in runs
+static bool runs_get(const DYNLIST(u32) runs, int i) {
+    const int r = runs_find(runs, i) * 2;
+    return r < dynlist_size(runs) && runs[r] <= (u32) i;
+}
+
+// remove i from runs, splitting the run containing it if needed
+static void runs_clr(DYNLIST(u32) *runs, int i) {
+    const int r = runs_find(*runs, i) * 2;
+
+    if (r == dynlist_size(*runs) || (u32) i < (*runs)[r]) {
+        return;
+    }
+
+    const u32 start = (*runs)[r], end = (*runs)[r + 1];
+
+    if (start + 1 == end) {
+        dynlist_remove(*runs, r);
+        dynlist_remove(*runs, r);
+    } else if ((u32) i == start) {
+        (*runs)[r]++;
+    } else if ((u32) i == end - 1) {
+        (*runs)[r + 1]--;
+    } else {
+        (*runs)[r + 1] = i;
+        *dynlist_insert(*runs, r + 2) = end;
+        *dynlist_insert(*runs, r + 2) = i + 1;
+    }
+}
+
+// add i to runs, extending/merging neighboring runs if needed
+static void runs_set(DYNLIST(u32) *runs, int i) {
+    const int r = runs_find(*runs, i) * 2, n = dynlist_size(*runs);
+
+    if (r < n && (*runs)[r] <= (u32) i) {
+        return;
+    } else if (r > 0 && (*runs)[r - 1] == (u32) i) {
+        // extend previous run, merge with next run if they now touch
+        (*runs)[r - 1]++;
+
+        if (r < n && (*runs)[r] == (*runs)[r - 1]) {
+            (*runs)[r - 1] = (*runs)[r + 1];
+            dynlist_remove(*runs, r);
+            dynlist_remove(*runs, r);
+        }
+    } else if (r < n && (*runs)[r] == (u32) i + 1) {
+        (*runs)[r]--;
+    } else {
+        *dynlist_insert(*runs, r) = i + 1;
+        *dynlist_insert(*runs, r) = i;
+    }
+}
+
+bool visibility_is_sparse(const level_t *level) {
+    return level->visibility.runs != NULL;
+}
+
+void visibility_ensure(level_t *level, int n) {
+    const int n_old = level->visibility.n;
+
+    if ((level->visibility.matrix || level->visibility.runs) && n <= n_old) {
+        return;
+    }
+
+    int n_new = max(n_old, 64);
+    while (n_new < n) {
+        n_new *= 2;
+    }
+
+    DYNLIST(u32) *traced = calloc(n_new, sizeof(traced[0]));
+    if (level->visibility.traced) {
+        memcpy(traced, level->visibility.traced, n_old * sizeof(traced[0]));
+        free(level->visibility.traced);
+    }
+    level->visibility.traced = traced;
+
+    if (n_new > VISIBILITY_DENSE_MAX) {
+        DYNLIST(u32) *runs = calloc(n_new, sizeof(runs[0]));
+
+        if (level->visibility.runs) {
+            memcpy(runs, level->visibility.runs, n_old * sizeof(runs[0]));
+            free(level->visibility.runs);
+        } else if (level->visibility.matrix) {
+            // switching from dense -> sparse, encode existing rows
+            for (int i = 0; i < n_old; i++) {
+                runs_encode(
+                    &runs[i],
+                    &level->visibility.matrix[i * BITMAP_SIZE_TO_BYTES(n_old)],
+                    n_old);
+            }
+
+            free(level->visibility.matrix);
+            level->visibility.matrix = NULL;
+
+            LOG(
+                "switched to sparse visibility at %d sectors (%" PRIu64 " KiB)",
+                n,
+                (u64) (visibility_memory(level) / 1024));
+        }
+
+        level->visibility.runs = runs;
+        level->visibility.n = n_new;
+        return;
+    }
+
+    u8 *old = level->visibility.matrix;
+
+    level->visibility.matrix =
+        calloc(1, n_new * BITMAP_SIZE_TO_BYTES(n_new));
+    level->visibility.n = n_new;
+
+    if (old) {
+        // copy rows again
+        for (int i = 0; i < n_old; i++) {
+            memcpy(
+                &level->visibility.matrix[i * BITMAP_SIZE_TO_BYTES(n_new)],
+                &old[i * BITMAP_SIZE_TO_BYTES(n_old)],
+                BITMAP_SIZE_TO_BYTES(n_old));
+        }
+
+        free(old);
+    }
+}
+
+void visibility_destroy(level_t *level) {
+    if (level->visibility.matrix) {
+        free(level->visibility.matrix);
+    }
+
+    if (level->visibility.runs) {
+        for (int i = 0; i < level->visibility.n; i++) {
+            dynlist_free(level->visibility.runs[i]);
+        }
+
+        free(level->visibility.runs);
+    }
+
+    if (level->visibility.traced) {
+        for (int i = 0; i < level->visibility.n; i++) {
+            dynlist_free(level->visibility.traced[i]);
+        }
+
+        free(level->visibility.traced);
+    }
+
+    level->visibility.matrix = NULL;
+    level->visibility.runs = NULL;
+    level->visibility.traced = NULL;
+    level->visibility.n = 0;
+    level->visibility.baked = false;
+}
+
+const BITMAP *visibility_row(
+    const level_t *level,
+    const sector_t *sector,
+    BITMAP *scratch) {
+    if (sector->index >= level->visibility.n) {
+        return NULL;
+    } else if (level->visibility.matrix) {
+        return &level->visibility.matrix[
+            sector->index * BITMAP_SIZE_TO_BYTES(level->visibility.n)];
+    } else if (level->visibility.runs) {
+        runs_decode(
+            level->visibility.runs[sector->index],
+            scratch,
+            level->visibility.n);
+        return scratch;
+    }
+
+    return NULL;
+}
+
+bool visibility_get(const level_t *level, const sector_t *sector, int i) {
+    if (sector->index >= level->visibility.n) {
+        return false;
+    } else if (level->visibility.matrix) {
+        return bitmap_get(
+            &level->visibility.matrix[
+                sector->index * BITMAP_SIZE_TO_BYTES(level->visibility.n)],
+            i);
+    } else if (level->visibility.runs) {
+        return runs_get(level->visibility.runs[sector->index], i);
+    }
+
+    return false;
+}
+
+void visibility_set_row(
+    level_t *level,
+    const sector_t *sector,
+    const BITMAP *bits,
+    int n) {
+    visibility_ensure(level, max(n, sector->index + 1));
+
+    const int index = sector->index;
+    DYNLIST(u32) *traced = level->visibility.traced;
+
+    runs_encode(&traced[index], bits, n);
+
+    // pairs where the other sector's own trace agrees
+    BITMAP *agreed = bitmap_calloc(level->visibility.n);
+    bitmap_each_set(bits, n, i) {
+        if (i == index || runs_get(traced[i], index)) {
+            bitmap_set(agreed, i);
+        }
+    }
+
+    if (level->visibility.matrix) {
+        const int row_bytes = BITMAP_SIZE_TO_BYTES(level->visibility.n);
+
+        memcpy(&level->visibility.matrix[index * row_bytes], agreed, row_bytes);
+
+        // patch column so that rows stay symmetric
+        for (int i = 0; i < level->visibility.n; i++) {
+            if (i == index) { continue; }
+
+            bitmap_put(
+                &level->visibility.matrix[i * row_bytes],
+                index,
+                bitmap_get(agreed, i));
+        }
+    } else {
+        runs_encode(
+            &level->visibility.runs[index], agreed, level->visibility.n);
+
+        for (int i = 0; i < level->visibility.n; i++) {
+            if (i == index) { continue; }
+
+            if (bitmap_get(agreed, i)) {
+                runs_set(&level->visibility.runs[i], index);
+            } else {
+                runs_clr(&level->visibility.runs[i], index);
+            }
+        }
+
+#ifdef DO_VERIFY_VIS_RUNS
+        BITMAP *decoded = bitmap_alloc(n);
+        runs_decode(level->visibility.runs[index], decoded, n);
+        for (int i = 0; i < n; i++) {
+            if (bitmap_get(decoded, i) != bitmap_get(agreed, i)) {
+                WARN("bad visibility runs for sector %d at %d", index, i);
+                break;
+            }
+
+            if (i != index
+                && runs_get(level->visibility.runs[i], index)
+                    != bitmap_get(agreed, i)) {
+                WARN("bad visibility column for sector %d at %d", index, i);
+                break;
+            }
+        }
+        bitmap_free(decoded);
+#endif // ifdef DO_VERIFY_VIS_RUNS
+    }
+
+    bitmap_free(agreed);
+}
+
+void visibility_clear(level_t *level, const sector_t *sector) {
+    if (sector->index >= level->visibility.n) {
+        return;
+    }
+
+    if (level->visibility.traced) {
+        dynlist_free(level->visibility.traced[sector->index]);
+
+        for (int i = 0; i < level->visibility.n; i++) {
+            runs_clr(&level->visibility.traced[i], sector->index);
+        }
+    }
+
+    if (level->visibility.matrix) {
+        const int row_bytes = BITMAP_SIZE_TO_BYTES(level->visibility.n);
+
+        bitmap_fill(
+            &level->visibility.matrix[sector->index * row_bytes],
+            level->visibility.n,
+            false);
+
+        for (int i = 0; i < level->visibility.n; i++) {
+            bitmap_clr(&level->visibility.matrix[i * row_bytes], sector->index);
+        }
+    } else if (level->visibility.runs) {
+        dynlist_free(level->visibility.runs[sector->index]);
+
+        for (int i = 0; i < level->visibility.n; i++) {
+            runs_clr(&level->visibility.runs[i], sector->index);
+        }
+    }
+}
+
+// bytes used by n rows of runs
+static usize runs_memory(DYNLIST(u32) *runs, int n) {
+    usize size = n * sizeof(runs[0]);
+
+    for (int i = 0; i < n; i++) {
+        if (runs[i]) {
+            size +=
+                sizeof(dynlist_header)
+                    + dynlist_capacity(runs[i]) * sizeof(u32);
+        }
+    }
+
+    return size;
+}
+
+usize visibility_memory(const level_t *level) {
+    usize n = 0;
+
+    if (level->visibility.matrix) {
+        n += level->visibility.n * BITMAP_SIZE_TO_BYTES(level->visibility.n);
+    } else if (level->visibility.runs) {
+        n += runs_memory(level->visibility.runs, level->visibility.n);
+    }
+
+    if (level->visibility.traced) {
+        n += runs_memory(level->visibility.traced, level->visibility.n);
+    }
+
+    return n;
+}
+
+// max. number of portals a sightline is traced through when baking
+#define BAKE_MAX_DEPTH 256
+
+// epsilon for side tests when clipping
+#define BAKE_EPSILON 0.0001f
+
+typedef struct {
+    vec2s a, b;
+} vis_seg_t;
+
+// portal out of a subsector to another subsector
+typedef struct {
+    // line on "from" side
+    const sect_line_t *line;
+
+    // subsector on the other side
+    subsector_t *sub;
+
+    // if not NULL, the line is a disconnected portal and anything passing
+    // through it must be transformed from side -> side->portal
+    side_t *side;
+} vis_exit_t;
+
+typedef struct {
+    level_t *level;
+
+    // output sectors
+    BITMAP *bits;
+
+    // subsectors on current path, by id
+    BITMAP *path;
+
+    // DYNLIST(vis_exit_t) disconnected[id], exits via disconnected portals per
+    // subsector id
+    DYNLIST(vis_exit_t) *disconnected;
+} vis_bake_t;
+
+ALWAYS_INLINE vis_seg_t seg_from_line(const sect_line_t *line) {
+    return (vis_seg_t) { line->a->pos, line->b->pos };
+}
+
+ALWAYS_INLINE bool seg_is_degenerate(vis_seg_t s) {
+    return glms_vec2_distance2(s.a, s.b) < BAKE_EPSILON;
+}
+
+// clip segment to side of line p -> q on which r lies, false if nothing is left
+static bool clip_seg(vis_seg_t *seg, vec2s p, vec2s q, f32 r_side) {
+    const f32
+        sign = r_side > 0 ? 1.0f : -1.0f,
+        d0 = sign * point_side(seg->a, p, q),
+        d1 = sign * point_side(seg->b, p, q);
+
+    if (d0 >= -BAKE_EPSILON && d1 >= -BAKE_EPSILON) {
+        return true;
+    } else if (d0 < -BAKE_EPSILON && d1 < -BAKE_EPSILON) {
+        return false;
+    }
+
+    const vec2s x = glms_vec2_lerp(seg->a, seg->b, d0 / (d0 - d1));
+    if (d0 < 0) { seg->a = x; } else { seg->b = x; }
+    return !seg_is_degenerate(*seg);
+}
+
+// clip "seg" to the anti-penumbra of source through pass: the region where any
+// line through both "source" and "pass" can reach. this is bounded by the
+// separating lines from an endpoint of source to an endpoint of pass which
+// have source and pass on opposite sides; the anti-penumbra is on the side
+// of the other endpoint of pass.
+static bool clip_antipenumbra(vis_seg_t *seg, vis_seg_t source, vis_seg_t pass) {
+    const vec2s ss[2] = { source.a, source.b }, ps[2] = { pass.a, pass.b };
+
+    for (int i = 0; i < 2; i++) {
+        for (int j = 0; j < 2; j++) {
+            const f32
+                ds = point_side(ss[1 - i], ss[i], ps[j]),
+                dp = point_side(ps[1 - j], ss[i], ps[j]);
+
+            if (fabsf(dp) < BAKE_EPSILON || ds * dp > 0) { continue; }
+
+            if (!clip_seg(seg, ss[i], ps[j], dp)) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+ALWAYS_INLINE vis_seg_t seg_transform(level_t *level, side_t *side, vis_seg_t s) {
+    return (vis_seg_t) {
+        portal_transform(level, side, side->portal, s.a),
+        portal_transform(level, side, side->portal, s.b),
+    };
+}
+
+// get exit i of sub, where exits are first its neighbors, then its exits via
+// disconnected portals. returns false if exit is not passable.
+static bool get_exit(
+    const vis_bake_t *b,
+    const subsector_t *sub,
+    int i,
+    vis_exit_t *out) {
+    const int n_neighbors = dynlist_size(sub->neighbors);
+
+    if (i >= n_neighbors) {
+        *out = b->disconnected[sub->id][i - n_neighbors];
+        return true;
+    }
+
+    *out = (vis_exit_t) {
+        .line = sub->neighbors[i].line,
+        .sub = b->level->subsectors[sub->neighbors[i].id],
+    };
+
+    // disconnected portal walls can still be adjacent to whatever is on their
+    // other side, which is not visible through them
+    dynlist_each(b->disconnected[sub->id], it) {
+        if (sect_line_eq(it.el->line, out->line)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+ALWAYS_INLINE int num_exits(const vis_bake_t *b, const subsector_t *sub) {
+    return dynlist_size(sub->neighbors)
+        + dynlist_size(b->disconnected[sub->id]);
+}
+
+// sub was entered through "pass" and is visible, "source" is NULL if sub is
+// directly adjacent to the sector being computed. both are in sub's space.
+static void bake_flow(
+    vis_bake_t *b,
+    subsector_t *sub,
+    const vis_seg_t *source,
+    vis_seg_t pass,
+    int depth) {
+    bitmap_set(b->bits, sub->parent->index);
+
+    if (depth >= BAKE_MAX_DEPTH) {
+        WARN("sightline through > %d portals, stopping", BAKE_MAX_DEPTH);
+        return;
+    }
+
+    bitmap_set(b->path, sub->id);
+
+    for (int i = 0; i < num_exits(b, sub); i++) {
+        vis_exit_t exit;
+        if (!get_exit(b, sub, i, &exit)
+            || bitmap_get(b->path, exit.sub->id)) {
+            continue;
+        }
+
+        vis_seg_t target = seg_from_line(exit.line), from = pass;
+
+        // pass and target cannot be the same line (or points on it)
+        if (fabsf(point_side(target.a, pass.a, pass.b)) < BAKE_EPSILON
+            && fabsf(point_side(target.b, pass.a, pass.b)) < BAKE_EPSILON) {
+            continue;
+        }
+
+        if (source) {
+            // clip target to what can be seen from source through pass, then
+            // clip source to what can see clipped target through pass
+            from = *source;
+            if (!clip_antipenumbra(&target, from, pass)
+                || !clip_antipenumbra(&from, target, pass)) {
+                continue;
+            }
+        }
+
+        if (exit.side) {
+            from = seg_transform(b->level, exit.side, from);
+            target = seg_transform(b->level, exit.side, target);
+        }
+
+        bake_flow(b, exit.sub, &from, target, depth + 1);
+    }
+
+    bitmap_clr(b->path, sub->id);
+}
+
+// find subsector of sector with line on wall, NULL if there is none
+static const sect_line_t *find_wall_line(
+    sector_t *sector,
+    const wall_t *wall,
+    subsector_t **psub) {
+    const sect_line_t line = { .a = wall->v0, .b = wall->v1 };
+
+    dynlist_each(sector->subs, it) {
+        dynlist_each(it.el->lines, it_l) {
+            if (sect_line_eq(it_l.el, &line)) {
+                *psub = it.el;
+                return it_l.el;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+static void bake_init(vis_bake_t *b, level_t *level) {
+    *b = (vis_bake_t) {
+        .level = level,
+        .bits = bitmap_calloc(dynlist_size(level->sectors)),
+        .path = bitmap_calloc(dynlist_size(level->subsectors)),
+        .disconnected =
+            calloc(
+                max(dynlist_size(level->subsectors), 1),
+                sizeof(b->disconnected[0])),
+    };
+
+    level_dynlist_each(level->sides, it) {
+        side_t *side = *it.el;
+
+        if (!(side->flags & SIDE_FLAG_DISCONNECT)
+            || !side->portal
+            || !side->portal->sector
+            || !side->sector) {
+            continue;
+        }
+
+        subsector_t *from = NULL, *to = NULL;
+        const sect_line_t *line = find_wall_line(side->sector, side->wall, &from);
+
+        if (!line || !find_wall_line(side->portal->sector, side->portal->wall, &to)) {
+            continue;
+        }
+
+        *dynlist_push(b->disconnected[from->id]) = (vis_exit_t) {
+            .line = line,
+            .sub = to,
+            .side = side,
+        };
+    }
+}
+
+static void bake_destroy(vis_bake_t *b) {
+    for (int i = 0; i < dynlist_size(b->level->subsectors); i++) {
+        dynlist_free(b->disconnected[i]);
+    }
+
+    free(b->disconnected);
+    bitmap_free(b->path);
+    bitmap_free(b->bits);
+}
+
+// compute "exact" visibility for sector into b->bits by clipping
+// anti-penumbrae through all portal sequences leaving the sector, including
+// through disconnected portals
+static void bake_sector(vis_bake_t *b, sector_t *sector) {
+    bitmap_fill(b->bits, dynlist_size(b->level->sectors), false);
+    bitmap_set(b->bits, sector->index);
+
+    // any sightline out of the sector must leave through one of its boundary
+    // portals, so its own subsectors never need to be entered again
+    dynlist_each(sector->subs, it) {
+        bitmap_set(b->path, it.el->id);
+    }
+
+    dynlist_each(sector->subs, it) {
+        subsector_t *sub = it.el;
+
+        for (int i = 0; i < num_exits(b, sub); i++) {
+            vis_exit_t exit;
+            if (!get_exit(b, sub, i, &exit)
+                || bitmap_get(b->path, exit.sub->id)) {
+                continue;
+            }
+
+            vis_seg_t pass = seg_from_line(exit.line);
+            if (exit.side) {
+                pass = seg_transform(b->level, exit.side, pass);
+            }
+
+            bake_flow(b, exit.sub, NULL, pass, 1);
+        }
+    }
+
+    dynlist_each(sector->subs, it) {
+        bitmap_clr(b->path, it.el->id);
+    }
+}
+
+void visibility_bake(level_t *level) {
+    const int
+        n_sectors = dynlist_size(level->sectors),
+        row_bytes = BITMAP_SIZE_TO_BYTES(n_sectors);
+
+    vis_bake_t b;
+    bake_init(&b, level);
+
+    // rows are only set once all of them are traced, as setting a row patches
+    // the columns of every other row
+    BITMAP *baked = bitmap_calloc(max(n_sectors * row_bytes * 8, 1));
+
+    const u64 start = time_ns();
+
+    level_dynlist_each(level->sectors, it) {
+        bake_sector(&b, *it.el);
+        memcpy(&baked[(*it.el)->index * row_bytes], b.bits, row_bytes);
+    }
+
+    // sightlines are symmetric, but tracing from either end can disagree
+    // within BAKE_EPSILON: keep a pair if it was found from either side
+    for (int i = 0; i < n_sectors; i++) {
+        for (int j = i + 1; j < n_sectors; j++) {
+            if (bitmap_get(&baked[i * row_bytes], j)
+                != bitmap_get(&baked[j * row_bytes], i)) {
+                bitmap_set(&baked[i * row_bytes], j);
+                bitmap_set(&baked[j * row_bytes], i);
+            }
+        }
+    }
+
+    const u64 elapsed = time_ns() - start;
+
+    BITMAP
+        *scratch = bitmap_alloc(max(level->visibility.n, n_sectors)),
+        *old = bitmap_alloc(n_sectors),
+        *diff = bitmap_alloc(n_sectors);
+
+    int n_old = 0, n_new = 0, n_added = 0, n_removed = 0;
+
+    // compare against existing rows
+    level_dynlist_each(level->sectors, it) {
+        const BITMAP
+            *row = visibility_row(level, *it.el, scratch),
+            *bits = &baked[(*it.el)->index * row_bytes];
+
+        bitmap_fill(old, n_sectors, false);
+        if (row) {
+            memcpy(
+                old,
+                row,
+                BITMAP_SIZE_TO_BYTES(min(n_sectors, level->visibility.n)));
+        }
+
+        memcpy(diff, bits, row_bytes);
+        bitmap_and(diff, old, n_sectors);
+        const int
+            n_kept = bitmap_count_range(diff, 0, n_sectors, true),
+            n_row_old = bitmap_count_range(old, 0, n_sectors, true);
+
+        memcpy(diff, bits, row_bytes);
+        bitmap_andnot(diff, old, n_sectors);
+
+        n_old += n_row_old;
+        n_new += bitmap_count_range(bits, 0, n_sectors, true);
+        n_added += bitmap_count_range(diff, 0, n_sectors, true);
+        n_removed += n_row_old - n_kept;
+    }
+
+    level_dynlist_each(level->sectors, it) {
+        visibility_set_row(
+            level, *it.el, &baked[(*it.el)->index * row_bytes], n_sectors);
+    }
+
+    level->visibility.baked = true;
+
+    LOG(
+        "baked visibility for %d sectors in %.3f ms: "
+        "%d -> %d visible pairs (+%d, -%d)",
+        level_get_list_count(level, T_SECTOR),
+        elapsed / 1000000.0,
+        n_old, n_new, n_added, n_removed);
+
+    bitmap_free(baked);
+    bitmap_free(scratch);
+    bitmap_free(old);
+    bitmap_free(diff);
+    bake_destroy(&b);
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "util/bitmap.h"
+#include "defs.h"
+
+// ensure visibility storage has capacity for n sectors, converting to sparse
+// (run-length) rows when n exceeds VISIBILITY_DENSE_MAX
+void visibility_ensure(level_t *level, int n);
+
+// free all visibility storage
+void visibility_destroy(level_t *level);
+
+// true if visibility is stored as sparse rows rather than a dense matrix
+bool visibility_is_sparse(const level_t *level);
+
+// get the visibility row of a sector as a bitmap of level->visibility.n bits
+// if storage is sparse the row is decoded into "scratch", which must then be at
+// least BITMAP_SIZE_TO_BYTES(level->visibility.n) bytes
+// returns NULL if there is no visibility for this sector (yet)
+const BITMAP *visibility_row(
+    const level_t *level,
+    const sector_t *sector,
+    BITMAP *scratch);
+
+// true if sector with index "i" is in the visibility row of "sector"
+bool visibility_get(const level_t *level, const sector_t *sector, int i);
+
+// set the traced visibility of sector to the first n bits of "bits" and patch
+// its row and column in every other row to match, so that rows are always
+// symmetric (sector a is in b's row iff b is in a's row) and can be used as-is.
+// two sectors only see each other if both of their traces agree.
+void visibility_set_row(
+    level_t *level,
+    const sector_t *sector,
+    const BITMAP *bits,
+    int n);
+
+// clear row and column of sector so that nothing stale is left behind for
+// whichever sector reuses its index
+void visibility_clear(level_t *level, const sector_t *sector);
+
+// number of bytes currently used for visibility storage
+usize visibility_memory(const level_t *level);
+
+// replace visibility of all sectors with "exact" visibility, found by clipping
+// anti-penumbrae through all portal sequences leaving each sector (including
+// through disconnected portals), logging a comparison against the current
+// (incremental) visibility. this is much slower than sector_compute_visibility
+// and meant to be run on a finished level: baked rows are saved with the level
+// and used instead of sector_compute_visibility on load (see io.c) until any
+// sector's visibility changes, which makes the bake stale
+void visibility_bake(level_t *level);
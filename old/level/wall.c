@@ -97,13 +97,7 @@ void wall_recalculate(level_t *level, wall_t *wall) {
     wall->d = VEC2(b.x - a.x, b.y - a.y);
     wall->len = glms_vec2_norm(wall->d);
 
-    level_update_wall_blocks(
-        level,
-        wall,
-        &wall->last_pos[0],
-        &wall->last_pos[1]);
-    wall->last_pos[0] = wall->v0->pos;
-    wall->last_pos[1] = wall->v1->pos;
+    level_update_wall_blocks(level, wall);
 
     // recalculate sectors connected to this wall
     for (int i = 0; i < 2; i++) {
@@ -17,6 +17,7 @@
 #include "util/bitmap.h"
 #include "util/image.h"
 #include "util/sound.h"
+#include "util/sort.h"
 
 #include "level/vertex.h"
 #include "level/wall.h"
@@ -262,7 +263,12 @@ static void init() {
     state->sgl_state = sgl_create_state();
     sgl_set_state(state->sgl_state);
 
-    sg_setup(&(sg_desc) { .logger = (sg_logger) { .func = sg_logger_func } });
+    sg_setup(
+        &(sg_desc) {
+            .logger = (sg_logger) { .func = sg_logger_func },
+            // renderer has pipelines per portal depth
+            .pipeline_pool_size = 256,
+        });
 
     sgp_setup(&(sgp_desc) { .max_vertices = 65536 * 8 });
 
@@ -550,14 +556,7 @@ static void do_bullet(object_t *player) {
 }
 
 static void do_ui() {
-    object_t *player = NULL;
-    level_dynlist_each(state->level->objects, it) {
-        if ((*it.el)->type_index == OT_PLAYER) {
-            player = *it.el;
-            break;
-        }
-    }
-
+    object_t *player = object_get_player(state->level);
     if (!player) { 
         return; 
     }
@@ -576,6 +575,7 @@ static void do_ui() {
     }
 
     resource_t resource;
+    atlas_handle_t *handle;
     atlas_lookup_t lookup;
     ivec2s gun_pos;
 
@@ -583,12 +583,14 @@ static void do_ui() {
     switch (state->gun_mode) {
     case 1:
         resource = resource_from("HGUN2");
-        atlas_lookup(state->atlas, resource, &lookup);
+        handle = &state->gun_handles[0][0];
+        atlas_lookup_handle(state->atlas, handle, resource, &lookup);
         gun_pos = IVEC2(150, 0);
         break;
     case 2:
         resource = resource_from("HGUN4%c", (char) ('A' + frame));
-        atlas_lookup(state->atlas, resource, &lookup);
+        handle = &state->gun_handles[1][frame];
+        atlas_lookup_handle(state->atlas, handle, resource, &lookup);
         gun_pos = IVEC2(200, -20);
         break;
     }
@@ -686,6 +688,7 @@ static void do_ui() {
             &state->batcher,
             &(gfx_sprite_t) {
                 .res = AS_RESOURCE("HFLASH0"),
+                .handle = &state->flash_handle,
                 // TODO: this is only possible for 2 guns lol
                 .pos = state->gun_mode == 2 
                     ? IVEC_TO_V(glms_ivec2_add(gun_pos, IVEC2(4, 92))) 
@@ -706,6 +709,7 @@ static void do_ui() {
         &state->batcher,
         &(gfx_sprite_t) {
             .res = resource,
+            .handle = handle,
             .pos = IVEC_TO_V(gun_pos),
             .scale = VEC2(1),
             .color = VEC4(VEC3(light / (f32) LIGHT_MAX), 1),
@@ -1022,8 +1026,30 @@ static void frame() {
     SDL_GL_SwapWindow(state->window);
 }
 
-int main() {
+int main(int argc, char *argv[]) {
     state = calloc(1, sizeof(*state));
+
+    // headless golden check for CI: --check-golden <level> fails if
+    // <level>.golden(.png) are missing or differ, --update-golden <level>
+    // writes them
+    if (argc == 3
+        && (!strcmp(argv[1], "--check-golden")
+            || !strcmp(argv[1], "--update-golden"))) {
+        const int res =
+            state_check_golden(
+                state, argv[2], !strcmp(argv[1], "--update-golden"));
+        free(state);
+        return res;
+    }
+
+    // headless offline visibility bake: --bake-visibility <level> saves the
+    // level with baked visibility
+    if (argc == 3 && !strcmp(argv[1], "--bake-visibility")) {
+        const int res = state_bake_visibility(state, argv[2]);
+        free(state);
+        return res;
+    }
+
     init();
     while (!state->quit) frame();
     deinit();
@@ -8,7 +8,10 @@
 
 in vec3 a_position;
 in vec2 a_texcoord0;
-in float a_id;
+
+// id = x + (y << 16), float vertices only set x (y defaults to 0) while packed
+// vertices split id into two shorts, see render_vertex_t
+in vec2 a_id;
 in float a_index;
 in float a_flags;
 
@@ -32,7 +35,7 @@ void main() {
     pos_v = vec3(view * vec4(a_position, 1.0)).xyz;
     gl_Position = proj * vec4(pos_v, 1.0);
     uv = a_texcoord0;
-    id = int(a_id);
+    id = int(a_id.x) + (int(a_id.y) << 16);
     index = int(a_index);
     flags = int(a_flags);
     lookup_data(data_image, find_lsb(id >> 16), int(a_index), data);
@@ -145,7 +145,7 @@ SOKOL_SHDC_ALIGN(16) typedef struct level_fs_params_t {
     out vec2 uv;
     layout(location = 1) in vec2 a_texcoord0;
     flat out int id;
-    layout(location = 2) in float a_id;
+    layout(location = 2) in vec2 a_id;
     flat out int index;
     layout(location = 3) in float a_index;
     flat out int flags;
@@ -181,7 +181,7 @@ SOKOL_SHDC_ALIGN(16) typedef struct level_fs_params_t {
         pos_v = vec3((mat4(vs_params[0], vs_params[1], vs_params[2], vs_params[3]) * vec4(a_position, 1.0)).xyz);
         gl_Position = mat4(vs_params[4], vs_params[5], vs_params[6], vs_params[7]) * vec4(pos_v, 1.0);
         uv = a_texcoord0;
-        id = int(a_id);
+        id = int(a_id.x) + (int(a_id.y) << 16);
         int _156 = int(a_index);
         index = _156;
         flags = int(a_flags);
@@ -194,7 +194,7 @@ SOKOL_SHDC_ALIGN(16) typedef struct level_fs_params_t {
     }
     
 */
-static const char level_vs_source_glsl330[1460] = {
+static const char level_vs_source_glsl330[1483] = {
     0x23,0x76,0x65,0x72,0x73,0x69,0x6f,0x6e,0x20,0x33,0x33,0x30,0x0a,0x0a,0x75,0x6e,
     0x69,0x66,0x6f,0x72,0x6d,0x20,0x76,0x65,0x63,0x34,0x20,0x76,0x73,0x5f,0x70,0x61,
     0x72,0x61,0x6d,0x73,0x5b,0x38,0x5d,0x3b,0x0a,0x75,0x6e,0x69,0x66,0x6f,0x72,0x6d,
@@ -210,83 +210,84 @@ static const char level_vs_source_glsl330[1460] = {
     0x61,0x5f,0x74,0x65,0x78,0x63,0x6f,0x6f,0x72,0x64,0x30,0x3b,0x0a,0x66,0x6c,0x61,
     0x74,0x20,0x6f,0x75,0x74,0x20,0x69,0x6e,0x74,0x20,0x69,0x64,0x3b,0x0a,0x6c,0x61,
     0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,
-    0x32,0x29,0x20,0x69,0x6e,0x20,0x66,0x6c,0x6f,0x61,0x74,0x20,0x61,0x5f,0x69,0x64,
-    0x3b,0x0a,0x66,0x6c,0x61,0x74,0x20,0x6f,0x75,0x74,0x20,0x69,0x6e,0x74,0x20,0x69,
-    0x6e,0x64,0x65,0x78,0x3b,0x0a,0x6c,0x61,0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,
-    0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x33,0x29,0x20,0x69,0x6e,0x20,0x66,0x6c,
-    0x6f,0x61,0x74,0x20,0x61,0x5f,0x69,0x6e,0x64,0x65,0x78,0x3b,0x0a,0x66,0x6c,0x61,
-    0x74,0x20,0x6f,0x75,0x74,0x20,0x69,0x6e,0x74,0x20,0x66,0x6c,0x61,0x67,0x73,0x3b,
-    0x0a,0x6c,0x61,0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,
-    0x20,0x3d,0x20,0x34,0x29,0x20,0x69,0x6e,0x20,0x66,0x6c,0x6f,0x61,0x74,0x20,0x61,
-    0x5f,0x66,0x6c,0x61,0x67,0x73,0x3b,0x0a,0x66,0x6c,0x61,0x74,0x20,0x6f,0x75,0x74,
-    0x20,0x76,0x65,0x63,0x34,0x20,0x64,0x61,0x74,0x61,0x5b,0x38,0x5d,0x3b,0x0a,0x0a,
-    0x69,0x6e,0x74,0x20,0x66,0x69,0x6e,0x64,0x5f,0x6c,0x73,0x62,0x28,0x69,0x6e,0x74,
-    0x20,0x78,0x29,0x0a,0x7b,0x0a,0x20,0x20,0x20,0x20,0x69,0x6e,0x74,0x20,0x72,0x65,
-    0x73,0x20,0x3d,0x20,0x2d,0x31,0x3b,0x0a,0x20,0x20,0x20,0x20,0x66,0x6f,0x72,0x20,
-    0x28,0x69,0x6e,0x74,0x20,0x69,0x20,0x3d,0x20,0x30,0x3b,0x20,0x69,0x20,0x3c,0x20,
-    0x33,0x32,0x3b,0x20,0x69,0x2b,0x2b,0x29,0x0a,0x20,0x20,0x20,0x20,0x7b,0x0a,0x20,
-    0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x69,0x66,0x20,0x28,0x28,0x78,0x20,0x26,0x20,
-    0x28,0x31,0x20,0x3c,0x3c,0x20,0x69,0x29,0x29,0x20,0x21,0x3d,0x20,0x30,0x29,0x0a,
-    0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x7b,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,
-    0x20,0x20,0x20,0x20,0x20,0x20,0x72,0x65,0x73,0x20,0x3d,0x20,0x69,0x3b,0x0a,0x20,
-    0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x62,0x72,0x65,0x61,0x6b,
-    0x3b,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x7d,0x0a,0x20,0x20,0x20,0x20,
-    0x7d,0x0a,0x20,0x20,0x20,0x20,0x72,0x65,0x74,0x75,0x72,0x6e,0x20,0x72,0x65,0x73,
-    0x3b,0x0a,0x7d,0x0a,0x0a,0x76,0x6f,0x69,0x64,0x20,0x6c,0x6f,0x6f,0x6b,0x75,0x70,
-    0x5f,0x64,0x61,0x74,0x61,0x28,0x73,0x61,0x6d,0x70,0x6c,0x65,0x72,0x32,0x44,0x41,
-    0x72,0x72,0x61,0x79,0x20,0x64,0x61,0x74,0x61,0x5f,0x69,0x6d,0x61,0x67,0x65,0x5f,
-    0x31,0x2c,0x20,0x69,0x6e,0x74,0x20,0x74,0x79,0x70,0x65,0x5f,0x69,0x6e,0x64,0x65,
-    0x78,0x2c,0x20,0x69,0x6e,0x74,0x20,0x69,0x6e,0x64,0x65,0x78,0x5f,0x31,0x2c,0x20,
-    0x69,0x6e,0x6f,0x75,0x74,0x20,0x76,0x65,0x63,0x34,0x20,0x64,0x61,0x74,0x61,0x5f,
-    0x31,0x5b,0x38,0x5d,0x29,0x0a,0x7b,0x0a,0x20,0x20,0x20,0x20,0x76,0x65,0x63,0x33,
-    0x20,0x5f,0x36,0x37,0x20,0x3d,0x20,0x76,0x65,0x63,0x33,0x28,0x74,0x65,0x78,0x74,
-    0x75,0x72,0x65,0x53,0x69,0x7a,0x65,0x28,0x64,0x61,0x74,0x61,0x5f,0x69,0x6d,0x61,
-    0x67,0x65,0x5f,0x31,0x2c,0x20,0x30,0x29,0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,0x66,
-    0x6f,0x72,0x20,0x28,0x69,0x6e,0x74,0x20,0x69,0x20,0x3d,0x20,0x30,0x3b,0x20,0x69,
-    0x20,0x3c,0x20,0x38,0x3b,0x20,0x69,0x2b,0x2b,0x29,0x0a,0x20,0x20,0x20,0x20,0x7b,
-    0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x64,0x61,0x74,0x61,0x5f,0x31,0x5b,
-    0x69,0x5d,0x20,0x3d,0x20,0x74,0x65,0x78,0x74,0x75,0x72,0x65,0x4c,0x6f,0x64,0x28,
-    0x64,0x61,0x74,0x61,0x5f,0x69,0x6d,0x61,0x67,0x65,0x5f,0x31,0x2c,0x20,0x76,0x65,
-    0x63,0x33,0x28,0x66,0x6c,0x6f,0x61,0x74,0x28,0x69,0x29,0x20,0x2f,0x20,0x5f,0x36,
-    0x37,0x2e,0x78,0x2c,0x20,0x66,0x6c,0x6f,0x61,0x74,0x28,0x69,0x6e,0x64,0x65,0x78,
-    0x5f,0x31,0x29,0x20,0x2f,0x20,0x5f,0x36,0x37,0x2e,0x79,0x2c,0x20,0x66,0x6c,0x6f,
-    0x61,0x74,0x28,0x74,0x79,0x70,0x65,0x5f,0x69,0x6e,0x64,0x65,0x78,0x29,0x29,0x2c,
-    0x20,0x30,0x2e,0x30,0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,0x7d,0x0a,0x7d,0x0a,0x0a,
-    0x76,0x6f,0x69,0x64,0x20,0x6d,0x61,0x69,0x6e,0x28,0x29,0x0a,0x7b,0x0a,0x20,0x20,
-    0x20,0x20,0x70,0x6f,0x73,0x5f,0x77,0x20,0x3d,0x20,0x61,0x5f,0x70,0x6f,0x73,0x69,
-    0x74,0x69,0x6f,0x6e,0x3b,0x0a,0x20,0x20,0x20,0x20,0x70,0x6f,0x73,0x5f,0x76,0x20,
-    0x3d,0x20,0x76,0x65,0x63,0x33,0x28,0x28,0x6d,0x61,0x74,0x34,0x28,0x76,0x73,0x5f,
-    0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,0x30,0x5d,0x2c,0x20,0x76,0x73,0x5f,0x70,0x61,
-    0x72,0x61,0x6d,0x73,0x5b,0x31,0x5d,0x2c,0x20,0x76,0x73,0x5f,0x70,0x61,0x72,0x61,
-    0x6d,0x73,0x5b,0x32,0x5d,0x2c,0x20,0x76,0x73,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,
-    0x5b,0x33,0x5d,0x29,0x20,0x2a,0x20,0x76,0x65,0x63,0x34,0x28,0x61,0x5f,0x70,0x6f,
-    0x73,0x69,0x74,0x69,0x6f,0x6e,0x2c,0x20,0x31,0x2e,0x30,0x29,0x29,0x2e,0x78,0x79,
-    0x7a,0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,0x67,0x6c,0x5f,0x50,0x6f,0x73,0x69,0x74,
-    0x69,0x6f,0x6e,0x20,0x3d,0x20,0x6d,0x61,0x74,0x34,0x28,0x76,0x73,0x5f,0x70,0x61,
-    0x72,0x61,0x6d,0x73,0x5b,0x34,0x5d,0x2c,0x20,0x76,0x73,0x5f,0x70,0x61,0x72,0x61,
-    0x6d,0x73,0x5b,0x35,0x5d,0x2c,0x20,0x76,0x73,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,
-    0x5b,0x36,0x5d,0x2c,0x20,0x76,0x73,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,0x37,
-    0x5d,0x29,0x20,0x2a,0x20,0x76,0x65,0x63,0x34,0x28,0x70,0x6f,0x73,0x5f,0x76,0x2c,
-    0x20,0x31,0x2e,0x30,0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,0x75,0x76,0x20,0x3d,0x20,
-    0x61,0x5f,0x74,0x65,0x78,0x63,0x6f,0x6f,0x72,0x64,0x30,0x3b,0x0a,0x20,0x20,0x20,
-    0x20,0x69,0x64,0x20,0x3d,0x20,0x69,0x6e,0x74,0x28,0x61,0x5f,0x69,0x64,0x29,0x3b,
-    0x0a,0x20,0x20,0x20,0x20,0x69,0x6e,0x74,0x20,0x5f,0x31,0x35,0x36,0x20,0x3d,0x20,
-    0x69,0x6e,0x74,0x28,0x61,0x5f,0x69,0x6e,0x64,0x65,0x78,0x29,0x3b,0x0a,0x20,0x20,
-    0x20,0x20,0x69,0x6e,0x64,0x65,0x78,0x20,0x3d,0x20,0x5f,0x31,0x35,0x36,0x3b,0x0a,
-    0x20,0x20,0x20,0x20,0x66,0x6c,0x61,0x67,0x73,0x20,0x3d,0x20,0x69,0x6e,0x74,0x28,
-    0x61,0x5f,0x66,0x6c,0x61,0x67,0x73,0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,0x69,0x6e,
-    0x74,0x20,0x70,0x61,0x72,0x61,0x6d,0x20,0x3d,0x20,0x69,0x64,0x20,0x3e,0x3e,0x20,
-    0x31,0x36,0x3b,0x0a,0x20,0x20,0x20,0x20,0x69,0x6e,0x74,0x20,0x70,0x61,0x72,0x61,
-    0x6d,0x5f,0x31,0x20,0x3d,0x20,0x66,0x69,0x6e,0x64,0x5f,0x6c,0x73,0x62,0x28,0x70,
-    0x61,0x72,0x61,0x6d,0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,0x69,0x6e,0x74,0x20,0x70,
-    0x61,0x72,0x61,0x6d,0x5f,0x32,0x20,0x3d,0x20,0x5f,0x31,0x35,0x36,0x3b,0x0a,0x20,
-    0x20,0x20,0x20,0x76,0x65,0x63,0x34,0x20,0x70,0x61,0x72,0x61,0x6d,0x5f,0x33,0x5b,
-    0x38,0x5d,0x3b,0x0a,0x20,0x20,0x20,0x20,0x6c,0x6f,0x6f,0x6b,0x75,0x70,0x5f,0x64,
-    0x61,0x74,0x61,0x28,0x64,0x61,0x74,0x61,0x5f,0x69,0x6d,0x61,0x67,0x65,0x2c,0x20,
-    0x70,0x61,0x72,0x61,0x6d,0x5f,0x31,0x2c,0x20,0x70,0x61,0x72,0x61,0x6d,0x5f,0x32,
-    0x2c,0x20,0x70,0x61,0x72,0x61,0x6d,0x5f,0x33,0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,
-    0x64,0x61,0x74,0x61,0x20,0x3d,0x20,0x70,0x61,0x72,0x61,0x6d,0x5f,0x33,0x3b,0x0a,
-    0x7d,0x0a,0x0a,0x00,
+    0x32,0x29,0x20,0x69,0x6e,0x20,0x76,0x65,0x63,0x32,0x20,0x61,0x5f,0x69,0x64,0x3b,
+    0x0a,0x66,0x6c,0x61,0x74,0x20,0x6f,0x75,0x74,0x20,0x69,0x6e,0x74,0x20,0x69,0x6e,
+    0x64,0x65,0x78,0x3b,0x0a,0x6c,0x61,0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,0x61,
+    0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x33,0x29,0x20,0x69,0x6e,0x20,0x66,0x6c,0x6f,
+    0x61,0x74,0x20,0x61,0x5f,0x69,0x6e,0x64,0x65,0x78,0x3b,0x0a,0x66,0x6c,0x61,0x74,
+    0x20,0x6f,0x75,0x74,0x20,0x69,0x6e,0x74,0x20,0x66,0x6c,0x61,0x67,0x73,0x3b,0x0a,
+    0x6c,0x61,0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,
+    0x3d,0x20,0x34,0x29,0x20,0x69,0x6e,0x20,0x66,0x6c,0x6f,0x61,0x74,0x20,0x61,0x5f,
+    0x66,0x6c,0x61,0x67,0x73,0x3b,0x0a,0x66,0x6c,0x61,0x74,0x20,0x6f,0x75,0x74,0x20,
+    0x76,0x65,0x63,0x34,0x20,0x64,0x61,0x74,0x61,0x5b,0x38,0x5d,0x3b,0x0a,0x0a,0x69,
+    0x6e,0x74,0x20,0x66,0x69,0x6e,0x64,0x5f,0x6c,0x73,0x62,0x28,0x69,0x6e,0x74,0x20,
+    0x78,0x29,0x0a,0x7b,0x0a,0x20,0x20,0x20,0x20,0x69,0x6e,0x74,0x20,0x72,0x65,0x73,
+    0x20,0x3d,0x20,0x2d,0x31,0x3b,0x0a,0x20,0x20,0x20,0x20,0x66,0x6f,0x72,0x20,0x28,
+    0x69,0x6e,0x74,0x20,0x69,0x20,0x3d,0x20,0x30,0x3b,0x20,0x69,0x20,0x3c,0x20,0x33,
+    0x32,0x3b,0x20,0x69,0x2b,0x2b,0x29,0x0a,0x20,0x20,0x20,0x20,0x7b,0x0a,0x20,0x20,
+    0x20,0x20,0x20,0x20,0x20,0x20,0x69,0x66,0x20,0x28,0x28,0x78,0x20,0x26,0x20,0x28,
+    0x31,0x20,0x3c,0x3c,0x20,0x69,0x29,0x29,0x20,0x21,0x3d,0x20,0x30,0x29,0x0a,0x20,
+    0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x7b,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,
+    0x20,0x20,0x20,0x20,0x20,0x72,0x65,0x73,0x20,0x3d,0x20,0x69,0x3b,0x0a,0x20,0x20,
+    0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x62,0x72,0x65,0x61,0x6b,0x3b,
+    0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x7d,0x0a,0x20,0x20,0x20,0x20,0x7d,
+    0x0a,0x20,0x20,0x20,0x20,0x72,0x65,0x74,0x75,0x72,0x6e,0x20,0x72,0x65,0x73,0x3b,
+    0x0a,0x7d,0x0a,0x0a,0x76,0x6f,0x69,0x64,0x20,0x6c,0x6f,0x6f,0x6b,0x75,0x70,0x5f,
+    0x64,0x61,0x74,0x61,0x28,0x73,0x61,0x6d,0x70,0x6c,0x65,0x72,0x32,0x44,0x41,0x72,
+    0x72,0x61,0x79,0x20,0x64,0x61,0x74,0x61,0x5f,0x69,0x6d,0x61,0x67,0x65,0x5f,0x31,
+    0x2c,0x20,0x69,0x6e,0x74,0x20,0x74,0x79,0x70,0x65,0x5f,0x69,0x6e,0x64,0x65,0x78,
+    0x2c,0x20,0x69,0x6e,0x74,0x20,0x69,0x6e,0x64,0x65,0x78,0x5f,0x31,0x2c,0x20,0x69,
+    0x6e,0x6f,0x75,0x74,0x20,0x76,0x65,0x63,0x34,0x20,0x64,0x61,0x74,0x61,0x5f,0x31,
+    0x5b,0x38,0x5d,0x29,0x0a,0x7b,0x0a,0x20,0x20,0x20,0x20,0x76,0x65,0x63,0x33,0x20,
+    0x5f,0x36,0x37,0x20,0x3d,0x20,0x76,0x65,0x63,0x33,0x28,0x74,0x65,0x78,0x74,0x75,
+    0x72,0x65,0x53,0x69,0x7a,0x65,0x28,0x64,0x61,0x74,0x61,0x5f,0x69,0x6d,0x61,0x67,
+    0x65,0x5f,0x31,0x2c,0x20,0x30,0x29,0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,0x66,0x6f,
+    0x72,0x20,0x28,0x69,0x6e,0x74,0x20,0x69,0x20,0x3d,0x20,0x30,0x3b,0x20,0x69,0x20,
+    0x3c,0x20,0x38,0x3b,0x20,0x69,0x2b,0x2b,0x29,0x0a,0x20,0x20,0x20,0x20,0x7b,0x0a,
+    0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x64,0x61,0x74,0x61,0x5f,0x31,0x5b,0x69,
+    0x5d,0x20,0x3d,0x20,0x74,0x65,0x78,0x74,0x75,0x72,0x65,0x4c,0x6f,0x64,0x28,0x64,
+    0x61,0x74,0x61,0x5f,0x69,0x6d,0x61,0x67,0x65,0x5f,0x31,0x2c,0x20,0x76,0x65,0x63,
+    0x33,0x28,0x66,0x6c,0x6f,0x61,0x74,0x28,0x69,0x29,0x20,0x2f,0x20,0x5f,0x36,0x37,
+    0x2e,0x78,0x2c,0x20,0x66,0x6c,0x6f,0x61,0x74,0x28,0x69,0x6e,0x64,0x65,0x78,0x5f,
+    0x31,0x29,0x20,0x2f,0x20,0x5f,0x36,0x37,0x2e,0x79,0x2c,0x20,0x66,0x6c,0x6f,0x61,
+    0x74,0x28,0x74,0x79,0x70,0x65,0x5f,0x69,0x6e,0x64,0x65,0x78,0x29,0x29,0x2c,0x20,
+    0x30,0x2e,0x30,0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,0x7d,0x0a,0x7d,0x0a,0x0a,0x76,
+    0x6f,0x69,0x64,0x20,0x6d,0x61,0x69,0x6e,0x28,0x29,0x0a,0x7b,0x0a,0x20,0x20,0x20,
+    0x20,0x70,0x6f,0x73,0x5f,0x77,0x20,0x3d,0x20,0x61,0x5f,0x70,0x6f,0x73,0x69,0x74,
+    0x69,0x6f,0x6e,0x3b,0x0a,0x20,0x20,0x20,0x20,0x70,0x6f,0x73,0x5f,0x76,0x20,0x3d,
+    0x20,0x76,0x65,0x63,0x33,0x28,0x28,0x6d,0x61,0x74,0x34,0x28,0x76,0x73,0x5f,0x70,
+    0x61,0x72,0x61,0x6d,0x73,0x5b,0x30,0x5d,0x2c,0x20,0x76,0x73,0x5f,0x70,0x61,0x72,
+    0x61,0x6d,0x73,0x5b,0x31,0x5d,0x2c,0x20,0x76,0x73,0x5f,0x70,0x61,0x72,0x61,0x6d,
+    0x73,0x5b,0x32,0x5d,0x2c,0x20,0x76,0x73,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,
+    0x33,0x5d,0x29,0x20,0x2a,0x20,0x76,0x65,0x63,0x34,0x28,0x61,0x5f,0x70,0x6f,0x73,
+    0x69,0x74,0x69,0x6f,0x6e,0x2c,0x20,0x31,0x2e,0x30,0x29,0x29,0x2e,0x78,0x79,0x7a,
+    0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,0x67,0x6c,0x5f,0x50,0x6f,0x73,0x69,0x74,0x69,
+    0x6f,0x6e,0x20,0x3d,0x20,0x6d,0x61,0x74,0x34,0x28,0x76,0x73,0x5f,0x70,0x61,0x72,
+    0x61,0x6d,0x73,0x5b,0x34,0x5d,0x2c,0x20,0x76,0x73,0x5f,0x70,0x61,0x72,0x61,0x6d,
+    0x73,0x5b,0x35,0x5d,0x2c,0x20,0x76,0x73,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,
+    0x36,0x5d,0x2c,0x20,0x76,0x73,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,0x37,0x5d,
+    0x29,0x20,0x2a,0x20,0x76,0x65,0x63,0x34,0x28,0x70,0x6f,0x73,0x5f,0x76,0x2c,0x20,
+    0x31,0x2e,0x30,0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,0x75,0x76,0x20,0x3d,0x20,0x61,
+    0x5f,0x74,0x65,0x78,0x63,0x6f,0x6f,0x72,0x64,0x30,0x3b,0x0a,0x20,0x20,0x20,0x20,
+    0x69,0x64,0x20,0x3d,0x20,0x69,0x6e,0x74,0x28,0x61,0x5f,0x69,0x64,0x2e,0x78,0x29,
+    0x20,0x2b,0x20,0x28,0x69,0x6e,0x74,0x28,0x61,0x5f,0x69,0x64,0x2e,0x79,0x29,0x20,
+    0x3c,0x3c,0x20,0x31,0x36,0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,0x69,0x6e,0x74,0x20,
+    0x5f,0x31,0x35,0x36,0x20,0x3d,0x20,0x69,0x6e,0x74,0x28,0x61,0x5f,0x69,0x6e,0x64,
+    0x65,0x78,0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,0x69,0x6e,0x64,0x65,0x78,0x20,0x3d,
+    0x20,0x5f,0x31,0x35,0x36,0x3b,0x0a,0x20,0x20,0x20,0x20,0x66,0x6c,0x61,0x67,0x73,
+    0x20,0x3d,0x20,0x69,0x6e,0x74,0x28,0x61,0x5f,0x66,0x6c,0x61,0x67,0x73,0x29,0x3b,
+    0x0a,0x20,0x20,0x20,0x20,0x69,0x6e,0x74,0x20,0x70,0x61,0x72,0x61,0x6d,0x20,0x3d,
+    0x20,0x69,0x64,0x20,0x3e,0x3e,0x20,0x31,0x36,0x3b,0x0a,0x20,0x20,0x20,0x20,0x69,
+    0x6e,0x74,0x20,0x70,0x61,0x72,0x61,0x6d,0x5f,0x31,0x20,0x3d,0x20,0x66,0x69,0x6e,
+    0x64,0x5f,0x6c,0x73,0x62,0x28,0x70,0x61,0x72,0x61,0x6d,0x29,0x3b,0x0a,0x20,0x20,
+    0x20,0x20,0x69,0x6e,0x74,0x20,0x70,0x61,0x72,0x61,0x6d,0x5f,0x32,0x20,0x3d,0x20,
+    0x5f,0x31,0x35,0x36,0x3b,0x0a,0x20,0x20,0x20,0x20,0x76,0x65,0x63,0x34,0x20,0x70,
+    0x61,0x72,0x61,0x6d,0x5f,0x33,0x5b,0x38,0x5d,0x3b,0x0a,0x20,0x20,0x20,0x20,0x6c,
+    0x6f,0x6f,0x6b,0x75,0x70,0x5f,0x64,0x61,0x74,0x61,0x28,0x64,0x61,0x74,0x61,0x5f,
+    0x69,0x6d,0x61,0x67,0x65,0x2c,0x20,0x70,0x61,0x72,0x61,0x6d,0x5f,0x31,0x2c,0x20,
+    0x70,0x61,0x72,0x61,0x6d,0x5f,0x32,0x2c,0x20,0x70,0x61,0x72,0x61,0x6d,0x5f,0x33,
+    0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,0x64,0x61,0x74,0x61,0x20,0x3d,0x20,0x70,0x61,
+    0x72,0x61,0x6d,0x5f,0x33,0x3b,0x0a,0x7d,0x0a,0x0a,0x00,
 };
 /*
     #version 330
@@ -1377,7 +1378,7 @@ static const char level_fs_source_glsl330[10670] = {
     out vec2 uv;
     layout(location = 1) in vec2 a_texcoord0;
     flat out int id;
-    layout(location = 2) in float a_id;
+    layout(location = 2) in vec2 a_id;
     flat out int index;
     layout(location = 3) in float a_index;
     flat out int flags;
@@ -1413,7 +1414,7 @@ static const char level_fs_source_glsl330[10670] = {
         pos_v = vec3((mat4(vs_params[0], vs_params[1], vs_params[2], vs_params[3]) * vec4(a_position, 1.0)).xyz);
         gl_Position = mat4(vs_params[4], vs_params[5], vs_params[6], vs_params[7]) * vec4(pos_v, 1.0);
         uv = a_texcoord0;
-        id = int(a_id);
+        id = int(a_id.x) + (int(a_id.y) << 16);
         int _156 = int(a_index);
         index = _156;
         flags = int(a_flags);
@@ -1426,7 +1427,7 @@ static const char level_fs_source_glsl330[10670] = {
     }
     
 */
-static const char level_vs_source_glsl300es[1475] = {
+static const char level_vs_source_glsl300es[1498] = {
     0x23,0x76,0x65,0x72,0x73,0x69,0x6f,0x6e,0x20,0x33,0x30,0x30,0x20,0x65,0x73,0x0a,
     0x0a,0x75,0x6e,0x69,0x66,0x6f,0x72,0x6d,0x20,0x76,0x65,0x63,0x34,0x20,0x76,0x73,
     0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,0x38,0x5d,0x3b,0x0a,0x75,0x6e,0x69,0x66,
@@ -1442,84 +1443,85 @@ static const char level_vs_source_glsl300es[1475] = {
     0x20,0x69,0x6e,0x20,0x76,0x65,0x63,0x32,0x20,0x61,0x5f,0x74,0x65,0x78,0x63,0x6f,
     0x6f,0x72,0x64,0x30,0x3b,0x0a,0x66,0x6c,0x61,0x74,0x20,0x6f,0x75,0x74,0x20,0x69,
     0x6e,0x74,0x20,0x69,0x64,0x3b,0x0a,0x6c,0x61,0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,
-    0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x32,0x29,0x20,0x69,0x6e,0x20,0x66,
-    0x6c,0x6f,0x61,0x74,0x20,0x61,0x5f,0x69,0x64,0x3b,0x0a,0x66,0x6c,0x61,0x74,0x20,
-    0x6f,0x75,0x74,0x20,0x69,0x6e,0x74,0x20,0x69,0x6e,0x64,0x65,0x78,0x3b,0x0a,0x6c,
-    0x61,0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,
-    0x20,0x33,0x29,0x20,0x69,0x6e,0x20,0x66,0x6c,0x6f,0x61,0x74,0x20,0x61,0x5f,0x69,
-    0x6e,0x64,0x65,0x78,0x3b,0x0a,0x66,0x6c,0x61,0x74,0x20,0x6f,0x75,0x74,0x20,0x69,
-    0x6e,0x74,0x20,0x66,0x6c,0x61,0x67,0x73,0x3b,0x0a,0x6c,0x61,0x79,0x6f,0x75,0x74,
-    0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x34,0x29,0x20,0x69,
-    0x6e,0x20,0x66,0x6c,0x6f,0x61,0x74,0x20,0x61,0x5f,0x66,0x6c,0x61,0x67,0x73,0x3b,
-    0x0a,0x66,0x6c,0x61,0x74,0x20,0x6f,0x75,0x74,0x20,0x76,0x65,0x63,0x34,0x20,0x64,
-    0x61,0x74,0x61,0x5b,0x38,0x5d,0x3b,0x0a,0x0a,0x69,0x6e,0x74,0x20,0x66,0x69,0x6e,
-    0x64,0x5f,0x6c,0x73,0x62,0x28,0x69,0x6e,0x74,0x20,0x78,0x29,0x0a,0x7b,0x0a,0x20,
-    0x20,0x20,0x20,0x69,0x6e,0x74,0x20,0x72,0x65,0x73,0x20,0x3d,0x20,0x2d,0x31,0x3b,
-    0x0a,0x20,0x20,0x20,0x20,0x66,0x6f,0x72,0x20,0x28,0x69,0x6e,0x74,0x20,0x69,0x20,
-    0x3d,0x20,0x30,0x3b,0x20,0x69,0x20,0x3c,0x20,0x33,0x32,0x3b,0x20,0x69,0x2b,0x2b,
-    0x29,0x0a,0x20,0x20,0x20,0x20,0x7b,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,
-    0x69,0x66,0x20,0x28,0x28,0x78,0x20,0x26,0x20,0x28,0x31,0x20,0x3c,0x3c,0x20,0x69,
-    0x29,0x29,0x20,0x21,0x3d,0x20,0x30,0x29,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,
-    0x20,0x7b,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x72,
-    0x65,0x73,0x20,0x3d,0x20,0x69,0x3b,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,
-    0x20,0x20,0x20,0x20,0x62,0x72,0x65,0x61,0x6b,0x3b,0x0a,0x20,0x20,0x20,0x20,0x20,
-    0x20,0x20,0x20,0x7d,0x0a,0x20,0x20,0x20,0x20,0x7d,0x0a,0x20,0x20,0x20,0x20,0x72,
-    0x65,0x74,0x75,0x72,0x6e,0x20,0x72,0x65,0x73,0x3b,0x0a,0x7d,0x0a,0x0a,0x76,0x6f,
-    0x69,0x64,0x20,0x6c,0x6f,0x6f,0x6b,0x75,0x70,0x5f,0x64,0x61,0x74,0x61,0x28,0x68,
-    0x69,0x67,0x68,0x70,0x20,0x73,0x61,0x6d,0x70,0x6c,0x65,0x72,0x32,0x44,0x41,0x72,
-    0x72,0x61,0x79,0x20,0x64,0x61,0x74,0x61,0x5f,0x69,0x6d,0x61,0x67,0x65,0x5f,0x31,
-    0x2c,0x20,0x69,0x6e,0x74,0x20,0x74,0x79,0x70,0x65,0x5f,0x69,0x6e,0x64,0x65,0x78,
-    0x2c,0x20,0x69,0x6e,0x74,0x20,0x69,0x6e,0x64,0x65,0x78,0x5f,0x31,0x2c,0x20,0x69,
-    0x6e,0x6f,0x75,0x74,0x20,0x76,0x65,0x63,0x34,0x20,0x64,0x61,0x74,0x61,0x5f,0x31,
-    0x5b,0x38,0x5d,0x29,0x0a,0x7b,0x0a,0x20,0x20,0x20,0x20,0x76,0x65,0x63,0x33,0x20,
-    0x5f,0x36,0x37,0x20,0x3d,0x20,0x76,0x65,0x63,0x33,0x28,0x74,0x65,0x78,0x74,0x75,
-    0x72,0x65,0x53,0x69,0x7a,0x65,0x28,0x64,0x61,0x74,0x61,0x5f,0x69,0x6d,0x61,0x67,
-    0x65,0x5f,0x31,0x2c,0x20,0x30,0x29,0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,0x66,0x6f,
-    0x72,0x20,0x28,0x69,0x6e,0x74,0x20,0x69,0x20,0x3d,0x20,0x30,0x3b,0x20,0x69,0x20,
-    0x3c,0x20,0x38,0x3b,0x20,0x69,0x2b,0x2b,0x29,0x0a,0x20,0x20,0x20,0x20,0x7b,0x0a,
-    0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x64,0x61,0x74,0x61,0x5f,0x31,0x5b,0x69,
-    0x5d,0x20,0x3d,0x20,0x74,0x65,0x78,0x74,0x75,0x72,0x65,0x4c,0x6f,0x64,0x28,0x64,
-    0x61,0x74,0x61,0x5f,0x69,0x6d,0x61,0x67,0x65,0x5f,0x31,0x2c,0x20,0x76,0x65,0x63,
-    0x33,0x28,0x66,0x6c,0x6f,0x61,0x74,0x28,0x69,0x29,0x20,0x2f,0x20,0x5f,0x36,0x37,
-    0x2e,0x78,0x2c,0x20,0x66,0x6c,0x6f,0x61,0x74,0x28,0x69,0x6e,0x64,0x65,0x78,0x5f,
-    0x31,0x29,0x20,0x2f,0x20,0x5f,0x36,0x37,0x2e,0x79,0x2c,0x20,0x66,0x6c,0x6f,0x61,
-    0x74,0x28,0x74,0x79,0x70,0x65,0x5f,0x69,0x6e,0x64,0x65,0x78,0x29,0x29,0x2c,0x20,
-    0x30,0x2e,0x30,0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,0x7d,0x0a,0x7d,0x0a,0x0a,0x76,
-    0x6f,0x69,0x64,0x20,0x6d,0x61,0x69,0x6e,0x28,0x29,0x0a,0x7b,0x0a,0x20,0x20,0x20,
-    0x20,0x70,0x6f,0x73,0x5f,0x77,0x20,0x3d,0x20,0x61,0x5f,0x70,0x6f,0x73,0x69,0x74,
-    0x69,0x6f,0x6e,0x3b,0x0a,0x20,0x20,0x20,0x20,0x70,0x6f,0x73,0x5f,0x76,0x20,0x3d,
-    0x20,0x76,0x65,0x63,0x33,0x28,0x28,0x6d,0x61,0x74,0x34,0x28,0x76,0x73,0x5f,0x70,
-    0x61,0x72,0x61,0x6d,0x73,0x5b,0x30,0x5d,0x2c,0x20,0x76,0x73,0x5f,0x70,0x61,0x72,
-    0x61,0x6d,0x73,0x5b,0x31,0x5d,0x2c,0x20,0x76,0x73,0x5f,0x70,0x61,0x72,0x61,0x6d,
-    0x73,0x5b,0x32,0x5d,0x2c,0x20,0x76,0x73,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,
-    0x33,0x5d,0x29,0x20,0x2a,0x20,0x76,0x65,0x63,0x34,0x28,0x61,0x5f,0x70,0x6f,0x73,
-    0x69,0x74,0x69,0x6f,0x6e,0x2c,0x20,0x31,0x2e,0x30,0x29,0x29,0x2e,0x78,0x79,0x7a,
-    0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,0x67,0x6c,0x5f,0x50,0x6f,0x73,0x69,0x74,0x69,
-    0x6f,0x6e,0x20,0x3d,0x20,0x6d,0x61,0x74,0x34,0x28,0x76,0x73,0x5f,0x70,0x61,0x72,
-    0x61,0x6d,0x73,0x5b,0x34,0x5d,0x2c,0x20,0x76,0x73,0x5f,0x70,0x61,0x72,0x61,0x6d,
-    0x73,0x5b,0x35,0x5d,0x2c,0x20,0x76,0x73,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,
-    0x36,0x5d,0x2c,0x20,0x76,0x73,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,0x37,0x5d,
-    0x29,0x20,0x2a,0x20,0x76,0x65,0x63,0x34,0x28,0x70,0x6f,0x73,0x5f,0x76,0x2c,0x20,
-    0x31,0x2e,0x30,0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,0x75,0x76,0x20,0x3d,0x20,0x61,
-    0x5f,0x74,0x65,0x78,0x63,0x6f,0x6f,0x72,0x64,0x30,0x3b,0x0a,0x20,0x20,0x20,0x20,
-    0x69,0x64,0x20,0x3d,0x20,0x69,0x6e,0x74,0x28,0x61,0x5f,0x69,0x64,0x29,0x3b,0x0a,
-    0x20,0x20,0x20,0x20,0x69,0x6e,0x74,0x20,0x5f,0x31,0x35,0x36,0x20,0x3d,0x20,0x69,
-    0x6e,0x74,0x28,0x61,0x5f,0x69,0x6e,0x64,0x65,0x78,0x29,0x3b,0x0a,0x20,0x20,0x20,
-    0x20,0x69,0x6e,0x64,0x65,0x78,0x20,0x3d,0x20,0x5f,0x31,0x35,0x36,0x3b,0x0a,0x20,
-    0x20,0x20,0x20,0x66,0x6c,0x61,0x67,0x73,0x20,0x3d,0x20,0x69,0x6e,0x74,0x28,0x61,
-    0x5f,0x66,0x6c,0x61,0x67,0x73,0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,0x69,0x6e,0x74,
-    0x20,0x70,0x61,0x72,0x61,0x6d,0x20,0x3d,0x20,0x69,0x64,0x20,0x3e,0x3e,0x20,0x31,
-    0x36,0x3b,0x0a,0x20,0x20,0x20,0x20,0x69,0x6e,0x74,0x20,0x70,0x61,0x72,0x61,0x6d,
-    0x5f,0x31,0x20,0x3d,0x20,0x66,0x69,0x6e,0x64,0x5f,0x6c,0x73,0x62,0x28,0x70,0x61,
-    0x72,0x61,0x6d,0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,0x69,0x6e,0x74,0x20,0x70,0x61,
-    0x72,0x61,0x6d,0x5f,0x32,0x20,0x3d,0x20,0x5f,0x31,0x35,0x36,0x3b,0x0a,0x20,0x20,
-    0x20,0x20,0x76,0x65,0x63,0x34,0x20,0x70,0x61,0x72,0x61,0x6d,0x5f,0x33,0x5b,0x38,
-    0x5d,0x3b,0x0a,0x20,0x20,0x20,0x20,0x6c,0x6f,0x6f,0x6b,0x75,0x70,0x5f,0x64,0x61,
-    0x74,0x61,0x28,0x64,0x61,0x74,0x61,0x5f,0x69,0x6d,0x61,0x67,0x65,0x2c,0x20,0x70,
-    0x61,0x72,0x61,0x6d,0x5f,0x31,0x2c,0x20,0x70,0x61,0x72,0x61,0x6d,0x5f,0x32,0x2c,
-    0x20,0x70,0x61,0x72,0x61,0x6d,0x5f,0x33,0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,0x64,
-    0x61,0x74,0x61,0x20,0x3d,0x20,0x70,0x61,0x72,0x61,0x6d,0x5f,0x33,0x3b,0x0a,0x7d,
-    0x0a,0x0a,0x00,
+    0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x32,0x29,0x20,0x69,0x6e,0x20,0x76,
+    0x65,0x63,0x32,0x20,0x61,0x5f,0x69,0x64,0x3b,0x0a,0x66,0x6c,0x61,0x74,0x20,0x6f,
+    0x75,0x74,0x20,0x69,0x6e,0x74,0x20,0x69,0x6e,0x64,0x65,0x78,0x3b,0x0a,0x6c,0x61,
+    0x79,0x6f,0x75,0x74,0x28,0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,
+    0x33,0x29,0x20,0x69,0x6e,0x20,0x66,0x6c,0x6f,0x61,0x74,0x20,0x61,0x5f,0x69,0x6e,
+    0x64,0x65,0x78,0x3b,0x0a,0x66,0x6c,0x61,0x74,0x20,0x6f,0x75,0x74,0x20,0x69,0x6e,
+    0x74,0x20,0x66,0x6c,0x61,0x67,0x73,0x3b,0x0a,0x6c,0x61,0x79,0x6f,0x75,0x74,0x28,
+    0x6c,0x6f,0x63,0x61,0x74,0x69,0x6f,0x6e,0x20,0x3d,0x20,0x34,0x29,0x20,0x69,0x6e,
+    0x20,0x66,0x6c,0x6f,0x61,0x74,0x20,0x61,0x5f,0x66,0x6c,0x61,0x67,0x73,0x3b,0x0a,
+    0x66,0x6c,0x61,0x74,0x20,0x6f,0x75,0x74,0x20,0x76,0x65,0x63,0x34,0x20,0x64,0x61,
+    0x74,0x61,0x5b,0x38,0x5d,0x3b,0x0a,0x0a,0x69,0x6e,0x74,0x20,0x66,0x69,0x6e,0x64,
+    0x5f,0x6c,0x73,0x62,0x28,0x69,0x6e,0x74,0x20,0x78,0x29,0x0a,0x7b,0x0a,0x20,0x20,
+    0x20,0x20,0x69,0x6e,0x74,0x20,0x72,0x65,0x73,0x20,0x3d,0x20,0x2d,0x31,0x3b,0x0a,
+    0x20,0x20,0x20,0x20,0x66,0x6f,0x72,0x20,0x28,0x69,0x6e,0x74,0x20,0x69,0x20,0x3d,
+    0x20,0x30,0x3b,0x20,0x69,0x20,0x3c,0x20,0x33,0x32,0x3b,0x20,0x69,0x2b,0x2b,0x29,
+    0x0a,0x20,0x20,0x20,0x20,0x7b,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x69,
+    0x66,0x20,0x28,0x28,0x78,0x20,0x26,0x20,0x28,0x31,0x20,0x3c,0x3c,0x20,0x69,0x29,
+    0x29,0x20,0x21,0x3d,0x20,0x30,0x29,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,
+    0x7b,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x72,0x65,
+    0x73,0x20,0x3d,0x20,0x69,0x3b,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x20,
+    0x20,0x20,0x20,0x62,0x72,0x65,0x61,0x6b,0x3b,0x0a,0x20,0x20,0x20,0x20,0x20,0x20,
+    0x20,0x20,0x7d,0x0a,0x20,0x20,0x20,0x20,0x7d,0x0a,0x20,0x20,0x20,0x20,0x72,0x65,
+    0x74,0x75,0x72,0x6e,0x20,0x72,0x65,0x73,0x3b,0x0a,0x7d,0x0a,0x0a,0x76,0x6f,0x69,
+    0x64,0x20,0x6c,0x6f,0x6f,0x6b,0x75,0x70,0x5f,0x64,0x61,0x74,0x61,0x28,0x68,0x69,
+    0x67,0x68,0x70,0x20,0x73,0x61,0x6d,0x70,0x6c,0x65,0x72,0x32,0x44,0x41,0x72,0x72,
+    0x61,0x79,0x20,0x64,0x61,0x74,0x61,0x5f,0x69,0x6d,0x61,0x67,0x65,0x5f,0x31,0x2c,
+    0x20,0x69,0x6e,0x74,0x20,0x74,0x79,0x70,0x65,0x5f,0x69,0x6e,0x64,0x65,0x78,0x2c,
+    0x20,0x69,0x6e,0x74,0x20,0x69,0x6e,0x64,0x65,0x78,0x5f,0x31,0x2c,0x20,0x69,0x6e,
+    0x6f,0x75,0x74,0x20,0x76,0x65,0x63,0x34,0x20,0x64,0x61,0x74,0x61,0x5f,0x31,0x5b,
+    0x38,0x5d,0x29,0x0a,0x7b,0x0a,0x20,0x20,0x20,0x20,0x76,0x65,0x63,0x33,0x20,0x5f,
+    0x36,0x37,0x20,0x3d,0x20,0x76,0x65,0x63,0x33,0x28,0x74,0x65,0x78,0x74,0x75,0x72,
+    0x65,0x53,0x69,0x7a,0x65,0x28,0x64,0x61,0x74,0x61,0x5f,0x69,0x6d,0x61,0x67,0x65,
+    0x5f,0x31,0x2c,0x20,0x30,0x29,0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,0x66,0x6f,0x72,
+    0x20,0x28,0x69,0x6e,0x74,0x20,0x69,0x20,0x3d,0x20,0x30,0x3b,0x20,0x69,0x20,0x3c,
+    0x20,0x38,0x3b,0x20,0x69,0x2b,0x2b,0x29,0x0a,0x20,0x20,0x20,0x20,0x7b,0x0a,0x20,
+    0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x64,0x61,0x74,0x61,0x5f,0x31,0x5b,0x69,0x5d,
+    0x20,0x3d,0x20,0x74,0x65,0x78,0x74,0x75,0x72,0x65,0x4c,0x6f,0x64,0x28,0x64,0x61,
+    0x74,0x61,0x5f,0x69,0x6d,0x61,0x67,0x65,0x5f,0x31,0x2c,0x20,0x76,0x65,0x63,0x33,
+    0x28,0x66,0x6c,0x6f,0x61,0x74,0x28,0x69,0x29,0x20,0x2f,0x20,0x5f,0x36,0x37,0x2e,
+    0x78,0x2c,0x20,0x66,0x6c,0x6f,0x61,0x74,0x28,0x69,0x6e,0x64,0x65,0x78,0x5f,0x31,
+    0x29,0x20,0x2f,0x20,0x5f,0x36,0x37,0x2e,0x79,0x2c,0x20,0x66,0x6c,0x6f,0x61,0x74,
+    0x28,0x74,0x79,0x70,0x65,0x5f,0x69,0x6e,0x64,0x65,0x78,0x29,0x29,0x2c,0x20,0x30,
+    0x2e,0x30,0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,0x7d,0x0a,0x7d,0x0a,0x0a,0x76,0x6f,
+    0x69,0x64,0x20,0x6d,0x61,0x69,0x6e,0x28,0x29,0x0a,0x7b,0x0a,0x20,0x20,0x20,0x20,
+    0x70,0x6f,0x73,0x5f,0x77,0x20,0x3d,0x20,0x61,0x5f,0x70,0x6f,0x73,0x69,0x74,0x69,
+    0x6f,0x6e,0x3b,0x0a,0x20,0x20,0x20,0x20,0x70,0x6f,0x73,0x5f,0x76,0x20,0x3d,0x20,
+    0x76,0x65,0x63,0x33,0x28,0x28,0x6d,0x61,0x74,0x34,0x28,0x76,0x73,0x5f,0x70,0x61,
+    0x72,0x61,0x6d,0x73,0x5b,0x30,0x5d,0x2c,0x20,0x76,0x73,0x5f,0x70,0x61,0x72,0x61,
+    0x6d,0x73,0x5b,0x31,0x5d,0x2c,0x20,0x76,0x73,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,
+    0x5b,0x32,0x5d,0x2c,0x20,0x76,0x73,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,0x33,
+    0x5d,0x29,0x20,0x2a,0x20,0x76,0x65,0x63,0x34,0x28,0x61,0x5f,0x70,0x6f,0x73,0x69,
+    0x74,0x69,0x6f,0x6e,0x2c,0x20,0x31,0x2e,0x30,0x29,0x29,0x2e,0x78,0x79,0x7a,0x29,
+    0x3b,0x0a,0x20,0x20,0x20,0x20,0x67,0x6c,0x5f,0x50,0x6f,0x73,0x69,0x74,0x69,0x6f,
+    0x6e,0x20,0x3d,0x20,0x6d,0x61,0x74,0x34,0x28,0x76,0x73,0x5f,0x70,0x61,0x72,0x61,
+    0x6d,0x73,0x5b,0x34,0x5d,0x2c,0x20,0x76,0x73,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,
+    0x5b,0x35,0x5d,0x2c,0x20,0x76,0x73,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,0x36,
+    0x5d,0x2c,0x20,0x76,0x73,0x5f,0x70,0x61,0x72,0x61,0x6d,0x73,0x5b,0x37,0x5d,0x29,
+    0x20,0x2a,0x20,0x76,0x65,0x63,0x34,0x28,0x70,0x6f,0x73,0x5f,0x76,0x2c,0x20,0x31,
+    0x2e,0x30,0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,0x75,0x76,0x20,0x3d,0x20,0x61,0x5f,
+    0x74,0x65,0x78,0x63,0x6f,0x6f,0x72,0x64,0x30,0x3b,0x0a,0x20,0x20,0x20,0x20,0x69,
+    0x64,0x20,0x3d,0x20,0x69,0x6e,0x74,0x28,0x61,0x5f,0x69,0x64,0x2e,0x78,0x29,0x20,
+    0x2b,0x20,0x28,0x69,0x6e,0x74,0x28,0x61,0x5f,0x69,0x64,0x2e,0x79,0x29,0x20,0x3c,
+    0x3c,0x20,0x31,0x36,0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,0x69,0x6e,0x74,0x20,0x5f,
+    0x31,0x35,0x36,0x20,0x3d,0x20,0x69,0x6e,0x74,0x28,0x61,0x5f,0x69,0x6e,0x64,0x65,
+    0x78,0x29,0x3b,0x0a,0x20,0x20,0x20,0x20,0x69,0x6e,0x64,0x65,0x78,0x20,0x3d,0x20,
+    0x5f,0x31,0x35,0x36,0x3b,0x0a,0x20,0x20,0x20,0x20,0x66,0x6c,0x61,0x67,0x73,0x20,
+    0x3d,0x20,0x69,0x6e,0x74,0x28,0x61,0x5f,0x66,0x6c,0x61,0x67,0x73,0x29,0x3b,0x0a,
+    0x20,0x20,0x20,0x20,0x69,0x6e,0x74,0x20,0x70,0x61,0x72,0x61,0x6d,0x20,0x3d,0x20,
+    0x69,0x64,0x20,0x3e,0x3e,0x20,0x31,0x36,0x3b,0x0a,0x20,0x20,0x20,0x20,0x69,0x6e,
+    0x74,0x20,0x70,0x61,0x72,0x61,0x6d,0x5f,0x31,0x20,0x3d,0x20,0x66,0x69,0x6e,0x64,
+    0x5f,0x6c,0x73,0x62,0x28,0x70,0x61,0x72,0x61,0x6d,0x29,0x3b,0x0a,0x20,0x20,0x20,
+    0x20,0x69,0x6e,0x74,0x20,0x70,0x61,0x72,0x61,0x6d,0x5f,0x32,0x20,0x3d,0x20,0x5f,
+    0x31,0x35,0x36,0x3b,0x0a,0x20,0x20,0x20,0x20,0x76,0x65,0x63,0x34,0x20,0x70,0x61,
+    0x72,0x61,0x6d,0x5f,0x33,0x5b,0x38,0x5d,0x3b,0x0a,0x20,0x20,0x20,0x20,0x6c,0x6f,
+    0x6f,0x6b,0x75,0x70,0x5f,0x64,0x61,0x74,0x61,0x28,0x64,0x61,0x74,0x61,0x5f,0x69,
+    0x6d,0x61,0x67,0x65,0x2c,0x20,0x70,0x61,0x72,0x61,0x6d,0x5f,0x31,0x2c,0x20,0x70,
+    0x61,0x72,0x61,0x6d,0x5f,0x32,0x2c,0x20,0x70,0x61,0x72,0x61,0x6d,0x5f,0x33,0x29,
+    0x3b,0x0a,0x20,0x20,0x20,0x20,0x64,0x61,0x74,0x61,0x20,0x3d,0x20,0x70,0x61,0x72,
+    0x61,0x6d,0x5f,0x33,0x3b,0x0a,0x7d,0x0a,0x0a,0x00,
 };
 /*
     #version 300 es
@@ -1,8 +1,10 @@
 #include "src/state.h"
 #include "gfx/atlas.h"
+#include "gfx/palette.h"
 #include "gfx/renderer.h"
 #include "level/level.h"
 #include "level/io.h"
+#include "level/visibility.h"
 #include "editor/editor.h"
 #include "level/object.h"
 #include "util/file.h"
@@ -84,11 +86,13 @@ int state_load_level(state_t *state, const char *path) {
         path);
 
 #ifdef MAPEDITOR
-    snprintf(
-        state->editor->levelpath,
-        sizeof(state->editor->levelpath),
-        "%s",
-        path);
+    if (state->editor) {
+        snprintf(
+            state->editor->levelpath,
+            sizeof(state->editor->levelpath),
+            "%s",
+            path);
+    }
 #endif // ifdef MAPEDITOR
 
     LOG(
@@ -99,18 +103,11 @@ int state_load_level(state_t *state, const char *path) {
 
     // spawn "player" if in GAME mode
     if (state->mode == GAMEMODE_GAME) {
-        object_t *player = object_new(state->level), *spawn = NULL;
+        object_t *player = object_new(state->level);
         object_set_type(state->level, player, OT_PLAYER);
 
-        // TODO: level should have some object search function
         // find spawnpoint
-        level_dynlist_each(state->level->objects, it) {
-            object_t *o = *it.el;
-            if (o->type_index == OT_SPAWN) {
-                spawn = o;
-                break;
-            }
-        }
+        object_t *spawn = object_find_type(state->level, OT_SPAWN);
 
         vec2s spawn_pos;
 
@@ -126,3 +123,145 @@ int state_load_level(state_t *state, const char *path) {
 
     return 0;
 }
+
+int state_check_golden(state_t *state, const char *path, bool update) {
+    state->atlas = malloc(sizeof(*state->atlas));
+    atlas_init_headless(state->atlas);
+    atlas_load_all(state->atlas);
+
+    state->renderer = malloc(sizeof(*state->renderer));
+    renderer_init_headless(state->renderer);
+
+    // only bound (never sampled) by the headless renderer
+    state->palette = calloc(1, sizeof(*state->palette));
+
+    int res = state_load_level(state, path);
+    if (res) {
+        WARN("could not load level %s (%d)", path, res);
+        res = 1;
+        goto done;
+    }
+
+    char golden_path[1024];
+    snprintf(golden_path, sizeof(golden_path), "%s.golden", path);
+    res = renderer_check_golden(state->renderer, golden_path, update) ? 0 : 1;
+
+    // reference image from spawn (eye height as in player update) through
+    // the CPU rasterizer
+    object_t *spawn = object_find_type(state->level, OT_SPAWN);
+    if (!spawn || !spawn->sector) {
+        WARN("no OT_SPAWN in level %s, cannot render reference image", path);
+        res = 1;
+        goto done;
+    }
+
+    state->cam.pos =
+        VEC3(spawn->pos.x, spawn->pos.y, spawn->sector->floor.z + 1.35f);
+    state->cam.yaw = spawn->angle;
+    state->cam.pitch = 0.0f;
+    state->cam.sector = spawn->sector;
+
+    state->renderer->cam.pos = state->cam.pos;
+    state->renderer->cam.pitch = state->cam.pitch;
+    state->renderer->cam.yaw = state->cam.yaw;
+
+    snprintf(golden_path, sizeof(golden_path), "%s.golden.png", path);
+    if (!renderer_render_soft(state->renderer, golden_path, update)) {
+        res = 1;
+    }
+
+done:
+    if (state->level) {
+        renderer_destroy_for_level(state->renderer);
+        level_destroy(state->level);
+        free(state->level);
+        state->level = NULL;
+    }
+
+    renderer_destroy(state->renderer);
+    free(state->renderer);
+    state->renderer = NULL;
+
+    atlas_destroy(state->atlas);
+    free(state->atlas);
+    state->atlas = NULL;
+
+    free(state->palette);
+    state->palette = NULL;
+
+    return res;
+}
+
+// number of visible (sector, sector) pairs, counting both directions
+static int count_visible_pairs(level_t *level) {
+    const int n_sectors = dynlist_size(level->sectors);
+    BITMAP *scratch = bitmap_alloc(max(level->visibility.n, 1));
+
+    int n = 0;
+    level_dynlist_each(level->sectors, it) {
+        const BITMAP *row = visibility_row(level, *it.el, scratch);
+        if (!row) { continue; }
+
+        n += bitmap_count_range(
+            row, 0, min(n_sectors, level->visibility.n), true);
+    }
+
+    bitmap_free(scratch);
+    return n;
+}
+
+int state_bake_visibility(state_t *state, const char *path) {
+    int res = state_load_level(state, path);
+    if (res) {
+        WARN("could not load level %s (%d)", path, res);
+        res = 1;
+        goto done;
+    }
+
+    level_t *level = state->level;
+    const int
+        n_sectors = level_get_list_count(level, T_SECTOR),
+        n_before = count_visible_pairs(level);
+
+    visibility_bake(level);
+
+    const int n_after = count_visible_pairs(level);
+
+    LOG(
+        "%s: %d sectors, %d -> %d visible pairs (%.2f -> %.2f per sector)",
+        path,
+        n_sectors,
+        n_before,
+        n_after,
+        n_before / (f64) max(n_sectors, 1),
+        n_after / (f64) max(n_sectors, 1));
+
+    if ((res = file_makebak(path, ".bak"))) {
+        WARN("failed to make backup of %s: %d", path, res);
+        res = 1;
+        goto done;
+    }
+
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        WARN("could not open %s for writing", path);
+        res = 1;
+        goto done;
+    }
+
+    if ((res = io_save_level(f, level))) {
+        WARN("could not save level %s (%d)", path, res);
+        res = 1;
+    }
+
+    fclose(f);
+
+done:
+    if (state->level) {
+        level_destroy(state->level);
+        free(state->level);
+        state->level = NULL;
+    }
+
+    return res;
+}
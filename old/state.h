@@ -99,6 +99,9 @@ typedef struct state {
     int last_cbump;
     int last_shot;
     f32 cbump;
+
+    // gun sprites by [gun_mode - 1][frame] and muzzle flash, see do_ui
+    atlas_handle_t gun_handles[2][4], flash_handle;
 } state_t;
 
 // global state storage
@@ -111,3 +114,16 @@ int state_new_level(state_t *state);
 
 // TODO
 int state_load_level(state_t *state, const char *path);
+
+// headless (no window/sokol context) golden check of the level at path: mesh
+// hashes against <path>.golden (see renderer_check_golden) and the CPU
+// rasterized view from its spawn against <path>.golden.png (see
+// renderer_render_soft). writes both instead if update. returns process exit
+// status, 0 on match
+int state_check_golden(state_t *state, const char *path, bool update);
+
+// headless visibility bake of the level at path: loads it, replaces its
+// visibility with visibility_bake and saves it back (with the baked rows, see
+// io.c) after making a backup. logs visible pairs before and after. returns
+// process exit status, 0 on success
+int state_bake_visibility(state_t *state, const char *path);
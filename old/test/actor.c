@@ -0,0 +1,320 @@
+// test of level/actor.c: actors scheduled with timers, tag waits and wakes
+// must act in exactly the same ticks and order as if every actor were awake
+// and polling, and a benchmark of ticks with mostly sleeping actors
+// build and run from old/:
+//   clang -O2 -std=gnu2x -I. -I../lib/cglm/include test/actor.c -o test_actor
+//   ./test_actor
+#define UTIL_IMPL
+#define RELOAD_HOST
+#include "level/actor.c"
+#include "util/time.h"
+#include "test.h"
+
+#ifdef RELOADABLE
+reload_host_t *g_reload_host = NULL;
+#endif // ifdef RELOADABLE
+
+#define N_TAGS 8
+#define MAX_ACTORS 4096
+
+enum {
+    K_SETTER,
+    K_TIMER,
+    K_WAITER,
+    K_PINGED,
+    K_COUNT
+};
+
+typedef struct {
+    int id, kind;
+
+    // K_WAITER: tag waited on
+    int tag;
+
+    // polled: acts on its first tick, done actors never act again
+    bool first, done;
+
+    // polled: K_TIMER tick to act on, K_WAITER tag count last seen,
+    // K_PINGED pinged since last acting
+    u64 next;
+    int seen;
+    bool pinged;
+
+    // scheduled: actor of this sim actor, once it has acted
+    actor_t *self;
+} sim_t;
+
+typedef struct {
+    bool scheduled;
+    level_t *level;
+    u64 tick;
+
+    sim_t sims[MAX_ACTORS];
+    int n;
+
+    // ids of K_PINGED actors
+    int pinged[MAX_ACTORS];
+    int n_pinged;
+
+    // number of times each tag was set
+    int tag_counts[N_TAGS + 1];
+
+    // (tick << 32) | id for every act
+    DYNLIST(u64) log;
+} world_t;
+
+// decisions only depend on tick and actor, never on how actors are scheduled
+static u32 hash(u64 tick, int id, int salt) {
+    u64 x = (tick * 0x9E3779B97F4A7C15ull) ^ ((u64) id << 20) ^ salt;
+    x ^= x >> 33;
+    x *= 0xFF51AFD7ED558CCDull;
+    x ^= x >> 33;
+    return (u32) x;
+}
+
+static void sim_act(level_t*, actor_t*, void*);
+
+static void world_add(world_t *w, int kind) {
+    ASSERT(w->n < MAX_ACTORS);
+
+    const int id = w->n++;
+    sim_t *s = &w->sims[id];
+    *s = (sim_t) {
+        .id = id,
+        .kind = kind,
+        .tag = 1 + id % N_TAGS,
+        .first = true,
+    };
+
+    if (kind == K_PINGED) {
+        w->pinged[w->n_pinged++] = id;
+    }
+
+    if (w->scheduled) {
+        actor_add(
+            w->level,
+            (actor_t) { .act = sim_act, .param = s },
+            LPTR_NULL);
+    }
+}
+
+// act for both worlds, actor is NULL when polled
+static void act(world_t *w, sim_t *s, actor_t *actor) {
+    const u64 t = w->tick;
+    level_t *level = w->level;
+
+    *dynlist_push(w->log) = (t << 32) | s->id;
+    s->first = false;
+
+    switch (s->kind) {
+    case K_SETTER: {
+        const u32 h = hash(t, s->id, 0);
+
+        if (h % 4 == 0) {
+            const int tag = 1 + (h >> 8) % N_TAGS;
+            w->tag_counts[tag]++;
+            if (w->scheduled) { actor_wake_tag(level, tag); }
+        }
+
+        if (h % 5 == 0 && w->n_pinged > 0) {
+            sim_t *p = &w->sims[w->pinged[(h >> 12) % w->n_pinged]];
+            p->pinged = true;
+
+            // without self it has not acted yet, so it is awake anyway
+            if (w->scheduled && p->self) { actor_wake(level, p->self); }
+        }
+
+        if (h % 61 == 0 && w->n < MAX_ACTORS) {
+            world_add(w, K_TIMER);
+        }
+    } break;
+    case K_TIMER: {
+        const u32 h = hash(t, s->id, 1);
+
+        if (h % 13 == 0) {
+            s->done = true;
+            if (w->scheduled) { actor_done(level, actor); }
+            break;
+        }
+
+        const int delay = 1 + (h >> 8) % 40;
+        s->next = t + delay;
+        if (w->scheduled) { actor_sleep(level, actor, delay); }
+    } break;
+    case K_WAITER:
+        s->seen = w->tag_counts[s->tag];
+        if (w->scheduled) { actor_wait_tag(level, actor, s->tag); }
+        break;
+    case K_PINGED:
+        s->pinged = false;
+        if (w->scheduled) { actor_sleep(level, actor, -1); }
+        break;
+    }
+}
+
+static world_t *g_world;
+
+static void sim_act(level_t*, actor_t *actor, void *param) {
+    sim_t *s = param;
+    s->self = actor;
+    act(g_world, s, actor);
+}
+
+// polling: every actor checks each tick if it should act
+static void tick_polled(world_t *w) {
+    w->tick++;
+
+    for (int i = 0; i < w->n; i++) {
+        sim_t *s = &w->sims[i];
+        if (s->done) { continue; }
+
+        bool due = s->first;
+        switch (s->kind) {
+        case K_SETTER: due = true; break;
+        case K_TIMER: due |= s->next == w->tick; break;
+        case K_WAITER: due |= s->seen != w->tag_counts[s->tag]; break;
+        case K_PINGED: due |= s->pinged; break;
+        }
+
+        if (due) { act(w, s, NULL); }
+    }
+}
+
+static void tick_scheduled(world_t *w) {
+    g_world = w;
+    w->tick++;
+    actor_tick(w->level);
+    ASSERT(w->tick == w->level->sched.tick);
+}
+
+static void init_world(world_t *w, bool scheduled, int n) {
+    memset(w, 0, sizeof(*w));
+    w->scheduled = scheduled;
+
+    if (scheduled) {
+        w->level = calloc(1, sizeof(level_t));
+        g_world = w;
+    }
+
+    for (int i = 0; i < n; i++) {
+        world_add(w, hash(0, i, 2) % K_COUNT);
+    }
+}
+
+static void destroy_world(world_t *w) {
+    if (w->level) {
+        actor_destroy_all(w->level);
+        free(w->level);
+    }
+
+    dynlist_free(w->log);
+}
+
+static void test_determinism(int n, int n_ticks) {
+    static world_t polled, scheduled;
+    init_world(&polled, false, n);
+    init_world(&scheduled, true, n);
+
+    for (int t = 0; t < n_ticks; t++) {
+        tick_polled(&polled);
+        tick_scheduled(&scheduled);
+
+        // tag set and actor woken from outside of actor_tick
+        if (t % 7 == 0) {
+            const int tag = 1 + hash(t, 0, 3) % N_TAGS;
+            polled.tag_counts[tag]++;
+            scheduled.tag_counts[tag]++;
+            actor_wake_tag(scheduled.level, tag);
+        }
+    }
+
+    TEST_EQ(polled.n, scheduled.n, "n=%d: actors added", n);
+    TEST_EQ(
+        dynlist_size(polled.log), dynlist_size(scheduled.log),
+        "n=%d: number of acts", n);
+
+    for (int i = 0;
+         i < min(dynlist_size(polled.log), dynlist_size(scheduled.log));
+         i++) {
+        if (polled.log[i] != scheduled.log[i]) {
+            TEST(
+                false,
+                "n=%d: act %d differs, polled tick %d actor %d, "
+                "scheduled tick %d actor %d",
+                n, i,
+                (int) (polled.log[i] >> 32), (int) (u32) polled.log[i],
+                (int) (scheduled.log[i] >> 32), (int) (u32) scheduled.log[i]);
+            break;
+        }
+    }
+
+    destroy_world(&polled);
+    destroy_world(&scheduled);
+}
+
+static void nop_act(level_t*, actor_t*, void*) {}
+
+static void sleep_act(level_t *level, actor_t *actor, void *param) {
+    actor_sleep(level, actor, (int) (usize) param);
+}
+
+// n actors of which 1% act every tick, the rest on long timers or asleep,
+// against all of them awake
+static void bench(int n) {
+    const int n_ticks = 2000;
+
+    level_t *levels[2] = {
+        calloc(1, sizeof(level_t)),
+        calloc(1, sizeof(level_t)),
+    };
+
+    for (int i = 0; i < n; i++) {
+        actor_add(levels[0], (actor_t) { .act = nop_act }, LPTR_NULL);
+
+        actor_t actor = { .act = sleep_act };
+        if (i % 100 == 0) {
+            actor.act = nop_act;
+        } else if (i % 2) {
+            actor.param = (void*) (usize) (100 + i % 1000);
+        } else {
+            actor.param = (void*) (usize) -1;
+        }
+
+        actor_add(levels[1], actor, LPTR_NULL);
+    }
+
+    u64 ns[2];
+    for (int l = 0; l < 2; l++) {
+        const u64 start = time_ns();
+        for (int t = 0; t < n_ticks; t++) {
+            actor_tick(levels[l]);
+        }
+        ns[l] = time_ns() - start;
+    }
+
+    LOG(
+        "%6d actors: all awake %8.1f us/tick, scheduled %8.1f us/tick "
+        "(%d awake, %d sleeping)",
+        n,
+        ns[0] / (f64) (n_ticks * 1000),
+        ns[1] / (f64) (n_ticks * 1000),
+        levels[1]->sched.n_awake, levels[1]->sched.n_sleeping);
+
+    for (int l = 0; l < 2; l++) {
+        actor_destroy_all(levels[l]);
+        free(levels[l]);
+    }
+}
+
+int main(int, char *[]) {
+    test_determinism(4, 200);
+    test_determinism(50, 2000);
+    test_determinism(500, 2000);
+
+    const int ns[] = { 1000, 10000, 100000 };
+    for (usize i = 0; i < ARRLEN(ns); i++) {
+        bench(ns[i]);
+    }
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,136 @@
+// differential test of the word-level/SIMD kernels in util/bitmap.h against
+// bit-by-bit reference implementations
+// build and run from old/:
+//   clang -O2 -std=gnu2x -I. -I../lib/cglm/include test/bitmap.c -o test_bitmap
+//   ./test_bitmap
+// also build with -mavx2 and -mno-sse2 (or on arm64) to cover every row op path
+#include "util/bitmap.h"
+#include "test.h"
+
+static int ref_find(const BITMAP *b, int size, int start, bool val) {
+    for (int i = max(start, 0); i < size; i++) {
+        if (bitmap_get(b, i) == val) { return i; }
+    }
+
+    return INT_MAX;
+}
+
+static int ref_count_range(const BITMAP *b, int from, int to, bool val) {
+    int n = 0;
+    for (int i = from; i < to; i++) {
+        n += bitmap_get(b, i) == val;
+    }
+    return n;
+}
+
+// fill with random bits, biased so that long runs of 0s and 1s show up
+static void fill_random(BITMAP *b, int size) {
+    const int mode = rand() % 4;
+
+    for (int i = 0; i < BITMAP_SIZE_TO_BYTES(size); i++) {
+        switch (mode) {
+        case 0: b[i] = rand(); break;
+        case 1: b[i] = (rand() % 8) ? 0x00 : (1 << (rand() % 8)); break;
+        case 2: b[i] = (rand() % 8) ? 0xFF : ~(1 << (rand() % 8)); break;
+        default: b[i] = (rand() % 2) ? 0x00 : 0xFF; break;
+        }
+    }
+}
+
+static void test_find_count(int size) {
+    BITMAP *b = bitmap_alloc(size);
+    fill_random(b, size);
+
+    for (int val = 0; val < 2; val++) {
+        for (int start = 0; start <= size + 1; start++) {
+            TEST_EQ(
+                bitmap_find(b, size, start, val),
+                ref_find(b, size, start, val),
+                "find size=%d start=%d val=%d", size, start, val);
+        }
+
+        TEST_EQ(
+            bitmap_count(b, size, val),
+            ref_count_range(b, 0, size, val),
+            "count size=%d val=%d", size, val);
+
+        for (int from = 0; from <= size; from += 1 + (size / 40)) {
+            for (int to = from; to <= size; to++) {
+                TEST_EQ(
+                    bitmap_count_range(b, from, to, val),
+                    ref_count_range(b, from, to, val),
+                    "count_range size=%d [%d, %d) val=%d",
+                    size, from, to, val);
+            }
+        }
+    }
+
+    int n = 0, last = -1;
+    bitmap_each_set(b, size, i) {
+        TEST(i > last && bitmap_get(b, i), "each_set size=%d i=%d", size, i);
+        TEST_EQ(ref_find(b, size, last + 1, true), i, "each_set size=%d", size);
+        last = i;
+        n++;
+    }
+    TEST_EQ(n, ref_count_range(b, 0, size, true), "each_set size=%d", size);
+
+    bitmap_free(b);
+}
+
+// op: 0 = or, 1 = and, 2 = andnot
+static void test_row_op(int size, int op) {
+    const int n_bytes = BITMAP_SIZE_TO_BYTES(size);
+
+    // one guard byte past the end of dst must not be touched
+    BITMAP
+        *dst = bitmap_alloc(size + 8),
+        *src = bitmap_alloc(size),
+        *ref = bitmap_alloc(size + 8);
+
+    fill_random(dst, size + 8);
+    fill_random(src, size);
+    memcpy(ref, dst, n_bytes + 1);
+
+    for (int i = 0; i < n_bytes * 8; i++) {
+        const bool d = bitmap_get(ref, i), s = bitmap_get(src, i);
+        bitmap_put(
+            ref, i, op == 0 ? (d || s) : op == 1 ? (d && s) : (d && !s));
+    }
+
+    switch (op) {
+    case 0: bitmap_or(dst, src, size); break;
+    case 1: bitmap_and(dst, src, size); break;
+    default: bitmap_andnot(dst, src, size); break;
+    }
+
+    TEST(
+        !memcmp(dst, ref, n_bytes + 1),
+        "row op %d size=%d", op, size);
+
+    bitmap_free(dst);
+    bitmap_free(src);
+    bitmap_free(ref);
+}
+
+int main(int, char *[]) {
+    srand(0x5EED);
+
+    for (int size = 0; size <= 300; size++) {
+        for (int i = 0; i < 8; i++) {
+            test_find_count(size);
+
+            for (int op = 0; op < 3; op++) {
+                test_row_op(size, op);
+            }
+        }
+    }
+
+    // large enough for several iterations of every SIMD loop
+    for (int size = 1000; size <= 1100; size++) {
+        for (int op = 0; op < 3; op++) {
+            test_row_op(size, op);
+        }
+    }
+
+    return TEST_RESULT();
+}
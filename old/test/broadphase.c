@@ -0,0 +1,297 @@
+// test of level/broadphase.c: segment queries against brute force, results
+// independent of insertion/update order, and a benchmark of segment vs. box
+// queries vs. brute force for 100-5000 colliding objects
+// build and run from old/:
+//   clang -O2 -std=gnu2x -I. -I../lib/cglm/include test/broadphase.c -o test_broadphase
+//   ./test_broadphase
+#define UTIL_IMPL
+#define RELOAD_HOST
+#include "level/broadphase.c"
+#include "util/time.h"
+#include "test.h"
+
+static object_type_t types[] = {
+    { .radius = 0.25f },
+    { .radius = 0.5f },
+    { .radius = 1.0f },
+    { .radius = 3.0f },
+};
+
+static f32 rand_f32(f32 lo, f32 hi) {
+    return lo + (hi - lo) * (rand() / (f32) RAND_MAX);
+}
+
+static vec2s rand_pos(f32 size) {
+    return VEC2(rand_f32(-size, size), rand_f32(-size, size));
+}
+
+static level_t *new_level() {
+    level_t *level = calloc(1, sizeof(level_t));
+    broadphase_init(level);
+    return level;
+}
+
+static void free_level(level_t *level) {
+    broadphase_destroy(level);
+    free(level);
+}
+
+// n objects at random positions in [-size, size]^2
+static object_t *new_objects(int n, f32 size) {
+    object_t *objects = calloc(n, sizeof(object_t));
+
+    for (int i = 0; i < n; i++) {
+        objects[i].index = i;
+        objects[i].type = &types[rand() % ARRLEN(types)];
+        objects[i].pos = rand_pos(size);
+    }
+
+    return objects;
+}
+
+static bool touches_segment(const object_t *o, vec2s from, vec2s to, f32 r) {
+    const vec2s p = point_project_segment(o->pos, from, to);
+    return glms_vec2_distance(p, o->pos) <= o->type->radius + r;
+}
+
+static bool contains(const DYNLIST(object_t*) l, const object_t *o) {
+    dynlist_each(l, it) {
+        if (*it.el == o) { return true; }
+    }
+
+    return false;
+}
+
+// segment query results must be sorted and contain every object touching the
+// swept segment
+static void check_segment(
+    level_t *level,
+    object_t *objects,
+    int n,
+    vec2s from,
+    vec2s to,
+    f32 r) {
+    DYNLIST(object_t*) seg = NULL;
+    broadphase_query_segment(level, from, to, r, &seg);
+
+    for (int i = 1; i < dynlist_size(seg); i++) {
+        if (seg[i - 1]->index >= seg[i]->index) {
+            TEST(false, "results out of order at %d", i);
+            break;
+        }
+    }
+
+    for (int i = 0; i < n; i++) {
+        if (touches_segment(&objects[i], from, to, r)
+            && !contains(seg, &objects[i])) {
+            TEST(
+                false,
+                "missed object %d for (%.3f, %.3f) -> (%.3f, %.3f) r=%.3f",
+                i, from.x, from.y, to.x, to.y, r);
+            break;
+        }
+    }
+
+    dynlist_free(seg);
+}
+
+static void test_segments() {
+    const int n = 2000;
+    const f32 size = 40.0f;
+
+    level_t *level = new_level();
+    object_t *objects = new_objects(n, size);
+
+    for (int i = 0; i < n; i++) {
+        broadphase_update(level, &objects[i]);
+    }
+
+    for (int i = 0; i < 2000; i++) {
+        const vec2s from = rand_pos(size);
+        vec2s to;
+
+        switch (i % 4) {
+        case 0: to = rand_pos(size); break;
+        case 1: to = glms_vec2_add(from, rand_pos(2.0f)); break;
+        // axis aligned, also exactly on cell edges
+        case 2: to = VEC2(rand_pos(size).x, from.y); break;
+        default:
+            to = VEC2(
+                from.x,
+                roundf(from.y / BROADPHASE_CELL_SIZE) * BROADPHASE_CELL_SIZE);
+        }
+
+        check_segment(
+            level, objects, n, from, to, (i % 3) == 0 ? 0.0f : rand_f32(0, 2));
+    }
+
+    // zero length
+    check_segment(level, objects, n, VEC2(1, 1), VEC2(1, 1), 0.5f);
+
+    free_level(level);
+    free(objects);
+}
+
+// inserting and moving the same objects in a different order must give the
+// same query results
+static void test_determinism() {
+    const int n = 1000, n_moves = 4;
+    const f32 size = 20.0f;
+
+    object_t *objects[2] = {
+        new_objects(n, size),
+        calloc(n, sizeof(object_t)),
+    };
+    memcpy(objects[1], objects[0], n * sizeof(object_t));
+
+    vec2s *moves = malloc(n * n_moves * sizeof(vec2s));
+    for (int i = 0; i < n * n_moves; i++) {
+        moves[i] = rand_pos(size);
+    }
+
+    level_t *levels[2] = { new_level(), new_level() };
+
+    for (int m = -1; m < n_moves; m++) {
+        for (int i = 0; i < n; i++) {
+            // forwards in levels[0], backwards in levels[1]
+            const int j = n - 1 - i;
+
+            if (m >= 0) {
+                objects[0][i].pos = moves[m * n + i];
+                objects[1][j].pos = moves[m * n + j];
+            }
+
+            broadphase_update(levels[0], &objects[0][i]);
+            broadphase_update(levels[1], &objects[1][j]);
+        }
+
+        for (int q = 0; q < 200; q++) {
+            const vec2s from = rand_pos(size), to = rand_pos(size);
+            const f32 r = rand_f32(0, 1);
+
+            DYNLIST(object_t*) res[2] = { NULL, NULL };
+            for (int l = 0; l < 2; l++) {
+                broadphase_query_segment(levels[l], from, to, r, &res[l]);
+            }
+
+            TEST_EQ(dynlist_size(res[0]), dynlist_size(res[1]), "move %d", m);
+
+            for (int i = 0;
+                 i < min(dynlist_size(res[0]), dynlist_size(res[1]));
+                 i++) {
+                if (res[0][i]->index != res[1][i]->index) {
+                    TEST(false, "move %d: results differ at %d", m, i);
+                    break;
+                }
+            }
+
+            dynlist_free(res[0]);
+            dynlist_free(res[1]);
+        }
+    }
+
+    for (int i = 0; i < n; i += 2) {
+        broadphase_remove(levels[0], &objects[0][i]);
+        broadphase_remove(levels[1], &objects[1][i]);
+    }
+
+    DYNLIST(object_t*) res[2] = { NULL, NULL };
+    for (int l = 0; l < 2; l++) {
+        broadphase_query(levels[l], VEC2(-size), VEC2(size), &res[l]);
+    }
+
+    TEST_EQ(dynlist_size(res[0]), n / 2, "after remove");
+    TEST_EQ(dynlist_size(res[1]), n / 2, "after remove");
+
+    dynlist_free(res[0]);
+    dynlist_free(res[1]);
+    free_level(levels[0]);
+    free_level(levels[1]);
+    free(objects[0]);
+    free(objects[1]);
+    free(moves);
+}
+
+// crowd of n overlapping objects in a room, queried with movement-sized
+// segments and with segments across the room
+static void bench(int n) {
+    const int n_queries = 20000;
+    const f32 size = sqrtf(n) * 0.5f;
+
+    level_t *level = new_level();
+    object_t *objects = new_objects(n, size);
+
+    for (int i = 0; i < n; i++) {
+        broadphase_update(level, &objects[i]);
+    }
+
+    vec2s *from = malloc(n_queries * sizeof(vec2s)),
+          *to = malloc(n_queries * sizeof(vec2s));
+
+    for (int i = 0; i < n_queries; i++) {
+        from[i] = rand_pos(size);
+        to[i] =
+            (i % 8) == 0 ?
+                rand_pos(size)
+                : glms_vec2_add(from[i], rand_pos(0.5f));
+    }
+
+    DYNLIST(object_t*) res = NULL;
+    int n_seg = 0, n_box = 0, n_brute = 0;
+
+    u64 start = time_ns();
+    for (int i = 0; i < n_queries; i++) {
+        dynlist_resize(res, 0);
+        broadphase_query_segment(level, from[i], to[i], 0.5f, &res);
+        n_seg += dynlist_size(res);
+    }
+    const u64 ns_seg = time_ns() - start;
+
+    start = time_ns();
+    for (int i = 0; i < n_queries; i++) {
+        dynlist_resize(res, 0);
+        broadphase_query(
+            level,
+            glms_vec2_subs(glms_vec2_minv(from[i], to[i]), 0.5f),
+            glms_vec2_adds(glms_vec2_maxv(from[i], to[i]), 0.5f),
+            &res);
+        n_box += dynlist_size(res);
+    }
+    const u64 ns_box = time_ns() - start;
+
+    start = time_ns();
+    for (int i = 0; i < n_queries; i++) {
+        for (int j = 0; j < n; j++) {
+            n_brute += touches_segment(&objects[j], from[i], to[i], 0.5f);
+        }
+    }
+    const u64 ns_brute = time_ns() - start;
+
+    LOG(
+        "%5d objects: segment %8.1f ns/query (%6.1f candidates), "
+        "box %8.1f ns/query (%6.1f), brute force %9.1f ns/query (%5.1f hits)",
+        n,
+        ns_seg / (f64) n_queries, n_seg / (f64) n_queries,
+        ns_box / (f64) n_queries, n_box / (f64) n_queries,
+        ns_brute / (f64) n_queries, n_brute / (f64) n_queries);
+
+    dynlist_free(res);
+    free(from);
+    free(to);
+    free_level(level);
+    free(objects);
+}
+
+int main(int, char *[]) {
+    srand(0x5EED);
+
+    test_segments();
+    test_determinism();
+
+    const int ns[] = { 100, 500, 1000, 2500, 5000 };
+    for (usize i = 0; i < ARRLEN(ns); i++) {
+        bench(ns[i]);
+    }
+
+    return TEST_RESULT();
+}
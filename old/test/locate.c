@@ -0,0 +1,439 @@
+// test of level/locate.c: hinted point location along randomized walks over a
+// grid of triangulated sectors with holes must agree with a brute force search,
+// and a benchmark of hinted vs. block search
+// build and run from old/:
+//   clang -O2 -std=gnu2x -I. -I../lib/cglm/include test/locate.c -o test_locate
+//   ./test_locate
+#define UTIL_IMPL
+#define RELOAD_HOST
+#include "level/locate.c"
+#include "util/time.h"
+#include "test.h"
+
+// cells of CELL_SIZE, each split into two triangle subsectors along a
+// diagonal, grouped SECTOR_CELLS x SECTOR_CELLS into sectors
+#define CELL_SIZE 1.5f
+#define SECTOR_CELLS 4
+
+typedef struct {
+    level_t level;
+    int n_cells, n_blocks;
+
+    vertex_t *vertices;
+    sector_t *sectors;
+
+    // subsector ids per cell and triangle, -1 for holes
+    int (*cell_subs)[2];
+
+    // level_get_block blocks, n_blocks x n_blocks
+    block_t *blocks;
+} grid_t;
+
+static grid_t *g_grid;
+
+// stand-ins for the rest of the level code, as in level/sector.c
+
+bool sector_contains_point(const sector_t *sector, vec2s p) {
+    if (p.x < sector->min.x
+        || p.x > sector->max.x
+        || p.y < sector->min.y
+        || p.y > sector->max.y) {
+        return false;
+    }
+
+    return !!sector_find_subsector((sector_t*) sector, p);
+}
+
+static bool sub_contains(const subsector_t *sub, vec2s p) {
+    dynlist_each(sub->lines, it) {
+        if (point_side(p, it.el->a->pos, it.el->b->pos) < 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+subsector_t *sector_find_subsector(sector_t *sector, vec2s point) {
+    dynlist_each(sector->subs, it) {
+        if (sub_contains(it.el, point)) { return it.el; }
+    }
+
+    return NULL;
+}
+
+block_t *level_get_block(level_t*, ivec2s pos) {
+    if (pos.x < 0 || pos.y < 0
+        || pos.x >= g_grid->n_blocks || pos.y >= g_grid->n_blocks) {
+        return NULL;
+    }
+
+    return &g_grid->blocks[pos.y * g_grid->n_blocks + pos.x];
+}
+
+static f32 rand_f32(f32 lo, f32 hi) {
+    return lo + (hi - lo) * (rand() / (f32) RAND_MAX);
+}
+
+static vertex_t *grid_vertex(grid_t *grid, int x, int y) {
+    return &grid->vertices[y * (grid->n_cells + 1) + x];
+}
+
+static int cell_index(const grid_t *grid, int x, int y) {
+    return y * grid->n_cells + x;
+}
+
+// counter-clockwise triangles of cell (x, y), split along alternating
+// diagonals
+static void cell_triangles(grid_t *grid, int x, int y, vertex_t *tris[2][3]) {
+    vertex_t
+        *v00 = grid_vertex(grid, x, y),
+        *v10 = grid_vertex(grid, x + 1, y),
+        *v11 = grid_vertex(grid, x + 1, y + 1),
+        *v01 = grid_vertex(grid, x, y + 1);
+
+    if ((x + y) % 2 == 0) {
+        memcpy(tris[0], (vertex_t*[]) { v00, v10, v11 }, sizeof(tris[0]));
+        memcpy(tris[1], (vertex_t*[]) { v00, v11, v01 }, sizeof(tris[1]));
+    } else {
+        memcpy(tris[0], (vertex_t*[]) { v00, v10, v01 }, sizeof(tris[0]));
+        memcpy(tris[1], (vertex_t*[]) { v10, v11, v01 }, sizeof(tris[1]));
+    }
+}
+
+// subsector of cell (x, y) with line b -> a, if any
+static subsector_t *find_reverse_line(
+    grid_t *grid,
+    int x,
+    int y,
+    const sect_line_t *line) {
+    if (x < 0 || y < 0 || x >= grid->n_cells || y >= grid->n_cells) {
+        return NULL;
+    }
+
+    for (int t = 0; t < 2; t++) {
+        const int id = grid->cell_subs[cell_index(grid, x, y)][t];
+        if (id == -1) { continue; }
+
+        subsector_t *sub = grid->level.subsectors[id];
+        dynlist_each(sub->lines, it) {
+            if (it.el->a == line->b && it.el->b == line->a) {
+                return sub;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+// n_cells x n_cells grid with holes, vertices jittered so that no lines are
+// axis aligned
+static grid_t *new_grid(int n_cells) {
+    grid_t *grid = calloc(1, sizeof(grid_t));
+    g_grid = grid;
+
+    grid->n_cells = n_cells;
+    grid->vertices = calloc((n_cells + 1) * (n_cells + 1), sizeof(vertex_t));
+    grid->cell_subs = malloc(n_cells * n_cells * sizeof(grid->cell_subs[0]));
+
+    for (int i = 0; i < n_cells * n_cells; i++) {
+        grid->cell_subs[i][0] = grid->cell_subs[i][1] = -1;
+    }
+
+    for (int y = 0; y <= n_cells; y++) {
+        for (int x = 0; x <= n_cells; x++) {
+            grid_vertex(grid, x, y)->pos =
+                VEC2(
+                    (x + rand_f32(-0.25f, 0.25f)) * CELL_SIZE,
+                    (y + rand_f32(-0.25f, 0.25f)) * CELL_SIZE);
+        }
+    }
+
+    const int n_sector_cells = (n_cells + SECTOR_CELLS - 1) / SECTOR_CELLS;
+    const int n_sectors = n_sector_cells * n_sector_cells;
+    grid->sectors = calloc(n_sectors, sizeof(sector_t));
+
+    int n_subs = 0;
+    for (int i = 0; i < n_sectors; i++) {
+        sector_t *sector = &grid->sectors[i];
+        sector->index = i;
+        sector->min = VEC2(1e30f);
+        sector->max = VEC2(-1e30f);
+
+        // some sectors are missing entirely
+        if (rand() % 16 == 0) { continue; }
+
+        *dynlist_push(grid->level.sectors) = sector;
+
+        const int
+            sx = (i % n_sector_cells) * SECTOR_CELLS,
+            sy = (i / n_sector_cells) * SECTOR_CELLS;
+
+        for (int y = sy; y < min(sy + SECTOR_CELLS, n_cells); y++) {
+            for (int x = sx; x < min(sx + SECTOR_CELLS, n_cells); x++) {
+                vertex_t *tris[2][3];
+                cell_triangles(grid, x, y, tris);
+
+                for (int t = 0; t < 2; t++) {
+                    // and some triangles
+                    if (rand() % 20 == 0) { continue; }
+
+                    subsector_t sub = {
+                        .parent = sector,
+                        .id = n_subs++,
+                        .min = VEC2(1e30f),
+                        .max = VEC2(-1e30f),
+                    };
+
+                    for (int j = 0; j < 3; j++) {
+                        *dynlist_push(sub.lines) =
+                            (sect_line_t) {
+                                .a = tris[t][j],
+                                .b = tris[t][(j + 1) % 3]
+                            };
+                        sub.min = glms_vec2_minv(sub.min, tris[t][j]->pos);
+                        sub.max = glms_vec2_maxv(sub.max, tris[t][j]->pos);
+                    }
+
+                    sector->min = glms_vec2_minv(sector->min, sub.min);
+                    sector->max = glms_vec2_maxv(sector->max, sub.max);
+                    *dynlist_push(sector->subs) = sub;
+                    grid->cell_subs[cell_index(grid, x, y)][t] = sub.id;
+                }
+            }
+        }
+    }
+
+    // subsectors live in their sectors, so only point to them once all are
+    // added
+    dynlist_resize(grid->level.subsectors, n_subs);
+    level_dynlist_each(grid->level.sectors, it) {
+        dynlist_each((*it.el)->subs, it_s) {
+            grid->level.subsectors[it_s.el->id] = it_s.el;
+        }
+    }
+
+    // neighbors across every line shared with another subsector, in this or
+    // any adjacent cell and regardless of sector
+    for (int i = 0; i < n_cells * n_cells; i++) {
+        const int x = i % n_cells, y = i / n_cells;
+
+        for (int t = 0; t < 2; t++) {
+            if (grid->cell_subs[i][t] == -1) { continue; }
+            subsector_t *sub = grid->level.subsectors[grid->cell_subs[i][t]];
+
+            dynlist_each(sub->lines, it) {
+                const ivec2s cells[] = {
+                    IVEC2(x, y), IVEC2(x - 1, y), IVEC2(x + 1, y),
+                    IVEC2(x, y - 1), IVEC2(x, y + 1),
+                };
+
+                for (usize c = 0; c < ARRLEN(cells); c++) {
+                    subsector_t *other =
+                        find_reverse_line(grid, cells[c].x, cells[c].y, it.el);
+
+                    if (other) {
+                        *dynlist_push(sub->neighbors) =
+                            (subsector_neighbor_t) {
+                                .id = other->id,
+                                .line = it.el
+                            };
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    // blocks list every sector whose bounds overlap them
+    grid->n_blocks = (int) ceilf((n_cells + 1) * CELL_SIZE / BLOCK_SIZE);
+    grid->blocks = calloc(grid->n_blocks * grid->n_blocks, sizeof(block_t));
+
+    level_dynlist_each(grid->level.sectors, it) {
+        sector_t *sector = *it.el;
+        const ivec2s
+            lo = level_pos_to_block(glms_vec2_maxv(sector->min, VEC2(0))),
+            hi = level_pos_to_block(sector->max);
+
+        for (int y = lo.y; y <= min(hi.y, grid->n_blocks - 1); y++) {
+            for (int x = lo.x; x <= min(hi.x, grid->n_blocks - 1); x++) {
+                *dynlist_push(grid->blocks[y * grid->n_blocks + x].sectors) =
+                    sector;
+            }
+        }
+    }
+
+    grid->level.blocks.ready = true;
+    return grid;
+}
+
+static void free_grid(grid_t *grid) {
+    for (int i = 0; i < grid->n_blocks * grid->n_blocks; i++) {
+        dynlist_free(grid->blocks[i].sectors);
+    }
+
+    level_dynlist_each(grid->level.sectors, it) {
+        dynlist_each((*it.el)->subs, it_s) {
+            dynlist_free(it_s.el->lines);
+            dynlist_free(it_s.el->neighbors);
+        }
+
+        dynlist_free((*it.el)->subs);
+    }
+
+    dynlist_free(grid->level.sectors);
+    dynlist_free(grid->level.subsectors);
+    free(grid->blocks);
+    free(grid->sectors);
+    free(grid->vertices);
+    free(grid->cell_subs);
+    free(grid);
+}
+
+// sector of the first subsector containing p
+static sector_t *find_brute_force(grid_t *grid, vec2s p) {
+    level_dynlist_each(grid->level.subsectors, it) {
+        if (sub_contains(*it.el, p)) { return (*it.el)->parent; }
+    }
+
+    return NULL;
+}
+
+// next position of a walker: mostly small steps, sometimes onto grid
+// vertices/lines and sometimes anywhere (including outside of the grid)
+static vec2s walk_step(const grid_t *grid, vec2s p) {
+    const f32 size = grid->n_cells * CELL_SIZE;
+    const int r = rand() % 64;
+
+    if (r == 0) {
+        return VEC2(rand_f32(-2, size + 2), rand_f32(-2, size + 2));
+    } else if (r == 1) {
+        const int
+            x = rand() % (grid->n_cells + 1),
+            y = rand() % (grid->n_cells + 1);
+        return grid->vertices[y * (grid->n_cells + 1) + x].pos;
+    } else if (r == 2) {
+        // midpoint of a grid line
+        const int
+            x = rand() % grid->n_cells,
+            y = rand() % (grid->n_cells + 1);
+        const vertex_t *v = &grid->vertices[y * (grid->n_cells + 1) + x];
+        return glms_vec2_scale(glms_vec2_add(v[0].pos, v[1].pos), 0.5f);
+    }
+
+    const f32 step = r < 32 ? 0.1f : CELL_SIZE;
+    return glms_vec2_add(p, VEC2(rand_f32(-step, step), rand_f32(-step, step)));
+}
+
+static void check_walks(int n_cells, int n_walkers, int n_steps) {
+    grid_t *grid = new_grid(n_cells);
+    level_t *level = &grid->level;
+
+    for (int w = 0; w < n_walkers; w++) {
+        const f32 size = n_cells * CELL_SIZE;
+        vec2s p = VEC2(rand_f32(0, size), rand_f32(0, size));
+        sector_t *sector = NULL;
+        subsector_t *sub = NULL;
+
+        for (int i = 0; i < n_steps; i++) {
+            p = walk_step(grid, p);
+
+            sector_t
+                *res = level_find_point_sector(level, p, sector),
+                *expected = find_brute_force(grid, p);
+            subsector_t *res_sub = level_find_point_subsector(level, p, sub);
+
+            // points on shared lines can be in either sector
+            if (!res != !expected
+                || (res && !sector_contains_point(res, p))
+                || !res_sub != !expected
+                || (res_sub && !sub_contains(res_sub, p))) {
+                TEST(
+                    false,
+                    "%d cells, walker %d step %d: (%f, %f) found in sector %d "
+                    "subsector %d, expected sector %d",
+                    n_cells, w, i, p.x, p.y,
+                    res ? res->index : -1,
+                    res_sub ? res_sub->id : -1,
+                    expected ? expected->index : -1);
+                free_grid(grid);
+                return;
+            }
+
+            // as objects do, keep the last sector when leaving the grid
+            if (res) { sector = res; }
+            if (res_sub) { sub = res_sub; }
+        }
+    }
+
+    free_grid(grid);
+}
+
+// walkers taking object-sized steps, hinted against the block search used
+// without a hint
+static void bench(int n_cells) {
+    const int n_points = 1000000;
+
+    grid_t *grid = new_grid(n_cells);
+    level_t *level = &grid->level;
+
+    vec2s *points = malloc(n_points * sizeof(vec2s));
+    const f32 size = n_cells * CELL_SIZE;
+    vec2s p = VEC2(size / 2);
+
+    for (int i = 0; i < n_points; i++) {
+        p = glms_vec2_add(
+            p, VEC2(rand_f32(-0.1f, 0.1f), rand_f32(-0.1f, 0.1f)));
+
+        // stay in the grid, restart walk once out of sectors
+        if (p.x < 0 || p.y < 0 || p.x > size || p.y > size
+            || !find_point_sector_slow(level, p, NULL)) {
+            p = VEC2(rand_f32(0, size), rand_f32(0, size));
+        }
+
+        points[i] = p;
+    }
+
+    sector_t *sector = NULL;
+    int n_found[2] = { 0, 0 };
+
+    u64 start = time_ns();
+    for (int i = 0; i < n_points; i++) {
+        sector_t *res = level_find_point_sector(level, points[i], sector);
+        n_found[0] += !!res;
+        if (res) { sector = res; }
+    }
+    const u64 ns_hinted = time_ns() - start;
+
+    start = time_ns();
+    for (int i = 0; i < n_points; i++) {
+        n_found[1] += !!find_point_sector_slow(level, points[i], NULL);
+    }
+    const u64 ns_slow = time_ns() - start;
+
+    TEST_EQ(n_found[0], n_found[1], "%d cells: points found", n_cells);
+
+    LOG(
+        "%4d x %-4d cells (%6d subsectors): hinted %6.1f ns/call, "
+        "blocks %6.1f ns/call",
+        n_cells, n_cells, dynlist_size(level->subsectors),
+        ns_hinted / (f64) n_points, ns_slow / (f64) n_points);
+
+    free(points);
+    free_grid(grid);
+}
+
+int main(int, char *[]) {
+    srand(0x5EED);
+
+    check_walks(3, 50, 2000);
+    check_walks(16, 50, 5000);
+    check_walks(64, 10, 5000);
+
+    const int ns[] = { 16, 64, 256 };
+    for (usize i = 0; i < ARRLEN(ns); i++) {
+        bench(ns[i]);
+    }
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,346 @@
+// test of level/nav.c on a small hand-built graph: edges within a sector are
+// not gated by width, portals and sector transitions gate by width and height,
+// and paths/flow fields cross disconnected portals
+// build and run from old/:
+//   clang -O2 -std=gnu2x -I. -I../lib/cglm/include test/nav.c -o test_nav
+//   ./test_nav
+#define UTIL_IMPL
+#define RELOAD_HOST
+#include "level/nav.c"
+#include "test.h"
+
+// layout (floor 0, ceiling 4):
+//
+//   sector A: s0 [0,2]x[0,2], s1 [2,4]x[0,2], split along x = 2
+//   sector B: s2 [4,6]x[0,2], connected portal to A along x = 4
+//   sector C: s3 [4,6]x[2,4], solid wall to B along y = 2
+//   sector D: s4 [20,22]x[0,2], disconnected portal from B's x = 6 to D's
+//             x = 20 (both directions)
+enum { A, B, C, D, N_SECTORS };
+
+static level_t level;
+static sector_t sectors[N_SECTORS];
+static vertex_t vertices[64];
+static wall_t walls[8];
+static side_t sides[8];
+static int n_vertices, n_walls, n_sides;
+
+// stand-ins for the rest of the level code, just enough for these rectangles
+
+side_t *side_other(const side_t *side) {
+    return side->wall->side0 == side ? side->wall->side1 : side->wall->side0;
+}
+
+vec2s wall_midpoint(wall_t *wall) {
+    return glms_vec2_scale(glms_vec2_add(wall->v0->pos, wall->v1->pos), 0.5f);
+}
+
+// portals in this layout are parallel, so only translate
+vec2s portal_transform(level_t*, side_t *entry, side_t *exit, vec2s p) {
+    return
+        glms_vec2_add(
+            p,
+            glms_vec2_sub(
+                wall_midpoint(exit->wall),
+                wall_midpoint(entry->wall)));
+}
+
+static bool sub_contains(const subsector_t *sub, vec2s p) {
+    return p.x >= sub->min.x && p.x <= sub->max.x
+        && p.y >= sub->min.y && p.y <= sub->max.y;
+}
+
+subsector_t *sector_find_subsector(sector_t *sector, vec2s point) {
+    dynlist_each(sector->subs, it) {
+        if (sub_contains(it.el, point)) { return it.el; }
+    }
+
+    return NULL;
+}
+
+subsector_t *level_find_point_subsector(
+    level_t *level,
+    vec2s point,
+    subsector_t*) {
+    level_dynlist_each(level->subsectors, it) {
+        if (sub_contains(*it.el, point)) { return *it.el; }
+    }
+
+    return NULL;
+}
+
+static vertex_t *vertex(f32 x, f32 y) {
+    vertex_t *v = &vertices[n_vertices++];
+    v->pos = VEC2(x, y);
+    return v;
+}
+
+// lines are bottom, right, top, left
+enum { BOTTOM, RIGHT, TOP, LEFT };
+
+static void add_sub(int sector, f32 x0, f32 y0, f32 x1, f32 y1) {
+    subsector_t sub = {
+        .parent = &sectors[sector],
+        .min = VEC2(x0, y0),
+        .max = VEC2(x1, y1),
+    };
+
+    vertex_t *vs[4] = {
+        vertex(x0, y0), vertex(x1, y0), vertex(x1, y1), vertex(x0, y1)
+    };
+
+    for (int i = 0; i < 4; i++) {
+        *dynlist_push(sub.lines) =
+            (sect_line_t) { .a = vs[i], .b = vs[(i + 1) % 4] };
+    }
+
+    *dynlist_push(sectors[sector].subs) = sub;
+}
+
+static subsector_t *sub(int id) {
+    return level.subsectors[id];
+}
+
+static void link(int a, int line_a, int b, int line_b) {
+    *dynlist_push(sub(a)->neighbors) =
+        (subsector_neighbor_t) { .id = b, .line = &sub(a)->lines[line_a] };
+    *dynlist_push(sub(b)->neighbors) =
+        (subsector_neighbor_t) { .id = a, .line = &sub(b)->lines[line_b] };
+}
+
+static side_t *add_side(int sector, wall_t *wall, int flags) {
+    side_t *side = &sides[n_sides];
+    side->index = n_sides++;
+    side->wall = wall;
+    side->sector = &sectors[sector];
+    side->flags = flags;
+    llist_prepend(sector_sides, &sectors[sector].sides, side);
+    *dynlist_push(level.sides) = side;
+    return side;
+}
+
+static wall_t *add_wall(f32 x0, f32 y0, f32 x1, f32 y1) {
+    wall_t *wall = &walls[n_walls++];
+    wall->v0 = vertex(x0, y0);
+    wall->v1 = vertex(x1, y1);
+    wall->len = glms_vec2_distance(wall->v0->pos, wall->v1->pos);
+    return wall;
+}
+
+static void build() {
+    for (int i = 0; i < N_SECTORS; i++) {
+        sectors[i].index = i;
+        sectors[i].floor.z = 0.0f;
+        sectors[i].ceil.z = 4.0f;
+    }
+
+    add_sub(A, 0, 0, 2, 2);
+    add_sub(A, 2, 0, 4, 2);
+    add_sub(B, 4, 0, 6, 2);
+    add_sub(C, 4, 2, 6, 4);
+    add_sub(D, 20, 0, 22, 2);
+
+    for (int i = 0; i < N_SECTORS; i++) {
+        dynlist_each(sectors[i].subs, it) {
+            it.el->id = dynlist_size(level.subsectors);
+            *dynlist_push(level.subsectors) = it.el;
+        }
+    }
+
+    link(0, RIGHT, 1, LEFT);
+    link(1, RIGHT, 2, LEFT);
+    link(2, TOP, 3, BOTTOM);
+
+    // A <-> B
+    wall_t *ab = add_wall(4, 0, 4, 2);
+    ab->side0 = add_side(A, ab, 0);
+    ab->side1 = add_side(B, ab, 0);
+    ab->side0->portal = ab->side1;
+    ab->side1->portal = ab->side0;
+
+    // B | C
+    wall_t *bc = add_wall(6, 2, 4, 2);
+    bc->side0 = add_side(B, bc, 0);
+    bc->side1 = add_side(C, bc, 0);
+
+    // B -> D, D -> B
+    wall_t
+        *bd = add_wall(6, 0, 6, 2),
+        *db = add_wall(20, 2, 20, 0);
+    bd->side0 = add_side(B, bd, SIDE_FLAG_DISCONNECT);
+    db->side0 = add_side(D, db, SIDE_FLAG_DISCONNECT);
+    bd->side0->portal = db->side0;
+    db->side0->portal = bd->side0;
+
+    nav_init(&level);
+}
+
+static void destroy() {
+    nav_destroy(&level);
+
+    for (int i = 0; i < N_SECTORS; i++) {
+        dynlist_each(sectors[i].subs, it) {
+            dynlist_free(it.el->lines);
+            dynlist_free(it.el->neighbors);
+        }
+        dynlist_free(sectors[i].subs);
+    }
+
+    dynlist_free(level.subsectors);
+    dynlist_free(level.sides);
+}
+
+// find path, returns number of waypoints or -1 if there is none
+static int find(
+    vec2s from,
+    int from_sector,
+    vec2s to,
+    int to_sector,
+    f32 radius,
+    f32 height,
+    DYNLIST(nav_waypoint_t) *path) {
+    dynlist_resize(*path, 0);
+    return
+        nav_find_path(
+            &level,
+            from, &sectors[from_sector],
+            to, &sectors[to_sector],
+            radius, height,
+            path) ?
+            (int) dynlist_size(*path)
+            : -1;
+}
+
+static bool waypoint_is(const nav_waypoint_t *w, f32 x, f32 y, side_t *portal) {
+    return glms_vec2_eqv_eps(w->pos, VEC2(x, y)) && w->portal == portal;
+}
+
+// false if path has no waypoint i
+static bool path_at(
+    const DYNLIST(nav_waypoint_t) path,
+    int i,
+    f32 x,
+    f32 y,
+    side_t *portal) {
+    return i < dynlist_size(path) && waypoint_is(&path[i], x, y, portal);
+}
+
+static void test_within_sector() {
+    DYNLIST(nav_waypoint_t) path = NULL;
+
+    // wider than the split line between s0 and s1, which only comes from
+    // splitting A and does not gate anything (unlike the portal to B)
+    TEST_EQ(find(VEC2(1, 1), A, VEC2(3, 1), A, 1.1f, 1, &path), 2, "wide");
+    TEST(path_at(path, 0, 2, 1, NULL), "wide");
+
+    TEST_EQ(find(VEC2(3, 1), A, VEC2(1, 1), A, 1.1f, 1, &path), 2, "back");
+
+    dynlist_free(path);
+}
+
+static void test_portal() {
+    DYNLIST(nav_waypoint_t) path = NULL;
+
+    TEST_EQ(find(VEC2(1, 1), A, VEC2(5, 1), B, 0.5f, 1, &path), 3, "A -> B");
+    TEST(path_at(path, 0, 2, 1, NULL), "A -> B");
+    TEST(path_at(path, 1, 4, 1, NULL), "A -> B");
+    TEST(path_at(path, 2, 5, 1, NULL), "A -> B");
+
+    // portal is 2 wide
+    TEST_EQ(find(VEC2(1, 1), A, VEC2(5, 1), B, 1.1f, 1, &path), -1, "too wide");
+
+    // solid wall between adjacent subsectors of different sectors
+    TEST_EQ(find(VEC2(5, 1), B, VEC2(5, 3), C, 0.1f, 1, &path), -1, "solid");
+
+    dynlist_free(path);
+}
+
+static void test_disconnected() {
+    DYNLIST(nav_waypoint_t) path = NULL;
+    side_t *bd = walls[2].side0, *db = walls[3].side0;
+
+    TEST_EQ(find(VEC2(1, 1), A, VEC2(21, 1), D, 0.5f, 1, &path), 4, "A -> D");
+    TEST(path_at(path, 1, 4, 1, NULL), "A -> D");
+    TEST(path_at(path, 2, 6, 1, bd), "A -> D");
+    TEST(path_at(path, 3, 21, 1, NULL), "A -> D");
+    TEST(
+        dynlist_size(path) == 4
+            && glms_vec2_eqv_eps(
+                portal_transform(&level, bd, bd->portal, path[2].pos),
+                VEC2(20, 1)),
+        "A -> D exit");
+
+    TEST_EQ(find(VEC2(21, 1), D, VEC2(1, 1), A, 0.5f, 1, &path), 4, "D -> A");
+    TEST(path_at(path, 0, 20, 1, db), "D -> A");
+    TEST(path_at(path, 1, 4, 1, NULL), "D -> A");
+
+    // heights across the portal: small steps, not too high, enough clearance
+    sectors[D].floor.z = NAV_STEP_HEIGHT * 0.5f;
+    level.version++;
+    TEST_EQ(find(VEC2(5, 1), B, VEC2(21, 1), D, 0.5f, 1, &path), 2, "step");
+
+    sectors[D].floor.z = NAV_STEP_HEIGHT * 2.0f;
+    level.version++;
+    TEST_EQ(find(VEC2(5, 1), B, VEC2(21, 1), D, 0.5f, 1, &path), -1, "ledge");
+
+    // stepping down is always fine
+    TEST_EQ(find(VEC2(21, 1), D, VEC2(5, 1), B, 0.5f, 1, &path), 2, "down");
+
+    sectors[D].floor.z = 0.0f;
+    sectors[D].ceil.z = 1.0f;
+    level.version++;
+    TEST_EQ(find(VEC2(5, 1), B, VEC2(21, 1), D, 0.5f, 2, &path), -1, "low");
+    TEST_EQ(find(VEC2(5, 1), B, VEC2(21, 1), D, 0.5f, 1, &path), 2, "fits");
+
+    sectors[D].ceil.z = 4.0f;
+    level.version++;
+
+    dynlist_free(path);
+}
+
+static void test_field() {
+    nav_field_t field;
+    nav_field_init(&field);
+
+    const vec2s goal = VEC2(21, 1);
+    sector_t *goal_sector = &sectors[D];
+    nav_field_update(&level, &field, &goal, &goal_sector, 1, 0.9f, 1);
+
+    nav_waypoint_t w;
+    TEST(nav_field_sample(&level, &field, VEC2(1, 1), &sectors[A], &w), "s0");
+    TEST(waypoint_is(&w, 2, 1, NULL), "s0");
+
+    TEST(nav_field_sample(&level, &field, VEC2(5, 1), &sectors[B], &w), "s2");
+    TEST(waypoint_is(&w, 6, 1, walls[2].side0), "s2");
+
+    TEST(nav_field_sample(&level, &field, VEC2(21, 1), &sectors[D], &w), "s4");
+    TEST(waypoint_is(&w, 21, 1, NULL), "s4");
+
+    TEST(!nav_field_sample(&level, &field, VEC2(5, 3), &sectors[C], &w), "s3");
+
+    // too wide for the portal into B, but not for A's split line
+    nav_field_update(&level, &field, &goal, &goal_sector, 1, 1.1f, 1);
+    TEST(
+        !nav_field_sample(&level, &field, VEC2(1, 1), &sectors[A], &w),
+        "too wide");
+
+    const vec2s goal_a = VEC2(1, 1);
+    sector_t *goal_a_sector = &sectors[A];
+    nav_field_update(&level, &field, &goal_a, &goal_a_sector, 1, 1.1f, 1);
+    TEST(nav_field_sample(&level, &field, VEC2(3, 1), &sectors[A], &w), "wide");
+    TEST(waypoint_is(&w, 2, 1, NULL), "wide");
+
+    nav_field_destroy(&field);
+}
+
+int main(int, char *[]) {
+    build();
+
+    test_within_sector();
+    test_portal();
+    test_disconnected();
+    test_field();
+
+    destroy();
+    return TEST_RESULT();
+}
@@ -0,0 +1,133 @@
+// test of radix_sort_u32 (util/sort.h) against a stable reference sort
+// build and run from old/:
+//   clang -O2 -std=gnu2x -I. -I../lib/cglm/include test/radix_sort.c -o test_radix_sort
+//   ./test_radix_sort
+#define UTIL_IMPL
+#include "util/math.h"
+#include "util/sort.h"
+#include "test.h"
+
+// masks applied to random keys: every digit, each subset of digits (odd and
+// even numbers of scatter passes) and few distinct keys (many equal keys)
+static const u32 masks[] = {
+    0xFFFFFFFF,
+    0x000000FF,
+    0xFF000000,
+    0x00FF00FF,
+    0x00FFFFFF,
+    0x0000000F,
+    0x00030000,
+};
+
+static u32 rand_u32() {
+    return ((u32) (rand() & 0xFFFF) << 16) | (u32) (rand() & 0xFFFF);
+}
+
+// stable by (key, val), vals are initially the original indices
+static int ref_cmp(const u64 *a, const u64 *b, void*) {
+    return *a < *b ? -1 : (*a > *b ? 1 : 0);
+}
+
+// sort keys, vals = 0..n-1 with radix_sort_u32 and compare to reference
+static void check_sort(const u32 *input, usize n, const char *name) {
+    u32 *keys = malloc(max(n, 1) * sizeof(u32)),
+        *vals = malloc(max(n, 1) * sizeof(u32)),
+        *tmp_keys = malloc(max(n, 1) * sizeof(u32)),
+        *tmp_vals = malloc(max(n, 1) * sizeof(u32));
+    u64 *ref = malloc(max(n, 1) * sizeof(u64));
+
+    for (usize i = 0; i < n; i++) {
+        keys[i] = input[i];
+        vals[i] = i;
+        ref[i] = (((u64) input[i]) << 32) | i;
+    }
+
+    sort(ref, n, sizeof(u64), (f_sort_cmp) ref_cmp, NULL);
+    radix_sort_u32(keys, vals, tmp_keys, tmp_vals, n);
+
+    for (usize i = 0; i < n; i++) {
+        if (keys[i] != (u32) (ref[i] >> 32) || vals[i] != (u32) ref[i]) {
+            TEST(
+                false,
+                "%s n=%d: mismatch at %d (%08x/%d, expected %08x/%d)",
+                name, (int) n, (int) i,
+                keys[i], vals[i], (u32) (ref[i] >> 32), (u32) ref[i]);
+            break;
+        }
+    }
+
+    free(keys);
+    free(vals);
+    free(tmp_keys);
+    free(tmp_vals);
+    free(ref);
+}
+
+static void test_empty() {
+    // n = 0 must not touch (or need) any of the arrays
+    radix_sort_u32(NULL, NULL, NULL, NULL, 0);
+
+    u32 key = 0xDEADBEEF, val = 7, tmp_key = 0, tmp_val = 0;
+    radix_sort_u32(&key, &val, &tmp_key, &tmp_val, 1);
+    TEST_EQ(key, 0xDEADBEEF, "single key");
+    TEST_EQ(val, 7, "single val");
+}
+
+static void test_equal(usize n) {
+    u32 *keys = malloc(n * sizeof(u32));
+    for (usize i = 0; i < n; i++) {
+        keys[i] = 0x12345678;
+    }
+
+    check_sort(keys, n, "equal");
+    free(keys);
+}
+
+static void test_random(usize n, u32 mask) {
+    u32 *keys = malloc(max(n, 1) * sizeof(u32));
+    for (usize i = 0; i < n; i++) {
+        keys[i] = rand_u32() & mask;
+    }
+
+    check_sort(keys, n, "random");
+    free(keys);
+}
+
+// keys which are already sorted/reverse sorted
+static void test_ordered(usize n) {
+    u32 *keys = malloc(n * sizeof(u32));
+
+    for (usize i = 0; i < n; i++) {
+        keys[i] = i * 0x01010101;
+    }
+    check_sort(keys, n, "sorted");
+
+    for (usize i = 0; i < n; i++) {
+        keys[i] = (n - i) * 0x01010101;
+    }
+    check_sort(keys, n, "reversed");
+
+    free(keys);
+}
+
+int main(int, char *[]) {
+    srand(0x5EED);
+
+    test_empty();
+
+    for (usize n = 1; n <= 300; n++) {
+        test_equal(n);
+        test_ordered(n);
+
+        for (usize m = 0; m < ARRLEN(masks); m++) {
+            test_random(n, masks[m]);
+        }
+    }
+
+    test_equal(100000);
+    for (usize m = 0; m < ARRLEN(masks); m++) {
+        test_random(100000, masks[m]);
+    }
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,219 @@
+// test of level/tag.c: random tag_set calls on sides, sectors and decals
+// against a reference, checking tag list slot back-references, that sectors
+// come first in each list, tag_find, tag_suggest and tag_set_value callbacks
+// build and run from old/:
+//   clang -O2 -std=gnu2x -I. -I../lib/cglm/include test/tag.c -o test_tag
+//   ./test_tag
+#define UTIL_IMPL
+#define RELOAD_HOST
+#include "level/tag.c"
+#include "test.h"
+
+#define N_SECTORS 300
+#define N_SIDES 5000
+#define N_DECALS 300
+#define N_OBJECTS (N_SECTORS + N_SIDES + N_DECALS)
+
+static level_t level;
+static sector_t sectors[N_SECTORS];
+static side_t sides[N_SIDES];
+static decal_t decals[N_DECALS];
+
+// calls of tag_change per sector and of actor_wake_tag per tag
+static int tag_changes[N_SECTORS];
+static int tag_wakes[TAG_MAX];
+
+static void count_tag_change(level_t*, sector_t *sector) {
+    tag_changes[sector->index]++;
+}
+
+sector_func_type_t SECTOR_FUNC_TYPE[SCFT_COUNT] = {
+    [SCFT_DIFF] = { .tag_change = count_tag_change },
+};
+
+void actor_wake_tag(level_t*, int tag) {
+    tag_wakes[tag]++;
+}
+
+// lptr of object i, sectors then sides then decals
+static lptr_t object_ptr(int i) {
+    if (i < N_SECTORS) {
+        return LPTR_FROM(&sectors[i]);
+    } else if (i < N_SECTORS + N_SIDES) {
+        return LPTR_FROM(&sides[i - N_SECTORS]);
+    }
+
+    return LPTR_FROM(&decals[i - N_SECTORS - N_SIDES]);
+}
+
+static void init() {
+    for (int i = 0; i < N_SECTORS; i++) {
+        sectors[i].index = i;
+        sectors[i].gen = 1;
+        sectors[i].func_type = i % 2 ? SCFT_DIFF : SCFT_NONE;
+        *dynlist_push(level.sectors) = &sectors[i];
+    }
+
+    for (int i = 0; i < N_SIDES; i++) {
+        sides[i].index = i;
+        sides[i].gen = 1;
+        *dynlist_push(level.sides) = &sides[i];
+    }
+
+    for (int i = 0; i < N_DECALS; i++) {
+        decals[i].index = i;
+        decals[i].gen = 1;
+        *dynlist_push(level.decals) = &decals[i];
+    }
+}
+
+// list of tag must hold exactly the objects tagged with it, sectors first,
+// each knowing its slot
+static void check_tag(int tag, const int *ref, const char *name) {
+    if (tag == TAG_NONE) { return; }
+
+    const DYNLIST(lptr_t) list = level.tag_lists[tag];
+
+    int n = 0, n_sectors = 0;
+    for (int i = 0; i < N_OBJECTS; i++) {
+        if (ref[i] != tag) { continue; }
+        n++;
+        n_sectors += i < N_SECTORS;
+    }
+
+    TEST_EQ(dynlist_size(list), n, "%s: tag %d size", name, tag);
+    TEST_EQ(
+        level.tag_n_sectors[tag], n_sectors, "%s: tag %d sectors", name, tag);
+    TEST_EQ(
+        bitmap_get(level.tags_used, tag), n != 0,
+        "%s: tag %d used", name, tag);
+
+    dynlist_each(list, it) {
+        if (*lptr_ptag(&level, *it.el) != tag
+            || *lptr_ptag_slot(&level, *it.el) != (int) it.i
+            || (LPTR_TYPE(*it.el) == T_SECTOR) != ((int) it.i < n_sectors)) {
+            TEST(false, "%s: tag %d bad slot %d", name, tag, (int) it.i);
+            break;
+        }
+    }
+
+    lptr_t found[N_OBJECTS];
+    TEST_EQ(tag_find(&level, tag, found, N_OBJECTS), n, "%s: tag_find", name);
+    TEST(
+        n == 0 || !memcmp(found, list, n * sizeof(lptr_t)),
+        "%s: tag_find results differ", name);
+}
+
+// first tag with no objects
+static int ref_suggest(const int *ref) {
+    static bool used[TAG_MAX];
+    memset(used, 0, sizeof(used));
+
+    for (int i = 0; i < N_OBJECTS; i++) {
+        used[ref[i]] = true;
+    }
+
+    for (int tag = 1; tag < TAG_MAX; tag++) {
+        if (!used[tag]) { return tag; }
+    }
+
+    return TAG_NONE;
+}
+
+static void set(int *ref, int i, int tag) {
+    tag_set(&level, object_ptr(i), tag);
+    ref[i] = tag;
+}
+
+// random retags, mostly between a few tags so that lists get long
+static void test_random(int *ref, int n_ops) {
+    for (int op = 0; op < n_ops; op++) {
+        const int i = rand() % N_OBJECTS, old = ref[i];
+
+        int tag;
+        switch (rand() % 8) {
+        case 0: tag = TAG_NONE; break;
+        case 1: tag = 1 + rand() % (TAG_MAX - 1); break;
+        default: tag = 1 + rand() % 16;
+        }
+
+        set(ref, i, tag);
+
+        check_tag(old, ref, "random old");
+        check_tag(tag, ref, "random new");
+
+        if (op % 64 == 0) {
+            TEST_EQ(tag_suggest(&level), ref_suggest(ref), "op %d suggest", op);
+        }
+    }
+
+    for (int tag = 1; tag < TAG_MAX; tag++) {
+        check_tag(tag, ref, "random all");
+    }
+}
+
+// tag_set_value calls tag_change once per tagged sector, and only for them
+static void test_set_value(const int *ref) {
+    for (int tag = 1; tag <= 16; tag++) {
+        memset(tag_changes, 0, sizeof(tag_changes));
+        tag_wakes[tag] = 0;
+
+        TEST_EQ(tag_set_value(&level, tag, tag * 10), tag * 10, "set value");
+        TEST_EQ(tag_get_value(&level, tag), tag * 10, "get value");
+        TEST_EQ(tag_wakes[tag], 1, "tag %d woken", tag);
+
+        for (int i = 0; i < N_SECTORS; i++) {
+            const int expected =
+                ref[i] == tag && sectors[i].func_type == SCFT_DIFF;
+            if (tag_changes[i] != expected) {
+                TEST(
+                    false,
+                    "tag %d: sector %d tag_change called %d times",
+                    tag, i, tag_changes[i]);
+                break;
+            }
+        }
+    }
+}
+
+// fill every tag with a side so that tag_suggest runs out, then free tags
+// in reverse order
+static void test_suggest_full(int *ref) {
+    for (int i = 0; i < N_OBJECTS; i++) {
+        set(ref, i, TAG_NONE);
+    }
+
+    TEST_EQ(tag_suggest(&level), 1, "empty suggest");
+
+    for (int tag = 1; tag < TAG_MAX; tag++) {
+        set(ref, N_SECTORS + tag - 1, tag);
+        TEST_EQ(
+            tag_suggest(&level), tag == TAG_MAX - 1 ? TAG_NONE : tag + 1,
+            "suggest after filling tag %d", tag);
+    }
+
+    for (int tag = TAG_MAX - 1; tag >= 1; tag -= 7) {
+        set(ref, N_SECTORS + tag - 1, TAG_NONE);
+        TEST_EQ(tag_suggest(&level), tag, "suggest after freeing tag %d", tag);
+        check_tag(tag, ref, "freed");
+    }
+}
+
+int main(int, char *[]) {
+    srand(0x5EED);
+    init();
+
+    static int ref[N_OBJECTS];
+    test_random(ref, 20000);
+    test_set_value(ref);
+    test_suggest_full(ref);
+
+    for (int tag = 1; tag < TAG_MAX; tag++) {
+        dynlist_free(level.tag_lists[tag]);
+    }
+
+    dynlist_free(level.sectors);
+    dynlist_free(level.sides);
+    dynlist_free(level.decals);
+    return TEST_RESULT();
+}
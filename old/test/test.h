@@ -0,0 +1,43 @@
+#pragma once
+
+#include "util/log.h"
+#include "util/macros.h"
+#include "util/types.h"
+
+// minimal checks for the standalone programs in test/, each of which is built
+// on its own (see the comment at the top of each file) and exits non-zero if
+// any check failed
+
+static int test_failures = 0;
+
+// check _e, warning with fmt __VA_ARGS__ if it does not hold
+#define TEST(_e, _fmt, ...)                                                    \
+    do {                                                                       \
+        if (!(_e)) {                                                           \
+            WARN("FAILED: %s: " _fmt, #_e, ##__VA_ARGS__);                     \
+            test_failures++;                                                   \
+        }                                                                      \
+    } while (0)
+
+// check _a == _b for integers
+#define TEST_EQ(_a, _b, _fmt, ...)                                             \
+    do {                                                                       \
+        const i64 __a = (_a), __b = (_b);                                      \
+        if (__a != __b) {                                                      \
+            WARN(                                                              \
+                "FAILED: %s == %s (%" PRIi64 " != %" PRIi64 "): " _fmt,       \
+                #_a, #_b, __a, __b, ##__VA_ARGS__);                            \
+            test_failures++;                                                   \
+        }                                                                      \
+    } while (0)
+
+// log result, evaluates to exit code for main
+#define TEST_RESULT()                                                          \
+    ({                                                                         \
+        if (test_failures) {                                                   \
+            WARN("%d check(s) failed", test_failures);                         \
+        } else {                                                               \
+            LOG("all checks passed");                                          \
+        }                                                                      \
+        test_failures ? 1 : 0;                                                 \
+    })
@@ -0,0 +1,212 @@
+// differential test of sparse (run-length) visibility rows in
+// level/visibility.c against dense rows and a reference matrix
+// build and run from old/:
+//   clang -O2 -std=gnu2x -I. -I../lib/cglm/include test/visibility.c -o test_visibility
+//   ./test_visibility
+#define UTIL_IMPL
+#define RELOAD_HOST
+#include "level/visibility.c"
+#include "test.h"
+
+// not reached, visibility_bake is not tested here
+vec2s portal_transform(level_t*, side_t*, side_t*, vec2s p) {
+    return p;
+}
+
+int level_get_list_count(const level_t*, int) {
+    return 0;
+}
+
+// runs_set/runs_clr against a plain bitmap
+static void test_runs(int n, int n_ops) {
+    DYNLIST(u32) runs = NULL;
+    BITMAP *ref = bitmap_calloc(n), *decoded = bitmap_alloc(n);
+
+    for (int op = 0; op < n_ops; op++) {
+        const int i = rand() % n;
+
+        if (rand() % 2) {
+            runs_set(&runs, i);
+            bitmap_set(ref, i);
+        } else {
+            runs_clr(&runs, i);
+            bitmap_clr(ref, i);
+        }
+
+        const int j = rand() % n;
+        if (runs_get(runs, j) != bitmap_get(ref, j)) {
+            TEST(false, "n=%d op %d: runs_get(%d) differs", n, op, j);
+            break;
+        }
+    }
+
+    // runs must be sorted, non-empty, and neither adjacent nor overlapping
+    for (int r = 0; r < dynlist_size(runs); r += 2) {
+        TEST(runs[r] < runs[r + 1], "n=%d: empty run at %d", n, r);
+        TEST(
+            r == 0 || runs[r - 1] < runs[r],
+            "n=%d: runs touch at %d", n, r);
+    }
+
+    runs_decode(runs, decoded, n);
+    for (int i = 0; i < n; i++) {
+        if (bitmap_get(decoded, i) != bitmap_get(ref, i)) {
+            TEST(false, "n=%d: decoded runs differ at %d", n, i);
+            break;
+        }
+    }
+
+    dynlist_free(runs);
+    bitmap_free(ref);
+    bitmap_free(decoded);
+}
+
+// random row of n bits in clumps, as sectors usually see their surroundings
+static void random_row(BITMAP *bits, int n, int index) {
+    bitmap_fill(bits, n, false);
+
+    const int n_clumps = rand() % 6;
+    for (int c = 0; c < n_clumps; c++) {
+        const int start = rand() % n, len = 1 + rand() % 16;
+
+        for (int i = start; i < min(start + len, n); i++) {
+            bitmap_set(bits, i);
+        }
+    }
+
+    // and some scattered sectors
+    for (int i = 0; i < 4; i++) {
+        if (rand() % 2) { bitmap_set(bits, rand() % n); }
+    }
+
+    bitmap_set(bits, index);
+}
+
+typedef struct {
+    int n;
+
+    // reference traces and the rows expected from them
+    BITMAP **traced;
+} ref_t;
+
+ALWAYS_INLINE bool ref_get(const ref_t *ref, int i, int j) {
+    return bitmap_get(ref->traced[i], j)
+        && (i == j || bitmap_get(ref->traced[j], i));
+}
+
+// compare both levels against each other and against the reference
+static void check_levels(
+    level_t *dense,
+    level_t *sparse,
+    const ref_t *ref,
+    sector_t *sectors,
+    const char *name) {
+    TEST(!visibility_is_sparse(dense), "%s: dense is sparse", name);
+    TEST(visibility_is_sparse(sparse), "%s: sparse is dense", name);
+
+    BITMAP *scratch = bitmap_alloc(sparse->visibility.n);
+
+    for (int i = 0; i < ref->n; i++) {
+        const BITMAP
+            *row_d = visibility_row(dense, &sectors[i], NULL),
+            *row_s = visibility_row(sparse, &sectors[i], scratch);
+
+        for (int j = 0; j < ref->n; j++) {
+            const bool expected = ref_get(ref, i, j);
+
+            if (bitmap_get(row_d, j) != expected
+                || bitmap_get(row_s, j) != expected
+                || visibility_get(dense, &sectors[i], j) != expected
+                || visibility_get(sparse, &sectors[i], j) != expected) {
+                TEST(false, "%s: rows differ at (%d, %d)", name, i, j);
+                bitmap_free(scratch);
+                return;
+            }
+        }
+    }
+
+    bitmap_free(scratch);
+}
+
+static void test_rows(int n, int n_ops) {
+    level_t dense = { 0 }, sparse = { 0 };
+    visibility_ensure(&dense, n);
+    visibility_ensure(&sparse, VISIBILITY_DENSE_MAX + 1);
+
+    sector_t *sectors = calloc(n, sizeof(sector_t));
+    ref_t ref = { .n = n, .traced = calloc(n, sizeof(BITMAP*)) };
+
+    for (int i = 0; i < n; i++) {
+        sectors[i].index = i;
+        ref.traced[i] = bitmap_calloc(n);
+    }
+
+    BITMAP *bits = bitmap_alloc(n);
+
+    for (int op = 0; op < n_ops; op++) {
+        const int i = rand() % n;
+
+        if (rand() % 8 == 0) {
+            visibility_clear(&dense, &sectors[i]);
+            visibility_clear(&sparse, &sectors[i]);
+
+            bitmap_fill(ref.traced[i], n, false);
+            for (int j = 0; j < n; j++) {
+                bitmap_clr(ref.traced[j], i);
+            }
+        } else {
+            random_row(bits, n, i);
+            visibility_set_row(&dense, &sectors[i], bits, n);
+            visibility_set_row(&sparse, &sectors[i], bits, n);
+            memcpy(ref.traced[i], bits, BITMAP_SIZE_TO_BYTES(n));
+        }
+    }
+
+    check_levels(&dense, &sparse, &ref, sectors, "random");
+
+    // every sector traced once more, as after loading a level
+    for (int i = 0; i < n; i++) {
+        random_row(bits, n, i);
+        visibility_set_row(&dense, &sectors[i], bits, n);
+        visibility_set_row(&sparse, &sectors[i], bits, n);
+        memcpy(ref.traced[i], bits, BITMAP_SIZE_TO_BYTES(n));
+    }
+
+    check_levels(&dense, &sparse, &ref, sectors, "full");
+
+    // switching from dense to sparse keeps rows
+    level_t switched = { 0 };
+    visibility_ensure(&switched, n);
+    for (int i = 0; i < n; i++) {
+        visibility_set_row(&switched, &sectors[i], ref.traced[i], n);
+    }
+    visibility_ensure(&switched, VISIBILITY_DENSE_MAX + 1);
+
+    check_levels(&dense, &switched, &ref, sectors, "switched");
+
+    for (int i = 0; i < n; i++) {
+        bitmap_free(ref.traced[i]);
+    }
+
+    free(ref.traced);
+    free(sectors);
+    bitmap_free(bits);
+    visibility_destroy(&dense);
+    visibility_destroy(&sparse);
+    visibility_destroy(&switched);
+}
+
+int main(int, char *[]) {
+    srand(0x5EED);
+
+    for (int n = 1; n <= 200; n++) {
+        test_runs(n, 20 * n);
+    }
+    test_runs(100000, 200000);
+
+    test_rows(10, 200);
+    test_rows(100, 2000);
+    test_rows(1000, 4000);
+
+    return TEST_RESULT();
+}
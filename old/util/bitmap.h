@@ -7,6 +7,25 @@
 #include "util/types.h"
 #include "util/math.h"
 
+// row operations (or/and/andnot) use the widest vector unit available at
+// compile time, everything else works a u64 word at a time
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define BITMAP_SIMD_AVX2
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define BITMAP_SIMD_SSE2
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define BITMAP_SIMD_NEON
+#endif
+
+// word-level operations assume bit n of a bitmap is bit (n % 64) of the
+// (n / 64)th u64 word
+STATIC_ASSERT(
+    __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__,
+    "bitmap.h requires little endian");
+
 // usage: like FILE*, always use as BITMAP*
 typedef u8 BITMAP;
 
@@ -69,10 +88,15 @@ ALWAYS_INLINE void bitmap_put(BITMAP *b, int n, bool val) {
 }
 
 ALWAYS_INLINE void bitmap_fill(BITMAP *b, int size, bool val) {
-    const u8 v = val ? 0xFF : 0x00;
-    for (int i = 0; i < BITMAP_SIZE_TO_BYTES(size); i++) {
-        b[i] = v;
-    }
+    memset(b, val ? 0xFF : 0x00, BITMAP_SIZE_TO_BYTES(size));
+}
+
+// load (up to) 8 bytes of bitmap starting at byte i as a word, where n is the
+// size of the bitmap in bytes. bytes past the end are zero.
+ALWAYS_INLINE u64 _bitmap_load64(const BITMAP *b, int i, int n) {
+    u64 w = 0;
+    memcpy(&w, &b[i], n - i >= 8 ? 8 : n - i);
+    return w;
 }
 
 // count number of bits with value
@@ -114,6 +138,32 @@ ALWAYS_INLINE int bitmap_count(const BITMAP *b, int size, bool val) {
     return n;
 }
 
+// count number of bits with value in [from, to)
+ALWAYS_INLINE int bitmap_count_range(
+    const BITMAP *b,
+    int from,
+    int to,
+    bool val) {
+    if (from >= to) { return 0; }
+
+    const int n_bytes = BITMAP_SIZE_TO_BYTES(to);
+    int n = 0;
+
+    for (int i = (from / 64) * 8; i < n_bytes; i += 8) {
+        u64 w = _bitmap_load64(b, i, n_bytes);
+        if (!val) { w = ~w; }
+
+        // mask off bits outside of [from, to) in this word
+        const int lo = i * 8;
+        if (from > lo) { w &= ~0ull << (from - lo); }
+        if (to - lo < 64) { w &= (1ull << (to - lo)) - 1; }
+
+        n += popcount(w);
+    }
+
+    return n;
+}
+
 // returns index of lowest bit with value or INT_MAX if there is no such bit
 ALWAYS_INLINE int bitmap_find(
     const BITMAP *b,
@@ -123,26 +173,106 @@ ALWAYS_INLINE int bitmap_find(
     if (size == 0) { return INT_MAX; }
     else if (start >= size) { return INT_MAX; }
 
-    const u8 *p = b + (start / 8), *end = b + BITMAP_SIZE_TO_BYTES(size);
-
-    // search start value - offset according to start if not byte aligned
-    int from = start % 8;
+    const int n_bytes = BITMAP_SIZE_TO_BYTES(size);
+    const u64 flip = val ? 0 : ~0ull;
 
-    while (p != end) {
-        if ((val ? popcount(*p) : invpopcount(*p)) != 0) {
-            const int to =
-                p == (end - 1) ? (8 - BITMAP_EXCESS_BITS(size)) : 8;
+    // first word starts at start's byte, mask off bits before start
+    int i = start / 8;
+    u64 w = (_bitmap_load64(b, i, n_bytes) ^ flip) & (~0ull << (start % 8));
 
-            for (int i = from; i < to; i++) {
-                if (val == !!(*p & (1 << i))) {
-                    return (8 * ((int) (p - b))) + i;
-                }
-            }
+    while (true) {
+        if (w) {
+            // excess bits (or zero padding when looking for false) can be
+            // found past the end, but only if there is no valid bit before
+            const int n = (i * 8) + ctz64(w);
+            return n < size ? n : INT_MAX;
         }
 
-        from = 0;
-        p++;
+        i += 8;
+        if (i >= n_bytes) { break; }
+
+        w = _bitmap_load64(b, i, n_bytes) ^ flip;
     }
 
     return INT_MAX;
 }
+
+// iterate indices of set bits in bitmap, _b and _size are evaluated repeatedly
+// usage: bitmap_each_set(bits, n, i) { ... }
+#define bitmap_each_set(_b, _size, _i)                                         \
+    for (int _i = bitmap_find((_b), (_size), 0, true);                         \
+         _i != INT_MAX;                                                        \
+         _i = bitmap_find((_b), (_size), _i + 1, true))
+
+// defines bitmap_<_name>(dst, src, size), which applies an operation to the
+// first "size" bits of dst with src. _vop256/_vop128 are the vector
+// intrinsics for the operation on the selected SIMD target, _op is a scalar
+// expression of d and s.
+#if defined(BITMAP_SIMD_AVX2)
+#define _BITMAP_ROW_OP_SIMD(_vop256, _vop128)                                  \
+    for (; n - i >= 32; i += 32) {                                             \
+        const __m256i                                                          \
+            d = _mm256_loadu_si256((const __m256i*) &dst[i]),                  \
+            s = _mm256_loadu_si256((const __m256i*) &src[i]);                  \
+        _mm256_storeu_si256((__m256i*) &dst[i], _vop256);                      \
+    }
+#elif defined(BITMAP_SIMD_SSE2)
+#define _BITMAP_ROW_OP_SIMD(_vop256, _vop128)                                  \
+    for (; n - i >= 16; i += 16) {                                             \
+        const __m128i                                                          \
+            d = _mm_loadu_si128((const __m128i*) &dst[i]),                     \
+            s = _mm_loadu_si128((const __m128i*) &src[i]);                     \
+        _mm_storeu_si128((__m128i*) &dst[i], _vop128);                         \
+    }
+#elif defined(BITMAP_SIMD_NEON)
+#define _BITMAP_ROW_OP_SIMD(_vop256, _vop128)                                  \
+    for (; n - i >= 16; i += 16) {                                             \
+        const uint8x16_t d = vld1q_u8(&dst[i]), s = vld1q_u8(&src[i]);         \
+        vst1q_u8(&dst[i], _vop128);                                            \
+    }
+#else
+#define _BITMAP_ROW_OP_SIMD(_vop256, _vop128)
+#endif
+
+#define _BITMAP_ROW_OP(_name, _vop256, _vop128, _op)                           \
+    ALWAYS_INLINE void bitmap_##_name(                                         \
+        BITMAP *dst, const BITMAP *src, int size) {                            \
+        const int n = BITMAP_SIZE_TO_BYTES(size);                              \
+        int i = 0;                                                             \
+        _BITMAP_ROW_OP_SIMD(_vop256, _vop128)                                  \
+        for (; n - i >= 8; i += 8) {                                           \
+            u64 d, s;                                                          \
+            memcpy(&d, &dst[i], 8);                                            \
+            memcpy(&s, &src[i], 8);                                            \
+            d = _op;                                                           \
+            memcpy(&dst[i], &d, 8);                                            \
+        }                                                                      \
+        for (; i < n; i++) {                                                   \
+            const u8 d = dst[i], s = src[i];                                   \
+            dst[i] = _op;                                                      \
+        }                                                                      \
+    }
+
+#if defined(BITMAP_SIMD_NEON)
+// dst |= src
+_BITMAP_ROW_OP(or, _, vorrq_u8(d, s), d | s)
+
+// dst &= src
+_BITMAP_ROW_OP(and, _, vandq_u8(d, s), d & s)
+
+// dst &= ~src
+_BITMAP_ROW_OP(andnot, _, vbicq_u8(d, s), d & ~s)
+#else
+// dst |= src
+_BITMAP_ROW_OP(or, _mm256_or_si256(d, s), _mm_or_si128(d, s), d | s)
+
+// dst &= src
+_BITMAP_ROW_OP(and, _mm256_and_si256(d, s), _mm_and_si128(d, s), d & s)
+
+// dst &= ~src (NOTE: x86 andnot is ~a & b)
+_BITMAP_ROW_OP(
+    andnot, _mm256_andnot_si256(s, d), _mm_andnot_si128(s, d), d & ~s)
+#endif
+
+#undef _BITMAP_ROW_OP
+#undef _BITMAP_ROW_OP_SIMD
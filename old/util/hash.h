@@ -30,6 +30,16 @@ ALWAYS_INLINE hash_t hash_add_str(hash_t hash, const char *s) {
     return hash;
 }
 
+// fnv1a over n bytes, start from HASH_FNV1A_INIT
+#define HASH_FNV1A_INIT 14695981039346656037u
+
+ALWAYS_INLINE hash_t hash_add_bytes(hash_t hash, const void *p, usize n) {
+    for (usize i = 0; i < n; i++) {
+        hash = (hash ^ ((const u8*) p)[i]) * 1099511628211u;
+    }
+    return hash;
+}
+
 ALWAYS_INLINE hash_t hash_add_uintptr(hash_t hash, uintptr_t x) {
     return
         (hash ^
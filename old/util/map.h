@@ -5,6 +5,8 @@
 
 #include "util/types.h"
 #include "util/assert.h"
+#include "util/hash.h"
+#include "util/math.h"
 #include "util/str.h"
 
 typedef hash_t (*f_map_hash)(void*, void*);
@@ -47,15 +49,25 @@ enum {
 // hash functions
 hash_t map_hash_id(void *p, void*);
 hash_t map_hash_str(void *p, void*);
+hash_t map_hash_u64(void *p, void*);
 // uint64_t map_hash_u32(const void *key);
 
 // compare functions
 int map_cmp_id(void *p, void *q, void*);
 int map_cmp_str(void *p, void *q, void*);
+int map_cmp_u64(void *p, void *q, void*);
 // int map_cmp_u32(const void *a, const void *b);
 
+// pack ivec2s into a u64 key for map_hash_u64/map_cmp_u64 maps. keys are
+// passed as u64* and stored out of line (map_dup_u64/map_default_free) since
+// a void* key cannot hold a u64 on 32-bit targets
+ALWAYS_INLINE u64 map_ivec2_to_u64(ivec2s v) {
+    return ((u64) (u32) v.x) | (((u64) (u32) v.y) << 32);
+}
+
 // duplication functions
 void *map_dup_str(void *s, void*);
+void *map_dup_u64(void *p, void*);
 // void *map_dup_u32(const void *p);
 
 // default map_alloc_fn implemented with stdlib's "realloc()"
@@ -276,6 +288,11 @@ hash_t map_hash_str(void *p, void*) {
     return h;
 }
 
+hash_t map_hash_u64(void *p, void*) {
+    const u64 key = *(u64*) p;
+    return hash_add_u32(hash_add_u32(0x12345, key & 0xFFFFFFFF), key >> 32);
+}
+
 /* uint64_t map_hash_u32(const void *key) {
     return (uint64_t)(*(const uint32_t*)key);
 } */
@@ -288,6 +305,10 @@ int map_cmp_str(void *p, void *q, void*) {
     return strcmp(p, q);
 }
 
+int map_cmp_u64(void *p, void *q, void*) {
+    return *(u64*) p == *(u64*) q ? 0 : 1;
+}
+
 /* int map_cmp_u32(const void *a, const void *b) {
     return (*(const uint32_t*)a) - (*(const uint32_t*)b);
 } */
@@ -296,6 +317,12 @@ void *map_dup_str(void *s, void*) {
     return strdup(s);
 }
 
+void *map_dup_u64(void *p, void*) {
+    u64 *dup = malloc(sizeof(u64));
+    *dup = *(u64*) p;
+    return dup;
+}
+
 /* void *map_dup_u32(const void *p) {
     uint32_t *dup = malloc(sizeof(uint32_t));
     *dup = *(const uint32_t*)p;
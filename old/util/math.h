@@ -393,6 +393,43 @@ ALWAYS_INLINE bool sweep_circle_circle(
     return true;
 }
 
+// [pr]0 are static, [pr]1 are dynamic along v. unlike sweep_circle_circle, *t
+// is the time of first contact in [0, 1]. circles which already overlap only
+// "hit" (at t = 0) if v moves them further into each other.
+ALWAYS_INLINE bool sweep_circle_circle_contact(
+    vec2s p0, f32 r0, vec2s p1, f32 r1, vec2s v, f32 *t) {
+    const vec2s m = glms_vec2_sub(p1, p0);
+    const f32
+        r = r0 + r1,
+        a = glms_vec2_dot(v, v),
+        b = glms_vec2_dot(m, v),
+        c = glms_vec2_dot(m, m) - (r * r);
+
+    if (c < 0.0f) {
+        if (b >= 0.0f) { return false; }
+        if (t) { *t = 0.0f; }
+        return true;
+    }
+
+    // moving away or not moving
+    if (b >= 0.0f || a <= 0.0f) {
+        return false;
+    }
+
+    const f32 disc = (b * b) - (a * c);
+    if (disc < 0.0f) {
+        return false;
+    }
+
+    const f32 t_hit = (-b - sqrtf(disc)) / a;
+    if (t_hit > 1.0f) {
+        return false;
+    }
+
+    if (t) { *t = max(t_hit, 0.0f); }
+    return true;
+}
+
 // sweep circle at p with radius r along vector d, collide line segment a -> b
 ALWAYS_INLINE bool sweep_circle_line_segment(
     vec2s p,
@@ -654,6 +691,9 @@ ALWAYS_INLINE f32 angle_in_points(vec2s a, vec2s b, vec2s c) {
 // (C)ount (T)railing (Z)eros
 #define ctz(_x) (__builtin_ctz((_x)))
 
+// (C)ount (T)railing (Z)eros, 64-bit
+#define ctz64(_x) (__builtin_ctzll((_x)))
+
 // returns true if ts makes a hole inside of vs
 bool polygon_is_hole(
     vec2s vs[][2],
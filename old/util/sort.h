@@ -1,7 +1,9 @@
 #pragma once
 
 #include <stdlib.h>
+#include <string.h>
 
+#include "types.h"
 #include "macros.h"
 
 // adapted from stackoverflow.com/questions/4300896
@@ -37,3 +39,65 @@ ALWAYS_INLINE void sort(
     #error cannnot detect platform for sort!
 #endif
 }
+
+// stable LSD radix sort of n keys by 8 bit digits, vals are permuted along
+// with keys. tmp_keys/tmp_vals are scratch of n elements each
+void radix_sort_u32(
+    u32 *keys,
+    u32 *vals,
+    u32 *tmp_keys,
+    u32 *tmp_vals,
+    usize n);
+
+#ifdef UTIL_IMPL
+void radix_sort_u32(
+    u32 *keys,
+    u32 *vals,
+    u32 *tmp_keys,
+    u32 *tmp_vals,
+    usize n) {
+    u32 *src_k = keys, *src_v = vals, *dst_k = tmp_keys, *dst_v = tmp_vals;
+
+    // histograms for all digits in one pass over keys
+    usize counts[4][256] = { 0 };
+    for (usize i = 0; i < n; i++) {
+        const u32 k = keys[i];
+        counts[0][(k >> 0) & 0xFF]++;
+        counts[1][(k >> 8) & 0xFF]++;
+        counts[2][(k >> 16) & 0xFF]++;
+        counts[3][(k >> 24) & 0xFF]++;
+    }
+
+    for (int d = 0; d < 4; d++) {
+        const int shift = d * 8;
+
+        // skip digits where all keys are the same
+        if (n == 0 || counts[d][(keys[0] >> shift) & 0xFF] == n) {
+            continue;
+        }
+
+        // counts -> offsets
+        usize offsets[256], sum = 0;
+        for (int i = 0; i < 256; i++) {
+            offsets[i] = sum;
+            sum += counts[d][i];
+        }
+
+        for (usize i = 0; i < n; i++) {
+            const usize j = offsets[(src_k[i] >> shift) & 0xFF]++;
+            dst_k[j] = src_k[i];
+            dst_v[j] = src_v[i];
+        }
+
+        u32 *t;
+        t = src_k; src_k = dst_k; dst_k = t;
+        t = src_v; src_v = dst_v; dst_v = t;
+    }
+
+    // odd number of scatters, result is in scratch
+    if (src_k != keys) {
+        memcpy(keys, src_k, n * sizeof(u32));
+        memcpy(vals, src_v, n * sizeof(u32));
+    }
+}
+#endif // ifdef UTIL_IMPL